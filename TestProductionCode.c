@@ -36,6 +36,7 @@
 #include "unity.h"
 #include <string.h>             /* for strcmp() */
 #include <pthread.h>            /* for pthread_* calls */
+#include <unistd.h>             /* for sleep() */
 
 /*
  * Include things to test 
@@ -44,6 +45,20 @@
 #include "work_queue.hpp"
 #include "buffer_processing.hpp"
 #include "word_dict.hpp"
+#include "hash_store.hpp"
+#include "key_arena.hpp"
+#include "approx_counter.hpp"
+#include "hyper_log_log.hpp"
+#include "dict_snapshot.hpp"
+#include "dict_file.hpp"
+#include "perfect_hash.hpp"
+#include "frozen_dict.hpp"
+#include "radix_store.hpp"
+#include "mem_stats.hpp"
+#include "dict_spill.hpp"
+#include "word_scan.hpp"
+#include "uring_reader.hpp"
+#include "utf8_words.hpp"
 
 /**
  * Provide constant for a non-zero length, which should be valid, exact value
@@ -181,6 +196,62 @@ void test_popWorkQueue (void)
     myQueue->pop ();
 }
 
+/**
+ *******************************************************************************
+ * @brief test_tryPopWorkQueue - Test popping without waiting, from a queue
+ * with an entry and then from an empty one.
+ *******************************************************************************
+ */
+void test_tryPopWorkQueue (void)
+{
+    Work_Queue *myQueue = new Work_Queue ();
+    string filePath = "TESTTESTTEST";
+    string item = "";
+
+    TEST_ASSERT_NOT_NULL (myQueue);
+
+    myQueue->push (filePath);
+    TEST_ASSERT_TRUE (myQueue->tryPopFront (item) == TRUE);
+    TEST_ASSERT_EQUAL_STRING (item.c_str (), filePath.c_str ());
+    TEST_ASSERT_TRUE (myQueue->tryPopFront (item) == FALSE);
+    TEST_ASSERT_EQUAL (myQueue->size (), 0);
+    TEST_ASSERT_EQUAL (myQueue->bytesUsed (), 0);
+    delete myQueue;
+}
+
+/**
+ *******************************************************************************
+ * @brief test_pushFrontWorkQueue - Test a chunk pushed to the front comes off
+ * first, with its offset and length, ahead of a whole file.
+ *******************************************************************************
+ */
+void test_pushFrontWorkQueue (void)
+{
+    Work_Queue *myQueue = new Work_Queue ();
+    Work_Item_t chunk;
+    Work_Item_t item;
+
+    TEST_ASSERT_NOT_NULL (myQueue);
+
+    chunk.path = "CHUNKED";
+    chunk.offset = 4096;
+    chunk.length = 100;
+    myQueue->push ("WHOLE");
+    myQueue->pushFront (chunk);
+    TEST_ASSERT_EQUAL (myQueue->size (), 2);
+    item = myQueue->popItem ();
+    TEST_ASSERT_EQUAL_STRING (item.path.c_str (), "CHUNKED");
+    TEST_ASSERT_EQUAL (item.offset, 4096);
+    TEST_ASSERT_EQUAL (item.length, 100);
+    TEST_ASSERT_TRUE (myQueue->tryPopItem (item) == TRUE);
+    TEST_ASSERT_EQUAL_STRING (item.path.c_str (), "WHOLE");
+    TEST_ASSERT_EQUAL (item.offset, 0);
+    TEST_ASSERT_EQUAL (item.length, 0);
+    TEST_ASSERT_TRUE (myQueue->tryPopItem (item) == FALSE);
+    TEST_ASSERT_EQUAL (myQueue->bytesUsed (), 0);
+    delete myQueue;
+}
+
 /**
  *******************************************************************************
  * @brief test_sizeWorkQueueOneEntry - Test adding entry and getting queue size
@@ -275,6 +346,8 @@ void *ChildThread1 (void *arg)
     sleep (1);
     q->push ("CCC");
     sleep (1);
+
+    return (NULL);
 }
 
 /**
@@ -303,6 +376,8 @@ void *ChildThread2 (void *arg)
     q->push ("BBB");
     sleep (1);
     q->push ("DDD");
+
+    return (NULL);
 }
 
 /**
@@ -734,6 +809,50 @@ void test_BufferFullOffEnds (void)
     bufferProcFullBuffer ();
 }
 
+/**
+ *******************************************************************************
+ * @brief test_bufferProcSpans - Test finding words as spans of a buffer,
+ * with and without a word running to its end.
+ *******************************************************************************
+ */
+void test_bufferProcSpans (void)
+{
+    bufferProcSpans ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_bufferProcSpansWrappers - Test that the word copying functions
+ * agree with the spans.
+ *******************************************************************************
+ */
+void test_bufferProcSpansWrappers (void)
+{
+    bufferProcSpansWrappers ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_bufferProcSpansKernels - Test that every word scan kernel finds
+ * the same words as a byte at a time search.
+ *******************************************************************************
+ */
+void test_bufferProcSpansKernels (void)
+{
+    bufferProcSpansKernels ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_bufferProcFoldHash - Test lowercasing and hashing words in the
+ * same pass that finds them.
+ *******************************************************************************
+ */
+void test_bufferProcFoldHash (void)
+{
+    bufferProcFoldHash ();
+}
+
 /**
  *******************************************************************************
  * @brief test_fileProcess - Test processing a mocked file, which has enough
@@ -836,3 +955,608 @@ void test_wordDictGoodIncrement (void)
 {
     wordDictGoodIncrement ();
 }
+
+/**
+ *******************************************************************************
+ * @brief test_WordDictShardedIterItems - Test a multi-shard dictionary finds,
+ * counts and iterates words spread across all of its shards.
+ *******************************************************************************
+ */
+void test_WordDictShardedIterItems (void)
+{
+    wordDictShardedIterItems ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_WordDictShardedThreads - Test several threads incrementing the
+ * same words in a multi-shard dictionary, and that no counts are lost.
+ *******************************************************************************
+ */
+void test_WordDictShardedThreads (void)
+{
+    wordDictShardedThreads ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_WordDictAddOrIncrement - Test the single word upsert inserts new
+ * words and increments existing ones, returning the updated count.
+ *******************************************************************************
+ */
+void test_WordDictAddOrIncrement (void)
+{
+    wordDictAddOrIncrement ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_WordDictAddOrIncrementBatch - Test the batch upsert over a span
+ * of words, including repeated words and an empty span.
+ *******************************************************************************
+ */
+void test_WordDictAddOrIncrementBatch (void)
+{
+    wordDictAddOrIncrementBatch ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_WordDictAddOrIncrementThreads - Test several threads upserting
+ * words that start out missing, and that no counts are lost.
+ *******************************************************************************
+ */
+void test_WordDictAddOrIncrementThreads (void)
+{
+    wordDictAddOrIncrementThreads ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_WordDictMerge - Test merging one dictionary into another, for
+ * both matching and differing shard counts.
+ *******************************************************************************
+ */
+void test_WordDictMerge (void)
+{
+    wordDictMerge ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_WordDictMergeTree - Test the parallel tree reduction over an odd
+ * number of thread-local dictionaries.
+ *******************************************************************************
+ */
+void test_WordDictMergeTree (void)
+{
+    wordDictMergeTree ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_WordDictHashBackend - Test a sharded dictionary on the hash
+ * table backend, pointer and length lookups, and merging across backends.
+ *******************************************************************************
+ */
+void test_WordDictHashBackend (void)
+{
+    wordDictHashBackend ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_HashStoreInsertFind - Test inserting, finding and missing words
+ * in the Robin Hood hash store.
+ *******************************************************************************
+ */
+void test_HashStoreInsertFind (void)
+{
+    hashStoreInsertFind ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_HashStoreGrowIterate - Test that growing the table keeps every
+ * count, and that iteration visits each word exactly once.
+ *******************************************************************************
+ */
+void test_HashStoreGrowIterate (void)
+{
+    hashStoreGrowIterate ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_HashStoreCollisions - Test words which share a hash value are
+ * still told apart by their bytes.
+ *******************************************************************************
+ */
+void test_HashStoreCollisions (void)
+{
+    hashStoreCollisions ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_KeyArenaInternResolve - Test adding keys to the arena and
+ * resolving their ids back to bytes and lengths.
+ *******************************************************************************
+ */
+void test_KeyArenaInternResolve (void)
+{
+    keyArenaInternResolve ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_KeyArenaLargeKeys - Test keys spread over many blocks, and a key
+ * bigger than a block.
+ *******************************************************************************
+ */
+void test_KeyArenaLargeKeys (void)
+{
+    keyArenaLargeKeys ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_KeyArenaClear - Test that clear frees every block and restarts
+ * the ids.
+ *******************************************************************************
+ */
+void test_KeyArenaClear (void)
+{
+    keyArenaClear ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_fileProcessFlush - Test processing a mocked file into a sharded
+ * dictionary, flushing the pre-aggregated counts after every read.
+ *******************************************************************************
+ */
+void test_fileProcessFlush (void)
+{
+    fileProcessFlush ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_fileProcessDistinct - Test the distinct word estimate of a
+ * mocked file, with and without a dictionary to count into.
+ *******************************************************************************
+ */
+void test_fileProcessDistinct (void)
+{
+    fileProcessDistinct ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_fileProcessCarryOver - Test words cut off by the end of a read
+ * being carried into the next one, at several read buffer sizes.
+ *******************************************************************************
+ */
+void test_fileProcessCarryOver (void)
+{
+    fileProcessCarryOver ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_fileProcessMmap - Test counting a mocked file straight from a
+ * mapping, in windows of several sizes, and small files still being read.
+ *******************************************************************************
+ */
+void test_fileProcessMmap (void)
+{
+    fileProcessMmap ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_fileProcessUring - Test counting files taken from a queue with
+ * their reads in flight through io_uring, more files than slots.
+ *******************************************************************************
+ */
+void test_fileProcessUring (void)
+{
+    fileProcessUring ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_fileProcessIoPolicy - Test every I/O policy counts a mocked
+ * file the same, O_DIRECT's aligned reads included.
+ *******************************************************************************
+ */
+void test_fileProcessIoPolicy (void)
+{
+    fileProcessIoPolicy ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_fileProcessChunks - Test a mocked file counted in chunks of
+ * several sizes gives the whole file's counts, and splitting a real one.
+ *******************************************************************************
+ */
+void test_fileProcessChunks (void)
+{
+    fileProcessChunks ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_fileProcessChunkDistinct - Test a file split into chunks gets
+ * one distinct word estimate, of the whole file.
+ *******************************************************************************
+ */
+void test_fileProcessChunkDistinct (void)
+{
+    fileProcessChunkDistinct ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_fileProcessUtf8 - Test UTF-8 words are counted whole and case
+ * folded, through small reads and chunks.
+ *******************************************************************************
+ */
+void test_fileProcessUtf8 (void)
+{
+    fileProcessUtf8 ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_WordDictTopX - Test bounded top X selection across shards, tie
+ * ordering, and that any thread count gives the same answer.
+ *******************************************************************************
+ */
+void test_WordDictTopX (void)
+{
+    wordDictTopX ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_WordDictTopXAll - Test selecting every word, more words than
+ * exist, and no words.
+ *******************************************************************************
+ */
+void test_WordDictTopXAll (void)
+{
+    wordDictTopXAll ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_WordDictLeaderboard - Test the live leaderboard following
+ * inserts, increments and batch upserts, including eviction and ties.
+ *******************************************************************************
+ */
+void test_WordDictLeaderboard (void)
+{
+    wordDictLeaderboard ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_WordDictLeaderboardSeed - Test enabling the leaderboard on a
+ * populated dictionary, and that it agrees with a full top X after a merge.
+ *******************************************************************************
+ */
+void test_WordDictLeaderboardSeed (void)
+{
+    wordDictLeaderboardSeed ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_WordDictApproximate - Test approximate mode dictionaries, merged
+ * from exact counts and from each other.
+ *******************************************************************************
+ */
+void test_WordDictApproximate (void)
+{
+    wordDictApproximate ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_WordDictSnapshot - Test snapshots sharing unchanged shards,
+ * keeping their counts as the dictionary changes, and outliving it.
+ *******************************************************************************
+ */
+void test_WordDictSnapshot (void)
+{
+    wordDictSnapshot ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_WordDictSnapshotThreads - Test readers taking and iterating
+ * snapshots while writer threads keep counting.
+ *******************************************************************************
+ */
+void test_WordDictSnapshotThreads (void)
+{
+    wordDictSnapshotThreads ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_ApproxCounterOverestimate - Test the sketch never undercounts,
+ * and stays within its documented error bound.
+ *******************************************************************************
+ */
+void test_ApproxCounterOverestimate (void)
+{
+    approxCounterOverestimate ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_ApproxCounterHeavyHitters - Test late arriving heavy words
+ * displacing light ones from the candidate set.
+ *******************************************************************************
+ */
+void test_ApproxCounterHeavyHitters (void)
+{
+    approxCounterHeavyHitters ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_ApproxCounterMerge - Test combining two sketches, and refusing
+ * to combine sketches of different shapes.
+ *******************************************************************************
+ */
+void test_ApproxCounterMerge (void)
+{
+    approxCounterMerge ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_ApproxCounterCandidates - Test the heavy hitter candidates as
+ * words are bumped, replaced and churned through the set.
+ *******************************************************************************
+ */
+void test_ApproxCounterCandidates (void)
+{
+    approxCounterCandidates ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_HyperLogLogEstimate - Test the distinct word estimate for small
+ * and large numbers of words.
+ *******************************************************************************
+ */
+void test_HyperLogLogEstimate (void)
+{
+    hyperLogLogEstimate ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_HyperLogLogMerge - Test the estimate of two merged sketches
+ * covering overlapping words.
+ *******************************************************************************
+ */
+void test_HyperLogLogMerge (void)
+{
+    hyperLogLogMerge ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_DictShardViewFind - Test a shard view keeping its copy of a
+ * store, and finding and iterating its words.
+ *******************************************************************************
+ */
+void test_DictShardViewFind (void)
+{
+    dictShardViewFind ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_DictFileSaveLoad - Test saving a dictionary and answering
+ * lookups and top-X from the mapped file.
+ *******************************************************************************
+ */
+void test_DictFileSaveLoad (void)
+{
+    dictFileSaveLoad ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_DictFileCorrupt - Test damaged, truncated and missing
+ * dictionary files being refused.
+ *******************************************************************************
+ */
+void test_DictFileCorrupt (void)
+{
+    dictFileCorrupt ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_PerfectHashBuild - Test a minimal perfect hash gives every key
+ * its own slot, in a few bits per key.
+ *******************************************************************************
+ */
+void test_PerfectHashBuild (void)
+{
+    perfectHashBuild ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_FrozenDictLookup - Test frozen dictionary lookups and top-X,
+ * with and without a perfect hash.
+ *******************************************************************************
+ */
+void test_FrozenDictLookup (void)
+{
+    frozenDictLookup ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_DictFilePerfectHash - Test a frozen dictionary saved with its
+ * perfect hash and served from the mapped file.
+ *******************************************************************************
+ */
+void test_DictFilePerfectHash (void)
+{
+    dictFilePerfectHash ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_RadixStoreInsertFind - Test radix tree inserts and lookups
+ * through path splits and node growth, and word order iteration.
+ *******************************************************************************
+ */
+void test_RadixStoreInsertFind (void)
+{
+    radixStoreInsertFind ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_RadixStorePrefix - Test prefix iteration and pruned top-K by
+ * prefix against a full map scan.
+ *******************************************************************************
+ */
+void test_RadixStorePrefix (void)
+{
+    radixStorePrefix ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_WordDictPrefixTopX - Test top-X by prefix gives the same words
+ * with every backend.
+ *******************************************************************************
+ */
+void test_WordDictPrefixTopX (void)
+{
+    wordDictPrefixTopX ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_MemStatsParseSize - Test memory limit sizes and policy names
+ * from the command line.
+ *******************************************************************************
+ */
+void test_MemStatsParseSize (void)
+{
+    memStatsParseSize ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_MemStatsComponents - Test per component totals, names, and the
+ * work queue's path accounting.
+ *******************************************************************************
+ */
+void test_MemStatsComponents (void)
+{
+    memStatsComponents ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_WordDictMemoryUsage - Test dictionary memory accounting by
+ * component with every backend.
+ *******************************************************************************
+ */
+void test_WordDictMemoryUsage (void)
+{
+    wordDictMemoryUsage ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_WordDictMemoryLimit - Test the prune and approximate memory
+ * limit policies.
+ *******************************************************************************
+ */
+void test_WordDictMemoryLimit (void)
+{
+    wordDictMemoryLimit ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_DictSpillMergeRuns - Test writing sorted runs to the spill file
+ * and merging them back with an array in memory.
+ *******************************************************************************
+ */
+void test_DictSpillMergeRuns (void)
+{
+    dictSpillMergeRuns ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_WordDictSpill - Test that a dictionary which spilled to disk
+ * still gives exact counts, top-X lists and merges.
+ *******************************************************************************
+ */
+void test_WordDictSpill (void)
+{
+    wordDictSpill ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_WordDictSwitchThreads - Test switching to approximate counting
+ * while other threads count and read the leaderboard.
+ *******************************************************************************
+ */
+void test_WordDictSwitchThreads (void)
+{
+    wordDictSwitchThreads ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_WordScanKernels - Test every SIMD word character kernel this CPU
+ * supports against the scalar one.
+ *******************************************************************************
+ */
+void test_WordScanKernels (void)
+{
+    wordScanKernels ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_UringReaderReads - Test opens and reads at several offsets in
+ * flight at once through io_uring.
+ *******************************************************************************
+ */
+void test_UringReaderReads (void)
+{
+    uringReaderReads ();
+}
+
+/**
+ *******************************************************************************
+ * @brief test_Utf8Words - Test UTF-8 decoding, word characters, case folding
+ * and block masks against a code point at a time.
+ *******************************************************************************
+ */
+void test_Utf8Words (void)
+{
+    utf8Words ();
+}
@@ -0,0 +1,232 @@
+/* AUTOGENERATED FILE. DO NOT EDIT. */
+
+//=======Test Runner Used To Run Each Test Below=====
+#define RUN_TEST(TestFunc, TestLineNum) \
+{ \
+  Unity.CurrentTestName = #TestFunc; \
+  Unity.CurrentTestLineNumber = TestLineNum; \
+  Unity.NumberOfTests++; \
+  if (TEST_PROTECT()) \
+  { \
+      setUp(); \
+      TestFunc(); \
+  } \
+  if (TEST_PROTECT() && !TEST_IS_IGNORED) \
+  { \
+    tearDown(); \
+  } \
+  UnityConcludeTest(); \
+}
+
+//=======Automagically Detected Files To Include=====
+#include "unity.h"
+#include <setjmp.h>
+#include <stdio.h>
+
+//=======External Functions This Runner Calls=====
+extern void setUp(void);
+extern void tearDown(void);
+extern void test_newWorkQueue(void);
+extern void test_lockWorkQueue(void);
+extern void test_unlockWorkQueue(void);
+extern void test_pushWorkQueue(void);
+extern void test_frontWorkQueue(void);
+extern void test_popWorkQueue(void);
+extern void test_tryPopWorkQueue(void);
+extern void test_pushFrontWorkQueue(void);
+extern void test_sizeWorkQueueOneEntry(void);
+extern void test_sizeWorkQueueMoreThanOneEntry(void);
+extern void test_multiThreadAdd(void);
+extern void test_queueReaderWriter(void);
+extern void test_goodIsLowerWordChars(void);
+extern void test_goodIsUpperWordChars(void);
+extern void test_goodIsNumWordChars(void);
+extern void test_badIsWordChars(void);
+extern void test_bufferWordOneOnly(void);
+extern void test_bufferWordOneStartsLate(void);
+extern void test_bufferWordOneGarbageAtEnd(void);
+extern void test_bufferWordOneGarbageAtBothEnds(void);
+extern void test_bufferWordTwoWordsOnly(void);
+extern void test_bufferWordTwoWordsWithGarbageBothEnds(void);
+extern void test_Buffer4WordsAtStart(void);
+extern void test_Buffer1WordsAtStart(void);
+extern void test_BufferFullOffEnds(void);
+extern void test_bufferProcSpans(void);
+extern void test_bufferProcSpansWrappers(void);
+extern void test_bufferProcSpansKernels(void);
+extern void test_bufferProcFoldHash(void);
+extern void test_fileProcess(void);
+extern void test_WordDictConstruct(void);
+extern void test_WordDictInsert(void);
+extern void test_WordDictLock(void);
+extern void test_WordDictUnlock(void);
+extern void test_WordDictIterItems(void);
+extern void test_WordSearchGoodFind(void);
+extern void test_WordSearchGoodNoFind(void);
+extern void test_wordDictGoodIncrement(void);
+extern void test_WordDictShardedIterItems(void);
+extern void test_WordDictShardedThreads(void);
+extern void test_WordDictAddOrIncrement(void);
+extern void test_WordDictAddOrIncrementBatch(void);
+extern void test_WordDictAddOrIncrementThreads(void);
+extern void test_WordDictMerge(void);
+extern void test_WordDictMergeTree(void);
+extern void test_WordDictHashBackend(void);
+extern void test_HashStoreInsertFind(void);
+extern void test_HashStoreGrowIterate(void);
+extern void test_HashStoreCollisions(void);
+extern void test_KeyArenaInternResolve(void);
+extern void test_KeyArenaLargeKeys(void);
+extern void test_KeyArenaClear(void);
+extern void test_fileProcessFlush(void);
+extern void test_fileProcessDistinct(void);
+extern void test_fileProcessCarryOver(void);
+extern void test_fileProcessMmap(void);
+extern void test_fileProcessUring(void);
+extern void test_fileProcessIoPolicy(void);
+extern void test_fileProcessChunks(void);
+extern void test_fileProcessChunkDistinct(void);
+extern void test_fileProcessUtf8(void);
+extern void test_WordDictTopX(void);
+extern void test_WordDictTopXAll(void);
+extern void test_WordDictLeaderboard(void);
+extern void test_WordDictLeaderboardSeed(void);
+extern void test_WordDictApproximate(void);
+extern void test_WordDictSnapshot(void);
+extern void test_WordDictSnapshotThreads(void);
+extern void test_ApproxCounterOverestimate(void);
+extern void test_ApproxCounterHeavyHitters(void);
+extern void test_ApproxCounterMerge(void);
+extern void test_ApproxCounterCandidates(void);
+extern void test_HyperLogLogEstimate(void);
+extern void test_HyperLogLogMerge(void);
+extern void test_DictShardViewFind(void);
+extern void test_DictFileSaveLoad(void);
+extern void test_DictFileCorrupt(void);
+extern void test_PerfectHashBuild(void);
+extern void test_FrozenDictLookup(void);
+extern void test_DictFilePerfectHash(void);
+extern void test_RadixStoreInsertFind(void);
+extern void test_RadixStorePrefix(void);
+extern void test_WordDictPrefixTopX(void);
+extern void test_MemStatsParseSize(void);
+extern void test_MemStatsComponents(void);
+extern void test_WordDictMemoryUsage(void);
+extern void test_WordDictMemoryLimit(void);
+extern void test_DictSpillMergeRuns(void);
+extern void test_WordDictSpill(void);
+extern void test_WordDictSwitchThreads(void);
+extern void test_WordScanKernels(void);
+extern void test_UringReaderReads(void);
+extern void test_Utf8Words(void);
+
+
+//=======Test Reset Option=====
+void resetTest()
+{
+  tearDown();
+  setUp();
+}
+
+
+//=======MAIN=====
+int main(void)
+{
+  Unity.TestFile = "TestProductionCode.c";
+  UnityBegin();
+  RUN_TEST(test_newWorkQueue, 106);
+  RUN_TEST(test_lockWorkQueue, 118);
+  RUN_TEST(test_unlockWorkQueue, 133);
+  RUN_TEST(test_pushWorkQueue, 151);
+  RUN_TEST(test_frontWorkQueue, 166);
+  RUN_TEST(test_popWorkQueue, 185);
+  RUN_TEST(test_tryPopWorkQueue, 201);
+  RUN_TEST(test_pushFrontWorkQueue, 224);
+  RUN_TEST(test_sizeWorkQueueOneEntry, 257);
+  RUN_TEST(test_sizeWorkQueueMoreThanOneEntry, 275);
+  RUN_TEST(test_multiThreadAdd, 297);
+  RUN_TEST(test_queueReaderWriter, 385);
+  RUN_TEST(test_goodIsLowerWordChars, 505);
+  RUN_TEST(test_goodIsUpperWordChars, 530);
+  RUN_TEST(test_goodIsNumWordChars, 555);
+  RUN_TEST(test_badIsWordChars, 580);
+  RUN_TEST(test_bufferWordOneOnly, 610);
+  RUN_TEST(test_bufferWordOneStartsLate, 638);
+  RUN_TEST(test_bufferWordOneGarbageAtEnd, 666);
+  RUN_TEST(test_bufferWordOneGarbageAtBothEnds, 700);
+  RUN_TEST(test_bufferWordTwoWordsOnly, 724);
+  RUN_TEST(test_bufferWordTwoWordsWithGarbageBothEnds, 752);
+  RUN_TEST(test_Buffer4WordsAtStart, 781);
+  RUN_TEST(test_Buffer1WordsAtStart, 792);
+  RUN_TEST(test_BufferFullOffEnds, 807);
+  RUN_TEST(test_bufferProcSpans, 814);
+  RUN_TEST(test_bufferProcSpansWrappers, 825);
+  RUN_TEST(test_bufferProcSpansKernels, 836);
+  RUN_TEST(test_bufferProcFoldHash, 847);
+  RUN_TEST(test_fileProcess, 858);
+  RUN_TEST(test_WordDictConstruct, 875);
+  RUN_TEST(test_WordDictInsert, 889);
+  RUN_TEST(test_WordDictLock, 896);
+  RUN_TEST(test_WordDictUnlock, 906);
+  RUN_TEST(test_WordDictIterItems, 917);
+  RUN_TEST(test_WordSearchGoodFind, 928);
+  RUN_TEST(test_WordSearchGoodNoFind, 939);
+  RUN_TEST(test_wordDictGoodIncrement, 954);
+  RUN_TEST(test_WordDictShardedIterItems, 961);
+  RUN_TEST(test_WordDictShardedThreads, 972);
+  RUN_TEST(test_WordDictAddOrIncrement, 983);
+  RUN_TEST(test_WordDictAddOrIncrementBatch, 994);
+  RUN_TEST(test_WordDictAddOrIncrementThreads, 1005);
+  RUN_TEST(test_WordDictMerge, 1016);
+  RUN_TEST(test_WordDictMergeTree, 1027);
+  RUN_TEST(test_WordDictHashBackend, 1038);
+  RUN_TEST(test_HashStoreInsertFind, 1049);
+  RUN_TEST(test_HashStoreGrowIterate, 1060);
+  RUN_TEST(test_HashStoreCollisions, 1071);
+  RUN_TEST(test_KeyArenaInternResolve, 1082);
+  RUN_TEST(test_KeyArenaLargeKeys, 1093);
+  RUN_TEST(test_KeyArenaClear, 1104);
+  RUN_TEST(test_fileProcessFlush, 1115);
+  RUN_TEST(test_fileProcessDistinct, 1126);
+  RUN_TEST(test_fileProcessCarryOver, 1137);
+  RUN_TEST(test_fileProcessMmap, 1148);
+  RUN_TEST(test_fileProcessUring, 1159);
+  RUN_TEST(test_fileProcessIoPolicy, 1170);
+  RUN_TEST(test_fileProcessChunks, 1181);
+  RUN_TEST(test_fileProcessChunkDistinct, 1192);
+  RUN_TEST(test_fileProcessUtf8, 1203);
+  RUN_TEST(test_WordDictTopX, 1214);
+  RUN_TEST(test_WordDictTopXAll, 1225);
+  RUN_TEST(test_WordDictLeaderboard, 1236);
+  RUN_TEST(test_WordDictLeaderboardSeed, 1247);
+  RUN_TEST(test_WordDictApproximate, 1258);
+  RUN_TEST(test_WordDictSnapshot, 1269);
+  RUN_TEST(test_WordDictSnapshotThreads, 1280);
+  RUN_TEST(test_ApproxCounterOverestimate, 1291);
+  RUN_TEST(test_ApproxCounterHeavyHitters, 1302);
+  RUN_TEST(test_ApproxCounterMerge, 1313);
+  RUN_TEST(test_ApproxCounterCandidates, 1324);
+  RUN_TEST(test_HyperLogLogEstimate, 1335);
+  RUN_TEST(test_HyperLogLogMerge, 1346);
+  RUN_TEST(test_DictShardViewFind, 1357);
+  RUN_TEST(test_DictFileSaveLoad, 1368);
+  RUN_TEST(test_DictFileCorrupt, 1379);
+  RUN_TEST(test_PerfectHashBuild, 1390);
+  RUN_TEST(test_FrozenDictLookup, 1401);
+  RUN_TEST(test_DictFilePerfectHash, 1412);
+  RUN_TEST(test_RadixStoreInsertFind, 1423);
+  RUN_TEST(test_RadixStorePrefix, 1434);
+  RUN_TEST(test_WordDictPrefixTopX, 1445);
+  RUN_TEST(test_MemStatsParseSize, 1456);
+  RUN_TEST(test_MemStatsComponents, 1467);
+  RUN_TEST(test_WordDictMemoryUsage, 1478);
+  RUN_TEST(test_WordDictMemoryLimit, 1489);
+  RUN_TEST(test_DictSpillMergeRuns, 1500);
+  RUN_TEST(test_WordDictSpill, 1511);
+  RUN_TEST(test_WordDictSwitchThreads, 1522);
+  RUN_TEST(test_WordScanKernels, 1533);
+  RUN_TEST(test_UringReaderReads, 1544);
+  RUN_TEST(test_Utf8Words, 1555);
+
+  return (UnityEnd());
+}
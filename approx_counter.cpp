@@ -0,0 +1,817 @@
+/**
+ * @file           approx_counter.cpp
+ * @brief:         Fixed memory approximate word counting (Count-Min Sketch + heavy hitters).
+ * @verbatim
+ *******************************************************************************
+ * Author:         Douglas L. Potts
+ *
+ * Date:           10/17/2026, <SCR #>
+ *
+ *==============================================================================
+ *==============================================================================
+ * Copyright (c) 2015 Douglas Lee Potts
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ *==============================================================================
+ *==============================================================================
+ *
+ * History:
+ * Date        SCR #  Name  Description
+ * -----------------------------------------------------------------------------
+ *
+ *******************************************************************************
+ * @endverbatim
+ */
+
+/*******************************************************************************
+ * System Includes
+ *******************************************************************************
+ */
+#include <stdio.h>              /* for fprintf() */
+#include <stdlib.h>             /* for calloc() */
+#include <string.h>             /* for memcmp() */
+
+/*******************************************************************************
+ * Project Includes
+ *******************************************************************************
+ */
+#include "common_types.h"
+#include "approx_counter.hpp"
+#if defined(TEST)
+#include "unity.h"
+#endif /* defined(TEST) */
+
+/*******************************************************************************
+ * Local Function Prototypes 
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * Local Constants 
+ *******************************************************************************
+ */
+#define DBG(X)
+
+/** Euler's number, for the error bound (M_E is not in strict ANSI) */
+#define APPROX_E (2.718281828459045)
+
+/** Counters saturate here instead of wrapping */
+#define APPROX_COUNTER_MAX ((uint32_t) 0xFFFFFFFFU)
+
+/** Marks an empty slot in the candidate index */
+#define NO_CANDIDATE (-1)
+
+/*******************************************************************************
+ * File Scoped Variables 
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ ********************* E X T E R N A L  F U N C T I O N S **********************
+ *******************************************************************************
+ */
+
+#if defined(TEST)
+extern "C"
+{
+
+    void approxCounterOverestimate (void)
+    {
+        static const int NUM_WORDS = 2000;
+        Approx_Counter *counter = new Approx_Counter (512, 4, 8);
+        char word[32];
+        int idx = 0;
+        int len = 0;
+        uint32_t est = 0;
+        uint64_t over = 0;
+
+        for (idx = 0; idx < NUM_WORDS; idx++)
+        {
+            len = snprintf (word, sizeof (word), "w%d", idx);
+            counter->add (word, len, wordHash (word, len), (idx % 7) + 1);
+        }
+        TEST_ASSERT_EQUAL (counter->total (), 7995);   /* sum of (idx % 7) + 1 */
+
+        /*
+         * Never under, and the documented bound holds for (nearly) every
+         * word.  A 512 wide sketch over 2000 words is badly overloaded, so
+         * the bound is loose, but it must still be a bound.
+         */
+        for (idx = 0; idx < NUM_WORDS; idx++)
+        {
+            len = snprintf (word, sizeof (word), "w%d", idx);
+            est = counter->estimate (wordHash (word, len));
+            TEST_ASSERT_TRUE (est >= (uint32_t) ((idx % 7) + 1));
+            if (est - ((idx % 7) + 1) > counter->errorBound ())
+            {
+                over++;
+            }
+        }
+        TEST_ASSERT_TRUE (over <= NUM_WORDS / 20);
+        TEST_ASSERT_TRUE (counter->confidence () > 0.98);
+        TEST_ASSERT_TRUE (counter->bytesUsed () >= 512 * 4 * sizeof (uint32_t));
+
+        delete counter;
+    }
+    void approxCounterHeavyHitters (void)
+    {
+        static const int NUM_HEAVY = 5;
+        Approx_Counter *counter = new Approx_Counter (4096, 4, NUM_HEAVY);
+        vector < Dict_Entry_t > candidates;
+        char word[32];
+        int round = 0;
+        int idx = 0;
+        int len = 0;
+
+        /*
+         * Heavy words arrive late and one at a time, after a flood of
+         * light words has filled the candidate set.
+         */
+        for (idx = 0; idx < 1000; idx++)
+        {
+            len = snprintf (word, sizeof (word), "light%d", idx);
+            counter->add (word, len, wordHash (word, len));
+        }
+        for (round = 0; round < 50; round++)
+        {
+            for (idx = 0; idx < NUM_HEAVY; idx++)
+            {
+                len = snprintf (word, sizeof (word), "heavy%d", idx);
+                counter->add (word, len, wordHash (word, len), idx + 1);
+            }
+        }
+
+        counter->getCandidates (candidates);
+        TEST_ASSERT_EQUAL (candidates.size (), NUM_HEAVY);
+        for (idx = 0; idx < NUM_HEAVY; idx++)
+        {
+            TEST_ASSERT_EQUAL (strncmp (candidates[idx].word, "heavy", 5), 0);
+            TEST_ASSERT_TRUE (candidates[idx].count >=
+                              50 * ((candidates[idx].word[5] - '0') + 1));
+        }
+
+        counter->clear ();
+        TEST_ASSERT_EQUAL (counter->total (), 0);
+        TEST_ASSERT_EQUAL (counter->numCandidates (), 0);
+        TEST_ASSERT_EQUAL (counter->estimate (wordHash ("heavy1", 6)), 0);
+
+        delete counter;
+    }
+    void approxCounterMerge (void)
+    {
+        Approx_Counter *left = new Approx_Counter (1024, 3, 4);
+        Approx_Counter *right = new Approx_Counter (1024, 3, 4);
+        Approx_Counter *odd = new Approx_Counter (1000, 3, 4);
+        vector < Dict_Entry_t > candidates;
+
+        left->add ("apples", 6, wordHash ("apples", 6), 10);
+        left->add ("pears", 5, wordHash ("pears", 5), 1);
+        right->add ("pears", 5, wordHash ("pears", 5), 20);
+        right->add ("cherries", 8, wordHash ("cherries", 8), 5);
+
+        TEST_ASSERT_TRUE (left->merge (*right));
+        TEST_ASSERT_EQUAL (left->total (), 36);
+        TEST_ASSERT_TRUE (left->estimate (wordHash ("pears", 5)) >= 21);
+        TEST_ASSERT_TRUE (left->estimate (wordHash ("apples", 6)) >= 10);
+
+        left->getCandidates (candidates);
+        TEST_ASSERT_EQUAL (candidates.size (), 3);
+        TEST_ASSERT_EQUAL_STRING ("pears", candidates[0].word);
+        TEST_ASSERT_EQUAL_STRING ("apples", candidates[1].word);
+
+        /* Sketches of different shapes can't be combined */
+        TEST_ASSERT_FALSE (left->merge (*odd));
+        TEST_ASSERT_EQUAL (left->total (), 36);
+
+        delete left;
+        delete right;
+        delete odd;
+    }
+    void approxCounterCandidates (void)
+    {
+        static const int NUM_WORDS = 64;
+        static const int NUM_CANDIDATES = 8;
+        Approx_Counter *counter =
+            new Approx_Counter (1 << 16, 4, NUM_CANDIDATES);
+        vector < Dict_Entry_t > candidates;
+        char word[32];
+        int round = 0;
+        int idx = 0;
+        int len = 0;
+
+        /*
+         * A hot word stays the minimum while it is bumped, until it passes
+         * the others.
+         */
+        counter->add ("hot", 3, wordHash ("hot", 3));
+        for (idx = 1; idx < NUM_CANDIDATES; idx++)
+        {
+            len = snprintf (word, sizeof (word), "warm%d", idx);
+            counter->add (word, len, wordHash (word, len), 5);
+        }
+        for (idx = 0; idx < 10; idx++)
+        {
+            counter->add ("hot", 3, wordHash ("hot", 3));
+        }
+        counter->getCandidates (candidates);
+        TEST_ASSERT_EQUAL (candidates.size (), NUM_CANDIDATES);
+        TEST_ASSERT_EQUAL_STRING ("hot", candidates[0].word);
+        TEST_ASSERT_EQUAL (candidates[0].count, 11);
+
+        /* A new word must pass the lowest candidate, 5, to get in */
+        counter->add ("cold", 4, wordHash ("cold", 4), 5);
+        counter->getCandidates (candidates);
+        TEST_ASSERT_EQUAL_STRING ("warm7", candidates[NUM_CANDIDATES - 1].word);
+        counter->add ("cold", 4, wordHash ("cold", 4));
+        counter->getCandidates (candidates);
+        TEST_ASSERT_EQUAL (candidates.size (), NUM_CANDIDATES);
+        TEST_ASSERT_EQUAL_STRING ("cold", candidates[1].word);
+        TEST_ASSERT_EQUAL (candidates[1].count, 6);
+
+        /*
+         * Many words churning through the set, word i gains i each round:
+         * the highest ones finish as the candidates, with exact counts from
+         * a sketch this wide.
+         */
+        counter->clear ();
+        for (round = 0; round < 20; round++)
+        {
+            for (idx = 0; idx < NUM_WORDS; idx++)
+            {
+                len = snprintf (word, sizeof (word), "w%02d", idx);
+                counter->add (word, len, wordHash (word, len), idx + 1);
+            }
+        }
+        counter->getCandidates (candidates);
+        TEST_ASSERT_EQUAL (candidates.size (), NUM_CANDIDATES);
+        for (idx = 0; idx < NUM_CANDIDATES; idx++)
+        {
+            snprintf (word, sizeof (word), "w%02d", NUM_WORDS - 1 - idx);
+            TEST_ASSERT_EQUAL_STRING (word, candidates[idx].word);
+            TEST_ASSERT_EQUAL (candidates[idx].count,
+                               20 * (NUM_WORDS - idx));
+        }
+
+        delete counter;
+    }
+}
+#endif /* defined(TEST) */
+
+/**
+ *******************************************************************************
+ * @brief Approx_Counter - Constructor
+ *
+ * <!-- Parameters -->
+ *      @param[in]      width          Counters per row, at least 1.
+ *      @param[in]      depth          Rows, 1..APPROX_MAX_DEPTH.
+ *      @param[in]      num_candidates Heavy hitter words to keep, at least 1.
+ *
+ * @par Description:
+ *      All of the sketch memory (width * depth * 4 bytes) is allocated here,
+ *      nothing grows with the number of words counted.  Out of range
+ *      arguments are clamped.
+ *******************************************************************************
+ */
+Approx_Counter::Approx_Counter (uint32_t width, uint32_t depth,
+                                size_t num_candidates)
+{
+    size_t index_size = 1;
+
+    _width = (width < 1) ? 1 : width;
+    _depth = (depth < 1) ? 1 : depth;
+    if (_depth > APPROX_MAX_DEPTH)
+    {
+        _depth = APPROX_MAX_DEPTH;
+    }
+    _maxCandidates = (num_candidates < 1) ? 1 : num_candidates;
+    _total = 0;
+
+    _counters =
+        (uint32_t *) calloc ((size_t) _width * _depth, sizeof (uint32_t));
+    if (_counters == NULL)
+    {
+        fprintf (stderr, "[%s, %d:%s] failed to allocate %u x %u sketch\n",
+                 __FILE__, __LINE__, __FUNCTION__, _width, _depth);
+        exit (EXIT_FAILURE);
+    }
+
+    /*
+     * Candidate index stays at most half full
+     */
+    while (index_size < 2 * _maxCandidates)
+    {
+        index_size *= 2;
+    }
+    _index.assign (index_size, NO_CANDIDATE);
+    _indexMask = index_size - 1;
+    _candidates.reserve (_maxCandidates);
+}
+
+/**
+ *******************************************************************************
+ * @brief ~Approx_Counter - Destructor
+ *******************************************************************************
+ */
+Approx_Counter::~Approx_Counter (void)
+{
+    free (_counters);
+    _counters = NULL;
+}
+
+/**
+ *******************************************************************************
+ * @brief add - Count 'delta' more occurrences of a word.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      word           First byte of the word
+ *      @param[in]      len            Length of the word in bytes
+ *      @param[in]      hash           wordHash (word, len)
+ *      @param[in]      delta          Occurrences to add
+ *
+ * <!-- Returns -->
+ *      @return the word's estimate after the update.
+ *
+ * @par Algorithm:
+ *      Conservative update: the new estimate is the old one plus delta, and
+ *      each of the word's counters is raised to that only if it is lower.
+ *      The word is then offered to the heavy hitter candidates.
+ *******************************************************************************
+ */
+uint32_t Approx_Counter::add (const char *word, size_t len, Word_Hash_t hash,
+                              uint32_t delta)
+{
+    uint32_t slots[APPROX_MAX_DEPTH];
+    uint32_t est = APPROX_COUNTER_MAX;
+    uint32_t row = 0;
+
+    _rowSlots (hash, slots);
+    for (row = 0; row < _depth; row++)
+    {
+        if (_counters[slots[row]] < est)
+        {
+            est = _counters[slots[row]];
+        }
+    }
+    est = (est > APPROX_COUNTER_MAX - delta) ? APPROX_COUNTER_MAX : est + delta;
+    for (row = 0; row < _depth; row++)
+    {
+        if (_counters[slots[row]] < est)
+        {
+            _counters[slots[row]] = est;
+        }
+    }
+    _total += delta;
+    _offer (word, len, hash, est);
+
+    return (est);
+}
+
+/**
+ *******************************************************************************
+ * @brief estimate - Upper bound on a word's count, 0 if never seen.
+ *******************************************************************************
+ */
+uint32_t Approx_Counter::estimate (Word_Hash_t hash)
+{
+    uint32_t slots[APPROX_MAX_DEPTH];
+    uint32_t est = APPROX_COUNTER_MAX;
+    uint32_t row = 0;
+
+    _rowSlots (hash, slots);
+    for (row = 0; row < _depth; row++)
+    {
+        if (_counters[slots[row]] < est)
+        {
+            est = _counters[slots[row]];
+        }
+    }
+    return (est);
+}
+
+/**
+ *******************************************************************************
+ * @brief merge - Add another counter's counts into this one.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      other          Counter to add in, left unchanged.
+ *
+ * <!-- Returns -->
+ *      @return TRUE if merged, FALSE if the sketches differ in width or depth
+ *      (nothing is changed then).
+ *
+ * @par Description:
+ *      Sketches add counter by counter, and the sum keeps the same error
+ *      bound over the combined total.  The other counter's candidates are
+ *      offered again with their estimates from the combined sketch.
+ *******************************************************************************
+ */
+Bool_t Approx_Counter::merge (Approx_Counter & other)
+{
+    size_t idx = 0;
+    size_t num_counters = (size_t) _width * _depth;
+
+    if ((other._width != _width) || (other._depth != _depth))
+    {
+        return (FALSE);
+    }
+    if (&other == this)
+    {
+        return (TRUE);
+    }
+    for (idx = 0; idx < num_counters; idx++)
+    {
+        uint32_t sum = _counters[idx] + other._counters[idx];
+
+        _counters[idx] = (sum < _counters[idx]) ? APPROX_COUNTER_MAX : sum;
+    }
+    _total += other._total;
+
+    /*
+     * Re-estimate our own candidates first, then offer the other's
+     */
+    for (idx = 0; idx < _candidates.size (); idx++)
+    {
+        _candidates[idx].estimate = estimate (_candidates[idx].hash);
+    }
+    _heapify ();
+    for (idx = 0; idx < other._candidates.size (); idx++)
+    {
+        Approx_Candidate_t & cand = other._candidates[idx];
+
+        _offer (cand.word.data (), cand.word.size (), cand.hash,
+                estimate (cand.hash));
+    }
+    return (TRUE);
+}
+
+/**
+ *******************************************************************************
+ * @brief clear - Forget every count, keeping the sketch memory.
+ *******************************************************************************
+ */
+void Approx_Counter::clear (void)
+{
+    memset (_counters, 0, (size_t) _width * _depth * sizeof (uint32_t));
+    _total = 0;
+    _candidates.clear ();
+    _index.assign (_index.size (), NO_CANDIDATE);
+}
+
+/**
+ *******************************************************************************
+ * @brief getCandidates - Heavy hitter candidates, highest estimate first.
+ *
+ * <!-- Parameters -->
+ *      @param[out]     candidates     Replaced with one entry per candidate.
+ *                                     Words point into this counter and are
+ *                                     nul terminated, valid until the next
+ *                                     add, merge or clear.
+ *******************************************************************************
+ */
+void Approx_Counter::getCandidates (vector < Dict_Entry_t > &candidates)
+{
+    size_t idx = 0;
+    size_t sorted = 0;
+    Dict_Entry_t entry;
+    uint32_t est = 0;
+
+    candidates.clear ();
+    for (idx = 0; idx < _candidates.size (); idx++)
+    {
+        est = estimate (_candidates[idx].hash);
+        entry.word = _candidates[idx].word.c_str ();
+        entry.len = _candidates[idx].word.size ();
+        entry.hash = _candidates[idx].hash;
+        entry.count = (est > (uint32_t) APPROX_INT_COUNT_MAX) ?
+            APPROX_INT_COUNT_MAX : (int) est;
+
+        /*
+         * Insertion sort, the candidate set is small
+         */
+        candidates.push_back (entry);
+        for (sorted = candidates.size () - 1;
+             (sorted > 0) &&
+             ((candidates[sorted - 1].count < entry.count) ||
+              ((candidates[sorted - 1].count == entry.count) &&
+               (strcmp (candidates[sorted - 1].word, entry.word) > 0)));
+             sorted--)
+        {
+            candidates[sorted] = candidates[sorted - 1];
+        }
+        candidates[sorted] = entry;
+    }
+}
+
+/**
+ *******************************************************************************
+ * @brief errorBound - Most any estimate can be over its true count, with
+ * probability confidence(): ceil ((e / width) * total ()).
+ *******************************************************************************
+ */
+uint64_t Approx_Counter::errorBound (void)
+{
+    double bound = (APPROX_E / (double) _width) * (double) _total;
+    uint64_t whole = (uint64_t) bound;
+
+    return ((bound > (double) whole) ? whole + 1 : whole);
+}
+
+/**
+ *******************************************************************************
+ * @brief confidence - Probability that a given estimate is within
+ * errorBound(): 1 - e^-depth.
+ *******************************************************************************
+ */
+double Approx_Counter::confidence (void)
+{
+    double fail = 1.0;
+    uint32_t row = 0;
+
+    for (row = 0; row < _depth; row++)
+    {
+        fail /= APPROX_E;
+    }
+    return (1.0 - fail);
+}
+
+/**
+ *******************************************************************************
+ * @brief bytesUsed - Memory held by the sketch and candidate set.
+ *******************************************************************************
+ */
+size_t Approx_Counter::bytesUsed (void)
+{
+    size_t bytes = (size_t) _width * _depth * sizeof (uint32_t);
+    size_t idx = 0;
+
+    bytes += _candidates.capacity () * sizeof (Approx_Candidate_t);
+    bytes += _index.size () * sizeof (int);
+    for (idx = 0; idx < _candidates.size (); idx++)
+    {
+        bytes += _candidates[idx].word.capacity ();
+    }
+    return (bytes);
+}
+
+/*******************************************************************************
+ ************************ L O C A L  F U N C T I O N S *************************
+ *******************************************************************************
+ */
+
+/**
+ *******************************************************************************
+ * @brief _rowSlots - Index into _counters of the word's counter in each row.
+ *
+ * @par Description:
+ *      Row r uses hash + r * h2 (Kirsch-Mitzenmacher double hashing), with
+ *      h2 an odd remix of the hash, reduced to the row width by
+ *      multiply-shift.
+ *******************************************************************************
+ */
+void Approx_Counter::_rowSlots (Word_Hash_t hash, uint32_t * slots)
+{
+    uint32_t h2 = wordHashMix (hash) | 1;
+    uint32_t row = 0;
+    uint32_t row_hash = hash;
+
+    for (row = 0; row < _depth; row++)
+    {
+        slots[row] = row * _width +
+            (uint32_t) (((uint64_t) row_hash * _width) >> 32);
+        row_hash += h2;
+    }
+}
+
+/**
+ *******************************************************************************
+ * @brief _offer - Give a word a chance at the candidate set.
+ *
+ * @par Description:
+ *      A candidate's estimate only ever rises, and by at least the delta
+ *      added, so a word already in a full set always beats the minimum.  A
+ *      word at or below the minimum can therefore be turned away without a
+ *      lookup, which is the common case once the set is full.  The minimum
+ *      is the root of the candidate heap, a risen estimate sifts down from
+ *      where it is, and a new word either joins at the bottom or replaces
+ *      the root.
+ *******************************************************************************
+ */
+void Approx_Counter::_offer (const char *word, size_t len, Word_Hash_t hash,
+                             uint32_t estimate)
+{
+    int found = 0;
+    size_t cand_idx = 0;
+
+    if ((_candidates.size () >= _maxCandidates) &&
+        (estimate <= _candidates[0].estimate))
+    {
+        return;
+    }
+    found = _findCandidate (word, len, hash);
+    if (found != NO_CANDIDATE)
+    {
+        _candidates[found].estimate = estimate;
+        _heapDown ((size_t) found);
+        return;
+    }
+    if (_candidates.size () < _maxCandidates)
+    {
+        Approx_Candidate_t cand;
+
+        _candidates.push_back (cand);
+        cand_idx = _candidates.size () - 1;
+    }
+    else
+    {
+        cand_idx = 0;
+        _indexErase (cand_idx);
+    }
+    _candidates[cand_idx].word.assign (word, len);
+    _candidates[cand_idx].hash = hash;
+    _candidates[cand_idx].estimate = estimate;
+    _indexInsert (cand_idx);
+    if (cand_idx == 0)
+    {
+        _heapDown (cand_idx);
+    }
+    else
+    {
+        _heapUp (cand_idx);
+    }
+}
+
+/**
+ *******************************************************************************
+ * @brief _findCandidate - Position of a word in _candidates, NO_CANDIDATE if
+ * it is not a candidate.
+ *******************************************************************************
+ */
+int Approx_Counter::_findCandidate (const char *word, size_t len,
+                                    Word_Hash_t hash)
+{
+    size_t slot = hash & _indexMask;
+
+    while (_index[slot] != NO_CANDIDATE)
+    {
+        Approx_Candidate_t & cand = _candidates[_index[slot]];
+
+        if ((cand.hash == hash) && (cand.word.size () == len) &&
+            (memcmp (cand.word.data (), word, len) == 0))
+        {
+            return (_index[slot]);
+        }
+        slot = (slot + 1) & _indexMask;
+    }
+    return (NO_CANDIDATE);
+}
+
+/**
+ *******************************************************************************
+ * @brief _indexInsert - Add a candidate to the linear probing index.
+ *******************************************************************************
+ */
+void Approx_Counter::_indexInsert (size_t cand_idx)
+{
+    size_t slot = _candidates[cand_idx].hash & _indexMask;
+
+    while (_index[slot] != NO_CANDIDATE)
+    {
+        slot = (slot + 1) & _indexMask;
+    }
+    _index[slot] = (int) cand_idx;
+    _candidates[cand_idx].slot = slot;
+}
+
+/**
+ *******************************************************************************
+ * @brief _indexErase - Remove a candidate from the index.
+ *
+ * @par Algorithm:
+ *      Backward shift deletion: entries after the hole move back into it
+ *      unless that would put them before their home slot, so no tombstones
+ *      are needed and lookups never lengthen.
+ *******************************************************************************
+ */
+void Approx_Counter::_indexErase (size_t cand_idx)
+{
+    size_t hole = _candidates[cand_idx].slot;
+    size_t next = (hole + 1) & _indexMask;
+    size_t home = 0;
+
+    while (_index[next] != NO_CANDIDATE)
+    {
+        home = _candidates[_index[next]].hash & _indexMask;
+
+        /*
+         * Move it back if its home is not cyclically within (hole, next]
+         */
+        if (((next - home) & _indexMask) >= ((next - hole) & _indexMask))
+        {
+            _index[hole] = _index[next];
+            _candidates[_index[hole]].slot = hole;
+            hole = next;
+        }
+        next = (next + 1) & _indexMask;
+    }
+    _index[hole] = NO_CANDIDATE;
+}
+
+/**
+ *******************************************************************************
+ * @brief _heapSwap - Swap two candidates' places in the heap, keeping the
+ * index pointing at them.
+ *******************************************************************************
+ */
+void Approx_Counter::_heapSwap (size_t left, size_t right)
+{
+    Approx_Candidate_t & lcand = _candidates[left];
+    Approx_Candidate_t & rcand = _candidates[right];
+    Word_Hash_t hash = lcand.hash;
+    uint32_t estimate = lcand.estimate;
+    size_t slot = lcand.slot;
+
+    lcand.word.swap (rcand.word);
+    lcand.hash = rcand.hash;
+    lcand.estimate = rcand.estimate;
+    lcand.slot = rcand.slot;
+    rcand.hash = hash;
+    rcand.estimate = estimate;
+    rcand.slot = slot;
+    _index[lcand.slot] = (int) left;
+    _index[rcand.slot] = (int) right;
+}
+
+/**
+ *******************************************************************************
+ * @brief _heapUp - Move a candidate towards the root while it is below its
+ * parent.
+ *******************************************************************************
+ */
+void Approx_Counter::_heapUp (size_t cand_idx)
+{
+    size_t parent = 0;
+
+    while (cand_idx > 0)
+    {
+        parent = (cand_idx - 1) / 2;
+        if (_candidates[parent].estimate <= _candidates[cand_idx].estimate)
+        {
+            break;
+        }
+        _heapSwap (parent, cand_idx);
+        cand_idx = parent;
+    }
+}
+
+/**
+ *******************************************************************************
+ * @brief _heapDown - Move a candidate away from the root while it is above
+ * its lower child.
+ *******************************************************************************
+ */
+void Approx_Counter::_heapDown (size_t cand_idx)
+{
+    size_t num_cands = _candidates.size ();
+    size_t child = 0;
+
+    while ((child = 2 * cand_idx + 1) < num_cands)
+    {
+        if ((child + 1 < num_cands) &&
+            (_candidates[child + 1].estimate < _candidates[child].estimate))
+        {
+            child++;
+        }
+        if (_candidates[cand_idx].estimate <= _candidates[child].estimate)
+        {
+            break;
+        }
+        _heapSwap (cand_idx, child);
+        cand_idx = child;
+    }
+}
+
+/**
+ *******************************************************************************
+ * @brief _heapify - Rebuild the heap after every estimate has changed.
+ *******************************************************************************
+ */
+void Approx_Counter::_heapify (void)
+{
+    size_t idx = _candidates.size () / 2;
+
+    while (idx > 0)
+    {
+        idx--;
+        _heapDown (idx);
+    }
+}
@@ -0,0 +1,204 @@
+#ifndef __APPROX_COUNTER_H__
+#define __APPROX_COUNTER_H__
+/**
+ * @file           approx_counter.hpp
+ * @brief:         Fixed memory approximate word counting (Count-Min Sketch + heavy hitters).
+ * @verbatim
+ *******************************************************************************
+ * Author:         Douglas L. Potts
+ *
+ * Date:           10/17/2026, <SCR #>
+ *
+ *==============================================================================
+ *==============================================================================
+ * Copyright (c) 2015 Douglas Lee Potts
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ *==============================================================================
+ *==============================================================================
+ *
+ * History:
+ * Date        SCR #  Name  Description
+ * -----------------------------------------------------------------------------
+ *
+ *******************************************************************************
+ * @endverbatim
+ */
+
+/*******************************************************************************
+ * System Includes
+ *******************************************************************************
+ */
+#include <stddef.h>             /* for size_t */
+#include <stdint.h>             /* for uint32_t */
+#include <string>
+#include <vector>
+
+/*******************************************************************************
+ * Project Includes
+ *******************************************************************************
+ */
+#include "common_types.h"
+#include "word_hash.h"
+#include "dict_store.hpp"
+
+#if defined(TEST)
+extern "C"
+{
+    void approxCounterOverestimate (void);
+    void approxCounterHeavyHitters (void);
+    void approxCounterMerge (void);
+    void approxCounterCandidates (void);
+}
+#endif                          /* defined(TEST) */
+
+/*******************************************************************************
+ * Typedefs
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * Constants
+ *******************************************************************************
+ */
+/** Default counters per sketch row, error is e / width of all words counted */
+#define APPROX_DEFAULT_WIDTH      (262144)
+/** Default sketch rows, the error bound fails with probability e^-depth */
+#define APPROX_DEFAULT_DEPTH      (4)
+/** Default number of heavy hitter candidates tracked for the top X report */
+#define APPROX_DEFAULT_CANDIDATES (100)
+/** Most sketch rows allowed, e^-16 is already about one in nine million */
+#define APPROX_MAX_DEPTH          (16)
+/** Estimates above this are reported as this, to fit an int word count */
+#define APPROX_INT_COUNT_MAX      (0x7FFFFFFF)
+
+/*******************************************************************************
+ * Structures
+ *******************************************************************************
+ */
+using namespace std;
+
+/** One heavy hitter candidate */
+typedef struct
+{
+    string word;                /**< Copy of the word */
+    Word_Hash_t hash;           /**< wordHash() of word */
+    uint32_t estimate;          /**< Sketch estimate as of its last update */
+    size_t slot;                /**< Where _index holds its position */
+} Approx_Candidate_t;
+
+/**
+ * Approximate word counts in memory fixed at construction.
+ *
+ * Counts go into a Count-Min Sketch of 'depth' rows of 'width' counters, each
+ * row indexed by a different hash of the word.  A word's estimate is the
+ * smallest of its counters.  Updates are conservative (only counters below
+ * the word's new estimate are raised), which never loosens the classic
+ * guarantee: with N words counted in total,
+ *
+ *      true count <= estimate <= true count + (e / width) * N
+ *
+ * where the upper bound holds with probability at least 1 - e^-depth.  The
+ * row hashes are derived from the 32-bit word hash, so distinct words with
+ * the same wordHash() share every counter; that adds to the overestimate at
+ * a rate of about (distinct words / 2^32).
+ *
+ * The words themselves are not stored, except for the 'num_candidates'
+ * words with the highest estimates seen so far (Space-Saving style: a new
+ * word replaces the lowest candidate once its estimate passes it).  Those
+ * are what the top X report is drawn from.  The candidates are kept as a
+ * min-heap on their estimates, with _index finding a word's place in it, so
+ * updating one costs O(log num_candidates).
+ *
+ * No locking of its own, the owning Word_Dict serializes access.
+ */
+class Approx_Counter
+{
+  public:
+    Approx_Counter (uint32_t width = APPROX_DEFAULT_WIDTH,
+                    uint32_t depth = APPROX_DEFAULT_DEPTH,
+                    size_t num_candidates = APPROX_DEFAULT_CANDIDATES);
+    virtual ~ Approx_Counter (void);
+
+    uint32_t add (const char *word, size_t len, Word_Hash_t hash,
+                  uint32_t delta = 1);
+    uint32_t estimate (Word_Hash_t hash);
+    Bool_t merge (Approx_Counter & other);
+    void clear (void);
+    void getCandidates (vector < Dict_Entry_t > &candidates);
+
+    uint32_t width (void)
+    {
+        return (this->_width);
+    };
+    uint32_t depth (void)
+    {
+        return (this->_depth);
+    };
+    size_t numCandidates (void)
+    {
+        return (this->_candidates.size ());
+    };
+
+    /** Sum of every delta added, the N in the error bound */
+    uint64_t total (void)
+    {
+        return (this->_total);
+    };
+    uint64_t errorBound (void);
+    double confidence (void);
+    size_t bytesUsed (void);
+
+  private:
+    uint32_t *_counters;
+    uint32_t _width;
+    uint32_t _depth;
+    uint64_t _total;
+    size_t _maxCandidates;
+    vector < Approx_Candidate_t > _candidates;
+    vector < int >_index;
+    size_t _indexMask;
+
+    void _rowSlots (Word_Hash_t hash, uint32_t * slots);
+    void _offer (const char *word, size_t len, Word_Hash_t hash,
+                 uint32_t estimate);
+    int _findCandidate (const char *word, size_t len, Word_Hash_t hash);
+    void _indexInsert (size_t cand_idx);
+    void _indexErase (size_t cand_idx);
+    void _heapSwap (size_t left, size_t right);
+    void _heapUp (size_t cand_idx);
+    void _heapDown (size_t cand_idx);
+    void _heapify (void);
+};
+
+/*******************************************************************************
+ * Unions
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * External Function Prototypes
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * Global Variables
+ *******************************************************************************
+ */
+#if _MAIN_
+#define GLOBAL_VAR_DECLARE
+#else
+#define GLOBAL_VAR_DECLARE extern
+#endif /* _MAIN_ */
+
+#endif /* __APPROX_COUNTER_H__ */
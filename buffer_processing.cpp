@@ -41,9 +41,14 @@
 #include <stdlib.h>             /* for malloc() */
 #include <string.h>             /* for strncpy() */
 #include <list>                 /* for std::list */
+#include <map>
 #include <vector>
 #include <sys/types.h>
 #include <fcntl.h>
+#include <unistd.h>             /* for read(), lseek(), close() */
+#include <sys/mman.h>           /* for mmap(), madvise() */
+#include <sys/stat.h>           /* for fstat() */
+#include <time.h>               /* for clock_gettime() */
 #include <errno.h>              /* for errno */
 #include <algorithm>            /* for std::sort */
 
@@ -56,6 +61,10 @@
 #endif /* defined(TEST) */
 #include "buffer_processing.hpp"
 #include "common_types.h"
+#include "word_scan.hpp"
+#include "utf8_words.hpp"
+#include "work_queue.hpp"
+#include "uring_reader.hpp"
 
 using namespace std;
 
@@ -72,6 +81,84 @@ Bool_t g_debug_output = FALSE;
 extern Bool_t g_debug_output;
 #endif
 
+/*******************************************************************************
+ * Local Structs
+ *******************************************************************************
+ */
+/** A thread's private pre-aggregation table, see _thread_counts() */
+typedef struct
+{
+    Word_Dict *table;           /**< Unsharded and unlocked, empty between
+                                  flushes */
+    size_t published_bytes;     /**< Last given to _publish_buffer_bytes() */
+} Thread_Counts_t;
+
+/** Where processFile() counts the words of a file, and how far it has got */
+typedef struct
+{
+    Word_Dict *dict;            /**< Dictionary the file is counted into, or
+                                  NULL if only estimating */
+    Word_Dict *counts;          /**< The thread's private table flushed to
+                                  'dict', or 'dict' itself if it is not
+                                  shared */
+    Thread_Counts_t *local;     /**< The thread's private table, or NULL if
+                                  'counts' is 'dict' */
+    Hyper_Log_Log *distinct;    /**< The file's distinct word estimate, or
+                                  NULL */
+    size_t flush_bytes;         /**< File bytes between flushes to 'dict' */
+    size_t published_bytes;     /**< Last given to _publish_buffer_bytes(),
+                                  for the read buffer */
+    size_t unflushed_bytes;     /**< File bytes counted since the last flush */
+    size_t num_tokens;          /**< Words counted */
+    size_t num_flushed;         /**< Entries merged into 'dict' */
+} File_Counts_t;
+
+/** A file split into chunks, see processSplitItem(), until the last of them
+ * is counted */
+typedef struct
+{
+    unsigned int chunks_left;   /**< Chunks not yet counted */
+    Hyper_Log_Log *distinct;    /**< Estimates of the chunks counted so far,
+                                  merged, or NULL */
+} Split_File_t;
+
+/** A file being read and counted, see _file_begin() */
+typedef struct
+{
+    string path;                /**< Path of the file */
+    int fd;                     /**< Open file, or -1 */
+    int tid;                    /**< Thread index, for debug output */
+    Process_Io_Policy_t io_policy;      /**< How the file is read */
+    char *buffer;               /**< Page aligned read buffer */
+    size_t buf_size;            /**< Size of 'buffer' */
+    size_t read_align;          /**< Alignment reads need, 1 unless
+                                  PROCESS_IO_DIRECT */
+    size_t data_offset;         /**< Where the carried over word starts */
+    size_t carry_bytes;         /**< Partial word at 'data_offset', carried
+                                  over from the last read */
+    size_t read_pos;            /**< Where in 'buffer' the next read goes,
+                                  right behind the carried over word */
+    size_t read_len;            /**< Bytes the next read asks for */
+    uint64_t offset;            /**< File offset of the next read */
+    uint64_t chunk_start;       /**< File offset of the chunk counted, 0 for
+                                  the whole file, set before _file_begin() */
+    uint64_t chunk_end;         /**< File offset the chunk ends at, 0 for the
+                                  whole file, set before _file_begin() */
+    size_t skip_bytes;          /**< Bytes read from before the chunk still to
+                                  be dropped, see _chunk_skip() */
+    Bool_t skip_word;           /**< Still dropping the end of a word that
+                                  belongs to the chunk before */
+    uint64_t dropped_offset;    /**< File bytes dropped from the page cache,
+                                  PROCESS_IO_DONTNEED only */
+    size_t total_bytes;         /**< File bytes tokenized */
+    uint64_t num_reads;         /**< Reads made */
+    vector < int >read_counts;  /**< Bytes of each read, for debug output */
+    vector < Token_Span_t > spans;      /**< Reused for each buffer's words */
+    Hyper_Log_Log *distinct_words;      /**< Run's estimate 'fc.distinct'
+                                          is merged into, or NULL */
+    File_Counts_t fc;           /**< Where the words are counted */
+} File_Read_t;
+
 /*******************************************************************************
  * Local Function Prototypes 
  *******************************************************************************
@@ -80,6 +167,33 @@ static void print_read_performance (vector < int >&read_counts);
 static bool int_compare (int i, int j);
 static void _lock_printing (void);
 static void _unlock_printing (void);
+static void _publish_buffer_bytes (size_t * published, size_t bytes);
+static size_t _table_bytes (Word_Dict * table);
+static void _thread_counts_key (void);
+static void _thread_counts_free (void *local);
+static Thread_Counts_t *_thread_counts (void);
+static size_t _tokenize (const char *buffer, size_t buffer_sz,
+                         vector < Token_Span_t > &spans, Bool_t at_end,
+                         char *fold);
+static inline Word_Hash_t _fold_and_hash (const char *word, char *fold,
+                                          size_t len);
+static void _count_chunk (File_Counts_t * fc, const char *buffer,
+                          const vector < Token_Span_t > &spans,
+                          size_t bytes, Bool_t at_end);
+static Bool_t _map_file (File_Read_t * fr, size_t * mapped);
+static int _file_open_flags (Process_Io_Policy_t io_policy);
+static void _file_begin (File_Read_t * fr, int tid, Word_Dict * dict,
+                         size_t flush_bytes, Hyper_Log_Log * distinct_words,
+                         size_t read_bytes, Process_Io_Policy_t io_policy);
+static size_t _file_read_room (File_Read_t * fr, size_t carry);
+static char *_file_grow_buffer (File_Read_t * fr);
+static void _mark_active (Bool_t at_end);
+static void _chunk_clamp_read (File_Read_t * fr);
+static size_t _chunk_skip (File_Read_t * fr, const char *bytes, size_t count);
+static Bool_t _file_consume (File_Read_t * fr, size_t bytes);
+static void _file_end (File_Read_t * fr, size_t mapped_bytes);
+static Hyper_Log_Log *_file_distinct (File_Read_t * fr);
+static inline Bool_t _is_run_byte (char byte);
 
 /*******************************************************************************
  * Local Constants 
@@ -89,6 +203,19 @@ static void _unlock_printing (void);
 /** @def Used to turn on and off debug print statements. */
 #define DBG(X)
 
+/** Shift placing byte N of an 8 byte block where a memcpy() load puts it */
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+#define BLOCK_BYTE_SHIFT(N) (56 - 8 * (N))
+#else
+#define BLOCK_BYTE_SHIFT(N) (8 * (N))
+#endif
+
+/** _fold_and_hash() tail step: fold byte N of the last block into 'fold',
+ * and place it in 'block' */
+#define FOLD_TAIL_BYTE(N) \
+    fold[idx + (N)] = (char) g_foldTable[bytes[idx + (N)]]; \
+    block |= (uint64_t) g_foldTable[bytes[idx + (N)]] << BLOCK_BYTE_SHIFT (N)
+
 /*******************************************************************************
  * File Scoped Variables 
  *******************************************************************************
@@ -100,6 +227,81 @@ static void _unlock_printing (void);
  */
 static pthread_mutex_t g_printMutex = PTHREAD_MUTEX_INITIALIZER;
 
+/**
+ * Memory of every processFile() in progress, its read buffer and private
+ * table, and the most there has been at once, under g_memMutex.
+ */
+static pthread_mutex_t g_memMutex = PTHREAD_MUTEX_INITIALIZER;
+static size_t g_bufferBytes = 0;
+static size_t g_bufferPeak = 0;
+
+/** read() calls made by every processFile() so far, and the bytes they
+ * returned, also under g_memMutex */
+static uint64_t g_readCalls = 0;
+static uint64_t g_readBytes = 0;
+
+/** Files processFile() has counted straight from a mapping, and their bytes,
+ * also under g_memMutex */
+static uint64_t g_mappedFiles = 0;
+static uint64_t g_mappedBytes = 0;
+
+/** Each thread's Thread_Counts_t, made the first time the thread counts into
+ * a shared dictionary and freed when it exits */
+static pthread_key_t g_threadCountsKey;
+static pthread_once_t g_threadCountsOnce = PTHREAD_ONCE_INIT;
+
+/** Files processSplitItem() split, by path, under g_splitMutex */
+static pthread_mutex_t g_splitMutex = PTHREAD_MUTEX_INITIALIZER;
+static map < string, Split_File_t > g_splitFiles;
+
+/** Whether words are UTF-8, see tokenizeSetUtf8(), set before any file is
+ * counted */
+static Bool_t g_utf8Words = FALSE;
+
+/** When the first file was begun and the last one ended, CLOCK_MONOTONIC,
+ * also under g_memMutex */
+static struct timespec g_activeStart = { 0, 0 };
+static struct timespec g_activeEnd = { 0, 0 };
+
+/**
+ * Case folding of a byte, A-Z to a-z and every other byte as it is.  A table
+ * rather than tolower(), which goes through the locale for every byte.
+ */
+static const unsigned char g_foldTable[256] = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+    0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+    0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17,
+    0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f,
+    0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27,
+    0x28, 0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f,
+    0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37,
+    0x38, 0x39, 0x3a, 0x3b, 0x3c, 0x3d, 0x3e, 0x3f,
+    0x40, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67,
+    0x68, 0x69, 0x6a, 0x6b, 0x6c, 0x6d, 0x6e, 0x6f,
+    0x70, 0x71, 0x72, 0x73, 0x74, 0x75, 0x76, 0x77,
+    0x78, 0x79, 0x7a, 0x5b, 0x5c, 0x5d, 0x5e, 0x5f,
+    0x60, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67,
+    0x68, 0x69, 0x6a, 0x6b, 0x6c, 0x6d, 0x6e, 0x6f,
+    0x70, 0x71, 0x72, 0x73, 0x74, 0x75, 0x76, 0x77,
+    0x78, 0x79, 0x7a, 0x7b, 0x7c, 0x7d, 0x7e, 0x7f,
+    0x80, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+    0x88, 0x89, 0x8a, 0x8b, 0x8c, 0x8d, 0x8e, 0x8f,
+    0x90, 0x91, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97,
+    0x98, 0x99, 0x9a, 0x9b, 0x9c, 0x9d, 0x9e, 0x9f,
+    0xa0, 0xa1, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7,
+    0xa8, 0xa9, 0xaa, 0xab, 0xac, 0xad, 0xae, 0xaf,
+    0xb0, 0xb1, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7,
+    0xb8, 0xb9, 0xba, 0xbb, 0xbc, 0xbd, 0xbe, 0xbf,
+    0xc0, 0xc1, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6, 0xc7,
+    0xc8, 0xc9, 0xca, 0xcb, 0xcc, 0xcd, 0xce, 0xcf,
+    0xd0, 0xd1, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7,
+    0xd8, 0xd9, 0xda, 0xdb, 0xdc, 0xdd, 0xde, 0xdf,
+    0xe0, 0xe1, 0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7,
+    0xe8, 0xe9, 0xea, 0xeb, 0xec, 0xed, 0xee, 0xef,
+    0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7,
+    0xf8, 0xf9, 0xfa, 0xfb, 0xfc, 0xfd, 0xfe, 0xff
+};
+
 /*******************************************************************************
  ********************* E X T E R N A L  F U N C T I O N S **********************
  *******************************************************************************
@@ -328,6 +530,65 @@ off_t mock_lseek (int fd, off_t offset, int whence)
     return ((off_t) g_mock_file_ptr);
 }
 
+/**
+ *******************************************************************************
+ * @brief mock_fstat - Size of the mock file.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      fd            File descriptor (not used)
+ *      @param[out]     st            Cleared, with st_size the mock data size
+ *
+ * <!-- Returns -->
+ *      @return 0 - ALWAYS
+ *******************************************************************************
+ */
+int mock_fstat (int fd, struct stat *st)
+{
+    memset (st, 0, sizeof (*st));
+    st->st_size = (off_t) (g_mock_file_end - g_mock_file_data);
+    return (0);
+}
+
+/**
+ *******************************************************************************
+ * @brief mock_mmap - Map the mock file, which is the mock data itself.
+ *
+ * <!-- Returns -->
+ *      @return The mock file data, which stays owned by mock_close()
+ *******************************************************************************
+ */
+void *mock_mmap (void *addr, size_t length, int prot, int flags, int fd,
+                 off_t offset)
+{
+    return ((void *) (g_mock_file_data + offset));
+}
+
+/**
+ *******************************************************************************
+ * @brief mock_munmap - Unmap the mock file, a no-operation.
+ *
+ * <!-- Returns -->
+ *      @return 0 - ALWAYS
+ *******************************************************************************
+ */
+int mock_munmap (void *addr, size_t length)
+{
+    return (0);
+}
+
+/**
+ *******************************************************************************
+ * @brief mock_madvise - Advice on the mock file mapping, a no-operation.
+ *
+ * <!-- Returns -->
+ *      @return 0 - ALWAYS
+ *******************************************************************************
+ */
+int mock_madvise (void *addr, size_t length, int advice)
+{
+    return (0);
+}
+
 /*
  * When we are in #if defined(TEST), these will replace the system calls in this
  * file
@@ -337,6 +598,10 @@ off_t mock_lseek (int fd, off_t offset, int whence)
 #define read mock_read
 #define close mock_close
 #define lseek mock_lseek
+#define fstat mock_fstat
+#define mmap mock_mmap
+#define munmap mock_munmap
+#define madvise mock_madvise
 
 extern "C"
 {
@@ -422,6 +687,216 @@ extern "C"
 
     }
 
+    void bufferProcSpans (void)
+    {
+        char mybuf[] = "zzz=abc!!!555++++Doug!!!xy";
+        size_t buflen = strlen (mybuf);
+        vector < Token_Span_t > spans;
+        const Token_Span_t *first = NULL;
+        size_t capacity = 0;
+        size_t ret = 0;
+
+        /*
+         * The trailing "xy" may go on in the next read, so is left out
+         */
+        ret = tokenizeBuffer (mybuf, buflen, spans);
+        TEST_ASSERT_EQUAL (ret, buflen - 3);
+        TEST_ASSERT_EQUAL (spans.size (), 4);
+        TEST_ASSERT_EQUAL (spans[0].offset, 0);
+        TEST_ASSERT_EQUAL (spans[0].len, 3);
+        TEST_ASSERT_EQUAL (spans[1].offset, 4);
+        TEST_ASSERT_EQUAL (spans[2].offset, 10);
+        TEST_ASSERT_EQUAL (spans[3].offset, 17);
+        TEST_ASSERT_EQUAL (spans[3].len, 4);
+        TEST_ASSERT_EQUAL (strncmp (&mybuf[spans[3].offset], "Doug", 4), 0);
+
+        /*
+         * At the end of the file it is a word, and the vector is reused
+         * without allocating again
+         */
+        ret = tokenizeBuffer (mybuf, buflen, spans, TRUE);
+        TEST_ASSERT_EQUAL (ret, buflen);
+        TEST_ASSERT_EQUAL (spans.size (), 5);
+        TEST_ASSERT_EQUAL (spans[4].offset, buflen - 2);
+        TEST_ASSERT_EQUAL (spans[4].len, 2);
+        first = &spans[0];
+        capacity = spans.capacity ();
+        ret = tokenizeBuffer (mybuf, 10, spans);
+        TEST_ASSERT_EQUAL (ret, 10);
+        TEST_ASSERT_EQUAL (spans.size (), 2);
+        TEST_ASSERT_TRUE (&spans[0] == first);
+        TEST_ASSERT_EQUAL (spans.capacity (), capacity);
+
+        /*
+         * No words, and nothing but one word
+         */
+        ret = tokenizeBuffer ("!!==!!", 6, spans);
+        TEST_ASSERT_EQUAL (ret, 6);
+        TEST_ASSERT_EQUAL (spans.size (), 0);
+        ret = tokenizeBuffer ("abcdef", 6, spans);
+        TEST_ASSERT_EQUAL (ret, 6);
+        TEST_ASSERT_EQUAL (spans.size (), 1);
+        TEST_ASSERT_EQUAL (spans[0].len, 6);
+        ret = tokenizeBuffer ("", 0, spans);
+        TEST_ASSERT_EQUAL (ret, 0);
+        TEST_ASSERT_EQUAL (spans.size (), 0);
+    }
+    void bufferProcSpansWrappers (void)
+    {
+        char mybuf[] = "!!The quick, brown fox=jumps 42 times over";
+        int buflen = strlen (mybuf);
+        vector < Token_Span_t > spans;
+        list < char *>word_list;
+        char *word = NULL;
+        size_t idx = 0;
+        int ret = 0;
+
+        /*
+         * The old calloc()ing functions give the same words and counts
+         */
+        ret = processWholeBuffer (mybuf, buflen, word_list);
+        TEST_ASSERT_EQUAL (ret, (int) tokenizeBuffer (mybuf, buflen, spans));
+        TEST_ASSERT_EQUAL (word_list.size (), spans.size ());
+        for (list < char *>::iterator it = word_list.begin ();
+             it != word_list.end (); ++it, ++idx)
+        {
+            TEST_ASSERT_EQUAL (strlen (*it), spans[idx].len);
+            TEST_ASSERT_EQUAL (strncmp (*it, &mybuf[spans[idx].offset],
+                                        spans[idx].len), 0);
+            free (*it);
+        }
+
+        ret = processBufferForWords (&mybuf[6], buflen - 6, &word);
+        TEST_ASSERT_NOT_NULL (word);
+        TEST_ASSERT_EQUAL_STRING (word, "quick");
+        TEST_ASSERT_EQUAL (ret, 5);
+        free (word);
+        ret = processBufferForWords (&mybuf[buflen - 4], 4, &word);
+        TEST_ASSERT_EQUAL_STRING (word, "over");
+        TEST_ASSERT_EQUAL (ret, 4);
+        free (word);
+    }
+    void bufferProcSpansKernels (void)
+    {
+        static const char ALPHABET[] = "aZ9 .-Q\xe9\n";
+        static const size_t BUF_LEN = 300;
+        Word_Scan_Kernel_t original = wordScanKernel ();
+        char buffer[BUF_LEN];
+        vector < Token_Span_t > spans;
+        vector < Token_Span_t > expected;
+        Token_Span_t span;
+        uint32_t seed = 99;
+        size_t len = 0;
+        size_t idx = 0;
+        size_t ret = 0;
+        int kernel = 0;
+
+        /*
+         * Words of random lengths, so they start and end on every byte of a
+         * block and cross between blocks
+         */
+        for (idx = 0; idx < BUF_LEN; idx++)
+        {
+            seed = seed * 1103515245U + 12345U;
+            buffer[idx] = ALPHABET[(seed >> 16) % (sizeof (ALPHABET) - 1)];
+        }
+        for (kernel = WORD_SCAN_SCALAR; kernel < WORD_SCAN_NUM_KERNELS;
+             kernel++)
+        {
+            if (wordScanSetKernel ((Word_Scan_Kernel_t) kernel) == FALSE)
+            {
+                continue;
+            }
+            for (len = 0; len <= BUF_LEN; len++)
+            {
+                /* The original byte at a time search, at the end of file */
+                expected.clear ();
+                for (idx = 0; idx < len;)
+                {
+                    while ((idx < len) && (isWordChar (buffer[idx]) == FALSE))
+                    {
+                        idx++;
+                    }
+                    span.offset = idx;
+                    while ((idx < len) && (isWordChar (buffer[idx]) == TRUE))
+                    {
+                        idx++;
+                    }
+                    span.len = idx - span.offset;
+                    if (span.len > 0)
+                    {
+                        expected.push_back (span);
+                    }
+                }
+
+                ret = tokenizeBuffer (buffer, len, spans, TRUE);
+                TEST_ASSERT_EQUAL (ret, len);
+                TEST_ASSERT_EQUAL (spans.size (), expected.size ());
+                for (idx = 0; idx < expected.size (); idx++)
+                {
+                    TEST_ASSERT_EQUAL (spans[idx].offset,
+                                       expected[idx].offset);
+                    TEST_ASSERT_EQUAL (spans[idx].len, expected[idx].len);
+                }
+            }
+        }
+        TEST_ASSERT_TRUE (wordScanSetKernel (original) == TRUE);
+    }
+    void bufferProcFoldHash (void)
+    {
+        char mybuf[] = "The QUICK,brown=Fox 0123456789ABCDEFG!"
+            "AbCdEfGhIjKlMnOpQrStUvWxYz=x";
+        char folded[] = "the quick,brown=fox 0123456789abcdefg!"
+            "abcdefghijklmnopqrstuvwxyz=x";
+        size_t buflen = strlen (mybuf);
+        vector < Token_Span_t > spans;
+        vector < Token_Span_t > plain;
+        char word[64];
+        size_t idx = 0;
+        size_t len = 0;
+        size_t ret = 0;
+
+        /*
+         * Same words as tokenizeBuffer(), lowercased in place, with the
+         * punctuation and the unfinished "x" left alone
+         */
+        TEST_ASSERT_EQUAL (tokenizeBuffer (mybuf, buflen, plain), buflen - 2);
+        ret = tokenizeFoldHash (mybuf, buflen, spans);
+        TEST_ASSERT_EQUAL (ret, buflen - 2);
+        TEST_ASSERT_EQUAL (spans.size (), plain.size ());
+        TEST_ASSERT_EQUAL (spans.size (), 6);
+        TEST_ASSERT_EQUAL (memcmp (mybuf, folded, buflen - 1), 0);
+        TEST_ASSERT_EQUAL (mybuf[buflen - 1], 'x');
+        for (idx = 0; idx < spans.size (); idx++)
+        {
+            TEST_ASSERT_EQUAL (spans[idx].offset, plain[idx].offset);
+            TEST_ASSERT_EQUAL (spans[idx].len, plain[idx].len);
+            TEST_ASSERT_EQUAL (spans[idx].hash,
+                               wordHash (&folded[spans[idx].offset],
+                                         spans[idx].len));
+        }
+
+        /*
+         * Every length across the 8 byte blocks hashes as wordHash() does,
+         * and a word differing only in case or zero padding doesn't
+         */
+        for (len = 1; len < sizeof (word); len++)
+        {
+            for (idx = 0; idx < len; idx++)
+            {
+                word[idx] = (char) ('A' + (idx * 7 + len) % 26);
+            }
+            TEST_ASSERT_EQUAL (tokenizeFoldHash (word, len, spans, TRUE),
+                               len);
+            TEST_ASSERT_EQUAL (spans.size (), 1);
+            TEST_ASSERT_EQUAL (spans[0].hash, wordHash (word, len));
+            TEST_ASSERT_TRUE (word[len - 1] >= 'a');
+        }
+        TEST_ASSERT_TRUE (wordHash ("ab", 2) != wordHash ("ab\0", 3));
+        TEST_ASSERT_TRUE (wordHash ("ab", 2) != wordHash ("AB", 2));
+        TEST_ASSERT_TRUE (wordHash ("", 0) != wordHash ("\0", 1));
+    }
+
     void fileProcess (void)
     {
         static const int my_buf_len = 520;
@@ -467,466 +942,2567 @@ extern "C"
         while (word != "");
         TEST_ASSERT_EQUAL (dict_entry_count, 2);
     }
-}
-#endif /* defined(TEST) */
 
-/**
- *******************************************************************************
- * @brief isWordChar - Check if the given character is considered a "word" char.
- *
- * <!-- Parameters -->
- *      @param[in]      thisOne        Character code to check if it is a "word"
- *                                     char.
- *
- * <!-- Returns -->
- *      @return TRUE    If thisOne is a "word" character
- *      @return FALSE   If thisOne is NOT a "word" character
- *
- * @par Pre/Post Conditions:
- *      None (if entry/exit conditions do not apply)
- *
- * @par Global Data:
- *      None (if no global data)
- *
- * @par Description:
- *      Check if the character falls between a-z, A-Z, or 0-9.
- *******************************************************************************
- */
-Bool_t isWordChar (const char thisOne)
-{
-    if ((thisOne >= 'A' && thisOne <= 'Z') ||
-        (thisOne >= 'a' && thisOne <= 'z') ||
-        (thisOne >= '0' && thisOne <= '9'))
+    void fileProcessFlush (void)
     {
-        return TRUE;
+        static const char PATTERN[] = "The cat the DOG ";
+        static const int NUM_REPEATS = 96;      /* 3 full 512 byte reads */
+        int tid = 1;            /* Fake thread id */
+        string fakeFilePath = "/usr/local";
+        Word_Dict *testDict = new Word_Dict (4);
+        char fileData[sizeof (PATTERN) * NUM_REPEATS] = { 0 };
+        int data_len = 0;
+        int idx = 0;
+
+        for (idx = 0; idx < NUM_REPEATS; idx++)
+        {
+            memcpy (&fileData[data_len], PATTERN, strlen (PATTERN));
+            data_len += strlen (PATTERN);
+        }
+        mock_set_file_data (fileData, data_len);
+
+        /*
+         * Flush after every read, so the shared dictionary sees several
+         * merges of the same words.
+         */
+        processFile (tid, fakeFilePath, testDict, 512, NULL, 512);
+
+        TEST_ASSERT_EQUAL (testDict->getWordCount ((char *) "the"),
+                           2 * NUM_REPEATS);
+        TEST_ASSERT_EQUAL (testDict->getWordCount ((char *) "cat"),
+                           NUM_REPEATS);
+        TEST_ASSERT_EQUAL (testDict->getWordCount ((char *) "dog"),
+                           NUM_REPEATS);
+        TEST_ASSERT_EQUAL (testDict->size (), 3);
+
+        delete testDict;
     }
-    else
+
+    void fileProcessDistinct (void)
     {
-        return FALSE;
-    }
-}
+        static const char PATTERN[] = "one two Three four FIVE one ";
+        static const int NUM_REPEATS = 40;
+        int tid = 1;            /* Fake thread id */
+        string fakeFilePath = "/usr/local";
+        Word_Dict *testDict = new Word_Dict (4);
+        Hyper_Log_Log *distinct = new Hyper_Log_Log ();
+        char fileData[sizeof (PATTERN) * NUM_REPEATS] = { 0 };
+        int data_len = 0;
+        int idx = 0;
+        double est = 0.0;
 
-/**
- *******************************************************************************
- * @brief processFile - Take a file path, and parse the file for words putting
- * them in the dictionary.
- *
- * <!-- Parameters -->
- *      @param[in]      tid            Integer thread index, only used in debug
- *                                     output to track which thread is
- *                                     performing what operation.
- *      @param[in]      filePath       String file path to a ".txt" file
- *      @param[in]      dict           Pointer to a Word_Dict which any words
- *                                     processed will be kept.
- *
- * <!-- Returns -->
- *      None (if return type is void)
- *
- * @par Pre/Post Conditions:
- *      None (if entry/exit conditions do not apply)
- *
- * @par Global Data:
- *      None (if no global data)
- *
- * @par Description:
- *      Open the file specified by filePath, and read through it, searching for
- *      words (based on "word char" qualification), and updating the dictionary
- *      for each.  Updating consists of inserting if the word doesn't already
- *      exist, and updating the count for that word if it does.
- *******************************************************************************
- */
-void processFile (int tid, string filePath, Word_Dict * dict)
-{
-    static const int INITIAL_COUNT = 1;
-    char buffer[512] = { 0 };
+        for (idx = 0; idx < NUM_REPEATS; idx++)
+        {
+            memcpy (&fileData[data_len], PATTERN, strlen (PATTERN));
+            data_len += strlen (PATTERN);
+        }
 
-    int fIn;
-    ssize_t bytes = 0;
-    ssize_t total_bytes = 0;
-    list < char *>word_list;
-    vector < int >read_counts;
-    int processed_bytes = 0;
-    int leftover_bytes = 0;
+        /*
+         * Counting and estimating together
+         */
+        mock_set_file_data (fileData, data_len);
+        processFile (tid, fakeFilePath, testDict, PROCESS_FLUSH_BYTES,
+                     distinct);
+        est = distinct->estimate ();
+        TEST_ASSERT_TRUE ((est > 4.5) && (est < 5.5));
+        TEST_ASSERT_EQUAL (testDict->size (), 5);
+        TEST_ASSERT_EQUAL (testDict->getWordCount ((char *) "one"),
+                           2 * NUM_REPEATS);
 
-    fIn = open (filePath.c_str (), O_RDONLY);
-    if (fIn == -1)
-    {
-        fprintf (stderr, "Failed to open file: %s, errno=%d,%s",
-                 filePath.c_str (), errno, strerror (errno));
-        return;
+        /*
+         * Estimate only, no dictionary, the same words again don't add to
+         * the estimate
+         */
+        mock_set_file_data (fileData, data_len);
+        processFile (tid, fakeFilePath, NULL, PROCESS_FLUSH_BYTES, distinct);
+        TEST_ASSERT_TRUE (distinct->estimate () == est);
+
+        delete distinct;
+        delete testDict;
     }
 
-    DBG (printf ("Processing file: %s\n", filePath.c_str ()));
-    Bool_t already_rewound = FALSE;
+    /** Long words for a PROCESS_READ_MIN_BYTES buffer, the first is right
+     * behind the first read */
+    static const char LONG_WORDS[] =
+        "x 0123456789abc abcdefghijklmnopqrstuvwxyz0123456789 x "
+        "abcdefghijklmnopqrstuvwxyz0123456789x x";
 
-    while ((bytes = read (fIn, buffer, sizeof (buffer))) > 0)
+    void fileProcessCarryOver (void)
     {
+        /*
+         * Words of every length straddle the reads, and the file ends on a
+         * word with nothing after it.
+         */
+        static const char DATA[] =
+            "alpha be gamma-delta epsilon, z  Alpha;BE zeta12345 alphabet "
+            "ALPHA\nbe be epsilon.gamma z alpha endword";
+        static const size_t READ_SIZES[] = { 16, 17, 23, 64, 4096 };
+        int tid = 1;            /* Fake thread id */
+        string fakeFilePath = "/usr/local";
+        Word_Dict *testDict = NULL;
+        size_t idx = 0;
+        uint64_t calls = 0;
+        uint64_t bytes = 0;
+        uint64_t last_bytes = 0;
+
+        for (idx = 0; idx < sizeof (READ_SIZES) / sizeof (READ_SIZES[0]);
+             idx++)
+        {
+            testDict = new Word_Dict (4);
+            processReadStats (&calls, &last_bytes);
+            mock_set_file_data ((char *) DATA, strlen (DATA));
+            processFile (tid, fakeFilePath, testDict, PROCESS_FLUSH_BYTES,
+                         NULL, READ_SIZES[idx]);
+
+            TEST_ASSERT_EQUAL (testDict->getWordCount ((char *) "alpha"), 4);
+            TEST_ASSERT_EQUAL (testDict->getWordCount ((char *) "be"), 4);
+            TEST_ASSERT_EQUAL (testDict->getWordCount ((char *) "gamma"), 2);
+            TEST_ASSERT_EQUAL (testDict->getWordCount ((char *) "delta"), 1);
+            TEST_ASSERT_EQUAL (testDict->getWordCount ((char *) "epsilon"),
+                               2);
+            TEST_ASSERT_EQUAL (testDict->getWordCount ((char *) "z"), 2);
+            TEST_ASSERT_EQUAL (testDict->getWordCount ((char *) "zeta12345"),
+                               1);
+            TEST_ASSERT_EQUAL (testDict->getWordCount ((char *) "alphabet"),
+                               1);
+            TEST_ASSERT_EQUAL (testDict->getWordCount ((char *) "endword"),
+                               1);
+            TEST_ASSERT_EQUAL (testDict->size (), 9);
+
+            /* Every byte of the file read exactly once */
+            processReadStats (&calls, &bytes);
+            TEST_ASSERT_EQUAL (bytes - last_bytes, strlen (DATA));
+            delete testDict;
+        }
 
-        read_counts.push_back (bytes);
-        word_list.clear ();
-        processed_bytes = processWholeBuffer (buffer, bytes, word_list);
+        /*
+         * A word longer than the buffer grows it, and is counted whole, as
+         * is everything after it.  The first read ends right in front of
+         * one, the second is carried over.
+         */
+        testDict = new Word_Dict (4);
+        mock_set_file_data ((char *) LONG_WORDS, strlen (LONG_WORDS));
+        processFile (tid, fakeFilePath, testDict, PROCESS_FLUSH_BYTES, NULL,
+                     PROCESS_READ_MIN_BYTES);
+        TEST_ASSERT_EQUAL (testDict->getWordCount
+                           ((char *) "abcdefghijklmnopqrstuvwxyz0123456789"),
+                           1);
+        TEST_ASSERT_EQUAL (testDict->getWordCount
+                           ((char *) "abcdefghijklmnopqrstuvwxyz0123456789x"),
+                           1);
+        TEST_ASSERT_EQUAL (testDict->getWordCount ((char *) "x"), 3);
+        TEST_ASSERT_EQUAL (testDict->size (), 4);
+        delete testDict;
+    }
 
+    void fileProcessMmap (void)
+    {
+        static const char DATA[] =
+            "alpha be gamma-delta epsilon, z  Alpha;BE zeta12345 alphabet "
+            "ALPHA\nbe be epsilon.gamma z alpha endword";
+        static const size_t WINDOW_SIZES[] = { 16, 17, 23, 64 };
+        int tid = 1;            /* Fake thread id */
+        string fakeFilePath = "/usr/local";
+        Word_Dict *testDict = NULL;
+        vector < Token_Span_t > spans;
+        char fold[sizeof (DATA)];
+        size_t idx = 0;
+        uint64_t calls = 0;
+        uint64_t last_calls = 0;
+        uint64_t files = 0;
+        uint64_t last_files = 0;
+        uint64_t bytes = 0;
+        uint64_t last_bytes = 0;
 
-        DBG (printWordList (word_list));
+        /*
+         * The words go to 'fold' lowercased, the buffer is left alone
+         */
+        TEST_ASSERT_EQUAL (tokenizeFoldHashTo (DATA, 12, fold, spans), 8);
+        TEST_ASSERT_EQUAL (spans.size (), 2);
+        TEST_ASSERT_EQUAL_MEMORY ("alpha", &fold[spans[0].offset], 5);
+        TEST_ASSERT_EQUAL (spans[0].hash, wordHash ("alpha", 5));
+        TEST_ASSERT_EQUAL_MEMORY ("be", &fold[spans[1].offset], 2);
+        TEST_ASSERT_EQUAL_MEMORY ("alpha be gam", DATA, 12);
+        TEST_ASSERT_EQUAL (tokenizeFoldHashTo (&DATA[42], 10, fold, spans,
+                                               TRUE), 10);
+        TEST_ASSERT_EQUAL_MEMORY ("zeta12345", &fold[spans[0].offset], 9);
 
         /*
-         * Foreach word:
-         *     - Try and find it in the list
-         *     - if in the list, increment count
-         *     - otherwise add to the list with a count of 1
+         * Files bigger than the window are counted from the mapping, with
+         * words cut by every window boundary
          */
-        for (list < char *>::iterator it = word_list.begin ();
-             it != word_list.end (); ++it)
+        for (idx = 0; idx < sizeof (WINDOW_SIZES) / sizeof (WINDOW_SIZES[0]);
+             idx++)
         {
-            string word;
+            testDict = new Word_Dict (4);
+            processReadStats (&last_calls, &bytes);
+            processMapStats (&last_files, &last_bytes);
+            mock_set_file_data ((char *) DATA, strlen (DATA));
+            processFile (tid, fakeFilePath, testDict, PROCESS_FLUSH_BYTES,
+                         NULL, WINDOW_SIZES[idx], PROCESS_READ_MMAP);
+
+            TEST_ASSERT_EQUAL (testDict->getWordCount ((char *) "alpha"), 4);
+            TEST_ASSERT_EQUAL (testDict->getWordCount ((char *) "be"), 4);
+            TEST_ASSERT_EQUAL (testDict->getWordCount ((char *) "gamma"), 2);
+            TEST_ASSERT_EQUAL (testDict->getWordCount ((char *) "zeta12345"),
+                               1);
+            TEST_ASSERT_EQUAL (testDict->getWordCount ((char *) "endword"),
+                               1);
+            TEST_ASSERT_EQUAL (testDict->size (), 9);
+
+            processReadStats (&calls, &bytes);
+            processMapStats (&files, &bytes);
+            TEST_ASSERT_EQUAL (calls, last_calls);
+            TEST_ASSERT_EQUAL (files - last_files, 1);
+            TEST_ASSERT_EQUAL (bytes - last_bytes, strlen (DATA));
+            delete testDict;
+        }
 
-            word = *it;
-            DBG (printf ("Finding word: %s\n", word.c_str ()));
+        /*
+         * A word longer than a window widens it
+         */
+        testDict = new Word_Dict (4);
+        mock_set_file_data ((char *) LONG_WORDS, strlen (LONG_WORDS));
+        processFile (tid, fakeFilePath, testDict, PROCESS_FLUSH_BYTES,
+                     NULL, PROCESS_READ_MIN_BYTES, PROCESS_READ_MMAP);
+        TEST_ASSERT_EQUAL (testDict->getWordCount
+                           ((char *) "abcdefghijklmnopqrstuvwxyz0123456789"),
+                           1);
+        TEST_ASSERT_EQUAL (testDict->getWordCount
+                           ((char *) "abcdefghijklmnopqrstuvwxyz0123456789x"),
+                           1);
+        TEST_ASSERT_EQUAL (testDict->size (), 4);
+        delete testDict;
 
-            /*
-             * Convert word to lowercase before searching or inserting it 
-             */
-            transform (word.begin (), word.end (), word.begin (),::tolower);
+        /*
+         * A file that fits in the read buffer is read, not mapped
+         */
+        testDict = new Word_Dict (4);
+        processMapStats (&last_files, &last_bytes);
+        mock_set_file_data ((char *) DATA, strlen (DATA));
+        processFile (tid, fakeFilePath, testDict, PROCESS_FLUSH_BYTES,
+                     NULL, PROCESS_READ_BYTES, PROCESS_READ_MMAP);
+        TEST_ASSERT_EQUAL (testDict->size (), 9);
+        processMapStats (&files, &bytes);
+        TEST_ASSERT_EQUAL (files, last_files);
+        delete testDict;
+    }
 
-            if (dict->hasWord (word) == FALSE)
-            {
-                DBG (printf ("[%d] Word(%s) is not in dict. adding it\n",
-                             tid, *it));
-                dict->insertWord (word, INITIAL_COUNT);
-            }
-            else
-            {
-                DBG (printf ("[%d] Word(%s) IS in dict. incrementing it\n",
-                             tid, *it));
-                dict->incrementWordCount (word);
-            }
-            free (*it);
-        }                       /* end for */
-        DBG (printf
-             ("[%d] Processed %d bytes this loop\n", tid, processed_bytes));
+    void fileProcessUring (void)
+    {
+        static const char DATA[] =
+            "alpha be gamma-delta epsilon, z  Alpha;BE zeta12345 alphabet "
+            "ALPHA\nbe be epsilon.gamma z alpha endword";
+        static const int NUM_FILES = 3;
+        int tid = 1;            /* Fake thread id */
+        Word_Dict *testDict = new Word_Dict (4, TRUE);
+        Work_Queue *queue = new Work_Queue ();
+        char paths[NUM_FILES][32];
+        FILE *file = NULL;
+        int idx = 0;
+        uint64_t calls = 0;
+        uint64_t bytes = 0;
+        uint64_t last_bytes = 0;
+        Bool_t ran = FALSE;
 
         /*
-         * If we didn't process all of it, then only count what we did process
+         * Real files, io_uring doesn't go through the mocks.  More files
+         * than slots, and one that can't be opened.
          */
-        if (processed_bytes < bytes)
+        for (idx = 0; idx < NUM_FILES; idx++)
         {
-            total_bytes += processed_bytes;
-            leftover_bytes = bytes - processed_bytes;
-            if (already_rewound == FALSE)
-            {
-                lseek (fIn, total_bytes, SEEK_SET);
-                already_rewound = TRUE;
-            }
+            strcpy (paths[idx], "/tmp/ssfi_uring_XXXXXX");
+            file = fdopen (mkstemp (paths[idx]), "w");
+            TEST_ASSERT_NOT_NULL (file);
+            TEST_ASSERT_EQUAL (fwrite (DATA, 1, strlen (DATA), file),
+                               strlen (DATA));
+            fclose (file);
+            queue->push (paths[idx]);
         }
-        else
+        queue->push ("/nonexistent/ssfi");
+        queue->push ("EXIT");
+        queue->push ("not/reached");
+
+        processReadStats (&calls, &last_bytes);
+        ran = processFilesUring (tid, queue, testDict, PROCESS_FLUSH_BYTES,
+                                 NULL, 16, PROCESS_IO_NORMAL, 0, 2);
+        for (idx = 0; idx < NUM_FILES; idx++)
         {
-            total_bytes += bytes;
+            unlink (paths[idx]);
         }
+        if (ran == FALSE)
+        {
+            TEST_ASSERT_EQUAL (queue->size (), NUM_FILES + 3);
+            delete queue;
+            delete testDict;
+            TEST_IGNORE_MESSAGE ("io_uring is not available");
+        }
+
+        TEST_ASSERT_EQUAL (testDict->getWordCount ((char *) "alpha"),
+                           4 * NUM_FILES);
+        TEST_ASSERT_EQUAL (testDict->getWordCount ((char *) "zeta12345"),
+                           NUM_FILES);
+        TEST_ASSERT_EQUAL (testDict->getWordCount ((char *) "endword"),
+                           NUM_FILES);
+        TEST_ASSERT_EQUAL (testDict->size (), 9);
+        processReadStats (&calls, &bytes);
+        TEST_ASSERT_EQUAL (bytes - last_bytes, NUM_FILES * strlen (DATA));
+
+        /* Stopped at the "EXIT" */
+        TEST_ASSERT_EQUAL (queue->size (), 1);
+        delete queue;
+        delete testDict;
     }
-    /*
-     * Process anything left in the buffer, at end of file 
+
+    void fileProcessIoPolicy (void)
+    {
+        static const int MAX_LEN = 300;
+        static const int NUM_REPEATS = 2;
+        static const size_t READ_SIZES[] = { 1000, 8192, 3 * 4096 + 5 };
+        int tid = 1;            /* Fake thread id */
+        string fakeFilePath = "/usr/local";
+        Word_Dict *testDict = NULL;
+        Process_Io_Policy_t io_policy = PROCESS_IO_NORMAL;
+        char *fileData = (char *) malloc (NUM_REPEATS * MAX_LEN *
+                                          (MAX_LEN + 3));
+        char word[MAX_LEN];
+        size_t data_len = 0;
+        size_t size_idx = 0;
+        int rep = 0;
+        int len = 0;
+        int policy = 0;
+        uint64_t calls = 0;
+        uint64_t bytes = 0;
+        uint64_t last_bytes = 0;
+
+        TEST_ASSERT_TRUE (parseIoPolicy ("dontneed", &io_policy) == TRUE);
+        TEST_ASSERT_EQUAL (io_policy, PROCESS_IO_DONTNEED);
+        TEST_ASSERT_TRUE (parseIoPolicy ("bogus", &io_policy) == FALSE);
+        TEST_ASSERT_EQUAL_STRING (processIoPolicyName (PROCESS_IO_DIRECT),
+                                  "direct");
+
+        /*
+         * One word of every length up to MAX_LEN, so words straddle the
+         * aligned O_DIRECT reads at every offset
+         */
+        TEST_ASSERT_NOT_NULL (fileData);
+        for (rep = 0; rep < NUM_REPEATS; rep++)
+        {
+            for (len = 1; len <= MAX_LEN; len++)
+            {
+                memset (&fileData[data_len], 'a' + (len % 26), len);
+                data_len += len;
+                fileData[data_len++] = (len % 3 == 0) ? '\n' : ' ';
+                fileData[data_len++] = ',';
+            }
+        }
+
+        for (policy = PROCESS_IO_NORMAL; policy <= PROCESS_IO_DIRECT;
+             policy++)
+        {
+            for (size_idx = 0;
+                 size_idx < sizeof (READ_SIZES) / sizeof (READ_SIZES[0]);
+                 size_idx++)
+            {
+                testDict = new Word_Dict (4, TRUE);
+                processReadStats (&calls, &last_bytes);
+                mock_set_file_data (fileData, data_len);
+                processFile (tid, fakeFilePath, testDict, PROCESS_FLUSH_BYTES,
+                             NULL, READ_SIZES[size_idx], PROCESS_READ_SYSCALL,
+                             (Process_Io_Policy_t) policy);
+
+                TEST_ASSERT_EQUAL (testDict->size (), MAX_LEN);
+                for (len = 1; len <= MAX_LEN; len++)
+                {
+                    memset (word, 'a' + (len % 26), len);
+                    TEST_ASSERT_EQUAL (testDict->getWordCount (word, len),
+                                       NUM_REPEATS);
+                }
+                processReadStats (&calls, &bytes);
+                TEST_ASSERT_EQUAL (bytes - last_bytes, data_len);
+                delete testDict;
+            }
+        }
+        free (fileData);
+    }
+
+    void fileProcessChunks (void)
+    {
+        static const char DATA[] =
+            "alpha be gamma-delta epsilon, z  alpha;be zeta12345 alphabet "
+            "alpha\nbe be epsilon.gamma z alpha  ..  endword";
+        static const size_t CHUNK_SIZES[] = { 1, 2, 3, 5, 8, 13, 64 };
+        int tid = 1;            /* Fake thread id */
+        size_t data_len = strlen (DATA);
+        Word_Dict *wholeDict = new Word_Dict (4, TRUE);
+        Word_Dict *chunkDict = NULL;
+        Work_Queue *queue = new Work_Queue ();
+        vector < Token_Span_t > spans;
+        Work_Item_t item;
+        char path[32];
+        FILE *file = NULL;
+        size_t size_idx = 0;
+        size_t offset = 0;
+        size_t length = 0;
+        size_t idx = 0;
+
+        mock_set_file_data ((char *) DATA, data_len);
+        processFile (tid, "whole", wholeDict, PROCESS_FLUSH_BYTES, NULL, 16);
+        TEST_ASSERT_EQUAL (wholeDict->size (), 9);
+        (void) tokenizeBuffer (DATA, data_len, spans, TRUE);
+
+        /*
+         * Chunks ending inside words, between them, and right before one
+         */
+        for (size_idx = 0;
+             size_idx < sizeof (CHUNK_SIZES) / sizeof (CHUNK_SIZES[0]);
+             size_idx++)
+        {
+            chunkDict = new Word_Dict (4, TRUE);
+            for (offset = 0; offset < data_len;
+                 offset += CHUNK_SIZES[size_idx])
+            {
+                length = ((data_len - offset) < CHUNK_SIZES[size_idx]) ?
+                    (data_len - offset) : CHUNK_SIZES[size_idx];
+                mock_set_file_data ((char *) DATA, data_len);
+                processFile (tid, "chunk", chunkDict, PROCESS_FLUSH_BYTES,
+                             NULL, 16, PROCESS_READ_SYSCALL,
+                             PROCESS_IO_NORMAL, offset, length);
+            }
+            TEST_ASSERT_EQUAL (chunkDict->size (), wholeDict->size ());
+            for (idx = 0; idx < spans.size (); idx++)
+            {
+                TEST_ASSERT_EQUAL (chunkDict->getWordCount
+                                   (&DATA[spans[idx].offset],
+                                    spans[idx].len),
+                                   wholeDict->getWordCount
+                                   (&DATA[spans[idx].offset],
+                                    spans[idx].len));
+            }
+            delete chunkDict;
+        }
+
+        /*
+         * A real file, split into aligned chunks, the rest queued in order
+         */
+        strcpy (path, "/tmp/ssfi_chunk_XXXXXX");
+        file = fdopen (mkstemp (path), "w");
+        TEST_ASSERT_NOT_NULL (file);
+        for (idx = 0; idx < 2 * PROCESS_READ_ALIGN + 100; idx++)
+        {
+            fputc ('a', file);
+        }
+        fclose (file);
+        item.path = path;
+        item.offset = 0;
+        item.length = 0;
+        TEST_ASSERT_EQUAL (processSplitItem (queue, item, 0), 1);
+        TEST_ASSERT_EQUAL (processSplitItem (queue, item, 100), 3);
+        unlink (path);
+        TEST_ASSERT_EQUAL (item.offset, 0);
+        TEST_ASSERT_EQUAL (item.length, PROCESS_READ_ALIGN);
+        item = queue->popItem ();
+        TEST_ASSERT_EQUAL (item.offset, PROCESS_READ_ALIGN);
+        TEST_ASSERT_EQUAL (item.length, PROCESS_READ_ALIGN);
+        item = queue->popItem ();
+        TEST_ASSERT_EQUAL (item.offset, 2 * PROCESS_READ_ALIGN);
+        TEST_ASSERT_EQUAL (item.length, 100);
+        TEST_ASSERT_TRUE (queue->empty () == TRUE);
+        /* A chunk isn't split again */
+        TEST_ASSERT_EQUAL (processSplitItem (queue, item, 100), 1);
+        delete queue;
+        delete wholeDict;
+    }
+
+    void fileProcessChunkDistinct (void)
+    {
+        static const int NUM_WORDS = 2000;
+        int tid = 1;            /* Fake thread id */
+        Hyper_Log_Log *wholeDistinct = new Hyper_Log_Log ();
+        Hyper_Log_Log *runDistinct = new Hyper_Log_Log ();
+        Work_Queue *queue = new Work_Queue ();
+        string data;
+        Work_Item_t item;
+        char path[32];
+        char line[128];
+        char expected[64];
+        FILE *file = NULL;
+        FILE *output = NULL;
+        int saved_stdout = -1;
+        int num_lines = 0;
+        int idx = 0;
+
+        for (idx = 0; idx < NUM_WORDS; idx++)
+        {
+            sprintf (line, "w%d x ", idx);
+            data += line;
+        }
+        strcpy (path, "/tmp/ssfi_chunk_XXXXXX");
+        file = fdopen (mkstemp (path), "w");
+        TEST_ASSERT_NOT_NULL (file);
+        fwrite (data.data (), 1, data.size (), file);
+        fclose (file);
+
+        /*
+         * The whole file's estimate
+         */
+        mock_set_file_data ((char *) data.data (), data.size ());
+        processFile (tid, path, NULL, PROCESS_FLUSH_BYTES, wholeDistinct);
+        sprintf (expected, "%s: ~%.0f distinct words\n", path,
+                 wholeDistinct->estimate ());
+
+        /*
+         * Split into page sized chunks, each counted with what it prints
+         * caught, only the last one prints, for the whole file
+         */
+        output = tmpfile ();
+        TEST_ASSERT_NOT_NULL (output);
+        fflush (stdout);
+        saved_stdout = dup (STDOUT_FILENO);
+        dup2 (fileno (output), STDOUT_FILENO);
+        item.path = path;
+        item.offset = 0;
+        item.length = 0;
+        num_lines = (int) processSplitItem (queue, item, PROCESS_READ_ALIGN);
+        while (queue->empty () == FALSE)
+        {
+            mock_set_file_data ((char *) data.data (), data.size ());
+            processFile (tid, path, NULL, PROCESS_FLUSH_BYTES, runDistinct,
+                         PROCESS_READ_BYTES, PROCESS_READ_SYSCALL,
+                         PROCESS_IO_NORMAL, item.offset, item.length);
+            item = queue->popItem ();
+        }
+        mock_set_file_data ((char *) data.data (), data.size ());
+        processFile (tid, path, NULL, PROCESS_FLUSH_BYTES, runDistinct,
+                     PROCESS_READ_BYTES, PROCESS_READ_SYSCALL,
+                     PROCESS_IO_NORMAL, item.offset, item.length);
+        fflush (stdout);
+        dup2 (saved_stdout, STDOUT_FILENO);
+        fclose (fdopen (saved_stdout, "w"));
+        unlink (path);
+        TEST_ASSERT_TRUE (num_lines > 2);
+
+        rewind (output);
+        num_lines = 0;
+        while (fgets (line, sizeof (line), output) != NULL)
+        {
+            num_lines++;
+            TEST_ASSERT_NOT_NULL (strstr (line, expected));
+        }
+        fclose (output);
+        TEST_ASSERT_EQUAL (num_lines, 1);
+        TEST_ASSERT_TRUE (runDistinct->estimate () ==
+                          wholeDistinct->estimate ());
+
+        delete queue;
+        delete runDistinct;
+        delete wholeDistinct;
+    }
+
+    void fileProcessUtf8 (void)
+    {
+        /* "Zürich naïve ZÜRICH, café—CAFÉ «zürich» straße Ωmega 中文 中文
+         * ΣΟΦΙΑ σοφια x" */
+        static const char DATA[] =
+            "Z\xc3\xbcrich na\xc3\xafve Z\xc3\x9cRICH, caf\xc3\xa9\xe2\x80"
+            "\x94" "CAF\xc3\x89 \xc2\xabz\xc3\xbcrich\xc2\xbb stra\xc3\x9f"
+            "e \xce\xa9mega \xe4\xb8\xad\xe6\x96\x87 \xe4\xb8\xad\xe6\x96"
+            "\x87 \xce\xa3\xce\x9f\xce\xa6\xce\x99\xce\x91 \xcf\x83\xce"
+            "\xbf\xcf\x86\xce\xb9\xce\xb1 x";
+        static const size_t READ_SIZES[] = { 16, 17, 1000 };
+        static const struct
+        {
+            const char *word;
+            int count;
+        } EXPECTED[] =
+        {
+            {"z\xc3\xbcrich", 3}, {"na\xc3\xafve", 1},
+            {"caf\xc3\xa9", 2}, {"stra\xc3\x9f" "e", 1},
+            {"\xcf\x89mega", 1}, {"\xe4\xb8\xad\xe6\x96\x87", 2},
+            {"\xcf\x83\xce\xbf\xcf\x86\xce\xb9\xce\xb1", 2}, {"x", 1}
+        };
+        static const size_t NUM_EXPECTED = sizeof (EXPECTED) /
+            sizeof (EXPECTED[0]);
+        int tid = 1;            /* Fake thread id */
+        size_t data_len = strlen (DATA);
+        Word_Dict *testDict = NULL;
+        size_t size_idx = 0;
+        size_t offset = 0;
+        size_t length = 0;
+        size_t idx = 0;
+
+        tokenizeSetUtf8 (TRUE);
+        TEST_ASSERT_TRUE (tokenizeUtf8 () == TRUE);
+
+        /*
+         * Whole, in reads cutting sequences, and in 5 byte chunks
+         */
+        for (size_idx = 0;
+             size_idx <= sizeof (READ_SIZES) / sizeof (READ_SIZES[0]);
+             size_idx++)
+        {
+            testDict = new Word_Dict (4, TRUE);
+            for (offset = 0; offset < data_len; offset += length)
+            {
+                length = (size_idx < sizeof (READ_SIZES) /
+                          sizeof (READ_SIZES[0])) ? 0 : 5;
+                mock_set_file_data ((char *) DATA, data_len);
+                processFile (tid, "utf8", testDict, PROCESS_FLUSH_BYTES,
+                             NULL, (length == 0) ? READ_SIZES[size_idx] : 16,
+                             PROCESS_READ_SYSCALL, PROCESS_IO_NORMAL, offset,
+                             (offset + length > data_len) ?
+                             data_len - offset : length);
+                if (length == 0)
+                {
+                    break;
+                }
+            }
+            TEST_ASSERT_EQUAL (testDict->size (), NUM_EXPECTED);
+            for (idx = 0; idx < NUM_EXPECTED; idx++)
+            {
+                TEST_ASSERT_EQUAL (testDict->getWordCount
+                                   (EXPECTED[idx].word,
+                                    strlen (EXPECTED[idx].word)),
+                                   EXPECTED[idx].count);
+            }
+            delete testDict;
+        }
+
+        tokenizeSetUtf8 (FALSE);
+    }
+}
+#endif /* defined(TEST) */
+
+/**
+ *******************************************************************************
+ * @brief isWordChar - Check if the given character is considered a "word" char.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      thisOne        Character code to check if it is a "word"
+ *                                     char.
+ *
+ * <!-- Returns -->
+ *      @return TRUE    If thisOne is a "word" character
+ *      @return FALSE   If thisOne is NOT a "word" character
+ *
+ * @par Pre/Post Conditions:
+ *      None (if entry/exit conditions do not apply)
+ *
+ * @par Global Data:
+ *      None (if no global data)
+ *
+ * @par Description:
+ *      Check if the character falls between a-z, A-Z, or 0-9.
+ *******************************************************************************
+ */
+Bool_t isWordChar (const char thisOne)
+{
+    if ((thisOne >= 'A' && thisOne <= 'Z') ||
+        (thisOne >= 'a' && thisOne <= 'z') ||
+        (thisOne >= '0' && thisOne <= '9'))
+    {
+        return TRUE;
+    }
+    else
+    {
+        return FALSE;
+    }
+}
+
+/**
+ *******************************************************************************
+ * @brief processFile - Take a file path, and parse the file for words putting
+ * them in the dictionary.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      tid            Integer thread index, only used in debug
+ *                                     output to track which thread is
+ *                                     performing what operation.
+ *      @param[in]      filePath       String file path to a ".txt" file
+ *      @param[in]      dict           Pointer to a Word_Dict which any words
+ *                                     processed will be kept.
+ *      @param[in]      flush_bytes    For a thread-safe 'dict', how many
+ *                                     bytes of the file to pre-aggregate
+ *                                     before flushing the counts to 'dict'.
+ *      @param[in,out]  distinct_words If not NULL, every word of the file is
+ *                                     also added to this distinct word
+ *                                     estimate, and the file's own estimate
+ *                                     is printed.
+ *      @param[in]      read_bytes     Size of the read buffer, at least
+ *                                     PROCESS_READ_MIN_BYTES.
+ *      @param[in]      read_mode      PROCESS_READ_MMAP to count a file
+ *                                     bigger than the read buffer straight
+ *                                     from a mapping of it, see _map_file().
+ *      @param[in]      io_policy      Page cache hints, or O_DIRECT, which
+ *                                     reads and doesn't map.
+ *      @param[in]      chunk_offset   File offset of the chunk to count
+ *      @param[in]      chunk_length   Bytes in the chunk, 0 for the whole
+ *                                     file, see processSplitItem()
+ *
+ * <!-- Returns -->
+ *      None (if return type is void)
+ *
+ * @par Pre/Post Conditions:
+ *      None (if entry/exit conditions do not apply)
+ *
+ * @par Global Data:
+ *      None (if no global data)
+ *
+ * @par Description:
+ *      Open the file specified by filePath, and read through it, searching for
+ *      words (based on "word char" qualification), and updating the dictionary
+ *      for each.  Updating consists of inserting if the word doesn't already
+ *      exist, and updating the count for that word if it does.
+ *
+ *      Words are first counted in a private table, which is merged into a
+ *      shared 'dict' every 'flush_bytes' and at the end of the file.  Text
+ *      repeats words heavily, so this is far fewer updates of the shared
+ *      dictionary than one per word.
+ *
+ *      With a NULL 'dict', words are only added to 'distinct_words', a cheap
+ *      pass to size a run before committing to an exact dictionary.
+ *
+ *      The read buffer and private table are counted in processBytesUsed(),
+ *      and 'dict' gets a checkMemoryLimit() every 'flush_bytes' and at the
+ *      end of the file.  Without a memory limit or verbose output, the table
+ *      isn't measured.
+ *
+ *      The file is read 'read_bytes' at a time into a page aligned buffer.
+ *      A word cut off by the end of a read is moved to the front of the
+ *      buffer and the next read goes in behind it, so every byte is read
+ *      once, with no seeking back.  A word that fills the whole buffer
+ *      doubles it, up to PROCESS_READ_MAX_BYTES, past which it is counted
+ *      as pieces of that size.
+ *
+ *      With PROCESS_READ_MMAP the buffer only takes the lowercased words of
+ *      each window of the mapping, and a file that can't be mapped is read.
+ *
+ *      A chunk counts the words that start in it, see _file_consume(), and
+ *      is always read.
+ *******************************************************************************
+ */
+void processFile (int tid, string filePath, Word_Dict * dict,
+                  size_t flush_bytes, Hyper_Log_Log * distinct_words,
+                  size_t read_bytes, Process_Read_Mode_t read_mode,
+                  Process_Io_Policy_t io_policy, uint64_t chunk_offset,
+                  uint64_t chunk_length)
+{
+    File_Read_t *fr = NULL;
+    ssize_t bytes = 0;
+    size_t mapped_bytes = 0;
+    Bool_t at_end = FALSE;
+    int fIn;
+
+    fIn = open (filePath.c_str (), _file_open_flags (io_policy));
+    if ((fIn == -1) && (errno == EINVAL) && (io_policy == PROCESS_IO_DIRECT))
+    {
+        /* No O_DIRECT on this filesystem, at least keep out of the cache */
+        io_policy = PROCESS_IO_DONTNEED;
+        fIn = open (filePath.c_str (), _file_open_flags (io_policy));
+    }
+    if (fIn == -1)
+    {
+        fprintf (stderr, "Failed to open file: %s, errno=%d,%s",
+                 filePath.c_str (), errno, strerror (errno));
+        return;
+    }
+
+    DBG (printf ("Processing file: %s\n", filePath.c_str ()));
+
+    fr = new File_Read_t;
+    fr->path = filePath;
+    fr->fd = fIn;
+    fr->chunk_start = (chunk_length > 0) ? chunk_offset : 0;
+    fr->chunk_end = (chunk_length > 0) ? chunk_offset + chunk_length : 0;
+    _file_begin (fr, tid, dict, flush_bytes, distinct_words, read_bytes,
+                 io_policy);
+    if ((fr->offset > 0) &&
+        (lseek (fIn, (off_t) fr->offset, SEEK_SET) == (off_t) -1))
+    {
+        fprintf (stderr, "[%s, %d:%s] Failed to seek %s, errno=%d,%s\n",
+                 __FILE__, __LINE__, __FUNCTION__, filePath.c_str (),
+                 errno, strerror (errno));
+        at_end = TRUE;
+    }
+
+    if ((at_end == FALSE) && (read_mode == PROCESS_READ_MMAP) &&
+        (io_policy != PROCESS_IO_DIRECT) && (fr->chunk_end == 0) &&
+        (_map_file (fr, &mapped_bytes) == TRUE))
+    {
+        /* Counted straight from the mapping, nothing to read */
+        at_end = TRUE;
+    }
+
+    while (at_end == FALSE)
+    {
+        /*
+         * Read in behind the partial word carried over from the last read
+         */
+        bytes = read (fIn, &fr->buffer[fr->read_pos], fr->read_len);
+        if ((bytes < 0) && (errno == EINTR))
+        {
+            continue;
+        }
+        if (bytes < 0)
+        {
+            fprintf (stderr, "[%s, %d:%s] Failed to read %s, errno=%d,%s\n",
+                     __FILE__, __LINE__, __FUNCTION__, filePath.c_str (),
+                     errno, strerror (errno));
+            bytes = 0;
+        }
+        at_end = _file_consume (fr, (size_t) bytes);
+    }
+
+    _file_end (fr, mapped_bytes);
+    delete fr;
+
+    return;
+}
+
+/**
+ *******************************************************************************
+ * @brief processFilesUring - processFile() every path a worker takes from a
+ * queue, keeping several files' opens and reads in flight through io_uring.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      tid            As processFile()
+ *      @param[in,out]  queue          Paths to count, until an "EXIT"
+ *      @param[in]      dict           As processFile()
+ *      @param[in]      flush_bytes    As processFile()
+ *      @param[in,out]  distinct_words As processFile()
+ *      @param[in]      read_bytes     As processFile(), per file in flight
+ *      @param[in]      io_policy      As processFile()
+ *      @param[in]      chunk_bytes    Files bigger than this are split into
+ *                                     chunks, see processSplitItem()
+ *      @param[in]      depth          Most files in flight at once
+ *
+ * <!-- Returns -->
+ *      @return TRUE    Once "EXIT" has been taken from the queue and every
+ *                      file taken before it counted
+ *      @return FALSE   If io_uring can't be used, nothing was taken from the
+ *                      queue, use processFile() instead
+ *
+ * @par Description:
+ *      Each file has a slot, with its own read buffer, and one operation in
+ *      flight at a time: its open, then each read in turn.  A completed read
+ *      is counted just as processFile() counts it, carry over and all, and
+ *      the file's next read queued behind it, while the other slots' reads
+ *      go on in the kernel.  So a worker tokenizes one file while waiting
+ *      on the others' I/O, where processFile() blocks in read().
+ *
+ *      The queue is only waited on when nothing is in flight, otherwise
+ *      free slots take whatever paths are already queued.  'dict' gets a
+ *      checkMemoryLimit() with the queue's memory after each file, as the
+ *      worker loop does around processFile().
+ *******************************************************************************
+ */
+Bool_t processFilesUring (int tid, Work_Queue * queue, Word_Dict * dict,
+                          size_t flush_bytes, Hyper_Log_Log * distinct_words,
+                          size_t read_bytes, Process_Io_Policy_t io_policy,
+                          uint64_t chunk_bytes, unsigned int depth)
+{
+    Uring_Reader ring (depth);
+    vector < File_Read_t * >slots;
+    File_Read_t *fr = NULL;
+    Work_Item_t item;
+    Bool_t exiting = FALSE;
+    uint64_t slot = 0;
+    size_t idx = 0;
+    int res = 0;
+    int ret = 0;
+
+    if (ring.isReady () == FALSE)
+    {
+        return (FALSE);
+    }
+    slots.resize (ring.entries (), (File_Read_t *) NULL);
+
+    while ((exiting == FALSE) || (ring.inFlight () > 0))
+    {
+        /*
+         * Open files into the free slots
+         */
+        for (idx = 0; (idx < slots.size ()) && (exiting == FALSE); idx++)
+        {
+            if (slots[idx] != NULL)
+            {
+                continue;
+            }
+            if (ring.inFlight () == 0)
+            {
+                item = queue->popItem ();
+            }
+            else if (queue->tryPopItem (item) == FALSE)
+            {
+                break;
+            }
+            if (item.path == "EXIT")
+            {
+                exiting = TRUE;
+                break;
+            }
+            (void) processSplitItem (queue, item, chunk_bytes);
+            DBG (printf ("[%d] Opening: %s\n", tid, item.path.c_str ()));
+            fr = new File_Read_t;
+            fr->path = item.path;
+            fr->fd = -1;
+            fr->chunk_start = (item.length > 0) ? item.offset : 0;
+            fr->chunk_end = (item.length > 0) ? item.offset + item.length : 0;
+            fr->buffer = NULL;
+            fr->io_policy = io_policy;
+            slots[idx] = fr;
+            (void) ring.prepOpen (fr->path.c_str (),
+                                  _file_open_flags (fr->io_policy), idx);
+        }
+        if (ring.inFlight () == 0)
+        {
+            continue;
+        }
+
+        ret = ring.submit (1);
+        if (ret < 0)
+        {
+            fprintf (stderr, "[%s, %d:%s] io_uring_enter failed, errno=%d,"
+                     "%s\n", __FILE__, __LINE__, __FUNCTION__, -ret,
+                     strerror (-ret));
+            exit (EXIT_FAILURE);
+        }
+        while (ring.nextCompletion (&slot, &res) == TRUE)
+        {
+            fr = slots[slot];
+            if ((res == -EINTR) || (res == -EAGAIN))
+            {
+                /* Try the same open or read again */
+            }
+            else if ((fr->fd == -1) && (res == -EINVAL) &&
+                     (fr->io_policy == PROCESS_IO_DIRECT))
+            {
+                /* No O_DIRECT on this filesystem, as processFile() */
+                fr->io_policy = PROCESS_IO_DONTNEED;
+            }
+            else if (fr->fd == -1)
+            {
+                if (res < 0)
+                {
+                    fprintf (stderr, "Failed to open file: %s, errno=%d,%s",
+                             fr->path.c_str (), -res, strerror (-res));
+                    delete fr;
+                    slots[slot] = NULL;
+                    continue;
+                }
+                fr->fd = res;
+                _file_begin (fr, tid, dict, flush_bytes, distinct_words,
+                             read_bytes, fr->io_policy);
+            }
+            else
+            {
+                if (res < 0)
+                {
+                    fprintf (stderr, "[%s, %d:%s] Failed to read %s, "
+                             "errno=%d,%s\n", __FILE__, __LINE__,
+                             __FUNCTION__, fr->path.c_str (), -res,
+                             strerror (-res));
+                    res = 0;
+                }
+                if (_file_consume (fr, (size_t) res) == TRUE)
+                {
+                    _file_end (fr, 0);
+                    delete fr;
+                    slots[slot] = NULL;
+                    if (dict != NULL)
+                    {
+                        (void) dict->checkMemoryLimit (queue->bytesUsed () +
+                                                       processBytesUsed ());
+                    }
+                    continue;
+                }
+            }
+
+            if (fr->buffer == NULL)
+            {
+                (void) ring.prepOpen (fr->path.c_str (),
+                                      _file_open_flags (fr->io_policy), slot);
+            }
+            else
+            {
+                (void) ring.prepRead (fr->fd, &fr->buffer[fr->read_pos],
+                                      (unsigned int) fr->read_len,
+                                      fr->offset, slot);
+            }
+        }
+    }
+
+    return (TRUE);
+}
+
+/**
+ *******************************************************************************
+ * @brief processSplitItem - Split a whole file bigger than 'chunk_bytes' into
+ * chunks, so several workers can count it at once.
+ *
+ * <!-- Parameters -->
+ *      @param[in,out]  queue          Where the chunks after the first go
+ *      @param[in,out]  item           Item taken from 'queue', becomes the
+ *                                     first chunk if the file is split
+ *      @param[in]      chunk_bytes    Most bytes in a chunk, rounded up to
+ *                                     PROCESS_READ_ALIGN, 0 never splits
+ *
+ * <!-- Returns -->
+ *      @return Chunks the file was split into, 1 if it wasn't
+ *
+ * @par Description:
+ *      Done by the worker that takes the file rather than by listdir(), which
+ *      doesn't stat() anything.  The other chunks go on the front of the
+ *      queue, in order, ahead of the "EXIT"s, for the idle workers to take
+ *      while this one counts the first.  Chunks are aligned, so O_DIRECT can
+ *      read them, and are counted by processFile() or processFilesUring() as
+ *      they are, exactly as the whole file would be.
+ *
+ *      The file is noted as split until its last chunk is counted, so with
+ *      --hll the chunks' estimates make one estimate of the file.
+ *******************************************************************************
+ */
+unsigned int processSplitItem (Work_Queue * queue, Work_Item_t & item,
+                               uint64_t chunk_bytes)
+{
+    struct stat st;
+    Work_Item_t chunk;
+    uint64_t file_size = 0;
+    unsigned int num_chunks = 0;
+    unsigned int idx = 0;
+
+    if ((chunk_bytes == 0) || (item.length != 0) || (item.path == "EXIT"))
+    {
+        return (1);
+    }
+    chunk_bytes = (chunk_bytes + PROCESS_READ_ALIGN - 1) /
+        PROCESS_READ_ALIGN * PROCESS_READ_ALIGN;
+    if ((stat (item.path.c_str (), &st) != 0) || (S_ISREG (st.st_mode) == 0) ||
+        ((uint64_t) st.st_size <= chunk_bytes))
+    {
+        return (1);
+    }
+
+    file_size = (uint64_t) st.st_size;
+    num_chunks = (unsigned int) ((file_size + chunk_bytes - 1) / chunk_bytes);
+    chunk.path = item.path;
+    for (idx = num_chunks - 1; idx > 0; idx--)
+    {
+        chunk.offset = idx * chunk_bytes;
+        chunk.length = ((file_size - chunk.offset) < chunk_bytes) ?
+            (file_size - chunk.offset) : chunk_bytes;
+        queue->pushFront (chunk);
+    }
+    item.offset = 0;
+    item.length = chunk_bytes;
+
+    (void) pthread_mutex_lock (&g_splitMutex);
+    g_splitFiles[item.path].chunks_left += num_chunks;
+    (void) pthread_mutex_unlock (&g_splitMutex);
+    return (num_chunks);
+}
+
+/**
+ *******************************************************************************
+ * @brief processBytesUsed - Memory held right now by every processFile() in
+ * progress, read buffers and private pre-aggregation tables.
+ *
+ * @par Description:
+ *      The private tables are only measured when the dictionary has a memory
+ *      limit, or with verbose output, otherwise only the buffers are here.
+ *******************************************************************************
+ */
+size_t processBytesUsed (void)
+{
+    size_t bytes = 0;
+
+    (void) pthread_mutex_lock (&g_memMutex);
+    bytes = g_bufferBytes;
+    (void) pthread_mutex_unlock (&g_memMutex);
+    return (bytes);
+}
+
+/**
+ *******************************************************************************
+ * @brief processPeakBytes - Most memory processBytesUsed() has reported.
+ *******************************************************************************
+ */
+size_t processPeakBytes (void)
+{
+    size_t bytes = 0;
+
+    (void) pthread_mutex_lock (&g_memMutex);
+    bytes = g_bufferPeak;
+    (void) pthread_mutex_unlock (&g_memMutex);
+    return (bytes);
+}
+
+/**
+ *******************************************************************************
+ * @brief processReadStats - read() calls every processFile() has made so far,
+ * and the file bytes they returned.
+ *******************************************************************************
+ */
+void processReadStats (uint64_t * calls, uint64_t * bytes)
+{
+    (void) pthread_mutex_lock (&g_memMutex);
+    *calls = g_readCalls;
+    *bytes = g_readBytes;
+    (void) pthread_mutex_unlock (&g_memMutex);
+}
+
+/**
+ *******************************************************************************
+ * @brief processMapStats - Files every processFile() has counted from a
+ * mapping (PROCESS_READ_MMAP) so far, and their bytes.
+ *******************************************************************************
+ */
+void processMapStats (uint64_t * files, uint64_t * bytes)
+{
+    (void) pthread_mutex_lock (&g_memMutex);
+    *files = g_mappedFiles;
+    *bytes = g_mappedBytes;
+    (void) pthread_mutex_unlock (&g_memMutex);
+}
+
+/**
+ *******************************************************************************
+ * @brief tokenizeSetUtf8 - Count UTF-8 words, Unicode letters, marks and
+ * digits, simple case folded, rather than ASCII letters and digits alone.
+ *
+ * @par Description:
+ *      Set once, before any file is counted, it is read without a lock.
+ *      The edges of buffers and chunks are then drawn at ASCII bytes that
+ *      aren't word characters, so a sequence is never cut.
+ *******************************************************************************
+ */
+void tokenizeSetUtf8 (Bool_t utf8)
+{
+    g_utf8Words = utf8;
+}
+
+/**
+ *******************************************************************************
+ * @brief tokenizeUtf8 - TRUE if words are UTF-8, see tokenizeSetUtf8().
+ *******************************************************************************
+ */
+Bool_t tokenizeUtf8 (void)
+{
+    return (g_utf8Words);
+}
+
+/**
+ *******************************************************************************
+ * @brief processActiveSeconds - Time from the first processFile() beginning
+ * a file to the last one finishing, 0.0 if none has.
+ *******************************************************************************
+ */
+double processActiveSeconds (void)
+{
+    double seconds = 0.0;
+
+    (void) pthread_mutex_lock (&g_memMutex);
+    if (g_activeStart.tv_sec != 0)
+    {
+        seconds = (double) (g_activeEnd.tv_sec - g_activeStart.tv_sec) +
+            (double) (g_activeEnd.tv_nsec - g_activeStart.tv_nsec) / 1e9;
+    }
+    (void) pthread_mutex_unlock (&g_memMutex);
+    return (seconds);
+}
+
+/**
+ *******************************************************************************
+ * @brief processIoPolicyName - Name of an I/O policy, as --io-policy takes it.
+ *******************************************************************************
+ */
+const char *processIoPolicyName (Process_Io_Policy_t io_policy)
+{
+    switch (io_policy)
+    {
+    case PROCESS_IO_NORMAL:
+        return ("normal");
+    case PROCESS_IO_SEQUENTIAL:
+        return ("sequential");
+    case PROCESS_IO_NOREUSE:
+        return ("noreuse");
+    case PROCESS_IO_DONTNEED:
+        return ("dontneed");
+    case PROCESS_IO_DIRECT:
+        return ("direct");
+    default:
+        return ("unknown");
+    }
+}
+
+/**
+ *******************************************************************************
+ * @brief parseIoPolicy - Look up an I/O policy by its name.
+ *
+ * <!-- Returns -->
+ *      @return TRUE    If 'name' is a policy, set in 'io_policy'
+ *      @return FALSE   If not, 'io_policy' is left alone
+ *******************************************************************************
+ */
+Bool_t parseIoPolicy (const char *name, Process_Io_Policy_t * io_policy)
+{
+    int idx = 0;
+
+    for (idx = PROCESS_IO_NORMAL; idx <= PROCESS_IO_DIRECT; idx++)
+    {
+        if (strcmp (name, processIoPolicyName ((Process_Io_Policy_t) idx)) ==
+            0)
+        {
+            *io_policy = (Process_Io_Policy_t) idx;
+            return (TRUE);
+        }
+    }
+    return (FALSE);
+}
+
+/**
+ *******************************************************************************
+ * @brief tokenizeBuffer - Find every word in a buffer, as spans of the buffer,
+ * without copying or allocating anything.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      buffer         Pointer to the buffer read from file to
+ *                                     process.
+ *      @param[in]      buffer_sz      Size of 'buffer' in characters
+ *      @param[out]     spans          Replaced with the words found, in
+ *                                     buffer order.  Its capacity is kept, so
+ *                                     a vector reused from buffer to buffer
+ *                                     stops allocating once it has grown to
+ *                                     the most words in a buffer.
+ *      @param[in]      at_end         TRUE if nothing follows the buffer, so
+ *                                     a word running to its end is complete.
+ *
+ * <!-- Returns -->
+ *      @return count of bytes processed from the buffer.
+ *
+ * @par Pre/Post Conditions:
+ *      None (if entry/exit conditions do not apply)
+ *
+ * @par Global Data:
+ *      None (if no global data)
+ *
+ * @par Description:
+ *      Unless 'at_end', a word running to the end of the buffer may carry on
+ *      in the next read, so it is left out, and the count returned stops at
+ *      the non-word character in front of it.  A buffer which is all one
+ *      word is returned whole, as there is nothing to stop in front of.
+ *
+ * @par Algorithm:
+ *      The buffer is classified WORD_SCAN_BLOCK bytes at a time into a
+ *      bitmask of word characters, by the fastest SIMD kernel the CPU has
+ *      (see wordScanFunction()).  XOR of the mask with itself shifted up one
+ *      byte, the previous block's top bit shifted in, leaves a bit on every
+ *      word start and every word end.  Those are taken lowest first with a
+ *      count of trailing zeros and cleared with mask & (mask - 1), so the
+ *      cost is per word, not per byte.
+ *******************************************************************************
+ */
+size_t tokenizeBuffer (const char *buffer, size_t buffer_sz,
+                       vector < Token_Span_t > &spans, Bool_t at_end)
+{
+    return (_tokenize (buffer, buffer_sz, spans, at_end, NULL));
+}
+
+/**
+ *******************************************************************************
+ * @brief tokenizeFoldHash - tokenizeBuffer(), also lowercasing each word in
+ * place and setting its span's hash.
+ *
+ * @par Description:
+ *      Each word is folded and hashed as soon as its end is found, while its
+ *      bytes are still in cache from the word scan, rather than in a pass of
+ *      its own.  The hash is wordHash() of the folded word, ready to hand to
+ *      the dictionary.
+ *******************************************************************************
+ */
+size_t tokenizeFoldHash (char *buffer, size_t buffer_sz,
+                         vector < Token_Span_t > &spans, Bool_t at_end)
+{
+    return (_tokenize (buffer, buffer_sz, spans, at_end, buffer));
+}
+
+/**
+ *******************************************************************************
+ * @brief tokenizeFoldHashTo - tokenizeFoldHash() of a buffer which can't be
+ * written, such as a read-only file mapping.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      buffer         Buffer to find the words in
+ *      @param[in]      buffer_sz      Size of 'buffer' in characters
+ *      @param[out]     fold           At least 'buffer_sz' bytes, each word
+ *                                     is written here lowercased, at its
+ *                                     offset in 'buffer'.  Bytes between the
+ *                                     words are left as they were.
+ *      @param[out]     spans          As tokenizeBuffer(), with the hashes
+ *      @param[in]      at_end         As tokenizeBuffer()
+ *
+ * <!-- Returns -->
+ *      @return count of bytes processed from the buffer.
+ *******************************************************************************
+ */
+size_t tokenizeFoldHashTo (const char *buffer, size_t buffer_sz, char *fold,
+                           vector < Token_Span_t > &spans, Bool_t at_end)
+{
+    return (_tokenize (buffer, buffer_sz, spans, at_end, fold));
+}
+
+/**
+ *******************************************************************************
+ * @brief processBufferForWords - Take a buffer of data read from the file and
+ * parse for words.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      buffer         Pointer to the buffer read from file to
+ *                                     process.
+ *      @param[in]      buffer_sz      Size of 'buffer' in characters
+ *      @param[in]      word           Pointer to location in which to put the
+ *                                     word found.
+ *
+ * <!-- Returns -->
+ *      @return number of bytes processed.
+ *
+ * @par Pre/Post Conditions:
+ *      None (if entry/exit conditions do not apply)
+ *
+ * @par Global Data:
+ *      None (if no global data)
+ *
+ * @par Description:
+ *      Finds the first "run" of word characters, and returns it to the caller
+ *      by setting 'word' to point to a calloc()'d copy, which the caller
+ *      frees.  The bytes processed stop just past the word.  Kept for the
+ *      unit tests, file processing uses tokenizeBuffer().
+ *******************************************************************************
+ */
+int processBufferForWords (char *buffer, int buffer_sz, char **word)
+{
+    vector < Token_Span_t > spans;
+    char *tmp_word = NULL;
+
+    if (word == NULL)
+    {
+        return (0);
+    }
+    *word = NULL;
+    (void) tokenizeBuffer (buffer, (size_t) buffer_sz, spans, TRUE);
+    if (spans.empty ())
+    {
+        return (buffer_sz);
+    }
+    tmp_word = (char *) calloc (spans[0].len + 1, sizeof (char));
+    if (tmp_word != NULL)
+    {
+        memcpy (tmp_word, &buffer[spans[0].offset], spans[0].len);
+        *word = tmp_word;
+    }
+
+    return ((int) (spans[0].offset + spans[0].len));
+}
+
+/**
+ *******************************************************************************
+ * @brief processWholeBuffer - Process a whole buffer's worth of data for all of
+ * the words contained therein.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      buffer         Pointer to the buffer read from file to
+ *                                     process.
+ *      @param[in]      buffer_sz      Size of 'buffer' in characters
+ *      @param[in]      word_list      Reference to a stl::list in which to
+ *                                     insert all words found in the buffer.
+ *
+ * <!-- Returns -->
+ *      @return count of bytes processed from the buffer.
+ *
+ * @par Pre/Post Conditions:
+ *      None (if entry/exit conditions do not apply)
+ *
+ * @par Global Data:
+ *      None (if no global data)
+ *
+ * @par Description:
+ *      tokenizeBuffer(), with each word calloc()'d into 'word_list' for the
+ *      caller to free.  Kept for the unit tests.
+ *******************************************************************************
+ */
+int processWholeBuffer (char *buffer, int buffer_sz, list < char *>&word_list)
+{
+    vector < Token_Span_t > spans;
+    char *word_found = NULL;
+    size_t processed = 0;
+    size_t idx = 0;
+
+    DBG (printf ("Buffer size: %d\n", buffer_sz));
+    processed = tokenizeBuffer (buffer, (size_t) buffer_sz, spans);
+    for (idx = 0; idx < spans.size (); idx++)
+    {
+        word_found = (char *) calloc (spans[idx].len + 1, sizeof (char));
+        if (word_found != NULL)
+        {
+            memcpy (word_found, &buffer[spans[idx].offset], spans[idx].len);
+            DBG (printf ("---->Found word: %s\n", word_found));
+            word_list.push_back (word_found);
+        }
+    }
+
+    return ((int) processed);
+}
+
+/**
+ *******************************************************************************
+ * @brief _tokenize - tokenizeBuffer(), and with 'fold' (the buffer itself, or
+ * a buffer as big) tokenizeFoldHash().
+ *
+ * @par Description:
+ *      UTF-8 words take their blocks' masks from utf8ScanBlock().  A word
+ *      is only UTF-8 folded if it starts before the end of the last block
+ *      that had bytes above ASCII, the others take the ASCII fold alone.
+ *******************************************************************************
+ */
+static size_t _tokenize (const char *buffer, size_t buffer_sz,
+                         vector < Token_Span_t > &spans, Bool_t at_end,
+                         char *fold)
+{
+    Word_Scan_Fn_t scan = wordScanFunction ();
+    Token_Span_t span;
+    Utf8_Scan_t utf8;
+    Bool_t in_word = FALSE;
+    uint64_t mask = 0;
+    uint64_t edges = 0;
+    uint64_t carry = 0;
+    size_t non_ascii_end = 0;
+    size_t base = 0;
+    size_t pos = 0;
+    size_t end = buffer_sz;
+    size_t idx = 0;
+
+    memset (&utf8, 0, sizeof (utf8));
+
+    spans.clear ();
+    if ((at_end == FALSE) && (buffer_sz > 0) &&
+        (_is_run_byte (buffer[buffer_sz - 1]) == TRUE))
+    {
+        for (idx = buffer_sz; idx > 0; idx--)
+        {
+            if (_is_run_byte (buffer[idx - 1]) == FALSE)
+            {
+                end = idx - 1;
+                break;
+            }
+        }
+    }
+
+    span.offset = 0;
+    span.hash = 0;
+    for (base = 0; base < end; base += WORD_SCAN_BLOCK)
+    {
+        if (g_utf8Words == TRUE)
+        {
+            mask = utf8ScanBlock (&buffer[base], (end - base >=
+                                                  WORD_SCAN_BLOCK) ?
+                                  WORD_SCAN_BLOCK : end - base, end - base,
+                                  scan, &utf8);
+            if (utf8.non_ascii == TRUE)
+            {
+                non_ascii_end = base + WORD_SCAN_BLOCK;
+            }
+        }
+        else
+        {
+            mask = (end - base >= WORD_SCAN_BLOCK) ? scan (&buffer[base]) :
+                wordScanTail (&buffer[base], end - base);
+        }
+        edges = mask ^ ((mask << 1) | carry);
+        carry = mask >> (WORD_SCAN_BLOCK - 1);
+        while (edges != 0)
+        {
+            pos = base + (size_t) __builtin_ctzll (edges);
+            edges &= edges - 1;
+            if (in_word == FALSE)
+            {
+                span.offset = pos;
+                in_word = TRUE;
+            }
+            else
+            {
+                span.len = pos - span.offset;
+                if ((fold != NULL) && (span.offset < non_ascii_end))
+                {
+                    utf8FoldWord (&buffer[span.offset], &fold[span.offset],
+                                  span.len);
+                    span.hash = _fold_and_hash (&fold[span.offset],
+                                                &fold[span.offset],
+                                                span.len);
+                }
+                else if (fold != NULL)
+                {
+                    span.hash = _fold_and_hash (&buffer[span.offset],
+                                                &fold[span.offset],
+                                                span.len);
+                }
+                spans.push_back (span);
+                in_word = FALSE;
+            }
+        }
+    }
+    /* A word running right up to 'end' has no edge after it */
+    if (in_word == TRUE)
+    {
+        span.len = end - span.offset;
+        if ((fold != NULL) && (span.offset < non_ascii_end))
+        {
+            utf8FoldWord (&buffer[span.offset], &fold[span.offset],
+                          span.len);
+            span.hash = _fold_and_hash (&fold[span.offset],
+                                        &fold[span.offset], span.len);
+        }
+        else if (fold != NULL)
+        {
+            span.hash = _fold_and_hash (&buffer[span.offset],
+                                        &fold[span.offset], span.len);
+        }
+        spans.push_back (span);
+    }
+
+    return (end);
+}
+
+/**
+ *******************************************************************************
+ * @brief _fold_and_hash - Lowercase a word through g_foldTable into 'fold',
+ * which may be the word itself, and return its wordHash(), in one pass.
+ *
+ * @par Description:
+ *      Each 8 bytes are folded into a register, laid out as a memcpy() load
+ *      would be, then stored back with one write and mixed into the hash
+ *      (see wordHashBlock()).  Storing the bytes one by one and loading them
+ *      back would stall on store forwarding.
+ *******************************************************************************
+ */
+static inline Word_Hash_t _fold_and_hash (const char *word, char *fold,
+                                          size_t len)
+{
+    const unsigned char *bytes = (const unsigned char *) word;
+    uint64_t hash = WORD_HASH_SEED;
+    uint64_t block = 0;
+    size_t idx = 0;
+
+    for (idx = 0; idx + 8 <= len; idx += 8)
+    {
+        block = ((uint64_t) g_foldTable[bytes[idx]] << BLOCK_BYTE_SHIFT (0)) |
+            ((uint64_t) g_foldTable[bytes[idx + 1]] << BLOCK_BYTE_SHIFT (1)) |
+            ((uint64_t) g_foldTable[bytes[idx + 2]] << BLOCK_BYTE_SHIFT (2)) |
+            ((uint64_t) g_foldTable[bytes[idx + 3]] << BLOCK_BYTE_SHIFT (3)) |
+            ((uint64_t) g_foldTable[bytes[idx + 4]] << BLOCK_BYTE_SHIFT (4)) |
+            ((uint64_t) g_foldTable[bytes[idx + 5]] << BLOCK_BYTE_SHIFT (5)) |
+            ((uint64_t) g_foldTable[bytes[idx + 6]] << BLOCK_BYTE_SHIFT (6)) |
+            ((uint64_t) g_foldTable[bytes[idx + 7]] << BLOCK_BYTE_SHIFT (7));
+        memcpy (fold + idx, &block, 8);
+        hash = wordHashBlock (hash, block);
+    }
+    if (idx < len)
+    {
+        /* Fold and place the last 1-7 bytes, last first, falling through */
+        block = 0;
+        switch (len - idx)
+        {
+        case 7:
+            FOLD_TAIL_BYTE (6);
+        case 6:
+            FOLD_TAIL_BYTE (5);
+        case 5:
+            FOLD_TAIL_BYTE (4);
+        case 4:
+            FOLD_TAIL_BYTE (3);
+        case 3:
+            FOLD_TAIL_BYTE (2);
+        case 2:
+            FOLD_TAIL_BYTE (1);
+        default:
+            FOLD_TAIL_BYTE (0);
+        }
+        hash = wordHashBlock (hash, block);
+    }
+
+    return (wordHashFinish (hash, len));
+}
+
+/**
+ *******************************************************************************
+ * @brief int_compare - comparitor used by vector sort operation.
+ *******************************************************************************
+ */
+static bool int_compare (int i, int j)
+{
+    return (i < j);
+}
+
+/**
+ *******************************************************************************
+ * @brief print_read_performance - Function to go through the file read byte
+ * counts and plot the histogram.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      read_counts    Vector of all of the read operations on a
+ *                                     particular file thread.
+ *
+ * <!-- Returns -->
+ *      None (if return type is void)
+ *
+ * @par Pre/Post Conditions:
+ *      None (if entry/exit conditions do not apply)
+ *
+ * @par Global Data:
+ *      None (if no global data)
+ *
+ * @par Description:
+ *      For each file read operation, the size of the buffer returned is stored
+ *      in a vector, and then at file close, this function is called to plot the
+ *      read peformance.
+ *
+ *******************************************************************************
+ */
+static void print_read_performance (vector < int >&read_counts)
+{
+    sort (read_counts.begin (), read_counts.end (), int_compare);
+    printf ("Summarizing file read counts:\n");
+    for (vector < int >::iterator v_it = read_counts.begin ();
+         v_it != read_counts.end (); ++v_it)
+    {
+        printf (" %d,", *v_it);
+    }
+    printf ("\n");
+
+    /*
+     * Histogram 
+     */
+    /*
+     * if count == last_count
+     *   print *
+     * else
+     *   print \ncount
+     *
+     */
+    _lock_printing ();
+    int last_count = -1;
+
+    printf ("     Read Counts Histogram\n");
+    printf ("     +-----------------------------------------------------");
+    for (vector < int >::iterator v_it = read_counts.begin ();
+         v_it != read_counts.end (); ++v_it)
+    {
+
+        // printf ("---->v_it=%d,  last_count=%d\n", *v_it, last_count);
+        if (*v_it == last_count)
+        {
+            printf ("*");
+        }
+        else
+        {
+            printf ("\n%4d | *", *v_it);
+            last_count = *v_it;
+        }
+    }
+    printf ("\n     +-----------------------------------------------------\n");
+    _unlock_printing ();
+}
+
+/**
+ *******************************************************************************
+ * @brief _lock_printing - Grab the local file mutex for printing debug output.
+ *******************************************************************************
+ */
+static void _lock_printing (void)
+{
+    (void) pthread_mutex_lock (&g_printMutex);
+}
+
+/**
+ *******************************************************************************
+ * @brief _unlock_printing - Release the local file mutex for printing debug
+ * output.
+ *******************************************************************************
+ */
+static void _unlock_printing (void)
+{
+    (void) pthread_mutex_unlock (&g_printMutex);
+}
+
+/**
+ *******************************************************************************
+ * @brief _publish_buffer_bytes - Replace one processFile()'s share of the
+ * buffer memory total.
+ *
+ * <!-- Parameters -->
+ *      @param[in,out]  published      Bytes this caller last published,
+ *                                     updated to 'bytes'
+ *      @param[in]      bytes          Bytes the caller holds now
+ *******************************************************************************
+ */
+static void _publish_buffer_bytes (size_t * published, size_t bytes)
+{
+    (void) pthread_mutex_lock (&g_memMutex);
+    g_bufferBytes = g_bufferBytes - *published + bytes;
+    if (g_bufferBytes > g_bufferPeak)
+    {
+        g_bufferPeak = g_bufferBytes;
+    }
+    (void) pthread_mutex_unlock (&g_memMutex);
+    *published = bytes;
+}
+
+/**
+ *******************************************************************************
+ * @brief _table_bytes - Total memory of a private pre-aggregation table.
+ *******************************************************************************
+ */
+static size_t _table_bytes (Word_Dict * table)
+{
+    Mem_Stats_t stats;
+
+    memStatsClear (&stats);
+    table->memoryUsage (&stats);
+    return (memStatsTotal (&stats));
+}
+
+/**
+ *******************************************************************************
+ * @brief _thread_counts_key - Make the key each thread's Thread_Counts_t is
+ * kept under, once.
+ *******************************************************************************
+ */
+static void _thread_counts_key (void)
+{
+    (void) pthread_key_create (&g_threadCountsKey, _thread_counts_free);
+}
+
+/**
+ *******************************************************************************
+ * @brief _thread_counts_free - Free an exiting thread's Thread_Counts_t.
+ *******************************************************************************
+ */
+static void _thread_counts_free (void *local)
+{
+    Thread_Counts_t *counts = (Thread_Counts_t *) local;
+
+    _publish_buffer_bytes (&counts->published_bytes, 0);
+    delete counts->table;
+    delete counts;
+}
+
+/**
+ *******************************************************************************
+ * @brief _thread_counts - The calling thread's private pre-aggregation table,
+ * made the first time it is asked for.
+ *
+ * @par Description:
+ *      One table is reused for every file the thread counts, and every file
+ *      it has in flight, rather than one per file paying for a table and the
+ *      dictionary's sharding.  Every flush empties it, and merge() groups
+ *      its words by shard, so it has a single shard.
+ *******************************************************************************
+ */
+static Thread_Counts_t *_thread_counts (void)
+{
+    Thread_Counts_t *counts = NULL;
+
+    (void) pthread_once (&g_threadCountsOnce, _thread_counts_key);
+    counts = (Thread_Counts_t *) pthread_getspecific (g_threadCountsKey);
+    if (counts == NULL)
+    {
+        counts = new Thread_Counts_t;
+        counts->table = new Word_Dict (1, FALSE, DICT_BACKEND_HASH);
+        counts->published_bytes = 0;
+        (void) pthread_setspecific (g_threadCountsKey, counts);
+    }
+    return (counts);
+}
+
+/**
+ *******************************************************************************
+ * @brief _count_chunk - Count the words tokenizeFoldHash() found in a chunk of
+ * a file, flushing to the dictionary every 'flush_bytes' and at the end.
+ *
+ * <!-- Parameters -->
+ *      @param[in,out]  fc             Where the file is being counted
+ *      @param[in]      buffer         Buffer the spans are in, case folded
+ *      @param[in]      spans          Words found, with their hashes
+ *      @param[in]      bytes          File bytes this chunk adds
+ *      @param[in]      at_end         TRUE for the file's last chunk
+ *******************************************************************************
+ */
+static void _count_chunk (File_Counts_t * fc, const char *buffer,
+                          const vector < Token_Span_t > &spans,
+                          size_t bytes, Bool_t at_end)
+{
+    static const int INITIAL_COUNT = 1;
+    size_t idx = 0;
+    Bool_t measure = FALSE;
+
+    /*
+     * Each word is already lowercased and hashed, count it (insert with a
+     * count of 1, or increment if already present).
      */
-    if ((bytes == 0) && (leftover_bytes > 0))
-    {
-        int chars_processed = 0;
-        char *buffer_start = buffer;
-        int buffer_sz_to_process = leftover_bytes;
-        char *word_found = NULL;
-        int processed_this_round = 0;
-
-        while (chars_processed < buffer_sz_to_process)
-        {
-            processed_this_round = processBufferForWords (buffer_start,
-                                                          buffer_sz_to_process,
-                                                          &word_found);
-            buffer_start += processed_this_round;
-            chars_processed += processed_this_round;
-            DBG (printf
-                 ("  %d: bytes proceesed this loop\n", processed_this_round));
-            DBG (printf ("  %d: total bytes processed\n", chars_processed));
-            if (word_found != NULL)
+    for (idx = 0; idx < spans.size (); idx++)
+    {
+        DBG (printf ("Finding word: %.*s\n", (int) spans[idx].len,
+                     &buffer[spans[idx].offset]));
+        if (fc->counts != NULL)
+        {
+            fc->counts->addOrIncrement (&buffer[spans[idx].offset],
+                                        spans[idx].len, spans[idx].hash,
+                                        INITIAL_COUNT);
+        }
+        if (fc->distinct != NULL)
+        {
+            fc->distinct->add (spans[idx].hash);
+        }
+    }                           /* end for */
+    fc->num_tokens += spans.size ();
+
+    fc->unflushed_bytes += bytes;
+    if ((fc->dict != NULL) &&
+        ((fc->unflushed_bytes >= fc->flush_bytes) || (at_end == TRUE)))
+    {
+        /*
+         * The private table is only measured for a memory limit, or the
+         * verbose peak, as checkMemoryLimit() only looks with a limit
+         */
+        measure = ((fc->dict->getMemoryLimit () > 0) ||
+                   (g_debug_output == TRUE)) ? TRUE : FALSE;
+        if (fc->local != NULL)
+        {
+            if (measure == TRUE)
+            {
+                _publish_buffer_bytes (&fc->local->published_bytes,
+                                       _table_bytes (fc->counts));
+            }
+            fc->num_flushed += fc->counts->size ();
+            fc->dict->merge (*fc->counts);
+        }
+        if (fc->dict->getMemoryLimit () > 0)
+        {
+            (void) fc->dict->checkMemoryLimit (processBytesUsed ());
+        }
+        if (fc->local != NULL)
+        {
+            fc->counts->clear ();
+            if (measure == TRUE)
             {
-                DBG (printf ("---->Found word: %s\n", word_found));
-                word_list.push_back (word_found);
+                _publish_buffer_bytes (&fc->local->published_bytes,
+                                       _table_bytes (fc->counts));
             }
-            DBG (printf ("\n\n"));
         }
+        fc->unflushed_bytes = 0;
+    }
+}
+
+/**
+ *******************************************************************************
+ * @brief _file_open_flags - open() flags for a file read under an I/O policy.
+ *******************************************************************************
+ */
+static int _file_open_flags (Process_Io_Policy_t io_policy)
+{
+    return ((io_policy == PROCESS_IO_DIRECT) ? (O_RDONLY | O_DIRECT) :
+            O_RDONLY);
+}
+
+/**
+ *******************************************************************************
+ * @brief _file_begin - Set up to count an open file, with its read buffer
+ * and, for a shared dictionary, the thread's private table.
+ *
+ * <!-- Parameters -->
+ *      @param[in,out]  fr             File to count, 'path', 'fd' and the
+ *                                     chunk set
+ *      @param[in]      tid            Thread index, for debug output
+ *      @param[in]      dict           As processFile()
+ *      @param[in]      flush_bytes    As processFile()
+ *      @param[in]      distinct_words As processFile()
+ *      @param[in]      read_bytes     As processFile()
+ *      @param[in]      io_policy      As processFile(), PROCESS_IO_DIRECT
+ *                                     only if 'fd' was opened O_DIRECT
+ *
+ * @par Description:
+ *      O_DIRECT reads go to an aligned address, for a multiple of the
+ *      alignment, so the buffer is rounded up to a multiple of it, with room
+ *      for a carried over word and at least one aligned read.  The
+ *      posix_fadvise() hints are given here, for the whole file.
+ *
+ *      For a chunk, 'offset' is set just before its start, the caller seeks
+ *      there, or reads at 'offset' as it would anyway.
+ *******************************************************************************
+ */
+static void _file_begin (File_Read_t * fr, int tid, Word_Dict * dict,
+                         size_t flush_bytes, Hyper_Log_Log * distinct_words,
+                         size_t read_bytes, Process_Io_Policy_t io_policy)
+{
+    fr->tid = tid;
+    fr->io_policy = io_policy;
+    fr->buffer = NULL;
+    fr->buf_size = read_bytes;
+    fr->read_align = 1;
+    if (fr->buf_size < PROCESS_READ_MIN_BYTES)
+    {
+        fr->buf_size = PROCESS_READ_MIN_BYTES;
+    }
+    if (io_policy == PROCESS_IO_DIRECT)
+    {
+        fr->read_align = PROCESS_READ_ALIGN;
+        fr->buf_size = (fr->buf_size + PROCESS_READ_ALIGN - 1) &
+            ~((size_t) PROCESS_READ_ALIGN - 1);
+        if (fr->buf_size < 2 * PROCESS_READ_ALIGN)
+        {
+            fr->buf_size = 2 * PROCESS_READ_ALIGN;
+        }
+    }
+    if (posix_memalign ((void **) &fr->buffer, PROCESS_READ_ALIGN,
+                        fr->buf_size) != 0)
+    {
+        fprintf (stderr, "[%s, %d:%s] Failed to allocate %lu byte read "
+                 "buffer\n", __FILE__, __LINE__, __FUNCTION__,
+                 (unsigned long) fr->buf_size);
+        exit (EXIT_FAILURE);
+    }
+    fr->data_offset = 0;
+    fr->carry_bytes = 0;
+    fr->read_pos = 0;
+    fr->read_len = fr->buf_size;
+    fr->offset = 0;
+    fr->dropped_offset = 0;
+    fr->total_bytes = 0;
+    fr->num_reads = 0;
+    fr->distinct_words = distinct_words;
+    fr->skip_bytes = 0;
+    fr->skip_word = FALSE;
+    if (fr->chunk_start > 0)
+    {
+        /*
+         * Start reading just before the chunk, to see whether its first
+         * bytes finish a word of the chunk before.  An aligned read's worth
+         * before it for O_DIRECT.
+         */
+        fr->skip_bytes = (fr->chunk_start < fr->read_align) ?
+            (size_t) fr->chunk_start : fr->read_align;
+        fr->offset = fr->chunk_start - fr->skip_bytes;
+        fr->dropped_offset = fr->offset;
+    }
+    _chunk_clamp_read (fr);
+
+    switch (io_policy)
+    {
+    case PROCESS_IO_SEQUENTIAL:
+    case PROCESS_IO_DONTNEED:
+        (void) posix_fadvise (fr->fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        break;
+    case PROCESS_IO_NOREUSE:
+        (void) posix_fadvise (fr->fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        (void) posix_fadvise (fr->fd, 0, 0, POSIX_FADV_NOREUSE);
+        break;
+    default:
+        break;
+    }
+
+    /*
+     * A shared dictionary gets its updates through the thread's private,
+     * unlocked table, which merge() takes in shard order, so each flush
+     * takes each shard lock at most once.  A dictionary that is already
+     * private to this thread is counted into directly.
+     */
+    fr->fc.dict = dict;
+    fr->fc.counts = dict;
+    fr->fc.local = NULL;
+    fr->fc.distinct = NULL;
+    fr->fc.flush_bytes = flush_bytes;
+    fr->fc.published_bytes = 0;
+    fr->fc.unflushed_bytes = 0;
+    fr->fc.num_tokens = 0;
+    fr->fc.num_flushed = 0;
+    if ((dict != NULL) && (dict->isThreadSafe () == TRUE))
+    {
+        fr->fc.local = _thread_counts ();
+        fr->fc.counts = fr->fc.local->table;
+    }
+    if (distinct_words != NULL)
+    {
+        fr->fc.distinct = new Hyper_Log_Log (distinct_words->precision ());
+    }
+    _publish_buffer_bytes (&fr->fc.published_bytes, fr->buf_size);
+    _mark_active (FALSE);
+}
+
+/**
+ *******************************************************************************
+ * @brief _is_run_byte - isWordChar(), and with UTF-8 words any byte above
+ * ASCII, as it may be part of a word character.
+ *
+ * @par Description:
+ *      Where a buffer or chunk is cut, the run of these bytes there is kept
+ *      whole, and tokenized all together by one side.
+ *******************************************************************************
+ */
+static inline Bool_t _is_run_byte (char byte)
+{
+    if ((g_utf8Words == TRUE) && ((byte & 0x80) != 0))
+    {
+        return (TRUE);
     }
+    return (isWordChar (byte));
+}
+
+/**
+ *******************************************************************************
+ * @brief _mark_active - Note the time a file is begun, the first one's is
+ * kept, or ended, the last one's is kept, for processActiveSeconds().
+ *******************************************************************************
+ */
+static void _mark_active (Bool_t at_end)
+{
+    struct timespec now;
 
-    if (g_debug_output == TRUE)
+    (void) clock_gettime (CLOCK_MONOTONIC, &now);
+    (void) pthread_mutex_lock (&g_memMutex);
+    if (at_end == TRUE)
+    {
+        g_activeEnd = now;
+    }
+    else if (g_activeStart.tv_sec == 0)
     {
-        print_read_performance (read_counts);
+        g_activeStart = now;
+        g_activeEnd = now;
     }
+    (void) pthread_mutex_unlock (&g_memMutex);
+}
 
+/**
+ *******************************************************************************
+ * @brief _chunk_clamp_read - Keep the next read of a chunk from going past
+ * its end, and past the end to a page at a time.
+ *
+ * @par Description:
+ *      Once past the end only the rest of the chunk's last word is wanted,
+ *      which is usually a few bytes.  Chunk starts are aligned, so the reads
+ *      still are.
+ *******************************************************************************
+ */
+static void _chunk_clamp_read (File_Read_t * fr)
+{
+    uint64_t limit = 0;
 
-    close (fIn);
+    if (fr->chunk_end == 0)
+    {
+        return;
+    }
+    if (fr->offset < fr->chunk_end)
+    {
+        /* Aligned up, the last chunk ends at the end of the file */
+        limit = (fr->chunk_end - fr->offset + fr->read_align - 1) /
+            fr->read_align * fr->read_align;
+        if (fr->read_len > limit)
+        {
+            fr->read_len = (size_t) limit;
+        }
+    }
+    else if (fr->read_len > PROCESS_READ_ALIGN)
+    {
+        fr->read_len = PROCESS_READ_ALIGN;
+    }
+}
 
-    DBG (printf ("[%d] Finished processing file: %s, %lu bytes\n",
-                 tid, filePath.c_str (), total_bytes));
+/**
+ *******************************************************************************
+ * @brief _chunk_skip - Drop the bytes read from before a chunk, and the end
+ * of a word of the chunk before it runs into.
+ *
+ * <!-- Parameters -->
+ *      @param[in,out]  fr             Chunk being counted
+ *      @param[in]      bytes          Bytes read
+ *      @param[in]      count          Bytes at 'bytes'
+ *
+ * <!-- Returns -->
+ *      @return Bytes at the front of 'bytes' to drop, all of them if the
+ *              word carries on into the next read
+ *
+ * @par Description:
+ *      The last byte before the chunk decides: a word character means the
+ *      chunk starts inside that word, which is counted by the chunk before,
+ *      so the word characters up to the first other byte are dropped too.
+ *******************************************************************************
+ */
+static size_t _chunk_skip (File_Read_t * fr, const char *bytes, size_t count)
+{
+    size_t idx = 0;
 
-    return;
+    while ((idx < count) && (fr->skip_bytes > 0))
+    {
+        fr->skip_bytes--;
+        if (fr->skip_bytes == 0)
+        {
+            fr->skip_word = _is_run_byte (bytes[idx]);
+        }
+        idx++;
+    }
+    while ((idx < count) && (fr->skip_word == TRUE))
+    {
+        if (_is_run_byte (bytes[idx]) == FALSE)
+        {
+            fr->skip_word = FALSE;
+        }
+        else
+        {
+            idx++;
+        }
+    }
+    return (idx);
 }
 
 /**
  *******************************************************************************
- * @brief processBufferForWords - Take a buffer of data read from the file and
- * parse for words.
+ * @brief _file_read_room - Bytes the next read can ask for, with 'carry'
+ * bytes of a word carried over in front of it.
+ *
+ * @par Description:
+ *      The read goes at 'carry' rounded up to the read alignment, for the
+ *      rest of the buffer rounded down to it, 0 if there is no room.
+ *******************************************************************************
+ */
+static size_t _file_read_room (File_Read_t * fr, size_t carry)
+{
+    size_t pos = (carry + fr->read_align - 1) / fr->read_align *
+        fr->read_align;
+
+    if (pos >= fr->buf_size)
+    {
+        return (0);
+    }
+    return ((fr->buf_size - pos) / fr->read_align * fr->read_align);
+}
+
+/**
+ *******************************************************************************
+ * @brief _file_consume - Count what a read put in the buffer behind the
+ * carried over partial word.
  *
  * <!-- Parameters -->
- *      @param[in]      buffer         Pointer to the buffer read from file to
- *                                     process.
- *      @param[in]      buffer_sz      Size of 'buffer' in characters
- *      @param[in]      word           Pointer to location in which to put the
- *                                     word found.
+ *      @param[in,out]  fr             File being counted
+ *      @param[in]      bytes          Bytes the read returned, 0 at the end
+ *                                     of the file
  *
  * <!-- Returns -->
- *      @return number of bytes processed.
+ *      @return TRUE    If that was the end of the file
+ *      @return FALSE   If the next read goes to &buffer[read_pos], for
+ *                      read_len bytes, at file 'offset'
  *
- * @par Pre/Post Conditions:
- *      None (if entry/exit conditions do not apply)
+ * @par Description:
+ *      A short O_DIRECT read is the end of the file, the file's size isn't
+ *      aligned, so there is no aligned offset left to read at.
  *
- * @par Global Data:
- *      None (if no global data)
+ *      A chunk counts the words that start in it.  Its first bytes are
+ *      dropped if they finish a word of the chunk before, and past its end
+ *      it reads on just far enough to finish its own last word.  So the
+ *      chunks of a file count exactly what the whole file does, but for
+ *      words longer than PROCESS_READ_MAX_BYTES, which are split
+ *      differently.
  *
- * @par Description:
- *      Search through the buffer character by character to find "runs" of "word
- *      characters.  Once a run/word is found it, it is returned to the caller
- *      by setting 'word' to point to it.
+ *      A word carried over that leaves no room to read the rest of it grows
+ *      the buffer, see _file_grow_buffer().
  *******************************************************************************
  */
-int processBufferForWords (char *buffer, int buffer_sz, char **word)
+static Bool_t _file_consume (File_Read_t * fr, size_t bytes)
 {
-    int char_index;
-    int begin_last_word = -1;
-    int num_processed = 0;
+    char *data = &fr->buffer[fr->data_offset];
+    size_t avail_bytes = fr->carry_bytes + bytes;
+    size_t processed_bytes = 0;
+    size_t skipped_bytes = 0;
+    size_t read_pos = 0;
+    size_t idx = 0;
+    char *old_buffer = NULL;
+    Bool_t at_end = FALSE;
+
+    if ((bytes == 0) || ((bytes % fr->read_align) != 0))
+    {
+        at_end = TRUE;
+    }
+    fr->num_reads++;
+    fr->offset += bytes;
+    if (bytes > 0)
+    {
+        fr->read_counts.push_back ((int) bytes);
+    }
 
-    if (word == NULL)
+    if ((fr->skip_bytes > 0) || (fr->skip_word == TRUE))
     {
-        goto cleanup;
+        /*
+         * Nothing counted or carried yet, drop what belongs to the chunk
+         * before.  A chunk inside one long word has nothing of its own.
+         */
+        skipped_bytes = _chunk_skip (fr, data, avail_bytes);
+        data += skipped_bytes;
+        avail_bytes -= skipped_bytes;
+        fr->total_bytes += skipped_bytes;
+        if ((fr->skip_word == TRUE) && (fr->offset >= fr->chunk_end))
+        {
+            at_end = TRUE;
+        }
     }
-    *word = NULL;
-    for (char_index = 0; char_index < buffer_sz; char_index++)
+    else if ((fr->chunk_end > 0) && (fr->offset - bytes >= fr->chunk_end))
     {
         /*
-         * If a word character we'll want to keep going 
+         * Past the end of the chunk, only reading to finish its last word,
+         * up to the first byte that isn't part of it.
          */
-        if (isWordChar (buffer[char_index]))
+        for (idx = fr->carry_bytes;
+             (fr->carry_bytes > 0) && (idx < avail_bytes) &&
+             (_is_run_byte (data[idx]) == TRUE); idx++)
         {
-            if (begin_last_word == -1)
-            {
-                begin_last_word = char_index;
-            }
         }
-        else
+        if ((fr->carry_bytes == 0) || (idx < avail_bytes))
         {
-            if (begin_last_word != -1)
-            {
-                int length = char_index - begin_last_word;
-                char *tmp_word = (char *) calloc (length, sizeof (char));
-
-                if (tmp_word != NULL)
-                {
-                    strncpy (tmp_word, &buffer[begin_last_word], length);
-                    *word = tmp_word;
-                    goto cleanup;
-                }
-            }
+            avail_bytes = idx;
+            at_end = TRUE;
         }
-        num_processed++;
+    }
+    if ((at_end == FALSE) && (fr->chunk_end > 0) &&
+        (fr->offset >= fr->chunk_end) &&
+        ((avail_bytes == 0) || (_is_run_byte (data[avail_bytes - 1]) == FALSE)))
+    {
+        /* The chunk ends between words */
+        at_end = TRUE;
     }
 
-    if (begin_last_word != -1)
+    processed_bytes = tokenizeFoldHash (data, avail_bytes, fr->spans, at_end);
+    if ((at_end == FALSE) && (avail_bytes > 0) &&
+        (processed_bytes == avail_bytes) &&
+        (_is_run_byte (data[avail_bytes - 1]) == TRUE))
     {
         /*
-         * Buffer size minus where we started should be the length 
+         * All one word, read the rest of it behind it, growing the buffer if
+         * it is full.  Only a word filling the biggest buffer is counted as
+         * it is, split at the buffer size.
          */
-        int length = buffer_sz - begin_last_word;
-        char *tmp_word = (char *) calloc (length, sizeof (char));
-
-        if (tmp_word != NULL)
+        if (_file_read_room (fr, avail_bytes) == 0)
+        {
+            old_buffer = _file_grow_buffer (fr);
+        }
+        if ((_file_read_room (fr, avail_bytes) > 0) || (old_buffer != NULL))
         {
-            strncpy (tmp_word, &buffer[begin_last_word], length);
-            *word = tmp_word;
+            fr->spans.clear ();
+            processed_bytes = 0;
         }
+    }
+    else if ((at_end == FALSE) &&
+             (_file_read_room (fr, avail_bytes - processed_bytes) == 0))
+    {
+        /*
+         * No room to read the rest of the word behind it, so the buffer
+         * grows, the word moves over below, or is split as above.
+         */
+        old_buffer = _file_grow_buffer (fr);
+        if (old_buffer == NULL)
+        {
+            processed_bytes =
+                tokenizeFoldHash (data, avail_bytes, fr->spans, TRUE);
+        }
+    }
+
+    _count_chunk (&fr->fc, data, fr->spans, bytes, at_end);
+    DBG (printf ("[%d] Processed %lu bytes this loop\n", fr->tid,
+                 (unsigned long) processed_bytes));
 
+    if ((fr->io_policy == PROCESS_IO_DONTNEED) &&
+        ((at_end == TRUE) ||
+         (fr->offset - fr->dropped_offset >= PROCESS_DONTNEED_BYTES)))
+    {
+        /* Done with these pages, don't let them push out anything else */
+        (void) posix_fadvise (fr->fd, (off_t) fr->dropped_offset,
+                              (off_t) (fr->offset - fr->dropped_offset),
+                              POSIX_FADV_DONTNEED);
+        fr->dropped_offset = fr->offset;
     }
 
-  cleanup:
-    return (num_processed);
+    /*
+     * Whatever was not processed is the start of a word running on into the
+     * next read, move it up against where the next read goes.
+     */
+    fr->total_bytes += processed_bytes;
+    fr->carry_bytes = avail_bytes - processed_bytes;
+    if (at_end == FALSE)
+    {
+        read_pos = (fr->carry_bytes + fr->read_align - 1) / fr->read_align *
+            fr->read_align;
+        if (fr->carry_bytes > 0)
+        {
+            memmove (&fr->buffer[read_pos - fr->carry_bytes],
+                     &data[processed_bytes], fr->carry_bytes);
+        }
+        fr->data_offset = read_pos - fr->carry_bytes;
+        fr->read_pos = read_pos;
+        fr->read_len = _file_read_room (fr, fr->carry_bytes);
+        _chunk_clamp_read (fr);
+    }
+    free (old_buffer);
+    return (at_end);
 }
 
 /**
  *******************************************************************************
- * @brief processWholeBuffer - Process a whole buffer's worth of data for all of
- * the words contained therein.
+ * @brief _file_grow_buffer - Double a file's read buffer, for a word too long
+ * to read the rest of behind it.
  *
  * <!-- Parameters -->
- *      @param[in]      buffer         Pointer to the buffer read from file to
- *                                     process.
- *      @param[in]      buffer_sz      Size of 'buffer' in characters
- *      @param[in]      word_list      Reference to a stl::list in which to
- *                                     insert all words found in the buffer.
+ *      @param[in,out]  fr             File being counted
  *
  * <!-- Returns -->
- *      @return count of bytes processed from the buffer.
- *
- * @par Pre/Post Conditions:
- *      None (if entry/exit conditions do not apply)
- *
- * @par Global Data:
- *      None (if no global data)
+ *      @return The old buffer, for the caller to free once it has moved what
+ *              it needs out of it
+ *      @return NULL    If the buffer is already PROCESS_READ_MAX_BYTES
  *
  * @par Description:
- *      Takes a file read buffer's worth of data, passes it off to
- *      processBufferForWords() to get individual words from the buffer, and add
- *      them to the word_list vector (they will get coallated with the other
- *      words in the caller.
+ *      Capped at PROCESS_READ_MAX_BYTES, and still a multiple of the read
+ *      alignment.  The buffer keeps its size for the rest of the file.
  *******************************************************************************
  */
-int processWholeBuffer (char *buffer, int buffer_sz, list < char *>&word_list)
+static char *_file_grow_buffer (File_Read_t * fr)
 {
-    int chars_processed = 0;
-    char *buffer_start = buffer;
-    char *word_found = NULL;
-    int processed_this_round = 0;
-    int buffer_sz_to_process = buffer_sz;
-    int idx = 0;
+    char *old_buffer = fr->buffer;
+    size_t buf_size = fr->buf_size * 2;
 
-    DBG (printf ("Buffer size: %d\n", buffer_sz));
-    /*
-     * If very last of buffer looks like a word, back off until we are at the
-     * beginning of it, and then only process up until that point
-     */
-    if (isWordChar (buffer[buffer_sz - 1]))
+    if (fr->buf_size >= PROCESS_READ_MAX_BYTES)
     {
-        for (idx = buffer_sz - 1; idx >= 0; idx--)
-        {
-            if (isWordChar (buffer[idx]) == FALSE)
-            {
-                buffer_sz_to_process = idx;
-                break;
-            }
-        }                       /* end for */
+        return (NULL);
     }
-    while (chars_processed < buffer_sz_to_process)
-    {
-        processed_this_round = processBufferForWords (buffer_start,
-                                                      (buffer_sz_to_process -
-                                                       chars_processed),
-                                                      &word_found);
-        buffer_start += processed_this_round;
-        chars_processed += processed_this_round;
-        DBG (printf
-             ("  %d: bytes proceesed this loop\n", processed_this_round));
-        DBG (printf ("  %d: total bytes processed\n", chars_processed));
-        if (word_found != NULL)
-        {
-            DBG (printf ("---->Found word: %s\n", word_found));
-            word_list.push_back (word_found);
-        }
-        DBG (printf ("\n\n"));
+    if (buf_size > PROCESS_READ_MAX_BYTES)
+    {
+        buf_size = PROCESS_READ_MAX_BYTES;
     }
-
-    return (chars_processed);
+    if (posix_memalign ((void **) &fr->buffer, PROCESS_READ_ALIGN,
+                        buf_size) != 0)
+    {
+        fprintf (stderr, "[%s, %d:%s] Failed to allocate %lu byte read "
+                 "buffer\n", __FILE__, __LINE__, __FUNCTION__,
+                 (unsigned long) buf_size);
+        exit (EXIT_FAILURE);
+    }
+    fr->buf_size = buf_size;
+    _publish_buffer_bytes (&fr->fc.published_bytes, fr->buf_size);
+    return (old_buffer);
 }
 
 /**
  *******************************************************************************
- * @brief int_compare - comparitor used by vector sort operation.
+ * @brief _file_end - Close a counted file, release its buffer, and add its
+ * statistics and estimate to the run's.
+ *
+ * <!-- Parameters -->
+ *      @param[in,out]  fr             File counted
+ *      @param[in]      mapped_bytes   Bytes counted from a mapping, if any
  *******************************************************************************
  */
-static bool int_compare (int i, int j)
+static void _file_end (File_Read_t * fr, size_t mapped_bytes)
 {
-    return (i < j);
+    Word_Dict *dict = fr->fc.dict;
+    Hyper_Log_Log *own = fr->fc.distinct;
+    Hyper_Log_Log *distinct = NULL;
+
+    if ((fr->io_policy == PROCESS_IO_DONTNEED) && (mapped_bytes > 0))
+    {
+        (void) posix_fadvise (fr->fd, 0, 0, POSIX_FADV_DONTNEED);
+    }
+    close (fr->fd);
+    fr->fd = -1;
+
+    _publish_buffer_bytes (&fr->fc.published_bytes, 0);
+    fr->fc.counts = NULL;
+    fr->fc.local = NULL;
+    free (fr->buffer);
+    fr->buffer = NULL;
+    (void) pthread_mutex_lock (&g_memMutex);
+    g_readCalls += fr->num_reads;
+    g_readBytes += fr->total_bytes;
+    if (mapped_bytes > 0)
+    {
+        g_mappedFiles++;
+        g_mappedBytes += mapped_bytes;
+    }
+    (void) pthread_mutex_unlock (&g_memMutex);
+    _mark_active (TRUE);
+
+    if (own != NULL)
+    {
+        fr->distinct_words->merge (*own);
+    }
+    distinct = _file_distinct (fr);
+    if (distinct != NULL)
+    {
+        _lock_printing ();
+        printf ("[%d] %s%s: ~%.0f distinct words\n", fr->tid,
+                fr->path.c_str (),
+                ((fr->chunk_end > 0) && (distinct == own)) ? " (chunk)" : "",
+                distinct->estimate ());
+        _unlock_printing ();
+        delete distinct;
+    }
+
+    if ((g_debug_output == TRUE) && (dict != NULL))
+    {
+        print_read_performance (fr->read_counts);
+        printf ("[%d] %lu words, %lu shared dictionary updates\n", fr->tid,
+                (unsigned long) fr->fc.num_tokens,
+                (unsigned long) ((dict->isThreadSafe () == TRUE) ?
+                                 fr->fc.num_flushed : fr->fc.num_tokens));
+    }
+
+    DBG (printf ("[%d] Finished processing file: %s, %lu bytes\n",
+                 fr->tid, fr->path.c_str (),
+                 (unsigned long) (fr->total_bytes + mapped_bytes)));
 }
 
 /**
  *******************************************************************************
- * @brief print_read_performance - Function to go through the file read byte
- * counts and plot the histogram.
+ * @brief _file_distinct - The estimate to print for a counted file or chunk,
+ * once per file however it was split.
  *
  * <!-- Parameters -->
- *      @param[in]      read_counts    Vector of all of the read operations on a
- *                                     particular file thread.
+ *      @param[in,out]  fr             File or chunk counted, its estimate is
+ *                                     taken, if it has one
  *
  * <!-- Returns -->
- *      None (if return type is void)
- *
- * @par Pre/Post Conditions:
- *      None (if entry/exit conditions do not apply)
- *
- * @par Global Data:
- *      None (if no global data)
+ *      @return Estimate for the caller to print and delete, the file's own,
+ *              or for the last chunk of a split file every chunk's merged
+ *      @return NULL    If there is no estimate, or other chunks of the file
+ *                      are still to be counted
  *
  * @par Description:
- *      For each file read operation, the size of the buffer returned is stored
- *      in a vector, and then at file close, this function is called to plot the
- *      read peformance.
- *
+ *      A chunk of a file processSplitItem() didn't split is printed on its
+ *      own.
  *******************************************************************************
  */
-static void print_read_performance (vector < int >&read_counts)
+static Hyper_Log_Log *_file_distinct (File_Read_t * fr)
 {
-    sort (read_counts.begin (), read_counts.end (), int_compare);
-    printf ("Summarizing file read counts:\n");
-    for (vector < int >::iterator v_it = read_counts.begin ();
-         v_it != read_counts.end (); ++v_it)
+    map < string, Split_File_t >::iterator split;
+    Hyper_Log_Log *distinct = fr->fc.distinct;
+
+    fr->fc.distinct = NULL;
+    if (fr->chunk_end == 0)
     {
-        printf (" %d,", *v_it);
+        return (distinct);
     }
-    printf ("\n");
-
-    /*
-     * Histogram 
-     */
-    /*
-     * if count == last_count
-     *   print *
-     * else
-     *   print \ncount
-     *
-     */
-    _lock_printing ();
-    int last_count = -1;
 
-    printf ("     Read Counts Histogram\n");
-    printf ("     +-----------------------------------------------------");
-    for (vector < int >::iterator v_it = read_counts.begin ();
-         v_it != read_counts.end (); ++v_it)
+    (void) pthread_mutex_lock (&g_splitMutex);
+    split = g_splitFiles.find (fr->path);
+    if (split != g_splitFiles.end ())
     {
-
-        // printf ("---->v_it=%d,  last_count=%d\n", *v_it, last_count);
-        if (*v_it == last_count)
+        if (split->second.distinct == NULL)
         {
-            printf ("*");
+            split->second.distinct = distinct;
         }
-        else
+        else if (distinct != NULL)
         {
-            printf ("\n%4d | *", *v_it);
-            last_count = *v_it;
+            split->second.distinct->merge (*distinct);
+            delete distinct;
+        }
+        distinct = NULL;
+        split->second.chunks_left--;
+        if (split->second.chunks_left == 0)
+        {
+            distinct = split->second.distinct;
+            g_splitFiles.erase (split);
         }
     }
-    printf ("\n     +-----------------------------------------------------\n");
-    _unlock_printing ();
-}
+    (void) pthread_mutex_unlock (&g_splitMutex);
 
-/**
- *******************************************************************************
- * @brief _lock_printing - Grab the local file mutex for printing debug output.
- *******************************************************************************
- */
-static void _lock_printing (void)
-{
-    (void) pthread_mutex_lock (&g_printMutex);
+    return (distinct);
 }
 
 /**
  *******************************************************************************
- * @brief _unlock_printing - Release the local file mutex for printing debug
- * output.
+ * @brief _map_file - Count a file straight from a read-only mapping of it.
+ *
+ * <!-- Parameters -->
+ *      @param[in,out]  fr             Open file to map, its read buffer
+ *                                     takes the lowercased words of each
+ *                                     window of the mapping, and is the
+ *                                     window size
+ *      @param[out]     mapped         Bytes of the file counted
+ *
+ * <!-- Returns -->
+ *      @return TRUE    If the whole file was counted from the mapping
+ *      @return FALSE   If the file fits in the buffer or couldn't be mapped,
+ *                      and nothing was counted, read() it instead
+ *
+ * @par Description:
+ *      A file no bigger than the read buffer takes one read(), which is
+ *      cheaper than setting up and tearing down a mapping, so only bigger
+ *      files are mapped.  The mapping is advised MADV_SEQUENTIAL, so the
+ *      kernel reads ahead aggressively and drops pages behind.
+ *
+ *      The mapping is tokenized in buffer sized windows.  A window ends in
+ *      front of a word it cuts off, and the next window starts there; the
+ *      mapping is contiguous, so there is nothing to copy or carry.  The
+ *      words are lowercased into the buffer rather than in place, as writing
+ *      to a private mapping would copy every page.  A word longer than a
+ *      window grows the buffer, as for a read.
  *******************************************************************************
  */
-static void _unlock_printing (void)
+static Bool_t _map_file (File_Read_t * fr, size_t * mapped)
 {
-    (void) pthread_mutex_unlock (&g_printMutex);
+    struct stat st;
+    const char *map = NULL;
+    char *old_buffer = NULL;
+    void *addr = NULL;
+    size_t file_sz = 0;
+    size_t pos = 0;
+    size_t window = 0;
+    size_t processed = 0;
+    Bool_t at_end = FALSE;
+
+    *mapped = 0;
+    if ((fstat (fr->fd, &st) != 0) || (st.st_size <= (off_t) fr->buf_size))
+    {
+        return (FALSE);
+    }
+    file_sz = (size_t) st.st_size;
+    addr = mmap (NULL, file_sz, PROT_READ, MAP_PRIVATE, fr->fd, 0);
+    if (addr == MAP_FAILED)
+    {
+        return (FALSE);
+    }
+    map = (const char *) addr;
+    (void) madvise (addr, file_sz, MADV_SEQUENTIAL);
+
+    while (pos < file_sz)
+    {
+        window = ((file_sz - pos) > fr->buf_size) ? fr->buf_size :
+            (file_sz - pos);
+        at_end = ((pos + window) == file_sz) ? TRUE : FALSE;
+        processed = tokenizeFoldHashTo (&map[pos], window, fr->buffer,
+                                        fr->spans, at_end);
+        if ((processed == 0) ||
+            ((at_end == FALSE) && (processed == window) &&
+             (_is_run_byte (map[pos + window - 1]) == TRUE)))
+        {
+            /* A word longer than a window, widen the window for it, or
+             * split it at the biggest window size */
+            old_buffer = _file_grow_buffer (fr);
+            if (old_buffer != NULL)
+            {
+                free (old_buffer);
+                continue;
+            }
+            processed = tokenizeFoldHashTo (&map[pos], window, fr->buffer,
+                                            fr->spans, TRUE);
+        }
+        _count_chunk (&fr->fc, fr->buffer, fr->spans, processed, at_end);
+        pos += processed;
+    }
+
+    (void) munmap (addr, file_sz);
+    *mapped = file_sz;
+    return (TRUE);
 }
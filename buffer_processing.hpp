@@ -44,7 +44,10 @@
  * System Includes
  *******************************************************************************
  */
+#include <stddef.h>             /* for size_t */
+#include <stdint.h>             /* for uint64_t */
 #include <list>
+#include <vector>
 
 /*******************************************************************************
  * Project Includes
@@ -52,6 +55,8 @@
  */
 #include "common_types.h"
 #include "word_dict.hpp"
+#include "hyper_log_log.hpp"
+#include "work_queue.hpp"
 
 #if defined(TEST)
 extern "C"
@@ -61,8 +66,21 @@ extern "C"
     void bufferProcOneWordAtBegin (void);
     void bufferProcOneWordAtEnd (void);
     void bufferProcFullBuffer (void);
+    void bufferProcSpans (void);
+    void bufferProcSpansWrappers (void);
+    void bufferProcSpansKernels (void);
+    void bufferProcFoldHash (void);
 
     void fileProcess (void);
+    void fileProcessFlush (void);
+    void fileProcessDistinct (void);
+    void fileProcessCarryOver (void);
+    void fileProcessMmap (void);
+    void fileProcessUring (void);
+    void fileProcessIoPolicy (void);
+    void fileProcessChunks (void);
+    void fileProcessChunkDistinct (void);
+    void fileProcessUtf8 (void);
 }
 #endif                          /* defined(TEST) */
 
@@ -70,17 +88,69 @@ extern "C"
  * Typedefs
  *******************************************************************************
  */
+/** How processFile() gets at a file's bytes */
+typedef enum
+{
+    PROCESS_READ_SYSCALL = 0,   /**< read() into the read buffer */
+    PROCESS_READ_MMAP,          /**< Tokenize a read-only mapping of the
+                                  file, if it is bigger than the read buffer */
+    PROCESS_READ_URING          /**< Several files' reads in flight at once
+                                  through io_uring, see processFilesUring(),
+                                  processFile() itself read()s */
+} Process_Read_Mode_t;
+
+/** How processFile() treats the page cache, see processIoPolicyName() */
+typedef enum
+{
+    PROCESS_IO_NORMAL = 0,      /**< No hints */
+    PROCESS_IO_SEQUENTIAL,      /**< POSIX_FADV_SEQUENTIAL, more readahead */
+    PROCESS_IO_NOREUSE,         /**< Sequential, and POSIX_FADV_NOREUSE */
+    PROCESS_IO_DONTNEED,        /**< Sequential, and POSIX_FADV_DONTNEED
+                                  behind the reads, so the file's pages don't
+                                  push anything else out of the cache */
+    PROCESS_IO_DIRECT           /**< O_DIRECT into aligned buffers, past the
+                                  page cache entirely.  Dontneed where the
+                                  filesystem has no O_DIRECT */
+} Process_Io_Policy_t;
+
+class Work_Queue;
 
 /*******************************************************************************
  * Constants
  *******************************************************************************
  */
+/** Bytes of a file counted locally before flushing to a shared dictionary */
+#define PROCESS_FLUSH_BYTES (256 * 1024)
+/** Default size of processFile()'s read buffer */
+#define PROCESS_READ_BYTES (256 * 1024)
+/** Smallest read buffer processFile() will use */
+#define PROCESS_READ_MIN_BYTES (16)
+/** Largest read buffer accepted on the command line, and the most a buffer
+ * grows to for a long word */
+#define PROCESS_READ_MAX_BYTES (64 * 1024 * 1024)
+/** Alignment of processFile()'s read buffer, a page */
+#define PROCESS_READ_ALIGN (4096)
+/** Files processFilesUring() keeps in flight per worker */
+#define PROCESS_URING_DEPTH (4)
+/** File bytes read between page cache drops, PROCESS_IO_DONTNEED */
+#define PROCESS_DONTNEED_BYTES (8 * 1024 * 1024)
+/** Default size of the chunks a big file is split into for the workers */
+#define PROCESS_CHUNK_BYTES (64 * 1024 * 1024)
 
 /*******************************************************************************
  * Structures
  *******************************************************************************
  */
 
+/** One word found by tokenizeBuffer(), as a place in the buffer searched */
+typedef struct
+{
+    size_t offset;              /**< Index of the word's first byte */
+    size_t len;                 /**< Length of the word in bytes */
+    Word_Hash_t hash;           /**< wordHash() of the case-folded word, from
+                                  tokenizeFoldHash() only */
+} Token_Span_t;
+
 /*******************************************************************************
  * Unions
  *******************************************************************************
@@ -91,10 +161,43 @@ extern "C"
  *******************************************************************************
  */
 Bool_t isWordChar (const char thisOne);
-void processFile (int tid, std::string filePath, Word_Dict * dict);
+void processFile (int tid, std::string filePath, Word_Dict * dict,
+                  size_t flush_bytes = PROCESS_FLUSH_BYTES,
+                  Hyper_Log_Log * distinct_words = NULL,
+                  size_t read_bytes = PROCESS_READ_BYTES,
+                  Process_Read_Mode_t read_mode = PROCESS_READ_SYSCALL,
+                  Process_Io_Policy_t io_policy = PROCESS_IO_NORMAL,
+                  uint64_t chunk_offset = 0, uint64_t chunk_length = 0);
+Bool_t processFilesUring (int tid, Work_Queue * queue, Word_Dict * dict,
+                          size_t flush_bytes = PROCESS_FLUSH_BYTES,
+                          Hyper_Log_Log * distinct_words = NULL,
+                          size_t read_bytes = PROCESS_READ_BYTES,
+                          Process_Io_Policy_t io_policy = PROCESS_IO_NORMAL,
+                          uint64_t chunk_bytes = 0,
+                          unsigned int depth = PROCESS_URING_DEPTH);
+unsigned int processSplitItem (Work_Queue * queue, Work_Item_t & item,
+                               uint64_t chunk_bytes);
+size_t tokenizeBuffer (const char *buffer, size_t buffer_sz,
+                       std::vector < Token_Span_t > &spans,
+                       Bool_t at_end = FALSE);
+size_t tokenizeFoldHash (char *buffer, size_t buffer_sz,
+                         std::vector < Token_Span_t > &spans,
+                         Bool_t at_end = FALSE);
+size_t tokenizeFoldHashTo (const char *buffer, size_t buffer_sz, char *fold,
+                           std::vector < Token_Span_t > &spans,
+                           Bool_t at_end = FALSE);
 int processBufferForWords (char *buffer, int buffer_sz, char **word);
 int processWholeBuffer (char *buffer, int buffer_sz,
                         std::list < char *>&word_list);
+size_t processBytesUsed (void);
+size_t processPeakBytes (void);
+void processReadStats (uint64_t * calls, uint64_t * bytes);
+void processMapStats (uint64_t * files, uint64_t * bytes);
+double processActiveSeconds (void);
+void tokenizeSetUtf8 (Bool_t utf8);
+Bool_t tokenizeUtf8 (void);
+const char *processIoPolicyName (Process_Io_Policy_t io_policy);
+Bool_t parseIoPolicy (const char *name, Process_Io_Policy_t * io_policy);
 
 /*******************************************************************************
  * Global Variables
@@ -0,0 +1,794 @@
+/**
+ * @file           dict_file.cpp
+ * @brief:         Memory-mappable on-disk dictionary format.
+ * @verbatim
+ *******************************************************************************
+ * Author:         Douglas L. Potts
+ *
+ * Date:           10/17/2026, <SCR #>
+ *
+ *==============================================================================
+ *==============================================================================
+ * Copyright (c) 2015 Douglas Lee Potts
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ *==============================================================================
+ *==============================================================================
+ *
+ * History:
+ * Date        SCR #  Name  Description
+ * -----------------------------------------------------------------------------
+ *
+ *******************************************************************************
+ * @endverbatim
+ */
+
+/*******************************************************************************
+ * System Includes
+ *******************************************************************************
+ */
+#include <stdio.h>              /* for fopen(), fwrite() */
+#include <stdlib.h>             /* for mkstemp() */
+#include <string.h>             /* for memcmp(), strerror() */
+#include <errno.h>              /* for errno */
+#include <fcntl.h>              /* for open() */
+#include <unistd.h>             /* for close() */
+#include <sys/types.h>
+#include <sys/stat.h>           /* for fstat() */
+#include <sys/mman.h>           /* for mmap() */
+
+/*******************************************************************************
+ * Project Includes
+ *******************************************************************************
+ */
+#include "common_types.h"
+#include "dict_file.hpp"
+#if defined(TEST)
+#include "unity.h"
+#endif /* defined(TEST) */
+
+/*******************************************************************************
+ * Local Structs
+ *******************************************************************************
+ */
+/** Running Fletcher-style checksum over 32-bit words */
+typedef struct
+{
+    uint64_t low;               /**< Sum of the words */
+    uint64_t high;              /**< Sum of the running sums */
+} Dict_File_Sum_t;
+
+/*******************************************************************************
+ * Local Function Prototypes 
+ *******************************************************************************
+ */
+static uint64_t alignUp (uint64_t bytes);
+static void checksumSection (Dict_File_Sum_t * sum, const void *data,
+                             uint64_t len);
+static uint64_t checksumValue (const Dict_File_Sum_t * sum);
+static uint64_t headerChecksum (const Dict_File_Header_t * header);
+static Bool_t writeSection (FILE * fp, const void *data, uint64_t len);
+
+/*******************************************************************************
+ * Local Constants 
+ *******************************************************************************
+ */
+#define DBG(X)
+
+/** Largest word index a uint32_t rank can hold, plus one */
+#define DICT_FILE_MAX_WORDS ((uint64_t) 0xFFFFFFFFU)
+
+#if defined(TEST)
+/** mkstemp() template for the files the tests write */
+static const char TEST_DICT_FILE_TEMPLATE[] = "/tmp/ssfi_dict_XXXXXX";
+#endif /* defined(TEST) */
+
+/*******************************************************************************
+ * File Scoped Variables 
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ ********************* E X T E R N A L  F U N C T I O N S **********************
+ *******************************************************************************
+ */
+
+#if defined(TEST)
+extern "C"
+{
+
+    void dictFileSaveLoad (void)
+    {
+        Word_Dict *dict = new Word_Dict (4);
+        Word_Dict *empty = new Word_Dict ();
+        Dict_File *file = new Dict_File ();
+        vector < Dict_Entry_t > expected;
+        vector < Dict_Entry_t > top_list;
+        Dict_Entry_t entry;
+        Dict_Entry_t prev;
+        char path[sizeof (TEST_DICT_FILE_TEMPLATE)];
+        char word[32];
+        int fd = -1;
+        int idx = 0;
+        int len = 0;
+
+        strcpy (path, TEST_DICT_FILE_TEMPLATE);
+        fd = mkstemp (path);
+        TEST_ASSERT_TRUE (fd >= 0);
+        (void) close (fd);
+
+        for (idx = 0; idx < 1000; idx++)
+        {
+            len = snprintf (word, sizeof (word), "w%d", idx);
+            dict->addOrIncrement (word, len, wordHash (word, len),
+                                  (idx % 37) + 1);
+        }
+        dict->addOrIncrement ("apples", 6, wordHash ("apples", 6), 500);
+
+        TEST_ASSERT_TRUE (saveDictFile (*dict, path, FALSE));
+        TEST_ASSERT_TRUE (file->open (path, TRUE));
+        TEST_ASSERT_FALSE (file->hasPerfectHash ());
+        TEST_ASSERT_EQUAL (file->size (), 1001);
+        TEST_ASSERT_EQUAL (file->totalCount (), 18982 + 500);
+
+        for (idx = 0; idx < 1000; idx++)
+        {
+            len = snprintf (word, sizeof (word), "w%d", idx);
+            TEST_ASSERT_EQUAL (file->getWordCount (word, len),
+                               (idx % 37) + 1);
+        }
+        TEST_ASSERT_EQUAL (file->getWordCount ("apples", 6), 500);
+        TEST_ASSERT_EQUAL (file->getWordCount ("apple", 5), -1);
+        TEST_ASSERT_EQUAL (file->getWordCount ("w1000", 5), -1);
+        TEST_ASSERT_EQUAL (file->getWordCount ("zzz", 3), -1);
+
+        /* Stored in word order */
+        TEST_ASSERT_TRUE (file->entry (0, &prev));
+        for (idx = 1; file->entry (idx, &entry) == TRUE; idx++)
+        {
+            TEST_ASSERT_TRUE (compareWords (prev.word, prev.len,
+                                            entry.word, entry.len) < 0);
+            prev = entry;
+        }
+        TEST_ASSERT_EQUAL (idx, 1001);
+
+        /* Same top-X, ties and all, as the dictionary it came from */
+        dict->selectTopX (40, expected);
+        file->selectTopX (40, top_list);
+        TEST_ASSERT_EQUAL (top_list.size (), expected.size ());
+        for (idx = 0; idx < (int) expected.size (); idx++)
+        {
+            TEST_ASSERT_EQUAL (top_list[idx].count, expected[idx].count);
+            TEST_ASSERT_EQUAL (top_list[idx].len, expected[idx].len);
+            TEST_ASSERT_EQUAL (memcmp (top_list[idx].word,
+                                       expected[idx].word,
+                                       expected[idx].len), 0);
+        }
+        file->selectTopX (-1, top_list);
+        TEST_ASSERT_EQUAL (top_list.size (), 1001);
+
+        /*
+         * Reopening replaces the mapping, and an empty dictionary is fine
+         */
+        TEST_ASSERT_TRUE (saveDictFile (*empty, path));
+        TEST_ASSERT_TRUE (file->open (path, TRUE));
+        TEST_ASSERT_EQUAL (file->size (), 0);
+        TEST_ASSERT_EQUAL (file->getWordCount ("apples", 6), -1);
+        file->selectTopX (10, top_list);
+        TEST_ASSERT_EQUAL (top_list.size (), 0);
+
+        delete file;
+        delete empty;
+        delete dict;
+        (void) unlink (path);
+    }
+    void dictFileCorrupt (void)
+    {
+        Word_Dict *dict = new Word_Dict ();
+        Dict_File *file = new Dict_File ();
+        char path[sizeof (TEST_DICT_FILE_TEMPLATE)];
+        FILE *fp = NULL;
+        long file_len = 0;
+        int fd = -1;
+
+        strcpy (path, TEST_DICT_FILE_TEMPLATE);
+        fd = mkstemp (path);
+        TEST_ASSERT_TRUE (fd >= 0);
+        (void) close (fd);
+
+        dict->addOrIncrement ("apples", 6, wordHash ("apples", 6), 3);
+        dict->addOrIncrement ("pears", 5, wordHash ("pears", 5), 2);
+        TEST_ASSERT_TRUE (saveDictFile (*dict, path));
+
+        /*
+         * A damaged count only shows up when the data is verified
+         */
+        fp = fopen (path, "r+b");
+        TEST_ASSERT_NOT_NULL (fp);
+        fseek (fp, 0, SEEK_END);
+        file_len = ftell (fp);
+        fseek (fp, file_len - 12, SEEK_SET);
+        fputc (0x7F, fp);
+        fclose (fp);
+        TEST_ASSERT_TRUE (file->open (path));
+        TEST_ASSERT_FALSE (file->verify ());
+        TEST_ASSERT_FALSE (file->open (path, TRUE));
+        TEST_ASSERT_FALSE (file->isOpen ());
+
+        /* Bad magic */
+        TEST_ASSERT_TRUE (saveDictFile (*dict, path));
+        fp = fopen (path, "r+b");
+        TEST_ASSERT_NOT_NULL (fp);
+        fputc ('X', fp);
+        fclose (fp);
+        TEST_ASSERT_FALSE (file->open (path));
+
+        /* Truncated */
+        TEST_ASSERT_TRUE (saveDictFile (*dict, path));
+        TEST_ASSERT_EQUAL (truncate (path, file_len - 8), 0);
+        TEST_ASSERT_FALSE (file->open (path));
+
+        /* Missing */
+        (void) unlink (path);
+        TEST_ASSERT_FALSE (file->open (path));
+
+        delete file;
+        delete dict;
+    }
+    void dictFilePerfectHash (void)
+    {
+        Word_Dict *dict = new Word_Dict (4, TRUE, DICT_BACKEND_HASH);
+        Dict_File *file = new Dict_File ();
+        Frozen_Dict *frozen = NULL;
+        vector < Dict_Entry_t > expected;
+        vector < Dict_Entry_t > top_list;
+        char path[sizeof (TEST_DICT_FILE_TEMPLATE)];
+        char word[32];
+        int fd = -1;
+        int idx = 0;
+        int len = 0;
+
+        strcpy (path, TEST_DICT_FILE_TEMPLATE);
+        fd = mkstemp (path);
+        TEST_ASSERT_TRUE (fd >= 0);
+        (void) close (fd);
+
+        for (idx = 0; idx < 5000; idx++)
+        {
+            len = snprintf (word, sizeof (word), "p%d", idx);
+            dict->addOrIncrement (word, len, wordHash (word, len),
+                                  (idx % 101) + 1);
+        }
+
+        /*
+         * The mapped file answers as the frozen dictionary it was written
+         * from, and both as the live dictionary
+         */
+        frozen = dict->freeze ();
+        TEST_ASSERT_NOT_NULL (frozen);
+        TEST_ASSERT_TRUE (saveDictFile (*frozen, path));
+        TEST_ASSERT_TRUE (file->open (path, TRUE));
+        TEST_ASSERT_TRUE (file->hasPerfectHash ());
+        TEST_ASSERT_EQUAL (file->size (), 5000);
+        TEST_ASSERT_EQUAL (file->totalCount (), frozen->totalCount ());
+        for (idx = 0; idx < 5000; idx++)
+        {
+            len = snprintf (word, sizeof (word), "p%d", idx);
+            TEST_ASSERT_EQUAL (file->getWordCount (word, len),
+                               (idx % 101) + 1);
+            TEST_ASSERT_EQUAL (frozen->getWordCount (word, len),
+                               (idx % 101) + 1);
+        }
+        TEST_ASSERT_EQUAL (file->getWordCount ("p5000", 5), -1);
+        TEST_ASSERT_EQUAL (file->getWordCount ("q1", 2), -1);
+
+        dict->selectTopX (25, expected);
+        file->selectTopX (25, top_list);
+        TEST_ASSERT_EQUAL (top_list.size (), expected.size ());
+        for (idx = 0; idx < (int) expected.size (); idx++)
+        {
+            TEST_ASSERT_EQUAL (top_list[idx].count, expected[idx].count);
+            TEST_ASSERT_EQUAL (top_list[idx].len, expected[idx].len);
+            TEST_ASSERT_EQUAL (memcmp (top_list[idx].word,
+                                       expected[idx].word,
+                                       expected[idx].len), 0);
+        }
+
+        /* Saving the live dictionary includes the perfect hash too */
+        TEST_ASSERT_TRUE (saveDictFile (*dict, path));
+        TEST_ASSERT_TRUE (file->open (path, TRUE));
+        TEST_ASSERT_TRUE (file->hasPerfectHash ());
+        TEST_ASSERT_EQUAL (file->getWordCount ("p100", 4), 101);
+
+        delete frozen;
+        delete file;
+        delete dict;
+        (void) unlink (path);
+    }
+}
+#endif /* defined(TEST) */
+
+/**
+ *******************************************************************************
+ * @brief saveDictFile - Write a dictionary out in the Dict_File format.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      dict           Dictionary to save, other threads may
+ *                                     keep counting into it.
+ *      @param[in]      path           File to create or replace.
+ *      @param[in]      perfect_hash   If TRUE, include a perfect hash so a
+ *                                     lookup in the file is one probe.
+ *
+ * <!-- Returns -->
+ *      @return TRUE if the whole file was written.
+ *
+ * @par Pre/Post Conditions:
+ *      None (if entry/exit conditions do not apply)
+ *
+ * @par Global Data:
+ *      None (if no global data)
+ *
+ * @par Description:
+ *      Saves a frozen snapshot of 'dict', so the file is consistent per shard
+ *      even while counting goes on.  An approximate dictionary saves its
+ *      heavy hitters at their estimated counts.
+ *******************************************************************************
+ */
+Bool_t saveDictFile (Word_Dict & dict, const char *path, Bool_t perfect_hash)
+{
+    Frozen_Dict *table = dict.freeze (perfect_hash);
+    Bool_t saved = FALSE;
+
+    if (table == NULL)
+    {
+        fprintf (stderr, "[%s, %d:%s] failed to freeze the dictionary\n",
+                 __FILE__, __LINE__, __FUNCTION__);
+        return (FALSE);
+    }
+    saved = saveDictFile (*table, path);
+    delete table;
+    return (saved);
+}
+
+/**
+ *******************************************************************************
+ * @brief saveDictFile - Write a frozen dictionary's arrays out as a Dict_File.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      table          Dictionary to save.
+ *      @param[in]      path           File to create or replace.
+ *
+ * <!-- Returns -->
+ *      @return TRUE if the whole file was written.
+ *
+ * @par Description:
+ *      The arrays are written as they are, all sorting and hashing was done
+ *      by Frozen_Dict::build(), so a reader never has to.
+ *******************************************************************************
+ */
+Bool_t saveDictFile (Frozen_Dict & table, const char *path)
+{
+    Perfect_Hash & hash = table.perfectHash ();
+    uint64_t num_words = table.size ();
+    uint64_t mph_words = (table.hasPerfectHash () == TRUE) ?
+        hash.numWords () : 0;
+    Dict_File_Header_t header;
+    Dict_File_Sum_t sum = { 0, 0 };
+    FILE *fp = NULL;
+    Bool_t saved = FALSE;
+
+    if (num_words >= DICT_FILE_MAX_WORDS)
+    {
+        fprintf (stderr, "[%s, %d:%s] %lu words is too many to save\n",
+                 __FILE__, __LINE__, __FUNCTION__, (unsigned long) num_words);
+        return (FALSE);
+    }
+
+    memset (&header, 0, sizeof (header));
+    memcpy (header.magic, DICT_FILE_MAGIC, sizeof (header.magic));
+    header.version = DICT_FILE_VERSION;
+    header.byte_order = DICT_FILE_BYTE_ORDER;
+    header.num_words = num_words;
+    header.total_count = table.totalCount ();
+    header.keys_offset = alignUp (sizeof (header));
+    header.keys_bytes = table.keyBytes ();
+    header.offsets_offset = header.keys_offset + alignUp (header.keys_bytes);
+    header.counts_offset =
+        header.offsets_offset + alignUp ((num_words + 1) * sizeof (uint64_t));
+    header.ranks_offset =
+        header.counts_offset + alignUp (num_words * sizeof (uint32_t));
+    header.mph_offset =
+        header.ranks_offset + alignUp (num_words * sizeof (uint32_t));
+    header.mph_words = mph_words;
+    header.file_bytes = header.mph_offset + mph_words * sizeof (uint64_t);
+
+    checksumSection (&sum, table.keys (), header.keys_bytes);
+    checksumSection (&sum, table.offsets (),
+                     (num_words + 1) * sizeof (uint64_t));
+    checksumSection (&sum, table.counts (), num_words * sizeof (uint32_t));
+    checksumSection (&sum, table.ranks (), num_words * sizeof (uint32_t));
+    checksumSection (&sum, hash.words (), mph_words * sizeof (uint64_t));
+    header.data_checksum = checksumValue (&sum);
+    header.header_checksum = headerChecksum (&header);
+
+    fp = fopen (path, "wb");
+    if (fp == NULL)
+    {
+        fprintf (stderr, "[%s, %d:%s] failed to create %s, errno=%d, %s\n",
+                 __FILE__, __LINE__, __FUNCTION__, path, errno,
+                 strerror (errno));
+        goto cleanup;
+    }
+    if ((writeSection (fp, &header, sizeof (header)) == FALSE) ||
+        (writeSection (fp, table.keys (), header.keys_bytes) == FALSE) ||
+        (writeSection (fp, table.offsets (),
+                       (num_words + 1) * sizeof (uint64_t)) == FALSE) ||
+        (writeSection (fp, table.counts (),
+                       num_words * sizeof (uint32_t)) == FALSE) ||
+        (writeSection (fp, table.ranks (),
+                       num_words * sizeof (uint32_t)) == FALSE) ||
+        (writeSection (fp, hash.words (),
+                       mph_words * sizeof (uint64_t)) == FALSE))
+    {
+        fprintf (stderr, "[%s, %d:%s] failed writing %s, errno=%d, %s\n",
+                 __FILE__, __LINE__, __FUNCTION__, path, errno,
+                 strerror (errno));
+        goto cleanup;
+    }
+    saved = TRUE;
+
+  cleanup:
+    if ((fp != NULL) && (fclose (fp) != 0))
+    {
+        saved = FALSE;
+    }
+    return (saved);
+}
+
+/**
+ *******************************************************************************
+ * @brief Dict_File - Constructor
+ *******************************************************************************
+ */
+Dict_File::Dict_File (void)
+{
+    _fd = -1;
+    _map = NULL;
+    _mapBytes = 0;
+    _header = NULL;
+}
+
+/**
+ *******************************************************************************
+ * @brief ~Dict_File - Destructor
+ *******************************************************************************
+ */
+Dict_File::~Dict_File (void)
+{
+    close ();
+}
+
+/**
+ *******************************************************************************
+ * @brief open - Map a dictionary file for reading, closing any file already
+ * open.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      path           File written by saveDictFile().
+ *      @param[in]      verify         If TRUE, also check the data checksum
+ *                                     and the offsets, which reads the whole
+ *                                     file.
+ *
+ * <!-- Returns -->
+ *      @return TRUE if the file is open and usable.
+ *
+ * @par Pre/Post Conditions:
+ *      None (if entry/exit conditions do not apply)
+ *
+ * @par Global Data:
+ *      None (if no global data)
+ *
+ * @par Description:
+ *      Without 'verify' only the header is read, and checked against its own
+ *      checksum and the file size, so opening is constant time.
+ *******************************************************************************
+ */
+Bool_t Dict_File::open (const char *path, Bool_t verify)
+{
+    struct stat file_stat;
+
+    close ();
+    _fd = ::open (path, O_RDONLY);
+    if (_fd == -1)
+    {
+        fprintf (stderr, "[%s, %d:%s] failed to open %s, errno=%d, %s\n",
+                 __FILE__, __LINE__, __FUNCTION__, path, errno,
+                 strerror (errno));
+        goto error;
+    }
+    if ((fstat (_fd, &file_stat) != 0) ||
+        ((size_t) file_stat.st_size < sizeof (Dict_File_Header_t)))
+    {
+        fprintf (stderr, "[%s, %d:%s] %s is not a dictionary file\n",
+                 __FILE__, __LINE__, __FUNCTION__, path);
+        goto error;
+    }
+    _mapBytes = (size_t) file_stat.st_size;
+    _map = mmap (NULL, _mapBytes, PROT_READ, MAP_SHARED, _fd, 0);
+    if (_map == MAP_FAILED)
+    {
+        _map = NULL;
+        fprintf (stderr, "[%s, %d:%s] failed to map %s, errno=%d, %s\n",
+                 __FILE__, __LINE__, __FUNCTION__, path, errno,
+                 strerror (errno));
+        goto error;
+    }
+    _header = (const Dict_File_Header_t *) _map;
+    if (_checkHeader (path) == FALSE)
+    {
+        goto error;
+    }
+    if (_table.attach ((const char *) _map + _header->keys_offset,
+                       _header->keys_bytes,
+                       (const uint64_t *) ((const char *) _map +
+                                           _header->offsets_offset),
+                       (const uint32_t *) ((const char *) _map +
+                                           _header->counts_offset),
+                       (const uint32_t *) ((const char *) _map +
+                                           _header->ranks_offset),
+                       _header->num_words,
+                       (_header->mph_words == 0) ? NULL :
+                       (const uint64_t *) ((const char *) _map +
+                                           _header->mph_offset),
+                       (size_t) _header->mph_words) == FALSE)
+    {
+        fprintf (stderr, "[%s, %d:%s] %s has a bad perfect hash\n",
+                 __FILE__, __LINE__, __FUNCTION__, path);
+        goto error;
+    }
+
+    if ((verify == TRUE) && (this->verify () == FALSE))
+    {
+        fprintf (stderr, "[%s, %d:%s] %s is damaged\n",
+                 __FILE__, __LINE__, __FUNCTION__, path);
+        goto error;
+    }
+    return (TRUE);
+
+  error:
+    close ();
+    return (FALSE);
+}
+
+/**
+ *******************************************************************************
+ * @brief close - Unmap and close the file, if one is open.
+ *******************************************************************************
+ */
+void Dict_File::close (void)
+{
+    if (_map != NULL)
+    {
+        (void) munmap (_map, _mapBytes);
+    }
+    if (_fd != -1)
+    {
+        (void) ::close (_fd);
+    }
+    _fd = -1;
+    _map = NULL;
+    _mapBytes = 0;
+    _header = NULL;
+    (void) _table.attach (NULL, 0, NULL, NULL, NULL, 0, NULL, 0);
+}
+
+/**
+ *******************************************************************************
+ * @brief verify - Check every byte of the open file against its checksum, and
+ * that every array is consistent (Frozen_Dict::check()).
+ *
+ * <!-- Returns -->
+ *      @return TRUE if the file is intact.
+ *******************************************************************************
+ */
+Bool_t Dict_File::verify (void)
+{
+    Dict_File_Sum_t sum = { 0, 0 };
+
+    if (_header == NULL)
+    {
+        return (FALSE);
+    }
+    checksumSection (&sum, (const char *) _map + _header->keys_offset,
+                     _header->file_bytes - _header->keys_offset);
+    if (checksumValue (&sum) != _header->data_checksum)
+    {
+        return (FALSE);
+    }
+    return (_table.check ());
+}
+
+/**
+ *******************************************************************************
+ * @brief totalCount - Sum of the counts of every word in the file.
+ *******************************************************************************
+ */
+uint64_t Dict_File::totalCount (void)
+{
+    return ((_header != NULL) ? _header->total_count : 0);
+}
+
+/*******************************************************************************
+ ************************ L O C A L  F U N C T I O N S *************************
+ *******************************************************************************
+ */
+
+/**
+ *******************************************************************************
+ * @brief _checkHeader - Check the mapped header describes this file.
+ *
+ * @par Description:
+ *      Every section must be aligned, in order, and inside the file, and the
+ *      header must match its checksum.  Reports the first problem found.
+ *******************************************************************************
+ */
+Bool_t Dict_File::_checkHeader (const char *path)
+{
+    const Dict_File_Header_t *hdr = _header;
+    const char *problem = NULL;
+
+    if (memcmp (hdr->magic, DICT_FILE_MAGIC, sizeof (hdr->magic)) != 0)
+    {
+        problem = "is not a dictionary file";
+    }
+    else if (hdr->byte_order != DICT_FILE_BYTE_ORDER)
+    {
+        problem = "was written with a different byte order";
+    }
+    else if (hdr->version != DICT_FILE_VERSION)
+    {
+        problem = "is an unsupported version";
+    }
+    else if (hdr->header_checksum != headerChecksum (hdr))
+    {
+        problem = "has a damaged header";
+    }
+    else if ((hdr->file_bytes != _mapBytes) ||
+             (hdr->num_words >= DICT_FILE_MAX_WORDS) ||
+             (hdr->keys_offset != alignUp (sizeof (*hdr))) ||
+             (hdr->offsets_offset !=
+              hdr->keys_offset + alignUp (hdr->keys_bytes)) ||
+             (hdr->counts_offset != hdr->offsets_offset +
+              alignUp ((hdr->num_words + 1) * sizeof (uint64_t))) ||
+             (hdr->ranks_offset != hdr->counts_offset +
+              alignUp (hdr->num_words * sizeof (uint32_t))) ||
+             (hdr->mph_offset != hdr->ranks_offset +
+              alignUp (hdr->num_words * sizeof (uint32_t))) ||
+             (hdr->file_bytes != hdr->mph_offset +
+              hdr->mph_words * sizeof (uint64_t)))
+    {
+        problem = "is truncated or has a bad layout";
+    }
+
+    if (problem != NULL)
+    {
+        fprintf (stderr, "[%s, %d:%s] %s %s\n", __FILE__, __LINE__,
+                 __FUNCTION__, path, problem);
+        return (FALSE);
+    }
+    return (TRUE);
+}
+
+/**
+ *******************************************************************************
+ * @brief alignUp - Round a byte count up to DICT_FILE_ALIGN.
+ *******************************************************************************
+ */
+static uint64_t alignUp (uint64_t bytes)
+{
+    return ((bytes + DICT_FILE_ALIGN - 1) & ~((uint64_t) DICT_FILE_ALIGN - 1));
+}
+
+/**
+ *******************************************************************************
+ * @brief checksumSection - Add one section, as padded in the file, to a
+ * running checksum.
+ *
+ * <!-- Parameters -->
+ *      @param[in,out]  sum            Running checksum
+ *      @param[in]      data           Section bytes, may be NULL if 'len' is 0
+ *      @param[in]      len            Section length before padding
+ *
+ * @par Algorithm:
+ *      Fletcher-style over 32-bit words: low sums the words, high sums the
+ *      running values of low, so the order of words matters too.  Bytes past
+ *      'len' up to DICT_FILE_ALIGN count as zeros, as they are in the file,
+ *      which makes the checksum of consecutive sections equal that of the
+ *      file bytes they occupy.
+ *******************************************************************************
+ */
+static void checksumSection (Dict_File_Sum_t * sum, const void *data,
+                             uint64_t len)
+{
+    const unsigned char *bytes = (const unsigned char *) data;
+    uint64_t padded = alignUp (len);
+    uint64_t idx = 0;
+    uint32_t word = 0;
+
+    for (idx = 0; idx + sizeof (word) <= len; idx += sizeof (word))
+    {
+        memcpy (&word, bytes + idx, sizeof (word));
+        sum->low += word;
+        sum->high += sum->low;
+    }
+    for (; idx < padded; idx += sizeof (word))
+    {
+        word = 0;
+        if (idx < len)
+        {
+            memcpy (&word, bytes + idx, (size_t) (len - idx));
+        }
+        sum->low += word;
+        sum->high += sum->low;
+    }
+}
+
+/**
+ *******************************************************************************
+ * @brief checksumValue - Fold a running checksum into one value.
+ *******************************************************************************
+ */
+static uint64_t checksumValue (const Dict_File_Sum_t * sum)
+{
+    return (sum->low ^ (sum->high << 32) ^ (sum->high >> 32));
+}
+
+/**
+ *******************************************************************************
+ * @brief headerChecksum - Checksum of a header, taken with its
+ * header_checksum field zeroed.
+ *******************************************************************************
+ */
+static uint64_t headerChecksum (const Dict_File_Header_t * header)
+{
+    Dict_File_Header_t copy = *header;
+    Dict_File_Sum_t sum = { 0, 0 };
+
+    copy.header_checksum = 0;
+    checksumSection (&sum, &copy, sizeof (copy));
+    return (checksumValue (&sum));
+}
+
+/**
+ *******************************************************************************
+ * @brief writeSection - Write one section, zero padded to DICT_FILE_ALIGN.
+ *
+ * <!-- Returns -->
+ *      @return TRUE if every byte was written.
+ *******************************************************************************
+ */
+static Bool_t writeSection (FILE * fp, const void *data, uint64_t len)
+{
+    static const char ZEROS[DICT_FILE_ALIGN] = { 0 };
+    size_t pad = (size_t) (alignUp (len) - len);
+
+    if ((len > 0) && (fwrite (data, 1, (size_t) len, fp) != (size_t) len))
+    {
+        return (FALSE);
+    }
+    if ((pad > 0) && (fwrite (ZEROS, 1, pad, fp) != pad))
+    {
+        return (FALSE);
+    }
+    return (TRUE);
+}
@@ -0,0 +1,213 @@
+#ifndef __DICT_FILE_H__
+#define __DICT_FILE_H__
+/**
+ * @file           dict_file.hpp
+ * @brief:         Memory-mappable on-disk dictionary format.
+ * @verbatim
+ *******************************************************************************
+ * Author:         Douglas L. Potts
+ *
+ * Date:           10/17/2026, <SCR #>
+ *
+ *==============================================================================
+ *==============================================================================
+ * Copyright (c) 2015 Douglas Lee Potts
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ *==============================================================================
+ *==============================================================================
+ *
+ * History:
+ * Date        SCR #  Name  Description
+ * -----------------------------------------------------------------------------
+ *
+ *******************************************************************************
+ * @endverbatim
+ */
+
+/*******************************************************************************
+ * System Includes
+ *******************************************************************************
+ */
+#include <stddef.h>             /* for size_t */
+#include <stdint.h>             /* for uint64_t */
+#include <vector>
+
+/*******************************************************************************
+ * Project Includes
+ *******************************************************************************
+ */
+#include "common_types.h"
+#include "word_hash.h"
+#include "dict_store.hpp"
+#include "word_dict.hpp"
+#include "frozen_dict.hpp"
+
+#if defined(TEST)
+extern "C"
+{
+    void dictFileSaveLoad (void);
+    void dictFileCorrupt (void);
+    void dictFilePerfectHash (void);
+}
+#endif                          /* defined(TEST) */
+
+/*******************************************************************************
+ * Typedefs
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * Constants
+ *******************************************************************************
+ */
+/** First 8 bytes of every dictionary file */
+#define DICT_FILE_MAGIC      "SSFIDICT"
+/** Format version written, and the only one read */
+#define DICT_FILE_VERSION    (2)
+/** Written in native byte order, reads back differently on a foreign host */
+#define DICT_FILE_BYTE_ORDER (0x01020304U)
+/** Every section starts on this boundary, and is zero padded up to it */
+#define DICT_FILE_ALIGN      (8)
+
+/*******************************************************************************
+ * Structures
+ *******************************************************************************
+ */
+using namespace std;
+
+/**
+ * Start of a dictionary file.  All offsets are from the start of the file.
+ *
+ * File layout, each section DICT_FILE_ALIGN aligned:
+ *      header
+ *      keys      every word concatenated without separators
+ *      offsets   num_words + 1 uint64_t, word i is keys[offsets[i]] up to
+ *                keys[offsets[i + 1]]
+ *      counts    num_words uint32_t, count of word i
+ *      ranks     num_words uint32_t, word indices by descending count (ties
+ *                in word order), so top-X is a prefix of this array
+ *      mph       mph_words uint64_t, a Perfect_Hash placing word i at slot i,
+ *                or empty if the words are sorted bytewise instead
+ *
+ * These are the arrays of a Frozen_Dict, which serves them from the mapping.
+ *
+ * Numbers are in the writer's byte order, byte_order tells a reader whether
+ * that is its own.
+ */
+typedef struct
+{
+    char magic[8];              /**< DICT_FILE_MAGIC, not nul terminated */
+    uint32_t version;           /**< DICT_FILE_VERSION */
+    uint32_t byte_order;        /**< DICT_FILE_BYTE_ORDER */
+    uint64_t file_bytes;        /**< Size of the whole file */
+    uint64_t num_words;         /**< Distinct words in the file */
+    uint64_t total_count;       /**< Sum of all counts */
+    uint64_t keys_offset;       /**< Start of the key blob */
+    uint64_t keys_bytes;        /**< Length of the key blob, without padding */
+    uint64_t offsets_offset;    /**< Start of the offsets array */
+    uint64_t counts_offset;     /**< Start of the counts array */
+    uint64_t ranks_offset;      /**< Start of the ranks array */
+    uint64_t mph_offset;        /**< Start of the perfect hash words */
+    uint64_t mph_words;         /**< Number of perfect hash words, 0 if none */
+    uint64_t data_checksum;     /**< Checksum of every byte after the header */
+    uint64_t header_checksum;   /**< Checksum of the header, this field 0 */
+} Dict_File_Header_t;
+
+/**
+ * Read-only dictionary loaded from a file written by saveDictFile().
+ *
+ * The file is mapped, never read or parsed, so opening costs the same for any
+ * size of dictionary, and pages are only faulted in as lookups touch them.
+ * A word lookup is one probe of the perfect hash, or a binary search of the
+ * sorted keys in a file saved without one, and top-X reads the first X
+ * entries of the precomputed ranks.
+ */
+class Dict_File
+{
+  public:
+    Dict_File (void);
+    virtual ~ Dict_File (void);
+
+    Bool_t open (const char *path, Bool_t verify = FALSE);
+    void close (void);
+    Bool_t isOpen (void)
+    {
+        return ((this->_header != NULL) ? TRUE : FALSE);
+    };
+    Bool_t verify (void);
+
+    size_t size (void)
+    {
+        return (this->_table.size ());
+    };
+    uint64_t totalCount (void);
+    Bool_t hasPerfectHash (void)
+    {
+        return (this->_table.hasPerfectHash ());
+    };
+    Frozen_Dict & table (void)
+    {
+        return (this->_table);
+    };
+    Bool_t entry (size_t idx, Dict_Entry_t * entry)
+    {
+        return (this->_table.entry (idx, entry));
+    };
+    int getWordCount (const char *word, size_t len)
+    {
+        return (this->_table.getWordCount (word, len));
+    };
+    void selectTopX (int top_X_counts, vector < Dict_Entry_t > &top_list)
+    {
+        this->_table.selectTopX (top_X_counts, top_list);
+    };
+    void printTopX (int top_X_counts)
+    {
+        this->_table.printTopX (top_X_counts);
+    };
+
+  private:
+    int _fd;
+    void *_map;
+    size_t _mapBytes;
+    const Dict_File_Header_t *_header;
+    Frozen_Dict _table;
+
+    Bool_t _checkHeader (const char *path);
+};
+
+/*******************************************************************************
+ * Unions
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * External Function Prototypes
+ *******************************************************************************
+ */
+Bool_t saveDictFile (Frozen_Dict & table, const char *path);
+Bool_t saveDictFile (Word_Dict & dict, const char *path,
+                     Bool_t perfect_hash = TRUE);
+
+/*******************************************************************************
+ * Global Variables
+ *******************************************************************************
+ */
+#if _MAIN_
+#define GLOBAL_VAR_DECLARE
+#else
+#define GLOBAL_VAR_DECLARE extern
+#endif /* _MAIN_ */
+
+#endif /* __DICT_FILE_H__ */
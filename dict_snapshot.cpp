@@ -0,0 +1,432 @@
+/**
+ * @file           dict_snapshot.cpp
+ * @brief:         Read-only snapshot views of a Word_Dict.
+ * @verbatim
+ *******************************************************************************
+ * Author:         Douglas L. Potts
+ *
+ * Date:           10/17/2026, <SCR #>
+ *
+ *==============================================================================
+ *==============================================================================
+ * Copyright (c) 2015 Douglas Lee Potts
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ *==============================================================================
+ *==============================================================================
+ *
+ * History:
+ * Date        SCR #  Name  Description
+ * -----------------------------------------------------------------------------
+ *
+ *******************************************************************************
+ * @endverbatim
+ */
+
+/*******************************************************************************
+ * System Includes
+ *******************************************************************************
+ */
+#include <stdio.h>              /* for snprintf() */
+#include <string.h>             /* for memcmp() */
+#include <algorithm>            /* for std::sort, std::lower_bound */
+
+/*******************************************************************************
+ * Project Includes
+ *******************************************************************************
+ */
+#include "common_types.h"
+#include "dict_snapshot.hpp"
+#if defined(TEST)
+#include "unity.h"
+#endif /* defined(TEST) */
+
+/*******************************************************************************
+ * Local Function Prototypes 
+ *******************************************************************************
+ */
+static bool viewEntryHashBefore (const Dict_View_Entry_t & left,
+                                 const Dict_View_Entry_t & right);
+
+/*******************************************************************************
+ * Local Constants 
+ *******************************************************************************
+ */
+#define DBG(X)
+
+/*******************************************************************************
+ * File Scoped Variables 
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ ********************* E X T E R N A L  F U N C T I O N S **********************
+ *******************************************************************************
+ */
+
+#if defined(TEST)
+extern "C"
+{
+
+    void dictShardViewFind (void)
+    {
+        Dict_Store *store = newDictStore (DICT_BACKEND_HASH);
+        Dict_Shard_View *view = NULL;
+        Dict_Entry_t entry;
+        char word[32];
+        int idx = 0;
+        int len = 0;
+        int total = 0;
+
+        for (idx = 0; idx < 500; idx++)
+        {
+            len = snprintf (word, sizeof (word), "w%d", idx);
+            *store->findOrInsert (word, len, wordHash (word, len)) = idx + 1;
+        }
+        view = new Dict_Shard_View (*store);
+
+        /*
+         * The view doesn't follow the store
+         */
+        *store->findOrInsert ("w0", 2, wordHash ("w0", 2)) = 1000;
+        store->clear ();
+
+        TEST_ASSERT_EQUAL (view->size (), 500);
+        for (idx = 0; idx < 500; idx++)
+        {
+            len = snprintf (word, sizeof (word), "w%d", idx);
+            TEST_ASSERT_EQUAL (view->find (word, len, wordHash (word, len)),
+                               idx + 1);
+        }
+        TEST_ASSERT_EQUAL (view->find ("w500", 4, wordHash ("w500", 4)), 0);
+        TEST_ASSERT_EQUAL (view->find ("w4", 2, wordHash ("w45", 3)), 0);
+
+        for (idx = 0; view->entry (idx, &entry) == TRUE; idx++)
+        {
+            total += entry.count;
+            TEST_ASSERT_EQUAL (entry.hash, wordHash (entry.word, entry.len));
+        }
+        TEST_ASSERT_EQUAL (idx, 500);
+        TEST_ASSERT_EQUAL (total, 500 * 501 / 2);
+
+        /*
+         * Still usable while a second holder has it
+         */
+        view->acquire ();
+        view->release ();
+        TEST_ASSERT_EQUAL (view->find ("w7", 2, wordHash ("w7", 2)), 8);
+        view->release ();
+
+        delete store;
+    }
+}
+#endif /* defined(TEST) */
+
+/**
+ *******************************************************************************
+ * @brief Dict_Shard_View - Constructor, copying every word of a store.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      store          Store to copy, its cursor is left at
+ *                                     the end.
+ *
+ * <!-- Returns -->
+ *      None (if return type is void)
+ *
+ * @par Pre/Post Conditions:
+ *      @pre     The caller keeps 'store' from changing during the copy.
+ *      @post    The view has one reference, owned by the caller.
+ *******************************************************************************
+ */
+Dict_Shard_View::Dict_Shard_View (Dict_Store & store)
+{
+    Dict_Entry_t entry;
+
+    (void) pthread_mutex_init (&_mut, NULL);
+    _refs = 1;
+    _entries.reserve (store.size ());
+    store.rewind ();
+    while (store.next (&entry) == TRUE)
+    {
+        _append (entry);
+    }
+    _index ();
+}
+
+/**
+ *******************************************************************************
+ * @brief Dict_Shard_View - Constructor, copying a list of entries.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      entries        Words to copy, for instance the heavy
+ *                                     hitters of an approximate dictionary.
+ *******************************************************************************
+ */
+Dict_Shard_View::Dict_Shard_View (vector < Dict_Entry_t > &entries)
+{
+    size_t idx = 0;
+
+    (void) pthread_mutex_init (&_mut, NULL);
+    _refs = 1;
+    _entries.reserve (entries.size ());
+    for (idx = 0; idx < entries.size (); idx++)
+    {
+        _append (entries[idx]);
+    }
+    _index ();
+}
+
+/**
+ *******************************************************************************
+ * @brief ~Dict_Shard_View - Destructor, only reached through release().
+ *******************************************************************************
+ */
+Dict_Shard_View::~Dict_Shard_View (void)
+{
+    (void) pthread_mutex_destroy (&_mut);
+}
+
+/**
+ *******************************************************************************
+ * @brief acquire - Take another reference to the view.
+ *******************************************************************************
+ */
+void Dict_Shard_View::acquire (void)
+{
+    (void) pthread_mutex_lock (&_mut);
+    _refs++;
+    (void) pthread_mutex_unlock (&_mut);
+}
+
+/**
+ *******************************************************************************
+ * @brief release - Drop a reference to the view, deleting it with the last.
+ *
+ * @par Pre/Post Conditions:
+ *      @post    The caller must not use the view again.
+ *******************************************************************************
+ */
+void Dict_Shard_View::release (void)
+{
+    int refs = 0;
+
+    (void) pthread_mutex_lock (&_mut);
+    refs = --_refs;
+    (void) pthread_mutex_unlock (&_mut);
+    if (refs == 0)
+    {
+        delete this;
+    }
+}
+
+/**
+ *******************************************************************************
+ * @brief entry - Fetch the idx'th word of the view.
+ *
+ * <!-- Returns -->
+ *      @return TRUE if filled in, FALSE once idx is past the last word.
+ *
+ * @par Pre/Post Conditions:
+ *      @post    entry->word is NOT nul terminated, and is valid for as long
+ *               as the caller holds its reference to the view.
+ *******************************************************************************
+ */
+Bool_t Dict_Shard_View::entry (size_t idx, Dict_Entry_t * entry)
+{
+    if ((entry == NULL) || (idx >= _entries.size ()))
+    {
+        return (FALSE);
+    }
+    entry->word = _keys.data () + _entries[idx].offset;
+    entry->len = _entries[idx].len;
+    entry->hash = _entries[idx].hash;
+    entry->count = _entries[idx].count;
+    return (TRUE);
+}
+
+/**
+ *******************************************************************************
+ * @brief find - Count of a word as of the view, 0 if it is not in the view.
+ *
+ * @par Algorithm:
+ *      Binary search for the first entry with the word's hash, then compare
+ *      bytes across the (nearly always one entry) run of equal hashes.
+ *******************************************************************************
+ */
+int Dict_Shard_View::find (const char *word, size_t len, Word_Hash_t hash)
+{
+    Dict_View_Entry_t key;
+    vector < Dict_View_Entry_t >::iterator it;
+
+    key.hash = hash;
+    it = lower_bound (_entries.begin (), _entries.end (), key,
+                      viewEntryHashBefore);
+    for (; (it != _entries.end ()) && (it->hash == hash); ++it)
+    {
+        if ((it->len == len) &&
+            (memcmp (_keys.data () + it->offset, word, len) == 0))
+        {
+            return (it->count);
+        }
+    }
+    return (0);
+}
+
+/**
+ *******************************************************************************
+ * @brief Dict_Snapshot - Constructor
+ *
+ * <!-- Parameters -->
+ *      @param[in]      views          One view per dictionary shard, in shard
+ *                                     order.  The snapshot takes over the
+ *                                     caller's reference to each.
+ *******************************************************************************
+ */
+Dict_Snapshot::Dict_Snapshot (vector < Dict_Shard_View * >&views)
+{
+    _views = views;
+    _itShard = 0;
+    _itEntry = 0;
+}
+
+/**
+ *******************************************************************************
+ * @brief ~Dict_Snapshot - Destructor, releases the shard views.
+ *******************************************************************************
+ */
+Dict_Snapshot::~Dict_Snapshot (void)
+{
+    size_t idx = 0;
+
+    for (idx = 0; idx < _views.size (); idx++)
+    {
+        _views[idx]->release ();
+    }
+    _views.clear ();
+}
+
+/**
+ *******************************************************************************
+ * @brief begin - Set the snapshot's cursor to its first word.
+ *******************************************************************************
+ */
+void Dict_Snapshot::begin (void)
+{
+    _itShard = 0;
+    _itEntry = 0;
+}
+
+/**
+ *******************************************************************************
+ * @brief getNextEntry - Using the snapshot's cursor, get the next word and
+ * its count.
+ *
+ * <!-- Returns -->
+ *      @return TRUE if an entry was returned, FALSE past the last word.
+ *
+ * @par Pre/Post Conditions:
+ *      @post    entry->word is NOT nul terminated, and is valid for the life
+ *               of the snapshot, whatever happens to the dictionary.
+ *******************************************************************************
+ */
+Bool_t Dict_Snapshot::getNextEntry (Dict_Entry_t * entry)
+{
+    while (_itShard < _views.size ())
+    {
+        if (_views[_itShard]->entry (_itEntry, entry) == TRUE)
+        {
+            _itEntry++;
+            return (TRUE);
+        }
+        _itShard++;
+        _itEntry = 0;
+    }
+    return (FALSE);
+}
+
+/**
+ *******************************************************************************
+ * @brief getWordCount - Count of a word as of the snapshot, 0 if absent.
+ *******************************************************************************
+ */
+int Dict_Snapshot::getWordCount (const char *word, size_t len)
+{
+    Word_Hash_t hash = wordHash (word, len);
+
+    if (_views.size () == 0)
+    {
+        return (0);
+    }
+    return (_views[wordHashRange (hash, (unsigned int) _views.size ())]->
+            find (word, len, hash));
+}
+
+/**
+ *******************************************************************************
+ * @brief size - Number of distinct words in the snapshot.
+ *******************************************************************************
+ */
+size_t Dict_Snapshot::size (void)
+{
+    size_t idx = 0;
+    size_t total = 0;
+
+    for (idx = 0; idx < _views.size (); idx++)
+    {
+        total += _views[idx]->size ();
+    }
+    return (total);
+}
+
+/*******************************************************************************
+ ************************ L O C A L  F U N C T I O N S *************************
+ *******************************************************************************
+ */
+
+/**
+ *******************************************************************************
+ * @brief _append - Copy one word onto the end of the view.
+ *******************************************************************************
+ */
+void Dict_Shard_View::_append (const Dict_Entry_t & entry)
+{
+    Dict_View_Entry_t copy;
+
+    copy.offset = _keys.size ();
+    copy.len = entry.len;
+    copy.hash = entry.hash;
+    copy.count = entry.count;
+    _keys.append (entry.word, entry.len);
+    _entries.push_back (copy);
+}
+
+/**
+ *******************************************************************************
+ * @brief _index - Order the entries by hash, for find().
+ *******************************************************************************
+ */
+void Dict_Shard_View::_index (void)
+{
+    sort (_entries.begin (), _entries.end (), viewEntryHashBefore);
+}
+
+/**
+ *******************************************************************************
+ * @brief viewEntryHashBefore - Ordering of view entries by hash.
+ *******************************************************************************
+ */
+static bool viewEntryHashBefore (const Dict_View_Entry_t & left,
+                                 const Dict_View_Entry_t & right)
+{
+    return (left.hash < right.hash);
+}
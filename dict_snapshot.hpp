@@ -0,0 +1,187 @@
+#ifndef __DICT_SNAPSHOT_H__
+#define __DICT_SNAPSHOT_H__
+/**
+ * @file           dict_snapshot.hpp
+ * @brief:         Read-only snapshot views of a Word_Dict.
+ * @verbatim
+ *******************************************************************************
+ * Author:         Douglas L. Potts
+ *
+ * Date:           10/17/2026, <SCR #>
+ *
+ *==============================================================================
+ *==============================================================================
+ * Copyright (c) 2015 Douglas Lee Potts
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ *==============================================================================
+ *==============================================================================
+ *
+ * History:
+ * Date        SCR #  Name  Description
+ * -----------------------------------------------------------------------------
+ *
+ *******************************************************************************
+ * @endverbatim
+ */
+
+/*******************************************************************************
+ * System Includes
+ *******************************************************************************
+ */
+#include <pthread.h>            /* for pthread_* calls */
+#include <stddef.h>             /* for size_t */
+#include <string>
+#include <vector>
+
+/*******************************************************************************
+ * Project Includes
+ *******************************************************************************
+ */
+#include "common_types.h"
+#include "word_hash.h"
+#include "dict_store.hpp"
+
+#if defined(TEST)
+extern "C"
+{
+    void dictShardViewFind (void);
+}
+#endif                          /* defined(TEST) */
+
+/*******************************************************************************
+ * Typedefs
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * Constants
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * Structures
+ *******************************************************************************
+ */
+using namespace std;
+
+/** One word of a Dict_Shard_View, its bytes are in the view's key blob */
+typedef struct
+{
+    size_t offset;              /**< Offset of the word in the key blob */
+    size_t len;                 /**< Length of the word in bytes */
+    Word_Hash_t hash;           /**< wordHash() of the word */
+    int count;                  /**< Count when the view was taken */
+} Dict_View_Entry_t;
+
+/**
+ * Immutable copy of the words of one dictionary shard.
+ *
+ * A Word_Dict keeps the view of each shard it last copied, and hands the same
+ * view to every snapshot taken until that shard is next written.  Views are
+ * reference counted, the last release() deletes the view, so a shard's view
+ * may outlive both the dictionary's interest in it and the dictionary.
+ *
+ * Entries are ordered by hash for lookup, iteration order is unspecified.
+ */
+class Dict_Shard_View
+{
+  public:
+    Dict_Shard_View (Dict_Store & store);
+    Dict_Shard_View (vector < Dict_Entry_t > &entries);
+
+    void acquire (void);
+    void release (void);
+
+    size_t size (void)
+    {
+        return (this->_entries.size ());
+    };
+    Bool_t entry (size_t idx, Dict_Entry_t * entry);
+    int find (const char *word, size_t len, Word_Hash_t hash);
+
+    /** Bytes held by the copied keys and entries */
+    size_t bytesUsed (void)
+    {
+        return (this->_keys.capacity () +
+                this->_entries.capacity () * sizeof (Dict_View_Entry_t));
+    };
+
+  private:
+    /* Only release() may delete a view */
+    ~Dict_Shard_View (void);
+
+    pthread_mutex_t _mut;
+    int _refs;
+    string _keys;
+    vector < Dict_View_Entry_t > _entries;
+
+    void _append (const Dict_Entry_t & entry);
+    void _index (void);
+};
+
+/**
+ * Point in time, read-only view of a Word_Dict, from Word_Dict::snapshot().
+ *
+ * A snapshot holds one Dict_Shard_View per shard, so reading it takes no
+ * dictionary locks, and writers carry on counting while any number of
+ * snapshots are iterated or queried.  Each snapshot has its own cursor, and is
+ * meant to be used by one thread.  Each shard is copied at its own instant,
+ * so counts in different shards may be a few updates apart.
+ */
+class Dict_Snapshot
+{
+  public:
+    Dict_Snapshot (vector < Dict_Shard_View * >&views);
+    virtual ~ Dict_Snapshot (void);
+
+    void begin (void);
+    Bool_t getNextEntry (Dict_Entry_t * entry);
+    int getWordCount (const char *word, size_t len);
+    size_t size (void);
+    unsigned int getNumShards (void)
+    {
+        return ((unsigned int) this->_views.size ());
+    };
+    Dict_Shard_View *getShardView (unsigned int shard_idx)
+    {
+        return (this->_views[shard_idx]);
+    };
+
+  private:
+    vector < Dict_Shard_View * >_views;
+    unsigned int _itShard;
+    size_t _itEntry;
+};
+
+/*******************************************************************************
+ * Unions
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * External Function Prototypes
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * Global Variables
+ *******************************************************************************
+ */
+#if _MAIN_
+#define GLOBAL_VAR_DECLARE
+#else
+#define GLOBAL_VAR_DECLARE extern
+#endif /* _MAIN_ */
+
+#endif /* __DICT_SNAPSHOT_H__ */
@@ -0,0 +1,656 @@
+/**
+ * @file           dict_spill.cpp
+ * @brief:         Sorted runs of word counts spilled to disk, and their merge.
+ * @verbatim
+ *******************************************************************************
+ * Author:         Douglas L. Potts
+ *
+ * Date:           10/17/2026, <SCR #>
+ *
+ *==============================================================================
+ *==============================================================================
+ * Copyright (c) 2015 Douglas Lee Potts
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ *==============================================================================
+ *==============================================================================
+ *
+ * History:
+ * Date        SCR #  Name  Description
+ * -----------------------------------------------------------------------------
+ *
+ *******************************************************************************
+ * @endverbatim
+ */
+
+/*******************************************************************************
+ * System Includes
+ *******************************************************************************
+ */
+#include <stdio.h>              /* for fprintf(), snprintf() */
+#include <stdlib.h>             /* for malloc(), getenv(), mkstemp() */
+#include <string.h>             /* for memcpy(), memmove() */
+#include <errno.h>              /* for errno */
+#include <unistd.h>             /* for pread(), write(), unlink() */
+#include <algorithm>            /* for std::sort, std::push_heap */
+#include <map>
+
+/*******************************************************************************
+ * Project Includes
+ *******************************************************************************
+ */
+#include "common_types.h"
+#include "dict_spill.hpp"
+#if defined(TEST)
+#include "unity.h"
+#endif /* defined(TEST) */
+
+/*******************************************************************************
+ * Local Structs
+ *******************************************************************************
+ */
+/** Heap order for the merge, the cursor on the lowest word on top */
+struct Spill_Cursor_After
+{
+    vector < Spill_Cursor_t > *cursors;
+
+    bool operator () (size_t left, size_t right) const
+    {
+        const Dict_Entry_t & l = (*cursors)[left].cur;
+        const Dict_Entry_t & r = (*cursors)[right].cur;
+
+        return (compareWords (l.word, l.len, r.word, r.len) > 0);
+    }
+};
+
+/*******************************************************************************
+ * Local Function Prototypes 
+ *******************************************************************************
+ */
+static Bool_t writeAll (int fd, const char *data, size_t len);
+
+/*******************************************************************************
+ * Local Constants 
+ *******************************************************************************
+ */
+#define DBG(X)
+
+/** Bytes of a record ahead of the word: its length and count */
+#define SPILL_RECORD_HEADER (2 * sizeof (uint32_t))
+
+/*******************************************************************************
+ * File Scoped Variables 
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ ********************* E X T E R N A L  F U N C T I O N S **********************
+ *******************************************************************************
+ */
+
+#if defined(TEST)
+extern "C"
+{
+    void dictSpillMergeRuns (void)
+    {
+        static const int NUM_RUNS = 3;
+        static const int WORDS_PER_RUN = 500;
+        /* Smaller than a record, so records straddle every refill */
+        Dict_Spill *spill = new Dict_Spill (16);
+        map < string, int >expected;
+        map < string, int >::iterator it;
+        vector < Dict_Entry_t > entries;
+        vector < string > words;
+        Dict_Entry_t entry;
+        char word[64];
+        int run = 0;
+        int idx = 0;
+        int len = 0;
+
+        /*
+         * Runs overlap in some of their words, and one word is far longer
+         * than the read buffer.  Entries go in unsorted.
+         */
+        for (run = 0; run <= NUM_RUNS; run++)
+        {
+            words.clear ();
+            for (idx = WORDS_PER_RUN - 1; idx >= 0; idx--)
+            {
+                len = snprintf (word, sizeof (word), (idx % 7 == 0) ?
+                                "shared%d" : "run%d_word%d_long_enough",
+                                (idx % 7 == 0) ? idx : run, idx);
+                words.push_back (string (word, len));
+            }
+            words.push_back (string (300, 'z'));
+            entries.clear ();
+            for (idx = 0; idx < (int) words.size (); idx++)
+            {
+                entry.word = words[idx].data ();
+                entry.len = words[idx].size ();
+                entry.hash = wordHash (entry.word, entry.len);
+                entry.count = idx + run + 1;
+                entries.push_back (entry);
+                expected[words[idx]] += entry.count;
+            }
+            if (run < NUM_RUNS)
+            {
+                TEST_ASSERT_TRUE (spill->addRun (entries) == TRUE);
+                TEST_ASSERT_EQUAL (spill->numRuns (), run + 1);
+            }
+        }
+        TEST_ASSERT_TRUE (spill->bytesWritten () > NUM_RUNS * WORDS_PER_RUN *
+                          (SPILL_RECORD_HEADER + 7));
+
+        /*
+         * The last set stays in memory, and is merged in with the runs
+         */
+        sort (entries.begin (), entries.end (), dictEntryWordBefore);
+        spill->rewind (&entries);
+        it = expected.begin ();
+        while (spill->next (&entry) == TRUE)
+        {
+            TEST_ASSERT_TRUE (it != expected.end ());
+            TEST_ASSERT_EQUAL (entry.len, it->first.size ());
+            TEST_ASSERT_EQUAL (memcmp (entry.word, it->first.data (),
+                                       entry.len), 0);
+            TEST_ASSERT_EQUAL (entry.count, it->second);
+            TEST_ASSERT_EQUAL (entry.hash, wordHash (entry.word, entry.len));
+            ++it;
+        }
+        TEST_ASSERT_TRUE (it == expected.end ());
+
+        /*
+         * A merge can be started over, and lookups scan the runs only
+         */
+        spill->rewind ();
+        TEST_ASSERT_TRUE (spill->next (&entry) == TRUE);
+        TEST_ASSERT_EQUAL (entry.len, expected.begin ()->first.size ());
+        TEST_ASSERT_EQUAL (memcmp (entry.word,
+                                   expected.begin ()->first.data (),
+                                   entry.len), 0);
+        TEST_ASSERT_EQUAL (spill->getWordCount ("shared0", 7),
+                           3 * WORDS_PER_RUN + 3);
+        TEST_ASSERT_EQUAL (spill->getWordCount ("run3_word1_long_enough",
+                                                22), -1);
+        TEST_ASSERT_EQUAL (spill->getWordCount ("aaa", 3), -1);
+        TEST_ASSERT_EQUAL (spill->getWordCount ("zzzzzzzzzzzzzzzzzzzzzzzz",
+                                                24), -1);
+
+        delete spill;
+    }
+}
+#endif /* defined(TEST) */
+
+/**
+ *******************************************************************************
+ * @brief Dict_Spill - Constructor, the spill file is only created by the
+ * first addRun().
+ *
+ * <!-- Parameters -->
+ *      @param[in]      read_buffer    Bytes buffered per run while merging,
+ *                                     grown as needed for a long word
+ *******************************************************************************
+ */
+Dict_Spill::Dict_Spill (size_t read_buffer)
+{
+    _fd = -1;
+    _readBuffer = read_buffer;
+    _bytes = 0;
+}
+
+/**
+ *******************************************************************************
+ * @brief ~Dict_Spill - Destructor, closing (and so removing) the spill file.
+ *******************************************************************************
+ */
+Dict_Spill::~Dict_Spill (void)
+{
+    _closeCursors ();
+    if (_fd != -1)
+    {
+        close (_fd);
+        _fd = -1;
+    }
+}
+
+/**
+ *******************************************************************************
+ * @brief addRun - Sort a set of entries into word order and append them to
+ * the spill file as one run.
+ *
+ * <!-- Parameters -->
+ *      @param[in,out]  entries        Entries to write, each word at most
+ *                                     once, sorted in place
+ *
+ * <!-- Returns -->
+ *      @return TRUE once the run is written.
+ *      @return FALSE if the file could not be created or written, in which
+ *      case there is no new run.
+ *
+ * @par Description:
+ *      Records are gathered in a SPILL_WRITE_BUFFER sized buffer and written
+ *      in large sequential writes.  Any merge in progress is ended.
+ *******************************************************************************
+ */
+Bool_t Dict_Spill::addRun (vector < Dict_Entry_t > &entries)
+{
+    vector < char >buffer;
+    Spill_Run_t run;
+    uint32_t header[2];
+    size_t used = 0;
+    size_t idx = 0;
+
+    if ((_fd == -1) && (_open () == FALSE))
+    {
+        return (FALSE);
+    }
+    _closeCursors ();
+    sort (entries.begin (), entries.end (), dictEntryWordBefore);
+
+    run.offset = (off_t) _bytes;
+    run.bytes = 0;
+    run.numEntries = entries.size ();
+    buffer.resize (SPILL_WRITE_BUFFER);
+    for (idx = 0; idx < entries.size (); idx++)
+    {
+        if (used + SPILL_RECORD_HEADER + entries[idx].len > buffer.size ())
+        {
+            if (writeAll (_fd, &buffer[0], used) == FALSE)
+            {
+                goto error;
+            }
+            run.bytes += used;
+            used = 0;
+            if (SPILL_RECORD_HEADER + entries[idx].len > buffer.size ())
+            {
+                buffer.resize (SPILL_RECORD_HEADER + entries[idx].len);
+            }
+        }
+        header[0] = (uint32_t) entries[idx].len;
+        header[1] = (uint32_t) entries[idx].count;
+        memcpy (&buffer[used], header, SPILL_RECORD_HEADER);
+        memcpy (&buffer[used + SPILL_RECORD_HEADER], entries[idx].word,
+                entries[idx].len);
+        used += SPILL_RECORD_HEADER + entries[idx].len;
+    }
+    if ((used > 0) && (writeAll (_fd, &buffer[0], used) == FALSE))
+    {
+        goto error;
+    }
+    run.bytes += used;
+    _runs.push_back (run);
+    _bytes += run.bytes;
+    return (TRUE);
+
+  error:
+    /* Later runs overwrite whatever part of this one made it out */
+    return (FALSE);
+}
+
+/**
+ *******************************************************************************
+ * @brief bytesUsed - Memory held for the runs, mostly the read buffers of a
+ * merge in progress.
+ *******************************************************************************
+ */
+size_t Dict_Spill::bytesUsed (void)
+{
+    size_t bytes = _runs.capacity () * sizeof (Spill_Run_t) +
+        _cursors.capacity () * sizeof (Spill_Cursor_t) + _word.capacity ();
+    size_t idx = 0;
+
+    for (idx = 0; idx < _cursors.size (); idx++)
+    {
+        bytes += _cursors[idx].bufSize;
+    }
+    return (bytes);
+}
+
+/**
+ *******************************************************************************
+ * @brief rewind - Start a merge of every run, and optionally one more sorted
+ * set of entries in memory.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      extra          Entries in word order (see
+ *                                     dictEntryWordBefore()), each word at
+ *                                     most once, or NULL.  Must stay valid
+ *                                     and unchanged until the merge is done.
+ *******************************************************************************
+ */
+void Dict_Spill::rewind (vector < Dict_Entry_t > *extra)
+{
+    Spill_Cursor_After after;
+    size_t idx = 0;
+
+    _closeCursors ();
+    _cursors.resize (_runs.size () + ((extra != NULL) ? 1 : 0));
+    for (idx = 0; idx < _runs.size (); idx++)
+    {
+        _openCursor (&_cursors[idx], _runs[idx]);
+    }
+    if (extra != NULL)
+    {
+        memset (&_cursors[idx], 0, sizeof (_cursors[idx]));
+        _cursors[idx].entries = extra;
+    }
+
+    after.cursors = &_cursors;
+    for (idx = 0; idx < _cursors.size (); idx++)
+    {
+        if (_advance (&_cursors[idx]) == TRUE)
+        {
+            _heap.push_back (idx);
+            push_heap (_heap.begin (), _heap.end (), after);
+        }
+    }
+}
+
+/**
+ *******************************************************************************
+ * @brief next - Next word of the merge, in word order.
+ *
+ * <!-- Parameters -->
+ *      @param[out]     entry          The word, with its counts from every
+ *                                     run summed.  'word' stays valid until
+ *                                     the next call.
+ *
+ * <!-- Returns -->
+ *      @return FALSE once every run is used up.
+ *******************************************************************************
+ */
+Bool_t Dict_Spill::next (Dict_Entry_t * entry)
+{
+    Spill_Cursor_After after;
+    Spill_Cursor_t *cursor = NULL;
+    int count = 0;
+
+    after.cursors = &_cursors;
+    if (_heap.empty ())
+    {
+        return (FALSE);
+    }
+    do
+    {
+        pop_heap (_heap.begin (), _heap.end (), after);
+        cursor = &_cursors[_heap.back ()];
+        if (count == 0)
+        {
+            _word.assign (cursor->cur.word, cursor->cur.len);
+        }
+        count += cursor->cur.count;
+        if (_advance (cursor) == TRUE)
+        {
+            push_heap (_heap.begin (), _heap.end (), after);
+        }
+        else
+        {
+            _heap.pop_back ();
+        }
+    }
+    while ((_heap.empty () == false) &&
+           (compareWords (_cursors[_heap.front ()].cur.word,
+                          _cursors[_heap.front ()].cur.len,
+                          _word.data (), _word.size ()) == 0));
+
+    entry->word = _word.data ();
+    entry->len = _word.size ();
+    entry->hash = wordHash (entry->word, entry->len);
+    entry->count = count;
+    return (TRUE);
+}
+
+/**
+ *******************************************************************************
+ * @brief getWordCount - A word's count summed over every run, -1 if it is in
+ * none of them.
+ *
+ * @par Description:
+ *      Runs are only readable in order, so this reads each run up to where
+ *      the word would be, meant for the odd lookup, not for many.  Ends any
+ *      merge in progress.
+ *******************************************************************************
+ */
+int Dict_Spill::getWordCount (const char *word, size_t len)
+{
+    Spill_Cursor_t cursor;
+    int total = -1;
+    int cmp = 0;
+    size_t idx = 0;
+
+    _closeCursors ();
+    for (idx = 0; idx < _runs.size (); idx++)
+    {
+        _openCursor (&cursor, _runs[idx]);
+        while (_advance (&cursor) == TRUE)
+        {
+            cmp = compareWords (cursor.cur.word, cursor.cur.len, word, len);
+            if (cmp == 0)
+            {
+                total = ((total < 0) ? 0 : total) + cursor.cur.count;
+            }
+            if (cmp >= 0)
+            {
+                break;
+            }
+        }
+        free (cursor.buf);
+    }
+    return (total);
+}
+
+/*******************************************************************************
+ ************************ L O C A L  F U N C T I O N S *************************
+ *******************************************************************************
+ */
+
+/**
+ *******************************************************************************
+ * @brief _open - Create the spill file, in $TMPDIR or /tmp.
+ *
+ * @par Description:
+ *      The file is unlinked as soon as it is created, so it is never seen by
+ *      anyone else and is removed however the process ends.
+ *******************************************************************************
+ */
+Bool_t Dict_Spill::_open (void)
+{
+    const char *dir = getenv ("TMPDIR");
+    string path;
+    vector < char >name;
+
+    if ((dir == NULL) || (dir[0] == '\0'))
+    {
+        dir = "/tmp";
+    }
+    path = string (dir) + "/ssfi_spill_XXXXXX";
+    name.assign (path.begin (), path.end ());
+    name.push_back ('\0');
+    _fd = mkstemp (&name[0]);
+    if (_fd == -1)
+    {
+        fprintf (stderr, "[%s, %d:%s] failed to create %s, errno=%d, %s\n",
+                 __FILE__, __LINE__, __FUNCTION__, path.c_str (), errno,
+                 strerror (errno));
+        return (FALSE);
+    }
+    (void) unlink (&name[0]);
+    return (TRUE);
+}
+
+/**
+ *******************************************************************************
+ * @brief _openCursor - Position a cursor before the first record of a run.
+ *******************************************************************************
+ */
+void Dict_Spill::_openCursor (Spill_Cursor_t * cursor,
+                              const Spill_Run_t & run)
+{
+    memset (cursor, 0, sizeof (*cursor));
+    cursor->pos = run.offset;
+    cursor->end = run.offset + run.bytes;
+    cursor->bufSize = _readBuffer;
+    cursor->buf = (char *) malloc (cursor->bufSize);
+    if (cursor->buf == NULL)
+    {
+        fprintf (stderr, "[%s, %d:%s] failed to allocate %lu bytes\n",
+                 __FILE__, __LINE__, __FUNCTION__,
+                 (unsigned long) cursor->bufSize);
+        exit (EXIT_FAILURE);
+    }
+}
+
+/**
+ *******************************************************************************
+ * @brief _fill - Make sure the next 'num_bytes' of a run are in the cursor's
+ * buffer, reading more of the run if not.
+ *
+ * <!-- Returns -->
+ *      @return FALSE if the run ends, or the file can't be read, first.
+ *******************************************************************************
+ */
+Bool_t Dict_Spill::_fill (Spill_Cursor_t * cursor, size_t num_bytes)
+{
+    ssize_t bytes = 0;
+    size_t want = 0;
+
+    if (cursor->bufLen - cursor->bufPos >= num_bytes)
+    {
+        return (TRUE);
+    }
+    memmove (cursor->buf, cursor->buf + cursor->bufPos,
+             cursor->bufLen - cursor->bufPos);
+    cursor->bufLen -= cursor->bufPos;
+    cursor->bufPos = 0;
+    if (num_bytes > cursor->bufSize)
+    {
+        cursor->buf = (char *) realloc (cursor->buf, num_bytes);
+        if (cursor->buf == NULL)
+        {
+            fprintf (stderr, "[%s, %d:%s] failed to allocate %lu bytes\n",
+                     __FILE__, __LINE__, __FUNCTION__,
+                     (unsigned long) num_bytes);
+            exit (EXIT_FAILURE);
+        }
+        cursor->bufSize = num_bytes;
+    }
+    while ((cursor->bufLen < num_bytes) && (cursor->pos < cursor->end))
+    {
+        want = cursor->bufSize - cursor->bufLen;
+        if ((off_t) want > cursor->end - cursor->pos)
+        {
+            want = (size_t) (cursor->end - cursor->pos);
+        }
+        bytes = pread (_fd, cursor->buf + cursor->bufLen, want, cursor->pos);
+        if ((bytes < 0) && (errno == EINTR))
+        {
+            continue;
+        }
+        if (bytes <= 0)
+        {
+            fprintf (stderr, "[%s, %d:%s] spill file read failed, "
+                     "errno=%d, %s\n", __FILE__, __LINE__, __FUNCTION__,
+                     errno, strerror (errno));
+            return (FALSE);
+        }
+        cursor->bufLen += (size_t) bytes;
+        cursor->pos += bytes;
+    }
+    return ((cursor->bufLen >= num_bytes) ? TRUE : FALSE);
+}
+
+/**
+ *******************************************************************************
+ * @brief _advance - Move a cursor to its next entry.
+ *
+ * <!-- Returns -->
+ *      @return FALSE once the cursor's run or array is used up.
+ *******************************************************************************
+ */
+Bool_t Dict_Spill::_advance (Spill_Cursor_t * cursor)
+{
+    uint32_t header[2];
+
+    if (cursor->entries != NULL)
+    {
+        if (cursor->entryIdx >= cursor->entries->size ())
+        {
+            return (FALSE);
+        }
+        cursor->cur = (*cursor->entries)[cursor->entryIdx++];
+        return (TRUE);
+    }
+
+    /* The word of the previous record is given up here */
+    if (_fill (cursor, SPILL_RECORD_HEADER) == FALSE)
+    {
+        return (FALSE);
+    }
+    memcpy (header, cursor->buf + cursor->bufPos, SPILL_RECORD_HEADER);
+    if (_fill (cursor, SPILL_RECORD_HEADER + header[0]) == FALSE)
+    {
+        return (FALSE);
+    }
+    cursor->cur.word = cursor->buf + cursor->bufPos + SPILL_RECORD_HEADER;
+    cursor->cur.len = header[0];
+    cursor->cur.hash = 0;
+    cursor->cur.count = (int) header[1];
+    cursor->bufPos += SPILL_RECORD_HEADER + header[0];
+    return (TRUE);
+}
+
+/**
+ *******************************************************************************
+ * @brief _closeCursors - End any merge in progress, freeing its buffers.
+ *******************************************************************************
+ */
+void Dict_Spill::_closeCursors (void)
+{
+    size_t idx = 0;
+
+    for (idx = 0; idx < _cursors.size (); idx++)
+    {
+        free (_cursors[idx].buf);
+    }
+    _cursors.clear ();
+    _heap.clear ();
+}
+
+/**
+ *******************************************************************************
+ * @brief writeAll - write() every byte, through short writes and signals.
+ *******************************************************************************
+ */
+static Bool_t writeAll (int fd, const char *data, size_t len)
+{
+    ssize_t bytes = 0;
+
+    while (len > 0)
+    {
+        bytes = write (fd, data, len);
+        if ((bytes < 0) && (errno == EINTR))
+        {
+            continue;
+        }
+        if (bytes <= 0)
+        {
+            fprintf (stderr, "[%s, %d:%s] spill file write failed, "
+                     "errno=%d, %s\n", __FILE__, __LINE__, __FUNCTION__,
+                     errno, strerror (errno));
+            return (FALSE);
+        }
+        data += bytes;
+        len -= (size_t) bytes;
+    }
+    return (TRUE);
+}
@@ -0,0 +1,176 @@
+#ifndef __DICT_SPILL_H__
+#define __DICT_SPILL_H__
+/**
+ * @file           dict_spill.hpp
+ * @brief:         Sorted runs of word counts spilled to disk, and their merge.
+ * @verbatim
+ *******************************************************************************
+ * Author:         Douglas L. Potts
+ *
+ * Date:           10/17/2026, <SCR #>
+ *
+ *==============================================================================
+ *==============================================================================
+ * Copyright (c) 2015 Douglas Lee Potts
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ *==============================================================================
+ *==============================================================================
+ *
+ * History:
+ * Date        SCR #  Name  Description
+ * -----------------------------------------------------------------------------
+ *
+ *******************************************************************************
+ * @endverbatim
+ */
+
+/*******************************************************************************
+ * System Includes
+ *******************************************************************************
+ */
+#include <stddef.h>             /* for size_t */
+#include <stdint.h>             /* for uint64_t */
+#include <sys/types.h>          /* for off_t */
+#include <string>
+#include <vector>
+
+/*******************************************************************************
+ * Project Includes
+ *******************************************************************************
+ */
+#include "common_types.h"
+#include "dict_store.hpp"
+
+#if defined(TEST)
+extern "C"
+{
+    void dictSpillMergeRuns (void);
+}
+#endif                          /* defined(TEST) */
+
+/*******************************************************************************
+ * Typedefs
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * Constants
+ *******************************************************************************
+ */
+/** Bytes buffered per run while merging */
+#define SPILL_READ_BUFFER  (64 * 1024)
+/** Bytes buffered while writing a run */
+#define SPILL_WRITE_BUFFER (1024 * 1024)
+
+/*******************************************************************************
+ * Structures
+ *******************************************************************************
+ */
+using namespace std;
+
+/** Where one sorted run lives in the spill file */
+typedef struct
+{
+    off_t offset;               /**< File offset of the first record */
+    off_t bytes;                /**< Bytes of records */
+    size_t numEntries;          /**< Words in the run */
+} Spill_Run_t;
+
+/**
+ * Read position in one source of sorted entries being merged, either a run
+ * in the spill file or a sorted array in memory.
+ */
+typedef struct
+{
+    off_t pos;                  /**< Next file offset to read */
+    off_t end;                  /**< File offset just past the run */
+    char *buf;                  /**< Read buffer, NULL for an array */
+    size_t bufSize;             /**< Bytes allocated at buf */
+    size_t bufLen;              /**< Bytes read into buf */
+    size_t bufPos;              /**< First unconsumed byte in buf */
+    const vector < Dict_Entry_t > *entries;     /**< Sorted array, or NULL
+                                                  for a file run */
+    size_t entryIdx;            /**< Next entry of the array */
+    Dict_Entry_t cur;           /**< Entry under the cursor */
+} Spill_Cursor_t;
+
+/**
+ * Word counts moved out of memory.  Each run is a set of words sorted into
+ * word order, with their counts, written with one streaming pass to an
+ * unlinked temporary file, which goes away with the object (or the process).
+ * A run record is the word's 32-bit length and count, then its bytes.
+ *
+ * Iterating with rewind()/next() is a k-way merge of every run, plus
+ * optionally one array still in memory, in word order, with the counts of a
+ * word found in several runs summed.  Each run is read sequentially through
+ * its own buffer, so the merge needs memory for the buffers, not the words.
+ */
+class Dict_Spill
+{
+  public:
+    Dict_Spill (size_t read_buffer = SPILL_READ_BUFFER);
+    virtual ~ Dict_Spill (void);
+
+    Bool_t addRun (vector < Dict_Entry_t > &entries);
+    size_t numRuns (void)
+    {
+        return (this->_runs.size ());
+    };
+    uint64_t bytesWritten (void)
+    {
+        return (this->_bytes);
+    };
+    size_t bytesUsed (void);
+
+    void rewind (vector < Dict_Entry_t > *extra = NULL);
+    Bool_t next (Dict_Entry_t * entry);
+    int getWordCount (const char *word, size_t len);
+
+  private:
+    int _fd;
+    size_t _readBuffer;
+    vector < Spill_Run_t > _runs;
+    uint64_t _bytes;
+    vector < Spill_Cursor_t > _cursors;
+    vector < size_t > _heap;
+    string _word;
+
+    Bool_t _open (void);
+    void _openCursor (Spill_Cursor_t * cursor, const Spill_Run_t & run);
+    Bool_t _fill (Spill_Cursor_t * cursor, size_t num_bytes);
+    Bool_t _advance (Spill_Cursor_t * cursor);
+    void _closeCursors (void);
+};
+
+/*******************************************************************************
+ * Unions
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * External Function Prototypes
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * Global Variables
+ *******************************************************************************
+ */
+#if _MAIN_
+#define GLOBAL_VAR_DECLARE
+#else
+#define GLOBAL_VAR_DECLARE extern
+#endif /* _MAIN_ */
+
+#endif /* __DICT_SPILL_H__ */
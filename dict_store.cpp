@@ -0,0 +1,512 @@
+/**
+ * @file           dict_store.cpp
+ * @brief:         Storage backends behind each Word_Dict shard.
+ * @verbatim
+ *******************************************************************************
+ * Author:         Douglas L. Potts
+ *
+ * Date:           10/17/2026, <SCR #>
+ *
+ *==============================================================================
+ *==============================================================================
+ * Copyright (c) 2015 Douglas Lee Potts
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ *==============================================================================
+ *==============================================================================
+ *
+ * History:
+ * Date        SCR #  Name  Description
+ * -----------------------------------------------------------------------------
+ *
+ *******************************************************************************
+ * @endverbatim
+ */
+
+/*******************************************************************************
+ * System Includes
+ *******************************************************************************
+ */
+#include <string.h>             /* for strcmp(), memcmp() */
+#include <algorithm>            /* for std::push_heap */
+
+/*******************************************************************************
+ * Project Includes
+ *******************************************************************************
+ */
+#include "common_types.h"
+#include "dict_store.hpp"
+#include "hash_store.hpp"
+#include "radix_store.hpp"
+
+/*******************************************************************************
+ * Local Function Prototypes 
+ *******************************************************************************
+ */
+static size_t mapKeyHeapBytes (size_t len);
+
+/*******************************************************************************
+ * Local Constants 
+ *******************************************************************************
+ */
+/** Estimated bytes of one std::map node: color, parent, left and right links,
+ * then the key/value pair */
+#define MAP_NODE_BYTES \
+    (4 * sizeof (void *) + sizeof (pair < const string, int >))
+
+/*******************************************************************************
+ * File Scoped Variables 
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ ********************* E X T E R N A L  F U N C T I O N S **********************
+ *******************************************************************************
+ */
+
+/**
+ *******************************************************************************
+ * @brief newDictStore - Factory for the storage backend of a dictionary shard.
+ *******************************************************************************
+ */
+Dict_Store *newDictStore (Dict_Backend_t backend)
+{
+    switch (backend)
+    {
+    case DICT_BACKEND_HASH:
+        return (new Hash_Store ());
+    case DICT_BACKEND_RADIX:
+        return (new Radix_Store ());
+    case DICT_BACKEND_MAP:
+    default:
+        return (new Map_Store ());
+    }
+}
+
+/**
+ *******************************************************************************
+ * @brief dictBackendName - Printable name for a backend, as used by
+ * parseDictBackend().
+ *******************************************************************************
+ */
+const char *dictBackendName (Dict_Backend_t backend)
+{
+    switch (backend)
+    {
+    case DICT_BACKEND_HASH:
+        return ("hash");
+    case DICT_BACKEND_RADIX:
+        return ("radix");
+    case DICT_BACKEND_MAP:
+        return ("map");
+    default:
+        return ("unknown");
+    }
+}
+
+/**
+ *******************************************************************************
+ * @brief parseDictBackend - Convert a backend name from the command line.
+ *
+ * <!-- Returns -->
+ *      @return TRUE and sets *backend if 'name' is a known backend
+ *      @return FALSE otherwise
+ *******************************************************************************
+ */
+Bool_t parseDictBackend (const char *name, Dict_Backend_t * backend)
+{
+    if (strcmp (name, "map") == 0)
+    {
+        *backend = DICT_BACKEND_MAP;
+        return (TRUE);
+    }
+    if (strcmp (name, "hash") == 0)
+    {
+        *backend = DICT_BACKEND_HASH;
+        return (TRUE);
+    }
+    if (strcmp (name, "radix") == 0)
+    {
+        *backend = DICT_BACKEND_RADIX;
+        return (TRUE);
+    }
+    return (FALSE);
+}
+
+/**
+ *******************************************************************************
+ * @brief compareWords - Bytewise word order, a prefix sorts first.
+ *
+ * <!-- Returns -->
+ *      @return <0, 0 or >0 as 'left' sorts before, with or after 'right'.
+ *******************************************************************************
+ */
+int compareWords (const char *left, size_t left_len,
+                  const char *right, size_t right_len)
+{
+    size_t min_len = (left_len < right_len) ? left_len : right_len;
+    int cmp = memcmp (left, right, min_len);
+
+    if (cmp != 0)
+    {
+        return (cmp);
+    }
+    if (left_len == right_len)
+    {
+        return (0);
+    }
+    return ((left_len < right_len) ? -1 : 1);
+}
+
+/**
+ *******************************************************************************
+ * @brief dictEntryRanksBefore - Ordering used for top X selection, highest
+ * count first, ties broken by word bytes so the output does not depend on the
+ * order entries were visited in.
+ *******************************************************************************
+ */
+bool dictEntryRanksBefore (const Dict_Entry_t & left,
+                           const Dict_Entry_t & right)
+{
+    if (left.count != right.count)
+    {
+        return (left.count > right.count);
+    }
+    return (compareWords (left.word, left.len, right.word, right.len) < 0);
+}
+
+/**
+ *******************************************************************************
+ * @brief dictEntryWordBefore - Word order of entries, see compareWords().
+ *******************************************************************************
+ */
+bool dictEntryWordBefore (const Dict_Entry_t & left,
+                          const Dict_Entry_t & right)
+{
+    return (compareWords (left.word, left.len, right.word, right.len) < 0);
+}
+
+/**
+ *******************************************************************************
+ * @brief dictEntryOffer - Keep an entry if it is among the best 'top_k'
+ * offered so far.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      entry          Candidate
+ *      @param[in]      top_k          Number of entries to keep
+ *      @param[in,out]  top_list       Heap of the entries kept, under
+ *                                     dictEntryRanksBefore(), so the front is
+ *                                     the worst of them.  sort_heap() puts it
+ *                                     in ranking order.
+ *******************************************************************************
+ */
+void dictEntryOffer (const Dict_Entry_t & entry, size_t top_k,
+                     vector < Dict_Entry_t > &top_list)
+{
+    if (top_list.size () < top_k)
+    {
+        top_list.push_back (entry);
+        push_heap (top_list.begin (), top_list.end (), dictEntryRanksBefore);
+    }
+    else if (dictEntryRanksBefore (entry, top_list.front ()))
+    {
+        pop_heap (top_list.begin (), top_list.end (), dictEntryRanksBefore);
+        top_list.back () = entry;
+        push_heap (top_list.begin (), top_list.end (), dictEntryRanksBefore);
+    }
+}
+
+/**
+ *******************************************************************************
+ * @brief selectPrefix - Default prefix top-K, a scan of every word keeping
+ * the best 'top_k' of those starting with 'prefix' in a heap.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      prefix         First byte of the prefix
+ *      @param[in]      len            Length of the prefix, 0 for every word
+ *      @param[in]      top_k          Number of words wanted
+ *      @param[out]     top_list       Replaced with the selected entries,
+ *                                     highest count first
+ *******************************************************************************
+ */
+void Dict_Store::selectPrefix (const char *prefix, size_t len, size_t top_k,
+                               vector < Dict_Entry_t > &top_list)
+{
+    Dict_Entry_t entry;
+
+    top_list.clear ();
+    if (top_k == 0)
+    {
+        return;
+    }
+    rewind ();
+    while (next (&entry) == TRUE)
+    {
+        if ((entry.len < len) || (memcmp (entry.word, prefix, len) != 0))
+        {
+            continue;
+        }
+        dictEntryOffer (entry, top_k, top_list);
+    }
+    rewind ();
+    sort_heap (top_list.begin (), top_list.end (), dictEntryRanksBefore);
+}
+
+/**
+ *******************************************************************************
+ * @brief prune - Default pruning, copy out the words to keep, then clear the
+ * store and put them back.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      min_count      Lowest count a word keeps its place with
+ *
+ * <!-- Returns -->
+ *      @return number of words removed.
+ *
+ * @par Description:
+ *      Works for any store, and gives back all of the memory a store only
+ *      frees on clear(), such as its key arena.  Only the surviving words are
+ *      copied, which when pruning to save memory should be the few.
+ *******************************************************************************
+ */
+size_t Dict_Store::prune (int min_count)
+{
+    vector < Dict_Entry_t > kept;
+    string kept_keys;
+    Dict_Entry_t entry;
+    size_t removed = 0;
+    size_t offset = 0;
+    size_t idx = 0;
+
+    rewind ();
+    while (next (&entry) == TRUE)
+    {
+        if (entry.count < min_count)
+        {
+            removed++;
+            continue;
+        }
+        kept_keys.append (entry.word, entry.len);
+        kept.push_back (entry);
+    }
+    if (removed > 0)
+    {
+        clear ();
+        for (idx = 0; idx < kept.size (); idx++)
+        {
+            *findOrInsert (kept_keys.data () + offset, kept[idx].len,
+                           kept[idx].hash) = kept[idx].count;
+            offset += kept[idx].len;
+        }
+    }
+    rewind ();
+    return (removed);
+}
+
+/**
+ *******************************************************************************
+ * @brief Map_Store - Constructor
+ *******************************************************************************
+ */
+Map_Store::Map_Store (void)
+{
+    _it = _dictionaryMap.begin ();
+    _keyBytes = 0;
+}
+
+/**
+ *******************************************************************************
+ * @brief ~Map_Store - Destructor
+ *******************************************************************************
+ */
+Map_Store::~Map_Store (void)
+{
+    _dictionaryMap.clear ();
+}
+
+/**
+ *******************************************************************************
+ * @brief find - Look up a word.  The map is keyed by std::string, so this has
+ * to build one from the pointer and length.
+ *******************************************************************************
+ */
+int *Map_Store::find (const char *word, size_t len, Word_Hash_t hash)
+{
+    map < string, int >::iterator it = _dictionaryMap.find (string (word, len));
+
+    if (it == _dictionaryMap.end ())
+    {
+        return (NULL);
+    }
+    return (&it->second);
+}
+
+/**
+ *******************************************************************************
+ * @brief findOrInsert - Look up a word, inserting it with a count of 0 if it
+ * is not present (a single tree descent either way).
+ *******************************************************************************
+ */
+int *Map_Store::findOrInsert (const char *word, size_t len, Word_Hash_t hash)
+{
+    size_t old_size = _dictionaryMap.size ();
+    int *count = &_dictionaryMap[string (word, len)];
+
+    if (_dictionaryMap.size () != old_size)
+    {
+        _keyBytes += mapKeyHeapBytes (len);
+    }
+    return (count);
+}
+
+/**
+ *******************************************************************************
+ * @brief size - Number of words in the map.
+ *******************************************************************************
+ */
+size_t Map_Store::size (void)
+{
+    return (_dictionaryMap.size ());
+}
+
+/**
+ *******************************************************************************
+ * @brief clear - Remove every word.
+ *******************************************************************************
+ */
+void Map_Store::clear (void)
+{
+    _dictionaryMap.clear ();
+    _it = _dictionaryMap.begin ();
+    _keyBytes = 0;
+}
+
+/**
+ *******************************************************************************
+ * @brief rewind - Restart iteration at the first word, in sorted order.
+ *******************************************************************************
+ */
+void Map_Store::rewind (void)
+{
+    _it = _dictionaryMap.begin ();
+}
+
+/**
+ *******************************************************************************
+ * @brief next - Return the word under the cursor and advance.
+ *******************************************************************************
+ */
+Bool_t Map_Store::next (Dict_Entry_t * entry)
+{
+    if (_it == _dictionaryMap.end ())
+    {
+        return (FALSE);
+    }
+    entry->word = _it->first.data ();
+    entry->len = _it->first.size ();
+    entry->hash = wordHash (entry->word, entry->len);
+    entry->count = _it->second;
+    ++_it;
+    return (TRUE);
+}
+
+/**
+ *******************************************************************************
+ * @brief selectPrefix - Prefix top-K over the range of the map holding the
+ * words which start with 'prefix', rather than the whole map.
+ *******************************************************************************
+ */
+void Map_Store::selectPrefix (const char *prefix, size_t len, size_t top_k,
+                              vector < Dict_Entry_t > &top_list)
+{
+    map < string, int >::iterator it;
+    Dict_Entry_t entry;
+
+    top_list.clear ();
+    if (top_k == 0)
+    {
+        return;
+    }
+    for (it = _dictionaryMap.lower_bound (string (prefix, len));
+         (it != _dictionaryMap.end ()) && (it->first.size () >= len) &&
+         (memcmp (it->first.data (), prefix, len) == 0); ++it)
+    {
+        entry.word = it->first.data ();
+        entry.len = it->first.size ();
+        entry.hash = wordHash (entry.word, entry.len);
+        entry.count = it->second;
+        dictEntryOffer (entry, top_k, top_list);
+    }
+    sort_heap (top_list.begin (), top_list.end (), dictEntryRanksBefore);
+}
+
+/**
+ *******************************************************************************
+ * @brief memoryUsage - Tree nodes as index, plus key bytes which did not fit
+ * in a std::string's own storage.
+ *
+ * @par Description:
+ *      Keys added through getMap() rather than findOrInsert() are counted as
+ *      nodes, but not for any heap key bytes.
+ *******************************************************************************
+ */
+void Map_Store::memoryUsage (Mem_Stats_t * stats)
+{
+    stats->bytes[MEM_INDEX] += _dictionaryMap.size () * MAP_NODE_BYTES;
+    stats->bytes[MEM_KEYS] += _keyBytes;
+}
+
+/**
+ *******************************************************************************
+ * @brief prune - Erase the words below 'min_count' in place, no copying.
+ *******************************************************************************
+ */
+size_t Map_Store::prune (int min_count)
+{
+    map < string, int >::iterator it = _dictionaryMap.begin ();
+    size_t removed = 0;
+
+    while (it != _dictionaryMap.end ())
+    {
+        if (it->second < min_count)
+        {
+            _keyBytes -= mapKeyHeapBytes (it->first.size ());
+            _dictionaryMap.erase (it++);
+            removed++;
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    _it = _dictionaryMap.begin ();
+    return (removed);
+}
+
+/*******************************************************************************
+ ************************ L O C A L  F U N C T I O N S *************************
+ *******************************************************************************
+ */
+
+/**
+ *******************************************************************************
+ * @brief mapKeyHeapBytes - Heap bytes a std::string key of 'len' bytes needs,
+ * 0 when it fits in the string's own (short string) storage.
+ *******************************************************************************
+ */
+static size_t mapKeyHeapBytes (size_t len)
+{
+    static const size_t inline_capacity = string ().capacity ();
+
+    return ((len > inline_capacity) ? len + 1 : 0);
+}
@@ -0,0 +1,204 @@
+#ifndef __DICT_STORE_H__
+#define __DICT_STORE_H__
+/**
+ * @file           dict_store.hpp
+ * @brief:         Storage backends behind each Word_Dict shard.
+ * @verbatim
+ *******************************************************************************
+ * Author:         Douglas L. Potts
+ *
+ * Date:           10/17/2026, <SCR #>
+ *
+ *==============================================================================
+ *==============================================================================
+ * Copyright (c) 2015 Douglas Lee Potts
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ *==============================================================================
+ *==============================================================================
+ *
+ * History:
+ * Date        SCR #  Name  Description
+ * -----------------------------------------------------------------------------
+ *
+ *******************************************************************************
+ * @endverbatim
+ */
+
+/*******************************************************************************
+ * System Includes
+ *******************************************************************************
+ */
+#include <stddef.h>             /* for size_t */
+#include <map>
+#include <string>
+#include <vector>
+
+/*******************************************************************************
+ * Project Includes
+ *******************************************************************************
+ */
+#include "common_types.h"
+#include "word_hash.h"
+#include "mem_stats.hpp"
+
+/*******************************************************************************
+ * Typedefs
+ *******************************************************************************
+ */
+
+/** Storage backend used by a Word_Dict, selected at construction time */
+typedef enum
+{
+    DICT_BACKEND_MAP = 0,       /**< std::map, ordered red-black tree, keys
+                                  are std::string copies, not interned */
+    DICT_BACKEND_HASH = 1,      /**< Flat open-addressing (Robin Hood) table,
+                                  keys interned in a Key_Arena */
+    DICT_BACKEND_RADIX = 2      /**< Adaptive radix tree, ordered, with fast
+                                  prefix queries, keys interned in a
+                                  Key_Arena */
+} Dict_Backend_t;
+
+/*******************************************************************************
+ * Constants
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * Structures
+ *******************************************************************************
+ */
+using namespace std;
+
+/**
+ * One word and its count, as handed out by Dict_Store::next().  'word' is NOT
+ * nul terminated, and only stays valid until the store is next modified.
+ */
+typedef struct
+{
+    const char *word;           /**< First byte of the word */
+    size_t len;                 /**< Length of the word in bytes */
+    Word_Hash_t hash;           /**< wordHash() of the word */
+    int count;                  /**< Current count for the word */
+} Dict_Entry_t;
+
+/**
+ * Interface to the word -> count storage of one dictionary shard.  Stores do
+ * no locking of their own, the owning Word_Dict serializes access.  Lookups
+ * take a pointer and length plus the precomputed hash, so callers never need
+ * to build a std::string just to search.
+ */
+class Dict_Store
+{
+  public:
+    virtual ~ Dict_Store (void)
+    {
+    };
+
+    /** Pointer to the count for 'word', or NULL if it is not present */
+    virtual int *find (const char *word, size_t len, Word_Hash_t hash) = 0;
+
+    /** Pointer to the count for 'word', inserting it with a count of 0 first
+     * if it is not present.  Valid until the store is next modified. */
+    virtual int *findOrInsert (const char *word, size_t len,
+                               Word_Hash_t hash) = 0;
+    virtual size_t size (void) = 0;
+    virtual void clear (void) = 0;
+
+    /** Restart the store's iteration cursor at the first entry */
+    virtual void rewind (void) = 0;
+
+    /** Fill in the entry under the cursor and advance, FALSE once past the
+     * last entry */
+    virtual Bool_t next (Dict_Entry_t * entry) = 0;
+
+    /** The 'top_k' words starting with 'prefix', highest count first, ties
+     * in word order.  By default a scan of every word, disturbing the
+     * iteration cursor. */
+    virtual void selectPrefix (const char *prefix, size_t len, size_t top_k,
+                               vector < Dict_Entry_t > &top_list);
+
+    /** Add the store's memory, by component, into 'stats' */
+    virtual void memoryUsage (Mem_Stats_t * stats) = 0;
+
+    /** Remove every word with a count below 'min_count', returning how many
+     * were removed.  By default the survivors are copied out and the store
+     * rebuilt, which disturbs the iteration cursor. */
+    virtual size_t prune (int min_count);
+};
+
+/**
+ * The original dictionary storage, a std::map from word to count.  Iterates
+ * in sorted word order.
+ */
+class Map_Store:public Dict_Store
+{
+  public:
+    Map_Store (void);
+    virtual ~ Map_Store (void);
+
+    virtual int *find (const char *word, size_t len, Word_Hash_t hash);
+    virtual int *findOrInsert (const char *word, size_t len,
+                               Word_Hash_t hash);
+    virtual size_t size (void);
+    virtual void clear (void);
+    virtual void rewind (void);
+    virtual Bool_t next (Dict_Entry_t * entry);
+    virtual void selectPrefix (const char *prefix, size_t len, size_t top_k,
+                               vector < Dict_Entry_t > &top_list);
+    virtual void memoryUsage (Mem_Stats_t * stats);
+    virtual size_t prune (int min_count);
+
+    map < string, int >&getMap (void)
+    {
+        return (this->_dictionaryMap);
+    };
+
+  private:
+    map < string, int >_dictionaryMap;
+    map < string, int >::iterator _it;
+    size_t _keyBytes;
+};
+
+/*******************************************************************************
+ * Unions
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * External Function Prototypes
+ *******************************************************************************
+ */
+Dict_Store *newDictStore (Dict_Backend_t backend);
+const char *dictBackendName (Dict_Backend_t backend);
+Bool_t parseDictBackend (const char *name, Dict_Backend_t * backend);
+int compareWords (const char *left, size_t left_len,
+                  const char *right, size_t right_len);
+bool dictEntryRanksBefore (const Dict_Entry_t & left,
+                           const Dict_Entry_t & right);
+bool dictEntryWordBefore (const Dict_Entry_t & left,
+                          const Dict_Entry_t & right);
+void dictEntryOffer (const Dict_Entry_t & entry, size_t top_k,
+                     vector < Dict_Entry_t > &top_list);
+
+/*******************************************************************************
+ * Global Variables
+ *******************************************************************************
+ */
+#if _MAIN_
+#define GLOBAL_VAR_DECLARE
+#else
+#define GLOBAL_VAR_DECLARE extern
+#endif /* _MAIN_ */
+
+#endif /* __DICT_STORE_H__ */
@@ -0,0 +1,574 @@
+/**
+ * @file           frozen_dict.cpp
+ * @brief:         Read-only dictionary in dense arrays, for serving finished counts.
+ * @verbatim
+ *******************************************************************************
+ * Author:         Douglas L. Potts
+ *
+ * Date:           10/17/2026, <SCR #>
+ *
+ *==============================================================================
+ *==============================================================================
+ * Copyright (c) 2015 Douglas Lee Potts
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ *==============================================================================
+ *==============================================================================
+ *
+ * History:
+ * Date        SCR #  Name  Description
+ * -----------------------------------------------------------------------------
+ *
+ *******************************************************************************
+ * @endverbatim
+ */
+
+/*******************************************************************************
+ * System Includes
+ *******************************************************************************
+ */
+#include <stdio.h>              /* for printf() */
+#include <string.h>             /* for memcmp() */
+#include <algorithm>            /* for std::sort */
+#include <utility>              /* for std::pair */
+
+/*******************************************************************************
+ * Project Includes
+ *******************************************************************************
+ */
+#include "common_types.h"
+#include "frozen_dict.hpp"
+#if defined(TEST)
+#include "unity.h"
+#endif /* defined(TEST) */
+
+/*******************************************************************************
+ * Local Function Prototypes 
+ *******************************************************************************
+ */
+static bool entryWordBefore (const Dict_Entry_t & left,
+                             const Dict_Entry_t & right);
+
+/*******************************************************************************
+ * Local Constants 
+ *******************************************************************************
+ */
+#define DBG(X)
+
+/*******************************************************************************
+ * File Scoped Variables 
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ ********************* E X T E R N A L  F U N C T I O N S **********************
+ *******************************************************************************
+ */
+
+#if defined(TEST)
+extern "C"
+{
+
+    void frozenDictLookup (void)
+    {
+        static const int NUM_WORDS = 3000;
+        Frozen_Dict *frozen = new Frozen_Dict ();
+        Frozen_Dict *attached = new Frozen_Dict ();
+        vector < string > words;
+        vector < Dict_Entry_t > entries;
+        vector < Dict_Entry_t > top_list;
+        Dict_Entry_t entry;
+        char word[32];
+        int pass = 0;
+        int idx = 0;
+        int len = 0;
+
+        for (idx = 0; idx < NUM_WORDS; idx++)
+        {
+            len = snprintf (word, sizeof (word), "w%d", idx);
+            words.push_back (string (word, len));
+        }
+        for (idx = 0; idx < NUM_WORDS; idx++)
+        {
+            entry.word = words[idx].data ();
+            entry.len = words[idx].size ();
+            entry.hash = wordHash (entry.word, entry.len);
+            entry.count = (idx % 50) + 1;
+            entries.push_back (entry);
+        }
+
+        /*
+         * The same answers with and without the perfect hash
+         */
+        for (pass = 0; pass < 2; pass++)
+        {
+            TEST_ASSERT_TRUE (frozen->build (entries, (Bool_t) (pass == 0)));
+            TEST_ASSERT_EQUAL (frozen->hasPerfectHash (), pass == 0);
+            TEST_ASSERT_EQUAL (frozen->size (), NUM_WORDS);
+            TEST_ASSERT_TRUE (frozen->check ());
+            for (idx = 0; idx < NUM_WORDS; idx++)
+            {
+                TEST_ASSERT_EQUAL (frozen->getWordCount (words[idx].data (),
+                                                         words[idx].size ()),
+                                   (idx % 50) + 1);
+            }
+            TEST_ASSERT_EQUAL (frozen->getWordCount ("w3000", 5), -1);
+            TEST_ASSERT_EQUAL (frozen->getWordCount ("", 0), -1);
+
+            /* 60 words have the top count of 50, w1049 sorts first */
+            frozen->selectTopX (3, top_list);
+            TEST_ASSERT_EQUAL (top_list.size (), 3);
+            TEST_ASSERT_EQUAL (top_list[0].count, 50);
+            TEST_ASSERT_EQUAL (top_list[0].len, 5);
+            TEST_ASSERT_EQUAL (memcmp (top_list[0].word, "w1049", 5), 0);
+            TEST_ASSERT_EQUAL (memcmp (top_list[1].word, "w1099", 5), 0);
+            TEST_ASSERT_EQUAL (frozen->totalCount (), 60 * 1275);
+        }
+
+        /*
+         * Attached to its own arrays, as Dict_File does with a mapping
+         */
+        TEST_ASSERT_TRUE (frozen->build (entries));
+        TEST_ASSERT_TRUE (attached->attach (frozen->keys (),
+                                            frozen->keyBytes (),
+                                            frozen->offsets (),
+                                            frozen->counts (),
+                                            frozen->ranks (),
+                                            frozen->size (),
+                                            frozen->perfectHash ().words (),
+                                            frozen->perfectHash ().
+                                            numWords ()));
+        TEST_ASSERT_TRUE (attached->check ());
+        TEST_ASSERT_EQUAL (attached->getWordCount ("w77", 3), 28);
+        TEST_ASSERT_FALSE (attached->attach (frozen->keys (),
+                                             frozen->keyBytes (),
+                                             frozen->offsets (),
+                                             frozen->counts (),
+                                             frozen->ranks (),
+                                             frozen->size () - 1,
+                                             frozen->perfectHash ().words (),
+                                             frozen->perfectHash ().
+                                             numWords ()));
+
+        delete attached;
+        delete frozen;
+    }
+}
+#endif /* defined(TEST) */
+
+/**
+ *******************************************************************************
+ * @brief Frozen_Dict - Constructor, an empty dictionary.
+ *******************************************************************************
+ */
+Frozen_Dict::Frozen_Dict (void)
+{
+    _clear ();
+}
+
+/**
+ *******************************************************************************
+ * @brief ~Frozen_Dict - Destructor
+ *******************************************************************************
+ */
+Frozen_Dict::~Frozen_Dict (void)
+{
+}
+
+/**
+ *******************************************************************************
+ * @brief build - Copy a finished set of words and counts into dense arrays.
+ *
+ * <!-- Parameters -->
+ *      @param[in,out]  entries        Distinct words, reordered by the call.
+ *                                     The words are copied, so they need
+ *                                     only stay valid during the call.
+ *      @param[in]      perfect_hash   If TRUE, place words by a Perfect_Hash
+ *                                     of their wordHash64(), else in word
+ *                                     order.
+ *
+ * <!-- Returns -->
+ *      @return TRUE if built, FALSE if the perfect hash failed (two words
+ *      with the same 64-bit hash), the dictionary is left empty then.
+ *
+ * @par Algorithm:
+ *      Sort by word, find each word's final index (its slot, or its sorted
+ *      position), rank the sorted words by count so ties stay in word order,
+ *      then lay the words out by final index.
+ *******************************************************************************
+ */
+Bool_t Frozen_Dict::build (vector < Dict_Entry_t > &entries,
+                           Bool_t perfect_hash)
+{
+    vector < uint64_t > hashes;
+    vector < uint64_t > index_of;
+    vector < size_t > at_index;
+    vector < pair < uint32_t, uint32_t > >order;
+    size_t idx = 0;
+    size_t src = 0;
+
+    _clear ();
+    sort (entries.begin (), entries.end (), entryWordBefore);
+
+    index_of.resize (entries.size ());
+    for (idx = 0; idx < entries.size (); idx++)
+    {
+        index_of[idx] = idx;
+    }
+    if (perfect_hash == TRUE)
+    {
+        hashes.reserve (entries.size ());
+        for (idx = 0; idx < entries.size (); idx++)
+        {
+            hashes.push_back (wordHash64 (entries[idx].word,
+                                          entries[idx].len));
+        }
+        if (_hash.build (hashes) == FALSE)
+        {
+            _clear ();
+            return (FALSE);
+        }
+        for (idx = 0; idx < entries.size (); idx++)
+        {
+            index_of[idx] = _hash.lookup (hashes[idx]);
+        }
+        _hasHash = TRUE;
+    }
+
+    /* (MAX - count, sorted position) ascending is count down, word up */
+    order.reserve (entries.size ());
+    for (idx = 0; idx < entries.size (); idx++)
+    {
+        order.push_back (pair < uint32_t, uint32_t >
+                         (0xFFFFFFFFU - (uint32_t) entries[idx].count,
+                          (uint32_t) idx));
+    }
+    sort (order.begin (), order.end ());
+    _ownRanks.reserve (order.size ());
+    for (idx = 0; idx < order.size (); idx++)
+    {
+        _ownRanks.push_back ((uint32_t) index_of[order[idx].second]);
+    }
+
+    at_index.resize (entries.size ());
+    for (idx = 0; idx < entries.size (); idx++)
+    {
+        at_index[index_of[idx]] = idx;
+    }
+    _ownOffsets.reserve (entries.size () + 1);
+    _ownCounts.reserve (entries.size ());
+    for (idx = 0; idx < entries.size (); idx++)
+    {
+        src = at_index[idx];
+        _ownOffsets.push_back (_ownKeys.size ());
+        _ownKeys.append (entries[src].word, entries[src].len);
+        _ownCounts.push_back ((uint32_t) entries[src].count);
+    }
+    _ownOffsets.push_back (_ownKeys.size ());
+
+    _keys = _ownKeys.data ();
+    _keyBytes = _ownKeys.size ();
+    _offsets = &_ownOffsets[0];
+    _counts = (_ownCounts.empty ())? NULL : &_ownCounts[0];
+    _ranks = (_ownRanks.empty ())? NULL : &_ownRanks[0];
+    _numWords = entries.size ();
+    return (TRUE);
+}
+
+/**
+ *******************************************************************************
+ * @brief attach - Serve arrays laid out as by build(), where they are.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      keys           Key blob
+ *      @param[in]      key_bytes      Length of the key blob
+ *      @param[in]      offsets        num_words + 1 offsets into the blob
+ *      @param[in]      counts         num_words counts
+ *      @param[in]      ranks          num_words indices, by descending count
+ *      @param[in]      num_words      Number of words
+ *      @param[in]      hash_words     Perfect_Hash words, NULL if the words
+ *                                     are in word order instead
+ *      @param[in]      hash_num_words Number of 'hash_words'
+ *
+ * <!-- Returns -->
+ *      @return TRUE if usable, FALSE if the perfect hash is malformed or is
+ *      not over num_words keys.
+ *
+ * @par Pre/Post Conditions:
+ *      @pre     The caller keeps every array valid until the dictionary is
+ *               rebuilt, reattached or deleted.
+ *******************************************************************************
+ */
+Bool_t Frozen_Dict::attach (const char *keys, uint64_t key_bytes,
+                            const uint64_t * offsets, const uint32_t * counts,
+                            const uint32_t * ranks, uint64_t num_words,
+                            const uint64_t * hash_words,
+                            size_t hash_num_words)
+{
+    _clear ();
+    if (hash_words != NULL)
+    {
+        if ((_hash.attach (hash_words, hash_num_words) == FALSE) ||
+            (_hash.size () != num_words))
+        {
+            _clear ();
+            return (FALSE);
+        }
+        _hasHash = TRUE;
+    }
+    _keys = keys;
+    _keyBytes = key_bytes;
+    _offsets = offsets;
+    _counts = counts;
+    _ranks = ranks;
+    _numWords = num_words;
+    return (TRUE);
+}
+
+/**
+ *******************************************************************************
+ * @brief check - Full consistency check of the arrays, reads every word.
+ *
+ * <!-- Returns -->
+ *      @return TRUE if every offset is in order and inside the blob, every
+ *      rank names a word, and every word is where its lookup would look.
+ *******************************************************************************
+ */
+Bool_t Frozen_Dict::check (void)
+{
+    uint64_t idx = 0;
+
+    if ((_offsets[0] != 0) || (_offsets[_numWords] != _keyBytes))
+    {
+        return (FALSE);
+    }
+    for (idx = 0; idx < _numWords; idx++)
+    {
+        if ((_offsets[idx] > _offsets[idx + 1]) || (_ranks[idx] >= _numWords))
+        {
+            return (FALSE);
+        }
+    }
+    for (idx = 0; idx < _numWords; idx++)
+    {
+        if (_hasHash == TRUE)
+        {
+            if (_hash.lookup (wordHash64 (_keys + _offsets[idx],
+                                          _wordLen (idx))) != idx)
+            {
+                return (FALSE);
+            }
+        }
+        else if ((idx > 0) &&
+                 (compareWords (_keys + _offsets[idx - 1], _wordLen (idx - 1),
+                                _keys + _offsets[idx], _wordLen (idx)) >= 0))
+        {
+            return (FALSE);
+        }
+    }
+    return (TRUE);
+}
+
+/**
+ *******************************************************************************
+ * @brief totalCount - Sum of every word's count.
+ *******************************************************************************
+ */
+uint64_t Frozen_Dict::totalCount (void)
+{
+    uint64_t total = 0;
+    uint64_t idx = 0;
+
+    for (idx = 0; idx < _numWords; idx++)
+    {
+        total += _counts[idx];
+    }
+    return (total);
+}
+
+/**
+ *******************************************************************************
+ * @brief bytesUsed - Size of the arrays, whether owned or attached.
+ *******************************************************************************
+ */
+size_t Frozen_Dict::bytesUsed (void)
+{
+    return ((size_t) (_keyBytes + (_numWords + 1) * sizeof (uint64_t) +
+                      2 * _numWords * sizeof (uint32_t) +
+                      _hash.numWords () * sizeof (uint64_t)));
+}
+
+/**
+ *******************************************************************************
+ * @brief entry - Fetch word idx (its slot, or its place in word order).
+ *
+ * <!-- Returns -->
+ *      @return TRUE if filled in, FALSE once idx is past the last word.
+ *
+ * @par Pre/Post Conditions:
+ *      @post    entry->word is NOT nul terminated, and is valid as long as
+ *               the arrays are.
+ *******************************************************************************
+ */
+Bool_t Frozen_Dict::entry (size_t idx, Dict_Entry_t * entry)
+{
+    if ((entry == NULL) || (idx >= _numWords))
+    {
+        return (FALSE);
+    }
+    entry->word = _keys + _offsets[idx];
+    entry->len = _wordLen (idx);
+    entry->hash = wordHash (entry->word, entry->len);
+    entry->count = (int) _counts[idx];
+    return (TRUE);
+}
+
+/**
+ *******************************************************************************
+ * @brief getWordCount - Count of a word.
+ *
+ * <!-- Returns -->
+ *      @return the word's count, -1 if it is not in the dictionary (as for
+ *      Word_Dict::getWordCount()).
+ *
+ * @par Description:
+ *      With a perfect hash, the one slot the word can be in is compared.
+ *      Otherwise the words are binary searched.
+ *******************************************************************************
+ */
+int Frozen_Dict::getWordCount (const char *word, size_t len)
+{
+    uint64_t low = 0;
+    uint64_t high = _numWords;
+    uint64_t mid = 0;
+    int cmp = 0;
+
+    if (_hasHash == TRUE)
+    {
+        mid = _hash.lookup (wordHash64 (word, len));
+        if ((mid < _numWords) && (_wordLen (mid) == len) &&
+            (memcmp (_keys + _offsets[mid], word, len) == 0))
+        {
+            return ((int) _counts[mid]);
+        }
+        return (-1);
+    }
+    while (low < high)
+    {
+        mid = low + (high - low) / 2;
+        cmp = compareWords (_keys + _offsets[mid], _wordLen (mid), word, len);
+        if (cmp == 0)
+        {
+            return ((int) _counts[mid]);
+        }
+        if (cmp < 0)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+    return (-1);
+}
+
+/**
+ *******************************************************************************
+ * @brief selectTopX - The words with the highest counts, highest first, ties
+ * in word order.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      top_X_counts   Number of words wanted, negative for all
+ *      @param[out]     top_list       Replaced with the selected entries
+ *
+ * @par Description:
+ *      Reads the first entries of the ranks array, nothing is sorted.
+ *******************************************************************************
+ */
+void Frozen_Dict::selectTopX (int top_X_counts,
+                              vector < Dict_Entry_t > &top_list)
+{
+    size_t top_k = (top_X_counts < 0) ? size () : (size_t) top_X_counts;
+    Dict_Entry_t entry;
+    size_t idx = 0;
+
+    top_list.clear ();
+    if (top_k > size ())
+    {
+        top_k = size ();
+    }
+    top_list.reserve (top_k);
+    for (idx = 0; idx < top_k; idx++)
+    {
+        (void) this->entry (_ranks[idx], &entry);
+        top_list.push_back (entry);
+    }
+}
+
+/**
+ *******************************************************************************
+ * @brief printTopX - Print the top words as Word_Dict::printTopX() does.
+ *******************************************************************************
+ */
+void Frozen_Dict::printTopX (int top_X_counts)
+{
+    vector < Dict_Entry_t > top_list;
+    size_t idx = 0;
+
+    selectTopX (top_X_counts, top_list);
+    for (idx = 0; idx < top_list.size (); idx++)
+    {
+        printf ("%.*s\t%d\n", (int) top_list[idx].len, top_list[idx].word,
+                top_list[idx].count);
+    }                           /* end for */
+}
+
+/*******************************************************************************
+ ************************ L O C A L  F U N C T I O N S *************************
+ *******************************************************************************
+ */
+
+/**
+ *******************************************************************************
+ * @brief _clear - Back to an empty dictionary.
+ *******************************************************************************
+ */
+void Frozen_Dict::_clear (void)
+{
+    static const uint64_t NO_OFFSETS[1] = { 0 };
+
+    _ownKeys.clear ();
+    _ownOffsets.clear ();
+    _ownCounts.clear ();
+    _ownRanks.clear ();
+    _keys = NULL;
+    _keyBytes = 0;
+    _offsets = NO_OFFSETS;
+    _counts = NULL;
+    _ranks = NULL;
+    _numWords = 0;
+    (void) _hash.attach (NULL, 0);
+    _hasHash = FALSE;
+}
+
+/**
+ *******************************************************************************
+ * @brief entryWordBefore - Ordering of dictionary entries by word.
+ *******************************************************************************
+ */
+static bool entryWordBefore (const Dict_Entry_t & left,
+                             const Dict_Entry_t & right)
+{
+    return (compareWords (left.word, left.len, right.word, right.len) < 0);
+}
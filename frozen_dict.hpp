@@ -0,0 +1,193 @@
+#ifndef __FROZEN_DICT_H__
+#define __FROZEN_DICT_H__
+/**
+ * @file           frozen_dict.hpp
+ * @brief:         Read-only dictionary in dense arrays, for serving finished counts.
+ * @verbatim
+ *******************************************************************************
+ * Author:         Douglas L. Potts
+ *
+ * Date:           10/17/2026, <SCR #>
+ *
+ *==============================================================================
+ *==============================================================================
+ * Copyright (c) 2015 Douglas Lee Potts
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ *==============================================================================
+ *==============================================================================
+ *
+ * History:
+ * Date        SCR #  Name  Description
+ * -----------------------------------------------------------------------------
+ *
+ *******************************************************************************
+ * @endverbatim
+ */
+
+/*******************************************************************************
+ * System Includes
+ *******************************************************************************
+ */
+#include <stddef.h>             /* for size_t */
+#include <stdint.h>             /* for uint64_t */
+#include <string>
+#include <vector>
+
+/*******************************************************************************
+ * Project Includes
+ *******************************************************************************
+ */
+#include "common_types.h"
+#include "word_hash.h"
+#include "dict_store.hpp"
+#include "perfect_hash.hpp"
+
+#if defined(TEST)
+extern "C"
+{
+    void frozenDictLookup (void);
+}
+#endif                          /* defined(TEST) */
+
+/*******************************************************************************
+ * Typedefs
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * Constants
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * Structures
+ *******************************************************************************
+ */
+using namespace std;
+
+/**
+ * A finished vocabulary and its counts, in dense arrays:
+ *      keys      every word concatenated, no separators
+ *      offsets   size() + 1 entries, word i is keys[offsets[i]] up to
+ *                keys[offsets[i + 1]]
+ *      counts    size() entries, count of word i
+ *      ranks     size() entries, word indices by descending count (ties in
+ *                word order), so top-X is a prefix
+ *
+ * With a Perfect_Hash, word i is the word whose 64-bit hash maps to slot i,
+ * and a lookup is one hash plus one key compare.  Without one, the words are
+ * in bytewise order and a lookup is a binary search.
+ *
+ * The arrays are either built and owned here, or attached where they are,
+ * which is how Dict_File serves a mapped file with the same code.  Nothing
+ * here changes once built, so any number of threads may read at once.
+ */
+class Frozen_Dict
+{
+  public:
+    Frozen_Dict (void);
+    virtual ~ Frozen_Dict (void);
+
+    Bool_t build (vector < Dict_Entry_t > &entries,
+                  Bool_t perfect_hash = TRUE);
+    Bool_t attach (const char *keys, uint64_t key_bytes,
+                   const uint64_t * offsets, const uint32_t * counts,
+                   const uint32_t * ranks, uint64_t num_words,
+                   const uint64_t * hash_words, size_t hash_num_words);
+    Bool_t check (void);
+
+    size_t size (void)
+    {
+        return ((size_t) this->_numWords);
+    };
+    Bool_t hasPerfectHash (void)
+    {
+        return (this->_hasHash);
+    };
+    Perfect_Hash & perfectHash (void)
+    {
+        return (this->_hash);
+    };
+    uint64_t totalCount (void);
+    size_t bytesUsed (void);
+
+    Bool_t entry (size_t idx, Dict_Entry_t * entry);
+    int getWordCount (const char *word, size_t len);
+    void selectTopX (int top_X_counts, vector < Dict_Entry_t > &top_list);
+    void printTopX (int top_X_counts);
+
+    /* Raw arrays, for writing them out */
+    const char *keys (void)
+    {
+        return (this->_keys);
+    };
+    uint64_t keyBytes (void)
+    {
+        return (this->_keyBytes);
+    };
+    const uint64_t *offsets (void)
+    {
+        return (this->_offsets);
+    };
+    const uint32_t *counts (void)
+    {
+        return (this->_counts);
+    };
+    const uint32_t *ranks (void)
+    {
+        return (this->_ranks);
+    };
+
+  private:
+    string _ownKeys;
+    vector < uint64_t > _ownOffsets;
+    vector < uint32_t > _ownCounts;
+    vector < uint32_t > _ownRanks;
+    const char *_keys;
+    uint64_t _keyBytes;
+    const uint64_t *_offsets;
+    const uint32_t *_counts;
+    const uint32_t *_ranks;
+    uint64_t _numWords;
+    Perfect_Hash _hash;
+    Bool_t _hasHash;
+
+    void _clear (void);
+    size_t _wordLen (size_t idx)
+    {
+        return ((size_t) (this->_offsets[idx + 1] - this->_offsets[idx]));
+    };
+};
+
+/*******************************************************************************
+ * Unions
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * External Function Prototypes
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * Global Variables
+ *******************************************************************************
+ */
+#if _MAIN_
+#define GLOBAL_VAR_DECLARE
+#else
+#define GLOBAL_VAR_DECLARE extern
+#endif /* _MAIN_ */
+
+#endif /* __FROZEN_DICT_H__ */
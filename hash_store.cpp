@@ -0,0 +1,458 @@
+/**
+ * @file           hash_store.cpp
+ * @brief:         Flat open-addressing (Robin Hood) dictionary store.
+ * @verbatim
+ *******************************************************************************
+ * Author:         Douglas L. Potts
+ *
+ * Date:           10/17/2026, <SCR #>
+ *
+ *==============================================================================
+ *==============================================================================
+ * Copyright (c) 2015 Douglas Lee Potts
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ *==============================================================================
+ *==============================================================================
+ *
+ * History:
+ * Date        SCR #  Name  Description
+ * -----------------------------------------------------------------------------
+ *
+ *******************************************************************************
+ * @endverbatim
+ */
+
+/*******************************************************************************
+ * System Includes
+ *******************************************************************************
+ */
+#include <stdio.h>              /* for fprintf() */
+#include <stdlib.h>             /* for calloc() */
+#include <string.h>             /* for memcmp() */
+
+/*******************************************************************************
+ * Project Includes
+ *******************************************************************************
+ */
+#include "common_types.h"
+#include "hash_store.hpp"
+#if defined(TEST)
+#include "unity.h"
+#endif /* defined(TEST) */
+
+/*******************************************************************************
+ * Local Function Prototypes 
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * Local Constants 
+ *******************************************************************************
+ */
+#define DBG(X)
+
+/** Marks "no slot chosen yet" while placing an entry */
+#define NO_SLOT ((size_t) -1)
+
+/*******************************************************************************
+ * File Scoped Variables 
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ ********************* E X T E R N A L  F U N C T I O N S **********************
+ *******************************************************************************
+ */
+
+#if defined(TEST)
+extern "C"
+{
+
+    void hashStoreInsertFind (void)
+    {
+        Hash_Store *store = new Hash_Store ();
+        int *count = NULL;
+
+        TEST_ASSERT_NOT_NULL (store);
+        TEST_ASSERT_NULL (store->find ("apples", 6, wordHash ("apples", 6)));
+
+        count = store->findOrInsert ("apples", 6, wordHash ("apples", 6));
+        TEST_ASSERT_NOT_NULL (count);
+        TEST_ASSERT_EQUAL (*count, 0);
+        *count += 3;
+
+        /*
+         * Lookup is by pointer and length, a longer buffer must still match
+         */
+        count = store->find ("applesauce", 6, wordHash ("apples", 6));
+        TEST_ASSERT_NOT_NULL (count);
+        TEST_ASSERT_EQUAL (*count, 3);
+        TEST_ASSERT_NULL (store->find ("apple", 5, wordHash ("apple", 5)));
+        TEST_ASSERT_EQUAL (store->size (), 1);
+
+        delete store;
+    }
+    void hashStoreGrowIterate (void)
+    {
+        static const int NUM_WORDS = 5000;
+        Hash_Store *store = new Hash_Store ();
+        Dict_Entry_t entry;
+        char word[32];
+        int idx = 0;
+        int len = 0;
+        int entries = 0;
+        long total = 0;
+
+        for (idx = 0; idx < NUM_WORDS; idx++)
+        {
+            len = snprintf (word, sizeof (word), "w%d", idx);
+            *store->findOrInsert (word, len, wordHash (word, len)) += idx;
+        }
+        TEST_ASSERT_EQUAL (store->size (), NUM_WORDS);
+        TEST_ASSERT_TRUE (store->capacity () >= (size_t) NUM_WORDS);
+
+        for (idx = 0; idx < NUM_WORDS; idx++)
+        {
+            len = snprintf (word, sizeof (word), "w%d", idx);
+            TEST_ASSERT_EQUAL (*store->find (word, len, wordHash (word, len)),
+                               idx);
+        }
+
+        store->rewind ();
+        while (store->next (&entry) == TRUE)
+        {
+            TEST_ASSERT_EQUAL (entry.hash, wordHash (entry.word, entry.len));
+            entries++;
+            total += entry.count;
+        }
+        TEST_ASSERT_EQUAL (entries, NUM_WORDS);
+        TEST_ASSERT_EQUAL (total, (long) NUM_WORDS * (NUM_WORDS - 1) / 2);
+
+        store->clear ();
+        TEST_ASSERT_EQUAL (store->size (), 0);
+        len = snprintf (word, sizeof (word), "w%d", 7);
+        TEST_ASSERT_NULL (store->find (word, len, wordHash (word, len)));
+
+        delete store;
+    }
+    void hashStoreCollisions (void)
+    {
+        static const int NUM_WORDS = 200;
+        static const Word_Hash_t SAME_HASH = 0x1234;
+        Hash_Store *store = new Hash_Store ();
+        char word[32];
+        int idx = 0;
+        int len = 0;
+
+        /*
+         * Force every word onto the same home slot, so every lookup has to
+         * walk the probe sequence and compare keys.
+         */
+        for (idx = 0; idx < NUM_WORDS; idx++)
+        {
+            len = snprintf (word, sizeof (word), "c%d", idx);
+            *store->findOrInsert (word, len, SAME_HASH) = idx + 1;
+            *store->findOrInsert (word, len, wordHash (word, len)) = -idx;
+        }
+        TEST_ASSERT_EQUAL (store->size (), 2 * NUM_WORDS);
+        for (idx = 0; idx < NUM_WORDS; idx++)
+        {
+            len = snprintf (word, sizeof (word), "c%d", idx);
+            TEST_ASSERT_EQUAL (*store->find (word, len, SAME_HASH), idx + 1);
+            TEST_ASSERT_EQUAL (*store->find (word, len, wordHash (word, len)),
+                               -idx);
+        }
+        TEST_ASSERT_NULL (store->find ("c9999", 5, SAME_HASH));
+
+        delete store;
+    }
+}
+#endif /* defined(TEST) */
+
+/**
+ *******************************************************************************
+ * @brief Hash_Store - Constructor
+ *******************************************************************************
+ */
+Hash_Store::Hash_Store (void)
+{
+    _slots = NULL;
+    _mask = 0;
+    _used = 0;
+    _cursor = 0;
+    _allocate (HASH_STORE_INITIAL_SLOTS);
+}
+
+/**
+ *******************************************************************************
+ * @brief ~Hash_Store - Destructor
+ *******************************************************************************
+ */
+Hash_Store::~Hash_Store (void)
+{
+    clear ();
+    free (_slots);
+    _slots = NULL;
+}
+
+/**
+ *******************************************************************************
+ * @brief find - Look up a word by pointer, length and hash.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      word           First byte of the word (need not be nul
+ *                                     terminated).
+ *      @param[in]      len            Length of the word in bytes
+ *      @param[in]      hash           wordHash() of the word
+ *
+ * <!-- Returns -->
+ *      @return pointer to the word's count, NULL if not present.
+ *
+ * @par Description:
+ *      Linear probe from the home slot.  Because of the Robin Hood invariant,
+ *      the search stops at the first empty slot or the first resident that is
+ *      closer to its own home slot than we are to ours.
+ *******************************************************************************
+ */
+int *Hash_Store::find (const char *word, size_t len, Word_Hash_t hash)
+{
+    size_t idx = hash & _mask;
+    size_t dist = 0;
+    Hash_Slot_t *slot = NULL;
+
+    while (TRUE)
+    {
+        slot = &_slots[idx];
+        if ((slot->id == KEY_ARENA_NO_ID) || (_probeDistance (idx) < dist))
+        {
+            return (NULL);
+        }
+        if ((slot->hash == hash) && (_keys.keyLen (slot->id) == len) &&
+            (memcmp (_keys.key (slot->id), word, len) == 0))
+        {
+            return (&slot->count);
+        }
+        idx = (idx + 1) & _mask;
+        dist++;
+    }
+}
+
+/**
+ *******************************************************************************
+ * @brief findOrInsert - Look up a word, inserting it with a count of 0 if it
+ * is not already present.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      word           First byte of the word
+ *      @param[in]      len            Length of the word in bytes
+ *      @param[in]      hash           wordHash() of the word
+ *
+ * <!-- Returns -->
+ *      @return pointer to the word's count, valid until the next insert.
+ *
+ * @par Description:
+ *      The table doubles before it would go over 7/8 full.  A new word is
+ *      copied into the key arena, there is no per-word allocation.
+ *******************************************************************************
+ */
+int *Hash_Store::findOrInsert (const char *word, size_t len, Word_Hash_t hash)
+{
+    int *count = find (word, len, hash);
+    Hash_Slot_t entry;
+
+    if (count != NULL)
+    {
+        return (count);
+    }
+    if ((_used + 1) * 8 > capacity () * 7)
+    {
+        _grow ();
+    }
+    entry.id = _keys.add (word, len);
+    entry.hash = hash;
+    entry.count = 0;
+    _used++;
+
+    return (&_slots[_place (entry)].count);
+}
+
+/**
+ *******************************************************************************
+ * @brief size - Number of words in the table.
+ *******************************************************************************
+ */
+size_t Hash_Store::size (void)
+{
+    return (_used);
+}
+
+/**
+ *******************************************************************************
+ * @brief clear - Remove every word, and shrink back to the initial size.
+ *******************************************************************************
+ */
+void Hash_Store::clear (void)
+{
+    _keys.clear ();
+    free (_slots);
+    _allocate (HASH_STORE_INITIAL_SLOTS);
+    _used = 0;
+    _cursor = 0;
+}
+
+/**
+ *******************************************************************************
+ * @brief memoryUsage - The slot table as index, and the key arena.
+ *******************************************************************************
+ */
+void Hash_Store::memoryUsage (Mem_Stats_t * stats)
+{
+    stats->bytes[MEM_INDEX] += capacity () * sizeof (Hash_Slot_t);
+    stats->bytes[MEM_ARENA] += _keys.bytesUsed ();
+}
+
+/**
+ *******************************************************************************
+ * @brief rewind - Restart iteration at the first slot.
+ *******************************************************************************
+ */
+void Hash_Store::rewind (void)
+{
+    _cursor = 0;
+}
+
+/**
+ *******************************************************************************
+ * @brief next - Return the next occupied slot, in table (not word) order.
+ *******************************************************************************
+ */
+Bool_t Hash_Store::next (Dict_Entry_t * entry)
+{
+    for (; _cursor <= _mask; _cursor++)
+    {
+        Hash_Slot_t *slot = &_slots[_cursor];
+
+        if (slot->id != KEY_ARENA_NO_ID)
+        {
+            entry->word = _keys.key (slot->id);
+            entry->len = _keys.keyLen (slot->id);
+            entry->hash = slot->hash;
+            entry->count = slot->count;
+            _cursor++;
+            return (TRUE);
+        }
+    }
+    return (FALSE);
+}
+
+/*******************************************************************************
+ ************************ L O C A L  F U N C T I O N S *************************
+ *******************************************************************************
+ */
+
+/**
+ *******************************************************************************
+ * @brief _allocate - Replace the slot array with 'num_slots' empty slots.
+ *******************************************************************************
+ */
+void Hash_Store::_allocate (size_t num_slots)
+{
+    _slots = (Hash_Slot_t *) calloc (num_slots, sizeof (Hash_Slot_t));
+    if (_slots == NULL)
+    {
+        fprintf (stderr, "[%s, %d:%s] failed to allocate %lu slots\n",
+                 __FILE__, __LINE__, __FUNCTION__, (unsigned long) num_slots);
+        exit (EXIT_FAILURE);
+    }
+    _mask = num_slots - 1;
+}
+
+/**
+ *******************************************************************************
+ * @brief _grow - Double the table, re-placing every entry from its stored
+ * hash (keys are never rehashed or copied).
+ *******************************************************************************
+ */
+void Hash_Store::_grow (void)
+{
+    Hash_Slot_t *old_slots = _slots;
+    size_t old_num_slots = _mask + 1;
+    size_t idx = 0;
+
+    _allocate (old_num_slots * 2);
+    for (idx = 0; idx < old_num_slots; idx++)
+    {
+        if (old_slots[idx].id != KEY_ARENA_NO_ID)
+        {
+            (void) _place (old_slots[idx]);
+        }
+    }
+    free (old_slots);
+    DBG (printf ("Hash_Store grew to %lu slots\n", _mask + 1));
+}
+
+/**
+ *******************************************************************************
+ * @brief _place - Robin Hood insert of an entry known to not be in the table.
+ *
+ * <!-- Returns -->
+ *      @return index of the slot where 'entry' itself ended up.
+ *
+ * @par Description:
+ *      Walk from the home slot; whenever the resident is closer to its home
+ *      than the entry being carried, swap them and carry the resident onward.
+ *******************************************************************************
+ */
+size_t Hash_Store::_place (Hash_Slot_t & entry)
+{
+    size_t idx = entry.hash & _mask;
+    size_t dist = 0;
+    size_t resident_dist = 0;
+    size_t landed = NO_SLOT;
+    Hash_Slot_t carried = entry;
+    Hash_Slot_t swap;
+
+    while (TRUE)
+    {
+        if (_slots[idx].id == KEY_ARENA_NO_ID)
+        {
+            _slots[idx] = carried;
+            return ((landed == NO_SLOT) ? idx : landed);
+        }
+        resident_dist = _probeDistance (idx);
+        if (resident_dist < dist)
+        {
+            swap = _slots[idx];
+            _slots[idx] = carried;
+            carried = swap;
+            dist = resident_dist;
+            if (landed == NO_SLOT)
+            {
+                landed = idx;
+            }
+        }
+        idx = (idx + 1) & _mask;
+        dist++;
+    }
+}
+
+/**
+ *******************************************************************************
+ * @brief _probeDistance - How far the occupant of a slot is from its home.
+ *******************************************************************************
+ */
+size_t Hash_Store::_probeDistance (size_t slot_idx)
+{
+    return ((slot_idx - (_slots[slot_idx].hash & _mask)) & _mask);
+}
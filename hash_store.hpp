@@ -0,0 +1,155 @@
+#ifndef __HASH_STORE_H__
+#define __HASH_STORE_H__
+/**
+ * @file           hash_store.hpp
+ * @brief:         Flat open-addressing (Robin Hood) dictionary store.
+ * @verbatim
+ *******************************************************************************
+ * Author:         Douglas L. Potts
+ *
+ * Date:           10/17/2026, <SCR #>
+ *
+ *==============================================================================
+ *==============================================================================
+ * Copyright (c) 2015 Douglas Lee Potts
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ *==============================================================================
+ *==============================================================================
+ *
+ * History:
+ * Date        SCR #  Name  Description
+ * -----------------------------------------------------------------------------
+ *
+ *******************************************************************************
+ * @endverbatim
+ */
+
+/*******************************************************************************
+ * System Includes
+ *******************************************************************************
+ */
+#include <stdint.h>             /* for uint32_t */
+
+/*******************************************************************************
+ * Project Includes
+ *******************************************************************************
+ */
+#include "common_types.h"
+#include "dict_store.hpp"
+#include "key_arena.hpp"
+
+#if defined(TEST)
+extern "C"
+{
+    void hashStoreInsertFind (void);
+    void hashStoreGrowIterate (void);
+    void hashStoreCollisions (void);
+}
+#endif                          /* defined(TEST) */
+
+/*******************************************************************************
+ * Typedefs
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * Constants
+ *******************************************************************************
+ */
+/** Slot count of a newly constructed table, must be a power of two */
+#define HASH_STORE_INITIAL_SLOTS (64)
+
+/*******************************************************************************
+ * Structures
+ *******************************************************************************
+ */
+
+/**
+ * One table slot.  The key bytes live in the store's Key_Arena, the slot only
+ * holds the key's id.  The full hash is kept in the slot, so most mismatches
+ * are rejected without touching the key bytes, and growing the table never
+ * has to rehash a key.
+ */
+typedef struct
+{
+    Key_Id_t id;                /**< Arena id of the word, KEY_ARENA_NO_ID if
+                                  the slot is empty */
+    Word_Hash_t hash;           /**< wordHash() of the word */
+    int count;                  /**< Count for this word */
+} Hash_Slot_t;
+
+/**
+ * Open-addressing hash table using Robin Hood linear probing: on insert, an
+ * entry that has probed further than the resident of a slot takes that slot
+ * over.  This keeps probe sequences short and lets a miss stop as soon as it
+ * reaches an entry closer to its home slot than the search is.
+ */
+class Hash_Store:public Dict_Store
+{
+  public:
+    Hash_Store (void);
+    virtual ~ Hash_Store (void);
+
+    virtual int *find (const char *word, size_t len, Word_Hash_t hash);
+    virtual int *findOrInsert (const char *word, size_t len,
+                               Word_Hash_t hash);
+    virtual size_t size (void);
+    virtual void clear (void);
+    virtual void rewind (void);
+    virtual Bool_t next (Dict_Entry_t * entry);
+    virtual void memoryUsage (Mem_Stats_t * stats);
+
+    size_t capacity (void)
+    {
+        return (this->_mask + 1);
+    };
+    Key_Arena & keys (void)
+    {
+        return (this->_keys);
+    };
+
+  private:
+    Hash_Slot_t *_slots;
+    Key_Arena _keys;
+    size_t _mask;
+    size_t _used;
+    size_t _cursor;
+
+    void _allocate (size_t num_slots);
+    void _grow (void);
+    size_t _place (Hash_Slot_t & entry);
+    size_t _probeDistance (size_t slot_idx);
+};
+
+/*******************************************************************************
+ * Unions
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * External Function Prototypes
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * Global Variables
+ *******************************************************************************
+ */
+#if _MAIN_
+#define GLOBAL_VAR_DECLARE
+#else
+#define GLOBAL_VAR_DECLARE extern
+#endif /* _MAIN_ */
+
+#endif /* __HASH_STORE_H__ */
@@ -0,0 +1,308 @@
+/**
+ * @file           hyper_log_log.cpp
+ * @brief:         HyperLogLog estimate of the number of distinct words.
+ * @verbatim
+ *******************************************************************************
+ * Author:         Douglas L. Potts
+ *
+ * Date:           10/17/2026, <SCR #>
+ *
+ *==============================================================================
+ *==============================================================================
+ * Copyright (c) 2015 Douglas Lee Potts
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ *==============================================================================
+ *==============================================================================
+ *
+ * History:
+ * Date        SCR #  Name  Description
+ * -----------------------------------------------------------------------------
+ *
+ *******************************************************************************
+ * @endverbatim
+ */
+
+/*******************************************************************************
+ * System Includes
+ *******************************************************************************
+ */
+#include <stdio.h>              /* for snprintf() */
+#include <math.h>               /* for log(), sqrt() */
+
+/*******************************************************************************
+ * Project Includes
+ *******************************************************************************
+ */
+#include "common_types.h"
+#include "hyper_log_log.hpp"
+#if defined(TEST)
+#include "unity.h"
+#endif /* defined(TEST) */
+
+/*******************************************************************************
+ * Local Function Prototypes 
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * Local Constants 
+ *******************************************************************************
+ */
+#define DBG(X)
+
+/** 2^32, the size of the hash space, for the large range correction */
+#define HLL_HASH_SPACE (4294967296.0)
+
+/*******************************************************************************
+ * File Scoped Variables 
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ ********************* E X T E R N A L  F U N C T I O N S **********************
+ *******************************************************************************
+ */
+
+#if defined(TEST)
+extern "C"
+{
+
+    void hyperLogLogEstimate (void)
+    {
+        static const int NUM_WORDS = 100000;
+        Hyper_Log_Log *hll = new Hyper_Log_Log ();
+        char word[32];
+        int idx = 0;
+        int len = 0;
+        double est = 0.0;
+
+        TEST_ASSERT_EQUAL (hll->bytesUsed (), 4096);
+        TEST_ASSERT_TRUE (hll->estimate () == 0.0);
+
+        /*
+         * Small counts go through linear counting and are nearly exact,
+         * repeats don't count again
+         */
+        for (idx = 0; idx < 30; idx++)
+        {
+            len = snprintf (word, sizeof (word), "w%d", idx % 10);
+            hll->add (wordHash (word, len));
+        }
+        est = hll->estimate ();
+        TEST_ASSERT_TRUE ((est > 9.5) && (est < 10.5));
+
+        for (idx = 0; idx < NUM_WORDS; idx++)
+        {
+            len = snprintf (word, sizeof (word), "w%d", idx);
+            hll->add (wordHash (word, len));
+        }
+        est = hll->estimate ();
+
+        /* Four standard errors either way */
+        TEST_ASSERT_TRUE (fabs (est - NUM_WORDS) <
+                          4 * hll->standardError () * NUM_WORDS);
+
+        hll->clear ();
+        TEST_ASSERT_TRUE (hll->estimate () == 0.0);
+
+        delete hll;
+    }
+    void hyperLogLogMerge (void)
+    {
+        Hyper_Log_Log *left = new Hyper_Log_Log (10);
+        Hyper_Log_Log *right = new Hyper_Log_Log (10);
+        Hyper_Log_Log *odd = new Hyper_Log_Log (11);
+        char word[32];
+        int idx = 0;
+        int len = 0;
+        double est = 0.0;
+
+        /*
+         * 0..29999 on the left, 20000..49999 on the right, 50000 in all
+         */
+        for (idx = 0; idx < 30000; idx++)
+        {
+            len = snprintf (word, sizeof (word), "w%d", idx);
+            left->add (wordHash (word, len));
+            len = snprintf (word, sizeof (word), "w%d", idx + 20000);
+            right->add (wordHash (word, len));
+        }
+        TEST_ASSERT_TRUE (left->merge (*right));
+        est = left->estimate ();
+        TEST_ASSERT_TRUE (fabs (est - 50000) <
+                          4 * left->standardError () * 50000);
+
+        /* Different register counts can't be combined */
+        TEST_ASSERT_FALSE (left->merge (*odd));
+        TEST_ASSERT_TRUE (left->estimate () == est);
+
+        delete left;
+        delete right;
+        delete odd;
+    }
+}
+#endif /* defined(TEST) */
+
+/**
+ *******************************************************************************
+ * @brief Hyper_Log_Log - Constructor
+ *
+ * <!-- Parameters -->
+ *      @param[in]      precision      Index bits, clamped to
+ *                                     HLL_MIN_PRECISION..HLL_MAX_PRECISION.
+ *                                     Memory is 2^precision bytes.
+ *******************************************************************************
+ */
+Hyper_Log_Log::Hyper_Log_Log (unsigned int precision)
+{
+    if (precision < HLL_MIN_PRECISION)
+    {
+        precision = HLL_MIN_PRECISION;
+    }
+    else if (precision > HLL_MAX_PRECISION)
+    {
+        precision = HLL_MAX_PRECISION;
+    }
+    _precision = precision;
+    _registers.assign ((size_t) 1 << _precision, 0);
+}
+
+/**
+ *******************************************************************************
+ * @brief ~Hyper_Log_Log - Destructor
+ *******************************************************************************
+ */
+Hyper_Log_Log::~Hyper_Log_Log (void)
+{
+}
+
+/**
+ *******************************************************************************
+ * @brief merge - Fold another sketch into this one, the result estimates the
+ * distinct words of the union.
+ *
+ * <!-- Returns -->
+ *      @return TRUE if merged, FALSE if the precisions differ (nothing is
+ *      changed then).
+ *******************************************************************************
+ */
+Bool_t Hyper_Log_Log::merge (Hyper_Log_Log & other)
+{
+    size_t idx = 0;
+
+    if (other._precision != _precision)
+    {
+        return (FALSE);
+    }
+    for (idx = 0; idx < _registers.size (); idx++)
+    {
+        if (other._registers[idx] > _registers[idx])
+        {
+            _registers[idx] = other._registers[idx];
+        }
+    }
+    return (TRUE);
+}
+
+/**
+ *******************************************************************************
+ * @brief clear - Forget every word.
+ *******************************************************************************
+ */
+void Hyper_Log_Log::clear (void)
+{
+    _registers.assign (_registers.size (), 0);
+}
+
+/**
+ *******************************************************************************
+ * @brief estimate - Estimated number of distinct words added.
+ *
+ * @par Algorithm:
+ *      Raw estimate alpha * m^2 / sum (2^-register).  Below 2.5 m with empty
+ *      registers left, linear counting (m ln (m / empty)) is more accurate.
+ *      Above 2^32 / 30, hash collisions start to hide words, and the raw
+ *      estimate is corrected by -2^32 ln (1 - E / 2^32).
+ *******************************************************************************
+ */
+double Hyper_Log_Log::estimate (void)
+{
+    double num_regs = (double) _registers.size ();
+    double alpha = 0.7213 / (1.0 + 1.079 / num_regs);
+    double sum = 0.0;
+    double est = 0.0;
+    size_t empty = 0;
+    size_t idx = 0;
+
+    for (idx = 0; idx < _registers.size (); idx++)
+    {
+        sum += ldexp (1.0, -(int) _registers[idx]);
+        if (_registers[idx] == 0)
+        {
+            empty++;
+        }
+    }
+    est = alpha * num_regs * num_regs / sum;
+
+    if ((est <= 2.5 * num_regs) && (empty > 0))
+    {
+        est = num_regs * log (num_regs / (double) empty);
+    }
+    else if (est > HLL_HASH_SPACE / 30.0)
+    {
+        est = -HLL_HASH_SPACE * log (1.0 - est / HLL_HASH_SPACE);
+    }
+    return (est);
+}
+
+/**
+ *******************************************************************************
+ * @brief standardError - Relative standard error of estimate().
+ *******************************************************************************
+ */
+double Hyper_Log_Log::standardError (void)
+{
+    return (1.04 / sqrt ((double) _registers.size ()));
+}
+
+/*******************************************************************************
+ ************************ L O C A L  F U N C T I O N S *************************
+ *******************************************************************************
+ */
+
+/**
+ *******************************************************************************
+ * @brief _rank - Position of the first set bit, counting from 1 at the top.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      bits           Hash bits left after the register index,
+ *                                     shifted up to the top of the word.
+ *
+ * @par Description:
+ *      Only 32 - precision bits are meaningful, so the rank is capped at one
+ *      more than that, which is what all zero bits give.
+ *******************************************************************************
+ */
+uint8_t Hyper_Log_Log::_rank (uint32_t bits)
+{
+    uint8_t rank = 1;
+    uint8_t max_rank = (uint8_t) (32 - _precision + 1);
+
+    while (((bits & 0x80000000U) == 0) && (rank < max_rank))
+    {
+        bits <<= 1;
+        rank++;
+    }
+    return (rank);
+}
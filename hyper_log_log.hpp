@@ -0,0 +1,157 @@
+#ifndef __HYPER_LOG_LOG_H__
+#define __HYPER_LOG_LOG_H__
+/**
+ * @file           hyper_log_log.hpp
+ * @brief:         HyperLogLog estimate of the number of distinct words.
+ * @verbatim
+ *******************************************************************************
+ * Author:         Douglas L. Potts
+ *
+ * Date:           10/17/2026, <SCR #>
+ *
+ *==============================================================================
+ *==============================================================================
+ * Copyright (c) 2015 Douglas Lee Potts
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ *==============================================================================
+ *==============================================================================
+ *
+ * History:
+ * Date        SCR #  Name  Description
+ * -----------------------------------------------------------------------------
+ *
+ *******************************************************************************
+ * @endverbatim
+ */
+
+/*******************************************************************************
+ * System Includes
+ *******************************************************************************
+ */
+#include <stddef.h>             /* for size_t */
+#include <stdint.h>             /* for uint8_t */
+#include <vector>
+
+/*******************************************************************************
+ * Project Includes
+ *******************************************************************************
+ */
+#include "common_types.h"
+#include "word_hash.h"
+
+#if defined(TEST)
+extern "C"
+{
+    void hyperLogLogEstimate (void);
+    void hyperLogLogMerge (void);
+}
+#endif                          /* defined(TEST) */
+
+/*******************************************************************************
+ * Typedefs
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * Constants
+ *******************************************************************************
+ */
+/** Default index bits, 2^12 one byte registers (4KB), about 1.6% error */
+#define HLL_DEFAULT_PRECISION (12)
+/** Index bit range accepted by the constructor */
+#define HLL_MIN_PRECISION     (4)
+#define HLL_MAX_PRECISION     (16)
+
+/*******************************************************************************
+ * Structures
+ *******************************************************************************
+ */
+using namespace std;
+
+/**
+ * HyperLogLog distinct count estimator over word hashes.
+ *
+ * Each word hash (remixed with wordHashMix()) picks one of 2^precision
+ * registers with its top bits, and the register keeps the longest run of
+ * leading zeros seen in the remaining bits.  The estimate has a relative
+ * standard error of about 1.04 / sqrt (2^precision), in 2^precision bytes, no
+ * matter how many words are added.  Registers combine by taking the maximum,
+ * so per-thread or per-file sketches merge losslessly.
+ *
+ * Built on the 32-bit word hash, so distinct words with equal hashes count
+ * once.  The usual large range correction accounts for that, and the
+ * estimate stays useful to a few hundred million distinct words.
+ *
+ * No locking, each sketch belongs to one thread until it is merged.
+ */
+class Hyper_Log_Log
+{
+  public:
+    Hyper_Log_Log (unsigned int precision = HLL_DEFAULT_PRECISION);
+    virtual ~ Hyper_Log_Log (void);
+
+    void add (Word_Hash_t hash)
+    {
+        uint32_t mixed = wordHashMix (hash);
+        uint32_t reg = mixed >> (32 - this->_precision);
+        uint8_t rank = _rank (mixed << this->_precision);
+
+        if (rank > this->_registers[reg])
+        {
+            this->_registers[reg] = rank;
+        }
+    };
+    Bool_t merge (Hyper_Log_Log & other);
+    void clear (void);
+    double estimate (void);
+
+    /** Relative standard error of estimate(), 1.04 / sqrt (registers) */
+    double standardError (void);
+    unsigned int precision (void)
+    {
+        return (this->_precision);
+    };
+    size_t bytesUsed (void)
+    {
+        return (this->_registers.size ());
+    };
+
+  private:
+    unsigned int _precision;
+    vector < uint8_t > _registers;
+
+    uint8_t _rank (uint32_t bits);
+};
+
+/*******************************************************************************
+ * Unions
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * External Function Prototypes
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * Global Variables
+ *******************************************************************************
+ */
+#if _MAIN_
+#define GLOBAL_VAR_DECLARE
+#else
+#define GLOBAL_VAR_DECLARE extern
+#endif /* _MAIN_ */
+
+#endif /* __HYPER_LOG_LOG_H__ */
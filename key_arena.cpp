@@ -0,0 +1,322 @@
+/**
+ * @file           key_arena.cpp
+ * @brief:         Block allocator which interns dictionary keys as 32-bit ids.
+ * @verbatim
+ *******************************************************************************
+ * Author:         Douglas L. Potts
+ *
+ * Date:           10/17/2026, <SCR #>
+ *
+ *==============================================================================
+ *==============================================================================
+ * Copyright (c) 2015 Douglas Lee Potts
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ *==============================================================================
+ *==============================================================================
+ *
+ * History:
+ * Date        SCR #  Name  Description
+ * -----------------------------------------------------------------------------
+ *
+ *******************************************************************************
+ * @endverbatim
+ */
+
+/*******************************************************************************
+ * System Includes
+ *******************************************************************************
+ */
+#include <stdio.h>              /* for fprintf() */
+#include <stdlib.h>             /* for malloc() */
+#include <string.h>             /* for memcpy() */
+
+/*******************************************************************************
+ * Project Includes
+ *******************************************************************************
+ */
+#include "common_types.h"
+#include "key_arena.hpp"
+#if defined(TEST)
+#include "unity.h"
+#endif /* defined(TEST) */
+
+/*******************************************************************************
+ * Local Function Prototypes 
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * Local Constants 
+ *******************************************************************************
+ */
+#define DBG(X)
+
+/** Key records start on a multiple of this, so the length prefix is aligned */
+#define KEY_ALIGN (sizeof (uint32_t))
+
+/*******************************************************************************
+ * File Scoped Variables 
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ ********************* E X T E R N A L  F U N C T I O N S **********************
+ *******************************************************************************
+ */
+
+#if defined(TEST)
+extern "C"
+{
+
+    void keyArenaInternResolve (void)
+    {
+        Key_Arena *arena = new Key_Arena ();
+        Key_Id_t apples = KEY_ARENA_NO_ID;
+        Key_Id_t pears = KEY_ARENA_NO_ID;
+
+        TEST_ASSERT_EQUAL (arena->size (), 0);
+        apples = arena->add ("applesauce", 6);
+        pears = arena->add ("pears", 5);
+        TEST_ASSERT_TRUE (apples != KEY_ARENA_NO_ID);
+        TEST_ASSERT_TRUE (pears != KEY_ARENA_NO_ID);
+        TEST_ASSERT_TRUE (apples != pears);
+        TEST_ASSERT_EQUAL (arena->size (), 2);
+
+        /* Keys come back nul terminated, with their lengths */
+        TEST_ASSERT_EQUAL_STRING ("apples", arena->key (apples));
+        TEST_ASSERT_EQUAL (arena->keyLen (apples), 6);
+        TEST_ASSERT_EQUAL_STRING ("pears", arena->key (pears));
+        TEST_ASSERT_EQUAL (arena->keyLen (pears), 5);
+
+        /* Both keys share one block, a small one to start with */
+        TEST_ASSERT_EQUAL (arena->bytesAllocated (), KEY_ARENA_FIRST_BLOCK);
+
+        delete arena;
+    }
+    void keyArenaLargeKeys (void)
+    {
+        static const size_t BLOCK_SIZE = 64;
+        static const int NUM_KEYS = 100;
+        Key_Arena *arena = new Key_Arena (BLOCK_SIZE);
+        Key_Id_t ids[NUM_KEYS];
+        const char *first = NULL;
+        char big[200];
+        char word[32];
+        int idx = 0;
+        int len = 0;
+
+        /*
+         * Enough keys to fill many small blocks, earlier keys must not move
+         * as later blocks are added.
+         */
+        for (idx = 0; idx < NUM_KEYS; idx++)
+        {
+            len = snprintf (word, sizeof (word), "key%d", idx);
+            ids[idx] = arena->add (word, len);
+            if (idx == 0)
+            {
+                first = arena->key (ids[idx]);
+            }
+        }
+        TEST_ASSERT_TRUE (first == arena->key (ids[0]));
+        for (idx = 0; idx < NUM_KEYS; idx++)
+        {
+            len = snprintf (word, sizeof (word), "key%d", idx);
+            TEST_ASSERT_EQUAL (arena->keyLen (ids[idx]), len);
+            TEST_ASSERT_EQUAL_STRING (word, arena->key (ids[idx]));
+        }
+
+        /* A key bigger than a block still fits */
+        memset (big, 'z', sizeof (big));
+        ids[0] = arena->add (big, sizeof (big));
+        TEST_ASSERT_EQUAL (arena->keyLen (ids[0]), sizeof (big));
+        TEST_ASSERT_EQUAL (memcmp (arena->key (ids[0]), big, sizeof (big)), 0);
+        TEST_ASSERT_EQUAL (arena->key (ids[0])[sizeof (big)], '\0');
+
+        delete arena;
+    }
+    void keyArenaClear (void)
+    {
+        Key_Arena *arena = new Key_Arena (64);
+        Key_Id_t id = KEY_ARENA_NO_ID;
+        int idx = 0;
+
+        for (idx = 0; idx < 50; idx++)
+        {
+            (void) arena->add ("cherries", 8);
+        }
+        TEST_ASSERT_TRUE (arena->bytesAllocated () > 64);
+        arena->clear ();
+        TEST_ASSERT_EQUAL (arena->size (), 0);
+        TEST_ASSERT_EQUAL (arena->bytesAllocated (), 0);
+
+        /* Ids restart after a clear */
+        id = arena->add ("oranges", 7);
+        TEST_ASSERT_EQUAL (id, 1);
+        TEST_ASSERT_EQUAL_STRING ("oranges", arena->key (id));
+
+        delete arena;
+    }
+}
+#endif /* defined(TEST) */
+
+/**
+ *******************************************************************************
+ * @brief Key_Arena - Constructor
+ *
+ * <!-- Parameters -->
+ *      @param[in]      block_size     Largest bytes per block.  Larger blocks
+ *                                     mean fewer allocations but more slack
+ *                                     in the last block.
+ *******************************************************************************
+ */
+Key_Arena::Key_Arena (size_t block_size)
+{
+    _blockSize = block_size;
+    _curSize = 0;
+    _blockUsed = 0;
+    _bytesAllocated = 0;
+    _keys.push_back (NULL);     /* KEY_ARENA_NO_ID */
+}
+
+/**
+ *******************************************************************************
+ * @brief ~Key_Arena - Destructor
+ *******************************************************************************
+ */
+Key_Arena::~Key_Arena (void)
+{
+    clear ();
+}
+
+/**
+ *******************************************************************************
+ * @brief add - Copy a key into the arena.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      key            First byte of the key (need not be nul
+ *                                     terminated)
+ *      @param[in]      len            Length of the key in bytes
+ *
+ * <!-- Returns -->
+ *      @return id of the new key, never KEY_ARENA_NO_ID.
+ *
+ * @par Description:
+ *      Every call adds a new key, even if the same bytes were added before.
+ *      Ids are handed out densely starting at 1.
+ *******************************************************************************
+ */
+Key_Id_t Key_Arena::add (const char *key, size_t len)
+{
+    char *record = _reserve (sizeof (uint32_t) + len + 1);
+    uint32_t len32 = (uint32_t) len;
+
+    memcpy (record, &len32, sizeof (len32));
+    record += sizeof (len32);
+    memcpy (record, key, len);
+    record[len] = '\0';
+    _keys.push_back (record);
+
+    return ((Key_Id_t) (_keys.size () - 1));
+}
+
+/**
+ *******************************************************************************
+ * @brief clear - Free every block.  All ids and key pointers become invalid.
+ *******************************************************************************
+ */
+void Key_Arena::clear (void)
+{
+    size_t idx = 0;
+
+    for (idx = 0; idx < _blocks.size (); idx++)
+    {
+        free (_blocks[idx]);
+    }
+    /* Swap rather than clear(), so the id table's memory is given back too */
+    vector < char *>().swap (_blocks);
+    vector < const char *>().swap (_keys);
+    _keys.push_back (NULL);
+    _curSize = 0;
+    _blockUsed = 0;
+    _bytesAllocated = 0;
+}
+
+/*******************************************************************************
+ ************************ L O C A L  F U N C T I O N S *************************
+ *******************************************************************************
+ */
+
+/**
+ *******************************************************************************
+ * @brief _reserve - Carve 'num_bytes' out of the current block, starting a new
+ * block when it does not fit.
+ *
+ * @par Description:
+ *      Each new block is twice the size of the last, starting from
+ *      KEY_ARENA_FIRST_BLOCK, up to the arena's block size.  A record bigger
+ *      than that gets a block of exactly its size.  The remainder of the
+ *      previous block is abandoned either way, which wastes at most one
+ *      record's worth of bytes per block.
+ *******************************************************************************
+ */
+char *Key_Arena::_reserve (size_t num_bytes)
+{
+    size_t aligned = (num_bytes + KEY_ALIGN - 1) & ~(KEY_ALIGN - 1);
+    size_t new_block = 0;
+    char *record = NULL;
+
+    if (_blockUsed + aligned > _curSize)
+    {
+        new_block = (_curSize == 0) ? KEY_ARENA_FIRST_BLOCK : _curSize * 2;
+        if (new_block > _blockSize)
+        {
+            new_block = _blockSize;
+        }
+        if (aligned > new_block)
+        {
+            new_block = aligned;
+        }
+        record = (char *) malloc (new_block);
+        if (record == NULL)
+        {
+            fprintf (stderr, "[%s, %d:%s] failed to allocate %lu bytes\n",
+                     __FILE__, __LINE__, __FUNCTION__,
+                     (unsigned long) new_block);
+            exit (EXIT_FAILURE);
+        }
+        _blocks.push_back (record);
+        _bytesAllocated += new_block;
+        DBG (printf ("Key_Arena added block %lu\n",
+                     (unsigned long) _blocks.size ()));
+        /*
+         * An oversized block is full as soon as its one record goes in, and
+         * does not count towards the doubling
+         */
+        if (new_block > aligned)
+        {
+            _curSize = new_block;
+            _blockUsed = aligned;
+        }
+        else
+        {
+            _blockUsed = _curSize;
+        }
+        return (record);
+    }
+    record = _blocks.back () + _blockUsed;
+    _blockUsed += aligned;
+
+    return (record);
+}
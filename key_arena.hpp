@@ -0,0 +1,165 @@
+#ifndef __KEY_ARENA_H__
+#define __KEY_ARENA_H__
+/**
+ * @file           key_arena.hpp
+ * @brief:         Block allocator which interns dictionary keys as 32-bit ids.
+ * @verbatim
+ *******************************************************************************
+ * Author:         Douglas L. Potts
+ *
+ * Date:           10/17/2026, <SCR #>
+ *
+ *==============================================================================
+ *==============================================================================
+ * Copyright (c) 2015 Douglas Lee Potts
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ *==============================================================================
+ *==============================================================================
+ *
+ * History:
+ * Date        SCR #  Name  Description
+ * -----------------------------------------------------------------------------
+ *
+ *******************************************************************************
+ * @endverbatim
+ */
+
+/*******************************************************************************
+ * System Includes
+ *******************************************************************************
+ */
+#include <stddef.h>             /* for size_t */
+#include <stdint.h>             /* for uint32_t */
+#include <vector>
+
+/*******************************************************************************
+ * Project Includes
+ *******************************************************************************
+ */
+#include "common_types.h"
+
+#if defined(TEST)
+extern "C"
+{
+    void keyArenaInternResolve (void);
+    void keyArenaLargeKeys (void);
+    void keyArenaClear (void);
+}
+#endif                          /* defined(TEST) */
+
+/*******************************************************************************
+ * Typedefs
+ *******************************************************************************
+ */
+/** Handle for an interned key, only meaningful to the arena which issued it */
+typedef uint32_t Key_Id_t;
+
+/*******************************************************************************
+ * Constants
+ *******************************************************************************
+ */
+/** Never issued by an arena, so zero-filled memory means "no key" */
+#define KEY_ARENA_NO_ID      ((Key_Id_t) 0)
+/** Bytes per arena block, keys longer than this get a block of their own */
+#define KEY_ARENA_BLOCK_SIZE  (1024 * 1024)
+/** Bytes of an arena's first block, each block after is twice the size of the
+ * one before, up to the arena's block size */
+#define KEY_ARENA_FIRST_BLOCK (4096)
+
+/*******************************************************************************
+ * Structures
+ *******************************************************************************
+ */
+using namespace std;
+
+/**
+ * Append-only storage for key bytes.  Keys are copied into large blocks, each
+ * preceded by its 32-bit length and followed by a nul, so a key costs its own
+ * length plus 5 bytes and one pointer in the id table, instead of a malloc'd
+ * string.  Keys never move once added, so pointers from key() stay valid until
+ * clear().  The arena does no locking and no de-duplication, that is up to
+ * the owning store.  Blocks start small and double, so the many small stores
+ * of a sharded dictionary do not each hold a full sized block.
+ */
+class Key_Arena
+{
+  public:
+    Key_Arena (size_t block_size = KEY_ARENA_BLOCK_SIZE);
+    virtual ~ Key_Arena (void);
+
+    Key_Id_t add (const char *key, size_t len);
+
+    /** Nul terminated bytes of key 'id' */
+    const char *key (Key_Id_t id)
+    {
+        return (this->_keys[id]);
+    };
+    uint32_t keyLen (Key_Id_t id)
+    {
+        return (((const uint32_t *) this->_keys[id])[-1]);
+    };
+
+    /** Number of keys added */
+    size_t size (void)
+    {
+        return (this->_keys.size () - 1);
+    };
+
+    /** Bytes of block memory currently allocated */
+    size_t bytesAllocated (void)
+    {
+        return (this->_bytesAllocated);
+    };
+
+    /** Bytes held in all, blocks plus the id table */
+    size_t bytesUsed (void)
+    {
+        return (this->_bytesAllocated +
+                this->_keys.capacity () * sizeof (const char *) +
+                this->_blocks.capacity () * sizeof (char *));
+    };
+    void clear (void);
+
+  private:
+    vector < char *>_blocks;
+    vector < const char *>_keys;
+    size_t _blockSize;
+    size_t _curSize;
+    size_t _blockUsed;
+    size_t _bytesAllocated;
+
+    char *_reserve (size_t num_bytes);
+};
+
+/*******************************************************************************
+ * Unions
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * External Function Prototypes
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * Global Variables
+ *******************************************************************************
+ */
+#if _MAIN_
+#define GLOBAL_VAR_DECLARE
+#else
+#define GLOBAL_VAR_DECLARE extern
+#endif /* _MAIN_ */
+
+#endif /* __KEY_ARENA_H__ */
@@ -132,7 +132,7 @@ extern void listdir(const char *dir_name, Work_Queue *fileQueue)
         d_name = entry->d_name;
 
         /* Only need to check for extension if this is a file */
-        if ((entry->d_type & DT_DIR) > 0)
+        if ((entry->d_type & DT_DIR) == 0)
         {
             /* Find first '.' starting at the end */
             const char *extension = strrchr(d_name, '.');
@@ -39,6 +39,7 @@
  *******************************************************************************
  */
 #include <unistd.h>
+#include <getopt.h>             /* for getopt_long() */
 #include <stdio.h>
 
 #include <errno.h>              /* for errno */
@@ -47,6 +48,7 @@
 #include <pthread.h>            /* for pthread_* calls */
 #include <assert.h>             /* for assert() */
 #include <string.h>             /* for strerror() */
+#include <time.h>               /* for clock_gettime() */
 #include <iostream>
 #include <list>
 #include <vector>
@@ -61,12 +63,49 @@
 #include "work_queue.hpp"
 #include "buffer_processing.hpp"
 #include "word_dict.hpp"
+#include "dict_file.hpp"
+#include "word_scan.hpp"
+#include "utf8_words.hpp"
 
 /*******************************************************************************
  * Local Constants 
  *******************************************************************************
  */
 #define BASE_TEN (0)            /* Used for strtol */
+/** Words on the live leaderboard printed in verbose mode */
+#define LEADERBOARD_SIZE       (10)
+/** Seconds between live leaderboard prints in verbose mode */
+#define LEADERBOARD_PERIOD_SEC (1)
+#define USAGE_STRING \
+    "Usage: %s [-t num_threads] [-s num_dict_shards] [-d hash|map|radix] " \
+    "[-l] [-v]\n" \
+    "          [-b read_size[K|M]] [--mmap | --io-uring]\n" \
+    "          [--io-policy normal|sequential|noreuse|dontneed|direct]\n" \
+    "          [--chunk-size SIZE[K|M|G]] [--utf8]\n" \
+    "          [-a [--cms-width N] [--cms-depth N] [--hh-size N]] " \
+    "[--hll | --hll-only]\n" \
+    "          [--mem-limit SIZE[K|M|G] [--mem-policy prune|approx|spill]]\n" \
+    "          [--prefix word_start] [-o dict_file] <first_dir_path>\n" \
+    "       %s -i dict_file [--verify] [word ...]\n"
+
+/** getopt_long() codes for options which only have a long form */
+enum
+{
+    OPT_CMS_WIDTH = 256,
+    OPT_CMS_DEPTH,
+    OPT_HH_SIZE,
+    OPT_HLL,
+    OPT_HLL_ONLY,
+    OPT_VERIFY,
+    OPT_PREFIX,
+    OPT_MEM_LIMIT,
+    OPT_MEM_POLICY,
+    OPT_MMAP,
+    OPT_IO_URING,
+    OPT_IO_POLICY,
+    OPT_CHUNK_SIZE,
+    OPT_UTF8
+};
 
 /*******************************************************************************
  * Local Macros
@@ -87,17 +126,42 @@
 typedef struct
 {
     Work_Queue *myQueue;        /**< Pointer to Thread-safe signaled work queue to use */
-    Word_Dict *wordDictionary;  /**< Pointer to Thread-safe word dictionary for
-                                  thread */
+    Word_Dict *wordDictionary;  /**< Pointer to word dictionary for thread,
+                                  shared and thread-safe, or private to the
+                                  thread in thread-local (-l) mode, NULL
+                                  if only estimating (--hll-only) */
+    Hyper_Log_Log *distinctWords;       /**< Thread's distinct word estimate,
+                                          NULL unless --hll or --hll-only */
     int thread_idx;             /**< Thread index, used in debug output to tell
                                   which thread is doing what operation */
+    size_t read_bytes;          /**< Size of the thread's read buffer */
+    Process_Read_Mode_t read_mode;      /**< How the thread gets at files */
+    Process_Io_Policy_t io_policy;      /**< Page cache hints, or O_DIRECT */
+    size_t chunk_bytes;         /**< Files bigger than this are split into
+                                  chunks, 0 never */
 } ReaderWriterArgs_t;
 
+/**
+ * State shared between main and the verbose mode leaderboard thread.
+ */
+typedef struct
+{
+    Word_Dict *wordDictionary;  /**< Dictionary whose leaderboard to print */
+    pthread_mutex_t mut;        /**< Protects stop */
+    pthread_cond_t cond;        /**< Signaled when stop is set */
+    Bool_t stop;                /**< Set by main once counting is done */
+} LeaderboardArgs_t;
+
 /*******************************************************************************
  * Local Function Prototypes 
  *******************************************************************************
  */
 void *workerThread (void *arg);
+void *leaderboardThread (void *arg);
+static long parseLongArg (const char *arg);
+static void reportMemoryLimit (Word_Dict * dict);
+static int queryDictFile (const char *path, Bool_t verify, char **words,
+                          int num_words);
 
 /*******************************************************************************
  * File Scoped Variables 
@@ -107,6 +171,25 @@ void *workerThread (void *arg);
 /** If set extending print output will be written to the screen */
 Bool_t g_debug_output = FALSE;
 
+/** Command line options, short options are also listed in main() */
+static const struct option g_long_options[] = {
+    {"cms-width", required_argument, NULL, OPT_CMS_WIDTH},
+    {"cms-depth", required_argument, NULL, OPT_CMS_DEPTH},
+    {"hh-size", required_argument, NULL, OPT_HH_SIZE},
+    {"hll", no_argument, NULL, OPT_HLL},
+    {"hll-only", no_argument, NULL, OPT_HLL_ONLY},
+    {"verify", no_argument, NULL, OPT_VERIFY},
+    {"prefix", required_argument, NULL, OPT_PREFIX},
+    {"mem-limit", required_argument, NULL, OPT_MEM_LIMIT},
+    {"mem-policy", required_argument, NULL, OPT_MEM_POLICY},
+    {"mmap", no_argument, NULL, OPT_MMAP},
+    {"io-uring", no_argument, NULL, OPT_IO_URING},
+    {"io-policy", required_argument, NULL, OPT_IO_POLICY},
+    {"chunk-size", required_argument, NULL, OPT_CHUNK_SIZE},
+    {"utf8", no_argument, NULL, OPT_UTF8},
+    {NULL, 0, NULL, 0}
+};
+
 /*******************************************************************************
  ********************* E X T E R N A L  F U N C T I O N S **********************
  *******************************************************************************
@@ -115,51 +198,212 @@ Bool_t g_debug_output = FALSE;
 int main (int argc, char *argv[])
 {
     int opt = 1;
-    char *endptr = NULL;
-    long tmp_long = 1;
     long num_worker_threads = 1;
+    long num_dict_shards = WORD_DICT_DEFAULT_SHARDS;
+    Bool_t thread_local_dicts = FALSE;
+    Dict_Backend_t dict_backend = DICT_BACKEND_HASH;
+    Bool_t approximate = FALSE;
+    long cms_width = APPROX_DEFAULT_WIDTH;
+    long cms_depth = APPROX_DEFAULT_DEPTH;
+    long hh_size = APPROX_DEFAULT_CANDIDATES;
+    Bool_t estimate_distinct = FALSE;
+    Bool_t count_words = TRUE;
+    Hyper_Log_Log **thread_distinct = NULL;
+    const char *save_path = NULL;
+    const char *load_path = NULL;
+    Bool_t verify_file = FALSE;
+    char *prefix = NULL;
+    size_t mem_limit = 0;
+    size_t read_bytes = PROCESS_READ_BYTES;
+    Process_Read_Mode_t read_mode = PROCESS_READ_SYSCALL;
+    Process_Io_Policy_t io_policy = PROCESS_IO_NORMAL;
+    size_t chunk_bytes = PROCESS_CHUNK_BYTES;
+    double active_seconds = 0.0;
+    uint64_t mapped_files = 0;
+    uint64_t mapped_total = 0;
+    uint64_t read_calls = 0;
+    uint64_t read_total = 0;
+    Mem_Policy_t mem_policy = MEM_POLICY_PRUNE;
+    Mem_Stats_t mem_stats;
+    vector < Dict_Entry_t > top_list;
+    size_t idx = 0;
+    int exit_status = EXIT_SUCCESS;
+    Word_Dict **local_dicts = NULL;
     char *first_dir = NULL;
     pthread_t *thread_array = NULL;
     ReaderWriterArgs_t *args_array = NULL;
     int stat = 0;
     int thread_idx = 0;
+    pthread_t leaderboard_thread;
+    LeaderboardArgs_t leaderboard_args;
+    Bool_t leaderboard_running = FALSE;
 
 
     Work_Queue *fileProcessingQueue = new Work_Queue ();
-    Word_Dict *wordDictionary = new Word_Dict ();
+    Word_Dict *wordDictionary = NULL;
 
-    while ((opt = getopt (argc, argv, "t:v")) != -1)
+    while ((opt =
+            getopt_long (argc, argv, "ab:d:i:lo:s:t:v", g_long_options,
+                         NULL)) != -1)
     {
         switch (opt)
         {
-        case 't':
-            tmp_long = strtol (optarg, &endptr, BASE_TEN);
-            if ((errno == ERANGE
-                 && (tmp_long == LONG_MAX || tmp_long == LONG_MIN))
-                || (errno != 0 && tmp_long == 0))
+        case 'a':
+            approximate = TRUE;
+            break;
+        case OPT_CMS_WIDTH:
+            cms_width = parseLongArg (optarg);
+            if ((cms_width < 1) || (cms_width > 0x7FFFFFFFL))
             {
-                perror ("strtol");
+                fprintf (stderr, "Sketch width must be 1..%ld\n",
+                         0x7FFFFFFFL);
                 exit (EXIT_FAILURE);
             }
-
-            if (endptr == optarg)
+            break;
+        case OPT_CMS_DEPTH:
+            cms_depth = parseLongArg (optarg);
+            if ((cms_depth < 1) || (cms_depth > APPROX_MAX_DEPTH))
+            {
+                fprintf (stderr, "Sketch depth must be 1..%d\n",
+                         APPROX_MAX_DEPTH);
+                exit (EXIT_FAILURE);
+            }
+            break;
+        case OPT_HH_SIZE:
+            hh_size = parseLongArg (optarg);
+            if (hh_size < 1)
+            {
+                fprintf (stderr, "Heavy hitter set size must be >= 1\n");
+                exit (EXIT_FAILURE);
+            }
+            break;
+        case OPT_HLL:
+            estimate_distinct = TRUE;
+            break;
+        case OPT_HLL_ONLY:
+            estimate_distinct = TRUE;
+            count_words = FALSE;
+            break;
+        case 'b':
+            if ((parseMemSize (optarg, &read_bytes) == FALSE) ||
+                (read_bytes < PROCESS_READ_MIN_BYTES) ||
+                (read_bytes > PROCESS_READ_MAX_BYTES))
             {
-                fprintf (stderr, "No digits were found\n");
+                fprintf (stderr, "Read size must be %d..%d bytes\n",
+                         PROCESS_READ_MIN_BYTES, PROCESS_READ_MAX_BYTES);
                 exit (EXIT_FAILURE);
             }
-            num_worker_threads = tmp_long;
+            break;
+        case OPT_MMAP:
+            read_mode = PROCESS_READ_MMAP;
+            break;
+        case OPT_IO_URING:
+            read_mode = PROCESS_READ_URING;
+            break;
+        case OPT_IO_POLICY:
+            if (parseIoPolicy (optarg, &io_policy) == FALSE)
+            {
+                fprintf (stderr, "Unknown I/O policy '%s'\n", optarg);
+                exit (EXIT_FAILURE);
+            }
+            break;
+        case OPT_CHUNK_SIZE:
+            if (parseMemSize (optarg, &chunk_bytes) == FALSE)
+            {
+                fprintf (stderr, "Bad chunk size '%s'\n", optarg);
+                exit (EXIT_FAILURE);
+            }
+            break;
+        case OPT_UTF8:
+            tokenizeSetUtf8 (TRUE);
+            break;
+        case 'd':
+            if (parseDictBackend (optarg, &dict_backend) == FALSE)
+            {
+                fprintf (stderr, "Unknown dictionary backend '%s'\n",
+                         optarg);
+                exit (EXIT_FAILURE);
+            }
+            break;
+        case 'i':
+            load_path = optarg;
+            break;
+        case OPT_VERIFY:
+            verify_file = TRUE;
+            break;
+        case OPT_PREFIX:
+            /* Words are counted case folded, UTF-8 words too */
+            prefix = optarg;
+            utf8FoldWord (prefix, prefix, strlen (prefix));
+            break;
+        case OPT_MEM_LIMIT:
+            if ((parseMemSize (optarg, &mem_limit) == FALSE) ||
+                (mem_limit == 0))
+            {
+                fprintf (stderr, "Bad memory limit '%s'\n", optarg);
+                exit (EXIT_FAILURE);
+            }
+            break;
+        case OPT_MEM_POLICY:
+            if (parseMemPolicy (optarg, &mem_policy) == FALSE)
+            {
+                fprintf (stderr, "Unknown memory limit policy '%s'\n",
+                         optarg);
+                exit (EXIT_FAILURE);
+            }
+            break;
+        case 'l':
+            thread_local_dicts = TRUE;
+            break;
+        case 'o':
+            save_path = optarg;
+            break;
+        case 's':
+            num_dict_shards = parseLongArg (optarg);
+            if ((num_dict_shards < 1)
+                || (num_dict_shards > WORD_DICT_MAX_SHARDS))
+            {
+                fprintf (stderr, "Shard count must be 1..%d\n",
+                         WORD_DICT_MAX_SHARDS);
+                exit (EXIT_FAILURE);
+            }
+            break;
+        case 't':
+            num_worker_threads = parseLongArg (optarg);
             break;
         case 'v':
             g_debug_output = TRUE;
             printf ("=========== VERBOSE DEBUG OUPUT SET ===========\n");
             break;
         default:
-            fprintf (stderr, "Usage: %s [-t num_threads] <first_dir_path>\n",
-                     argv[0]);
+            fprintf (stderr, USAGE_STRING, argv[0], argv[0]);
             exit (EXIT_FAILURE);
         }
     }
 
+    /*
+     * A saved dictionary answers queries straight from the file, nothing is
+     * counted.
+     */
+    if (load_path != NULL)
+    {
+        delete fileProcessingQueue;
+        return (queryDictFile (load_path, verify_file, &argv[optind],
+                               argc - optind));
+    }
+    if ((save_path != NULL) && (count_words == FALSE))
+    {
+        fprintf (stderr, "-o needs word counts, not --hll-only\n");
+        exit (EXIT_FAILURE);
+    }
+    if ((save_path != NULL) && (mem_limit > 0) &&
+        (mem_policy == MEM_POLICY_SPILL))
+    {
+        fprintf (stderr, "-o saves the counts in memory, not spilled runs, "
+                 "use another --mem-policy\n");
+        exit (EXIT_FAILURE);
+    }
+
     /*
      * Now optind (declared extern int by <unistd.h>) is the index of the first non-option argument. 
      */
@@ -168,15 +412,75 @@ int main (int argc, char *argv[])
      */
     if (optind >= argc)
     {
-        fprintf (stderr, "Usage: %s [-t num_threads] <first_dir_path>\n",
-                 argv[0]);
+        fprintf (stderr, USAGE_STRING, argv[0], argv[0]);
         exit (EXIT_FAILURE);
     }
     first_dir = argv[optind];
 
     DEBUG_PRINTF ("Number of threads:  %li\n", num_worker_threads);
+    DEBUG_PRINTF ("Dictionary shards:  %li\n", num_dict_shards);
+    DEBUG_PRINTF ("Dictionary backend: %s\n", dictBackendName (dict_backend));
+    DEBUG_PRINTF ("Read size:          %lu bytes%s\n",
+                  (unsigned long) read_bytes,
+                  (read_mode == PROCESS_READ_MMAP) ? ", mmap bigger files" :
+                  (read_mode == PROCESS_READ_URING) ? ", io_uring" : "");
+    DEBUG_PRINTF ("I/O policy:         %s\n", processIoPolicyName (io_policy));
+    if (chunk_bytes > 0)
+    {
+        DEBUG_PRINTF ("Chunk size:         %lu bytes\n",
+                      (unsigned long) chunk_bytes);
+    }
+    DEBUG_PRINTF ("Words:              %s\n",
+                  (tokenizeUtf8 () == TRUE) ? "UTF-8" : "ASCII");
+    DEBUG_PRINTF ("Word scan kernel:   %s\n",
+                  wordScanKernelName (wordScanKernel ()));
+    DEBUG_PRINTF ("Dictionary mode:    %s\n",
+                  (thread_local_dicts == TRUE) ? "thread-local" : "shared");
+    if (approximate == TRUE)
+    {
+        DEBUG_PRINTF ("Approximate:        %li x %li sketch, %li candidates\n",
+                      cms_width, cms_depth, hh_size);
+    }
+    if (estimate_distinct == TRUE)
+    {
+        DEBUG_PRINTF ("Distinct estimate:  %d registers, %s\n",
+                      1 << HLL_DEFAULT_PRECISION,
+                      (count_words == TRUE) ? "with counts" : "only");
+    }
+    if (mem_limit > 0)
+    {
+        DEBUG_PRINTF ("Memory limit:       %lu bytes, %s\n",
+                      (unsigned long) mem_limit, memPolicyName (mem_policy));
+    }
     DEBUG_PRINTF ("Based dir:          %s\n", first_dir);
 
+    /*
+     * A shared dictionary counting approximately has one sketch behind one
+     * lock, its shards don't spread the updates.
+     */
+    if ((count_words == TRUE) && (thread_local_dicts == FALSE) &&
+        (num_dict_shards > 1) &&
+        ((approximate == TRUE) ||
+         ((mem_limit > 0) && (mem_policy == MEM_POLICY_APPROX))))
+    {
+        fprintf (stderr, "Warning: approximate counting serializes every "
+                 "update on one lock, -s %li won't spread them, use -l to "
+                 "count in parallel\n", num_dict_shards);
+    }
+
+    if ((count_words == TRUE) && (thread_local_dicts == FALSE))
+    {
+        wordDictionary = new Word_Dict ((unsigned int) num_dict_shards, TRUE,
+                           dict_backend);
+        if (approximate == TRUE)
+        {
+            wordDictionary->enableApproximate ((uint32_t) cms_width,
+                                               (uint32_t) cms_depth,
+                                               (size_t) hh_size);
+        }
+        wordDictionary->setMemoryLimit (mem_limit, mem_policy);
+    }
+
     thread_array =
         (pthread_t *) malloc (num_worker_threads * sizeof (pthread_t));
     args_array =
@@ -196,11 +500,56 @@ int main (int argc, char *argv[])
                  errno, strerror (errno));
         exit (EXIT_FAILURE);
     }
+    if ((count_words == TRUE) && (thread_local_dicts == TRUE))
+    {
+        /*
+         * Each worker counts into its own unlocked dictionary, these get
+         * merged once all of the workers have been joined.
+         */
+        local_dicts = new Word_Dict *[num_worker_threads];
+        for (thread_idx = 0; thread_idx < num_worker_threads; thread_idx++)
+        {
+            local_dicts[thread_idx] =
+                new Word_Dict ((unsigned int) num_dict_shards, FALSE,
+                               dict_backend);
+            if (approximate == TRUE)
+            {
+                local_dicts[thread_idx]->enableApproximate ((uint32_t)
+                                                            cms_width,
+                                                            (uint32_t)
+                                                            cms_depth,
+                                                            (size_t)
+                                                            hh_size);
+            }
+            /* The workers share the limit evenly */
+            local_dicts[thread_idx]->setMemoryLimit (mem_limit /
+                                                     num_worker_threads,
+                                                     mem_policy);
+        }
+    }
+    if (estimate_distinct == TRUE)
+    {
+        /*
+         * A few KB per worker, merged once the workers are joined
+         */
+        thread_distinct = new Hyper_Log_Log *[num_worker_threads];
+        for (thread_idx = 0; thread_idx < num_worker_threads; thread_idx++)
+        {
+            thread_distinct[thread_idx] = new Hyper_Log_Log ();
+        }
+    }
     for (thread_idx = 0; thread_idx < num_worker_threads; thread_idx++)
     {
         args_array[thread_idx].myQueue = fileProcessingQueue;
         args_array[thread_idx].thread_idx = thread_idx;
-        args_array[thread_idx].wordDictionary = wordDictionary;
+        args_array[thread_idx].read_bytes = read_bytes;
+        args_array[thread_idx].read_mode = read_mode;
+        args_array[thread_idx].io_policy = io_policy;
+        args_array[thread_idx].chunk_bytes = chunk_bytes;
+        args_array[thread_idx].wordDictionary =
+            (local_dicts != NULL) ? local_dicts[thread_idx] : wordDictionary;
+        args_array[thread_idx].distinctWords =
+            (thread_distinct != NULL) ? thread_distinct[thread_idx] : NULL;
         stat =
             pthread_create (&thread_array[thread_idx], NULL, workerThread,
                             (void *) &args_array[thread_idx]);
@@ -212,6 +561,26 @@ int main (int argc, char *argv[])
         }
     }
 
+    /*
+     * In verbose mode, show the top words as they change.  Thread-local
+     * dictionaries don't come together until the end, so only the shared
+     * dictionary has a live leaderboard.
+     */
+    if ((g_debug_output == TRUE) && (wordDictionary != NULL))
+    {
+        wordDictionary->enableLeaderboard (LEADERBOARD_SIZE);
+        leaderboard_args.wordDictionary = wordDictionary;
+        leaderboard_args.stop = FALSE;
+        pthread_mutex_init (&leaderboard_args.mut, NULL);
+        pthread_cond_init (&leaderboard_args.cond, NULL);
+        stat = pthread_create (&leaderboard_thread, NULL, leaderboardThread,
+                               (void *) &leaderboard_args);
+        if (stat == 0)
+        {
+            leaderboard_running = TRUE;
+        }
+    }
+
     listdir (first_dir, fileProcessingQueue);
 
     for (thread_idx = 0; thread_idx < num_worker_threads; thread_idx++)
@@ -227,13 +596,119 @@ int main (int argc, char *argv[])
     free (thread_array);
     free (args_array);
 
+    if (leaderboard_running == TRUE)
+    {
+        pthread_mutex_lock (&leaderboard_args.mut);
+        leaderboard_args.stop = TRUE;
+        pthread_cond_signal (&leaderboard_args.cond);
+        pthread_mutex_unlock (&leaderboard_args.mut);
+        pthread_join (leaderboard_thread, NULL);
+        pthread_cond_destroy (&leaderboard_args.cond);
+        pthread_mutex_destroy (&leaderboard_args.mut);
+    }
+
+    if (g_debug_output == TRUE)
+    {
+        memStatsClear (&mem_stats);
+        mem_stats.bytes[MEM_QUEUE] += fileProcessingQueue->bytesUsed ();
+        mem_stats.bytes[MEM_BUFFERS] += processPeakBytes ();
+        for (thread_idx = 0; thread_idx < num_worker_threads; thread_idx++)
+        {
+            if (local_dicts != NULL)
+            {
+                local_dicts[thread_idx]->memoryUsage (&mem_stats);
+                reportMemoryLimit (local_dicts[thread_idx]);
+            }
+            if (thread_distinct != NULL)
+            {
+                mem_stats.bytes[MEM_SKETCHES] +=
+                    thread_distinct[thread_idx]->bytesUsed ();
+            }
+        }
+        if (wordDictionary != NULL)
+        {
+            wordDictionary->memoryUsage (&mem_stats);
+            reportMemoryLimit (wordDictionary);
+        }
+        printf ("Memory by component, buffers at their peak:\n");
+        memStatsPrint (&mem_stats);
+        processReadStats (&read_calls, &read_total);
+        printf ("Reads: %lu calls, %.1f MB, %.1f calls per MB\n",
+                (unsigned long) read_calls,
+                (double) read_total / (1024.0 * 1024.0),
+                (read_total > 0) ?
+                ((double) read_calls * 1024.0 * 1024.0 / read_total) : 0.0);
+        processMapStats (&mapped_files, &mapped_total);
+        if (mapped_files > 0)
+        {
+            printf ("Mapped: %lu files, %.1f MB\n",
+                    (unsigned long) mapped_files,
+                    (double) mapped_total / (1024.0 * 1024.0));
+        }
+        active_seconds = processActiveSeconds ();
+        printf ("Throughput (%s): %.1f MB in %.3f s, %.1f MB/s\n",
+                processIoPolicyName (io_policy),
+                (double) (read_total + mapped_total) / (1024.0 * 1024.0),
+                active_seconds, (active_seconds > 0.0) ?
+                ((double) (read_total + mapped_total) /
+                 (1024.0 * 1024.0) / active_seconds) : 0.0);
+    }
+
+    if (thread_distinct != NULL)
+    {
+        for (thread_idx = 1; thread_idx < num_worker_threads; thread_idx++)
+        {
+            thread_distinct[0]->merge (*thread_distinct[thread_idx]);
+            delete thread_distinct[thread_idx];
+        }
+        printf ("Distinct words (estimated): %.0f (+/- %.1f%%, %lu bytes)\n",
+                thread_distinct[0]->estimate (),
+                100.0 * thread_distinct[0]->standardError (),
+                (unsigned long) thread_distinct[0]->bytesUsed ());
+        delete thread_distinct[0];
+        delete[]thread_distinct;
+    }
 
-    wordDictionary->printTopX (10);
+    if (local_dicts != NULL)
+    {
+        DEBUG_PRINTF ("Merging %li thread-local dictionaries\n",
+                      num_worker_threads);
+        wordDictionary =
+            mergeDictionaries (local_dicts, (int) num_worker_threads);
+        for (thread_idx = 1; thread_idx < num_worker_threads; thread_idx++)
+        {
+            delete local_dicts[thread_idx];
+        }
+        delete[]local_dicts;
+    }
+
+    if ((wordDictionary != NULL) && (prefix != NULL))
+    {
+        wordDictionary->selectPrefixTopX (prefix, strlen (prefix), 10,
+                                          top_list);
+        for (idx = 0; idx < top_list.size (); idx++)
+        {
+            printf ("%.*s\t%d\n", (int) top_list[idx].len,
+                    top_list[idx].word, top_list[idx].count);
+        }
+    }
+    else if (wordDictionary != NULL)
+    {
+        wordDictionary->printTopX (10, (int) num_worker_threads);
+    }
+    if ((save_path != NULL) && (wordDictionary != NULL))
+    {
+        DEBUG_PRINTF ("Saving dictionary to %s\n", save_path);
+        if (saveDictFile (*wordDictionary, save_path) == FALSE)
+        {
+            exit_status = EXIT_FAILURE;
+        }
+    }
 
     delete fileProcessingQueue;
     delete wordDictionary;
 
-    return 0;
+    return (exit_status);
 }                               /* main */
 
 /*******************************************************************************
@@ -269,6 +744,13 @@ int main (int argc, char *argv[])
  *      pulls it off of the queue and starts reading and processing it.  If the
  *      path is instead the "EXIT" command, then thread gracefullys exits to be
  *      harvested by thread_join.
+ *
+ *      A file bigger than the chunk size is split, see processSplitItem(),
+ *      this thread counts the first chunk and the others are queued first.
+ *
+ *      With --io-uring the paths are taken by processFilesUring() instead,
+ *      several files at a time, falling back to this loop if the kernel has
+ *      no io_uring.
  *******************************************************************************
  */
 void *workerThread (void *arg)
@@ -277,10 +759,29 @@ void *workerThread (void *arg)
     Work_Queue *q = _arg->myQueue;
     Word_Dict *dict = _arg->wordDictionary;
     string queueString = "";
+    Work_Item_t item;
     int tid = _arg->thread_idx;
 
     DEBUG_PRINTF ("Worker Thread #%d starting...\n", tid);
     sleep (1);                  /* To allow threads to get started */
+    if (_arg->read_mode == PROCESS_READ_URING)
+    {
+        /*
+         * Takes paths from the queue itself, up to the EXIT, unless there is
+         * no io_uring, then the files are read() below.
+         */
+        if (processFilesUring (tid, q, dict, PROCESS_FLUSH_BYTES,
+                               _arg->distinctWords, _arg->read_bytes,
+                               _arg->io_policy, _arg->chunk_bytes) == TRUE)
+        {
+            queueString = "EXIT";
+        }
+        else
+        {
+            DEBUG_PRINTF ("[%d] io_uring not available, using read()\n",
+                          tid);
+        }
+    }
     while (queueString != "EXIT")
     {
         if (q->empty ())
@@ -289,12 +790,26 @@ void *workerThread (void *arg)
             q->waitForNotEmpty ();
         }
         DEBUG_PRINTF ("[%d] Queue not empty, popping front\n", tid);
-        queueString = q->pop_front ();
+        item = q->popItem ();
+        queueString = item.path;
 
         if (queueString != "EXIT")
         {
             DEBUG_PRINTF ("[%d] Processing:%s\n", tid, queueString.c_str ());
-            processFile (tid, queueString, dict);
+            if (processSplitItem (q, item, _arg->chunk_bytes) > 1)
+            {
+                DEBUG_PRINTF ("[%d] Split into %lu byte chunks\n", tid,
+                              (unsigned long) item.length);
+            }
+            processFile (tid, queueString, dict, PROCESS_FLUSH_BYTES,
+                         _arg->distinctWords, _arg->read_bytes,
+                         _arg->read_mode, _arg->io_policy, item.offset,
+                         item.length);
+            if (dict != NULL)
+            {
+                (void) dict->checkMemoryLimit (q->bytesUsed () +
+                                               processBytesUsed ());
+            }
         }
         else
         {
@@ -305,3 +820,172 @@ void *workerThread (void *arg)
 
     return (NULL);
 }
+
+/**
+ *******************************************************************************
+ * @brief leaderboardThread - Verbose mode thread printing the dictionary's
+ * live leaderboard every LEADERBOARD_PERIOD_SEC, until told to stop.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      arg            Pointer to the LeaderboardArgs_t
+ *
+ * <!-- Returns -->
+ *      None (if return type is void)
+ *
+ * @par Pre/Post Conditions:
+ *      @pre     enableLeaderboard() has been called on the dictionary.
+ *
+ * @par Global Data:
+ *      None (if no global data)
+ *
+ * @par Description:
+ *      Waits on the stop condition with a timeout rather than sleeping, so
+ *      main doesn't have to wait out a whole period at the end of the run.
+ *******************************************************************************
+ */
+void *leaderboardThread (void *arg)
+{
+    LeaderboardArgs_t *_arg = (LeaderboardArgs_t *) arg;
+    vector < pair < string, int > >leaders;
+    struct timespec wake_time;
+    size_t idx = 0;
+
+    pthread_mutex_lock (&_arg->mut);
+    while (_arg->stop == FALSE)
+    {
+        clock_gettime (CLOCK_REALTIME, &wake_time);
+        wake_time.tv_sec += LEADERBOARD_PERIOD_SEC;
+        while ((_arg->stop == FALSE) &&
+               (pthread_cond_timedwait (&_arg->cond, &_arg->mut,
+                                        &wake_time) == 0))
+        {
+            /* Spurious wakeup, keep waiting for the same deadline */
+        }
+        if (_arg->stop == TRUE)
+        {
+            break;
+        }
+        _arg->wordDictionary->getLeaderboard (leaders);
+        printf ("Leaderboard: -----------------------------------------\n");
+        for (idx = 0; idx < leaders.size (); idx++)
+        {
+            printf ("  %2lu. %s\t%d\n", (unsigned long) idx + 1,
+                    leaders[idx].first.c_str (), leaders[idx].second);
+        }
+    }
+    pthread_mutex_unlock (&_arg->mut);
+
+    return (NULL);
+}
+
+/**
+ *******************************************************************************
+ * @brief parseLongArg - Convert a numeric command line argument, exitting with
+ * an error message if it is not a valid number.
+ *******************************************************************************
+ */
+static long parseLongArg (const char *arg)
+{
+    char *endptr = NULL;
+    long tmp_long = 0;
+
+    errno = 0;
+    tmp_long = strtol (arg, &endptr, BASE_TEN);
+    if ((errno == ERANGE && (tmp_long == LONG_MAX || tmp_long == LONG_MIN))
+        || (errno != 0 && tmp_long == 0))
+    {
+        perror ("strtol");
+        exit (EXIT_FAILURE);
+    }
+
+    if (endptr == arg)
+    {
+        fprintf (stderr, "No digits were found\n");
+        exit (EXIT_FAILURE);
+    }
+    return (tmp_long);
+}
+
+/**
+ *******************************************************************************
+ * @brief reportMemoryLimit - Verbose mode note of what a dictionary's memory
+ * limit policy did, if anything.
+ *******************************************************************************
+ */
+static void reportMemoryLimit (Word_Dict * dict)
+{
+    if (dict->getMemoryLimit () == 0)
+    {
+        return;
+    }
+    if ((dict->getMemoryPolicy () == MEM_POLICY_APPROX) &&
+        (dict->isApproximate () == TRUE))
+    {
+        printf ("Memory limit reached, switched to approximate counting\n");
+    }
+    else if (dict->getSpilledRuns () > 0)
+    {
+        printf ("Memory limit reached, spilled %lu runs, %lu bytes\n",
+                (unsigned long) dict->getSpilledRuns (),
+                (unsigned long) dict->getSpilledBytes ());
+    }
+    else if (dict->getPrunedWords () > 0)
+    {
+        printf ("Memory limit reached, pruned %lu words below count %d\n",
+                (unsigned long) dict->getPrunedWords (),
+                dict->getPruneFloor ());
+    }
+}
+
+/**
+ *******************************************************************************
+ * @brief queryDictFile - Answer queries from a dictionary saved with -o.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      path           Dictionary file to map
+ *      @param[in]      verify         If TRUE, check the whole file first
+ *      @param[in]      words          Words to look up
+ *      @param[in]      num_words      Number of 'words', 0 to print the top 10
+ *
+ * <!-- Returns -->
+ *      @return exit status for main().
+ *
+ * @par Description:
+ *      Words are lowercased, as they were when counted.  A word not in the
+ *      file has a count of 0.
+ *******************************************************************************
+ */
+static int queryDictFile (const char *path, Bool_t verify, char **words,
+                          int num_words)
+{
+    Dict_File dict_file;
+    string word;
+    int count = 0;
+    int word_idx = 0;
+
+    if (dict_file.open (path, verify) == FALSE)
+    {
+        return (EXIT_FAILURE);
+    }
+    DEBUG_PRINTF ("Loaded %lu words (%lu total) from %s\n",
+                  (unsigned long) dict_file.size (),
+                  (unsigned long) dict_file.totalCount (), path);
+    if (dict_file.hasPerfectHash () == TRUE)
+    {
+        DEBUG_PRINTF ("Perfect hash index, %.2f bits per word\n",
+                      dict_file.table ().perfectHash ().bitsPerKey ());
+    }
+    if (num_words == 0)
+    {
+        dict_file.printTopX (10);
+        return (EXIT_SUCCESS);
+    }
+    for (word_idx = 0; word_idx < num_words; word_idx++)
+    {
+        word = words[word_idx];
+        utf8FoldWord (word.data (), &word[0], word.size ());
+        count = dict_file.getWordCount (word.data (), word.size ());
+        printf ("%s\t%d\n", word.c_str (), (count < 0) ? 0 : count);
+    }
+    return (EXIT_SUCCESS);
+}
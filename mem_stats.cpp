@@ -0,0 +1,331 @@
+/**
+ * @file           mem_stats.cpp
+ * @brief:         Memory accounting by component, and memory limit policies.
+ * @verbatim
+ *******************************************************************************
+ * Author:         Douglas L. Potts
+ *
+ * Date:           10/17/2026, <SCR #>
+ *
+ *==============================================================================
+ *==============================================================================
+ * Copyright (c) 2015 Douglas Lee Potts
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ *==============================================================================
+ *==============================================================================
+ *
+ * History:
+ * Date        SCR #  Name  Description
+ * -----------------------------------------------------------------------------
+ *
+ *******************************************************************************
+ * @endverbatim
+ */
+
+/*******************************************************************************
+ * System Includes
+ *******************************************************************************
+ */
+#include <stdio.h>              /* for printf() */
+#include <stdlib.h>             /* for strtoul() */
+#include <string.h>             /* for strcmp() */
+#include <ctype.h>              /* for toupper() */
+
+/*******************************************************************************
+ * Project Includes
+ *******************************************************************************
+ */
+#include "common_types.h"
+#include "mem_stats.hpp"
+#if defined(TEST)
+#include "unity.h"
+#include "work_queue.hpp"
+#endif /* defined(TEST) */
+
+/*******************************************************************************
+ * Local Function Prototypes 
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * Local Constants 
+ *******************************************************************************
+ */
+#define DBG(X)
+
+/*******************************************************************************
+ * File Scoped Variables 
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ ********************* E X T E R N A L  F U N C T I O N S **********************
+ *******************************************************************************
+ */
+
+#if defined(TEST)
+extern "C"
+{
+    void memStatsParseSize (void)
+    {
+        size_t bytes = 0;
+        Mem_Policy_t policy = MEM_POLICY_NONE;
+
+        TEST_ASSERT_TRUE (parseMemSize ("4096", &bytes) == TRUE);
+        TEST_ASSERT_EQUAL (bytes, 4096);
+        TEST_ASSERT_TRUE (parseMemSize ("64k", &bytes) == TRUE);
+        TEST_ASSERT_EQUAL (bytes, 64 * 1024);
+        TEST_ASSERT_TRUE (parseMemSize ("512M", &bytes) == TRUE);
+        TEST_ASSERT_EQUAL (bytes, 512 * 1024 * 1024);
+        TEST_ASSERT_TRUE (parseMemSize ("1g", &bytes) == TRUE);
+        TEST_ASSERT_EQUAL (bytes, 1024 * 1024 * 1024);
+
+        /*
+         * Bad sizes leave 'bytes' alone
+         */
+        TEST_ASSERT_TRUE (parseMemSize ("", &bytes) == FALSE);
+        TEST_ASSERT_TRUE (parseMemSize ("M", &bytes) == FALSE);
+        TEST_ASSERT_TRUE (parseMemSize ("12Q", &bytes) == FALSE);
+        TEST_ASSERT_TRUE (parseMemSize ("12MB", &bytes) == FALSE);
+        TEST_ASSERT_TRUE (parseMemSize ("-5", &bytes) == FALSE);
+        TEST_ASSERT_EQUAL (bytes, 1024 * 1024 * 1024);
+
+        TEST_ASSERT_TRUE (parseMemPolicy ("prune", &policy) == TRUE);
+        TEST_ASSERT_EQUAL (policy, MEM_POLICY_PRUNE);
+        TEST_ASSERT_TRUE (parseMemPolicy ("approx", &policy) == TRUE);
+        TEST_ASSERT_EQUAL (policy, MEM_POLICY_APPROX);
+        TEST_ASSERT_TRUE (parseMemPolicy ("spill", &policy) == TRUE);
+        TEST_ASSERT_EQUAL (policy, MEM_POLICY_SPILL);
+        TEST_ASSERT_TRUE (parseMemPolicy ("none", &policy) == TRUE);
+        TEST_ASSERT_EQUAL (policy, MEM_POLICY_NONE);
+        TEST_ASSERT_TRUE (parseMemPolicy ("drop", &policy) == FALSE);
+        TEST_ASSERT_EQUAL_STRING (memPolicyName (MEM_POLICY_APPROX),
+                                  "approx");
+    }
+    void memStatsComponents (void)
+    {
+        Mem_Stats_t stats;
+        Work_Queue *queue = NULL;
+        int idx = 0;
+
+        memStatsClear (&stats);
+        TEST_ASSERT_EQUAL (memStatsTotal (&stats), 0);
+        for (idx = 0; idx < MEM_NUM_COMPONENTS; idx++)
+        {
+            stats.bytes[idx] += (size_t) (idx + 1) * 100;
+            TEST_ASSERT_TRUE (strcmp
+                              (memComponentName ((Mem_Component_t) idx),
+                               "unknown") != 0);
+        }
+        TEST_ASSERT_EQUAL (memStatsTotal (&stats), 2800);
+        TEST_ASSERT_EQUAL_STRING (memComponentName (MEM_ARENA), "arena");
+        TEST_ASSERT_EQUAL_STRING (memComponentName (MEM_NUM_COMPONENTS),
+                                  "unknown");
+
+        /*
+         * Queued paths are counted while they wait
+         */
+        queue = new Work_Queue ();
+        TEST_ASSERT_EQUAL (queue->bytesUsed (), 0);
+        queue->push ("/tmp/one.txt");
+        queue->push ("/tmp/two.txt");
+        TEST_ASSERT_EQUAL (queue->bytesUsed (),
+                           2 * (sizeof (Work_Item_t) + 13));
+        (void) queue->pop_front ();
+        queue->pop ();
+        TEST_ASSERT_EQUAL (queue->bytesUsed (), 0);
+        delete queue;
+    }
+}
+#endif /* defined(TEST) */
+
+/**
+ *******************************************************************************
+ * @brief memStatsClear - Zero every component.
+ *******************************************************************************
+ */
+void memStatsClear (Mem_Stats_t * stats)
+{
+    memset (stats, 0, sizeof (*stats));
+}
+
+/**
+ *******************************************************************************
+ * @brief memStatsTotal - Bytes summed over every component.
+ *******************************************************************************
+ */
+size_t memStatsTotal (const Mem_Stats_t * stats)
+{
+    size_t total = 0;
+    int idx = 0;
+
+    for (idx = 0; idx < MEM_NUM_COMPONENTS; idx++)
+    {
+        total += stats->bytes[idx];
+    }
+    return (total);
+}
+
+/**
+ *******************************************************************************
+ * @brief memStatsPrint - One line per component with any bytes, then the
+ * total, in KiB.
+ *******************************************************************************
+ */
+void memStatsPrint (const Mem_Stats_t * stats)
+{
+    int idx = 0;
+
+    for (idx = 0; idx < MEM_NUM_COMPONENTS; idx++)
+    {
+        if (stats->bytes[idx] == 0)
+        {
+            continue;
+        }
+        printf ("  %-10s %10.1f KiB\n",
+                memComponentName ((Mem_Component_t) idx),
+                (double) stats->bytes[idx] / 1024.0);
+    }
+    printf ("  %-10s %10.1f KiB\n", "total",
+            (double) memStatsTotal (stats) / 1024.0);
+}
+
+/**
+ *******************************************************************************
+ * @brief memComponentName - Printable name for a component.
+ *******************************************************************************
+ */
+const char *memComponentName (Mem_Component_t component)
+{
+    switch (component)
+    {
+    case MEM_KEYS:
+        return ("keys");
+    case MEM_INDEX:
+        return ("index");
+    case MEM_ARENA:
+        return ("arena");
+    case MEM_SNAPSHOTS:
+        return ("snapshots");
+    case MEM_SKETCHES:
+        return ("sketches");
+    case MEM_QUEUE:
+        return ("queue");
+    case MEM_BUFFERS:
+        return ("buffers");
+    default:
+        return ("unknown");
+    }
+}
+
+/**
+ *******************************************************************************
+ * @brief memPolicyName - Printable name for a memory limit policy, as used by
+ * parseMemPolicy().
+ *******************************************************************************
+ */
+const char *memPolicyName (Mem_Policy_t policy)
+{
+    switch (policy)
+    {
+    case MEM_POLICY_NONE:
+        return ("none");
+    case MEM_POLICY_PRUNE:
+        return ("prune");
+    case MEM_POLICY_APPROX:
+        return ("approx");
+    case MEM_POLICY_SPILL:
+        return ("spill");
+    default:
+        return ("unknown");
+    }
+}
+
+/**
+ *******************************************************************************
+ * @brief parseMemPolicy - Convert a memory limit policy name from the command
+ * line.
+ *
+ * <!-- Returns -->
+ *      @return TRUE and sets *policy if 'name' is a known policy
+ *      @return FALSE otherwise
+ *******************************************************************************
+ */
+Bool_t parseMemPolicy (const char *name, Mem_Policy_t * policy)
+{
+    int idx = 0;
+
+    for (idx = MEM_POLICY_NONE; idx <= MEM_POLICY_SPILL; idx++)
+    {
+        if (strcmp (name, memPolicyName ((Mem_Policy_t) idx)) == 0)
+        {
+            *policy = (Mem_Policy_t) idx;
+            return (TRUE);
+        }
+    }
+    return (FALSE);
+}
+
+/**
+ *******************************************************************************
+ * @brief parseMemSize - Convert a size from the command line, a number of
+ * bytes with an optional K, M or G suffix (powers of 1024, either case).
+ *
+ * <!-- Returns -->
+ *      @return TRUE and sets *bytes if 'text' is a valid size
+ *      @return FALSE otherwise, leaving *bytes alone
+ *******************************************************************************
+ */
+Bool_t parseMemSize (const char *text, size_t * bytes)
+{
+    char *end = NULL;
+    unsigned long value = 0;
+    size_t scale = 1;
+
+    if ((text[0] < '0') || (text[0] > '9'))
+    {
+        return (FALSE);
+    }
+    value = strtoul (text, &end, 10);
+    switch (toupper ((unsigned char) *end))
+    {
+    case '\0':
+        break;
+    case 'K':
+        scale = 1024;
+        end++;
+        break;
+    case 'M':
+        scale = 1024 * 1024;
+        end++;
+        break;
+    case 'G':
+        scale = 1024 * 1024 * 1024;
+        end++;
+        break;
+    default:
+        return (FALSE);
+    }
+    if ((*end != '\0') || (value > ((size_t) -1) / scale))
+    {
+        return (FALSE);
+    }
+    *bytes = (size_t) value * scale;
+    return (TRUE);
+}
+
+/*******************************************************************************
+ ************************ L O C A L  F U N C T I O N S *************************
+ *******************************************************************************
+ */
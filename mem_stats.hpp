@@ -0,0 +1,143 @@
+#ifndef __MEM_STATS_H__
+#define __MEM_STATS_H__
+/**
+ * @file           mem_stats.hpp
+ * @brief:         Memory accounting by component, and memory limit policies.
+ * @verbatim
+ *******************************************************************************
+ * Author:         Douglas L. Potts
+ *
+ * Date:           10/17/2026, <SCR #>
+ *
+ *==============================================================================
+ *==============================================================================
+ * Copyright (c) 2015 Douglas Lee Potts
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ *==============================================================================
+ *==============================================================================
+ *
+ * History:
+ * Date        SCR #  Name  Description
+ * -----------------------------------------------------------------------------
+ *
+ *******************************************************************************
+ * @endverbatim
+ */
+
+/*******************************************************************************
+ * System Includes
+ *******************************************************************************
+ */
+#include <stddef.h>             /* for size_t */
+
+/*******************************************************************************
+ * Project Includes
+ *******************************************************************************
+ */
+#include "common_types.h"
+
+#if defined(TEST)
+extern "C"
+{
+    void memStatsParseSize (void);
+    void memStatsComponents (void);
+}
+#endif                          /* defined(TEST) */
+
+/*******************************************************************************
+ * Typedefs
+ *******************************************************************************
+ */
+
+/** What a counted byte of memory is being used for */
+typedef enum
+{
+    MEM_KEYS = 0,               /**< Word bytes held outside an arena, such as
+                                  heap allocated std::string keys */
+    MEM_INDEX = 1,              /**< Lookup structure: hash slots, tree and
+                                  trie nodes, radix leaves */
+    MEM_ARENA = 2,              /**< Key_Arena blocks and id tables */
+    MEM_SNAPSHOTS = 3,          /**< Shard views cached for snapshots */
+    MEM_SKETCHES = 4,           /**< Count-Min, heavy hitter and HyperLogLog
+                                  state */
+    MEM_QUEUE = 5,              /**< File paths waiting on the work queue */
+    MEM_BUFFERS = 6,            /**< Read buffers and per-file pre-aggregation
+                                  tables of the tokenizer */
+    MEM_NUM_COMPONENTS = 7
+} Mem_Component_t;
+
+/** What a dictionary does when it nears its memory limit */
+typedef enum
+{
+    MEM_POLICY_NONE = 0,        /**< Nothing, the limit is only reported */
+    MEM_POLICY_PRUNE = 1,       /**< Drop the least frequent words */
+    MEM_POLICY_APPROX = 2,      /**< Move the counts into a fixed size sketch
+                                  and carry on approximately */
+    MEM_POLICY_SPILL = 3        /**< Write the counts to a sorted run on disk
+                                  and merge the runs at the end, exactly */
+} Mem_Policy_t;
+
+/*******************************************************************************
+ * Constants
+ *******************************************************************************
+ */
+/** Percent of the memory limit at which the limit policy is applied */
+#define MEM_LIMIT_HIGH_WATER_PCT (90)
+/** Percent of the memory limit pruning brings the usage back down to */
+#define MEM_LIMIT_LOW_WATER_PCT  (60)
+
+/*******************************************************************************
+ * Structures
+ *******************************************************************************
+ */
+
+/**
+ * Bytes in use per component.  Anything reporting its memory adds into one of
+ * these, so a caller can total several owners with one structure.  The figures
+ * are estimates: they count what each structure allocates, not the allocator's
+ * own overhead.
+ */
+typedef struct
+{
+    size_t bytes[MEM_NUM_COMPONENTS];   /**< Bytes, by Mem_Component_t */
+} Mem_Stats_t;
+
+/*******************************************************************************
+ * Unions
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * External Function Prototypes
+ *******************************************************************************
+ */
+void memStatsClear (Mem_Stats_t * stats);
+size_t memStatsTotal (const Mem_Stats_t * stats);
+void memStatsPrint (const Mem_Stats_t * stats);
+const char *memComponentName (Mem_Component_t component);
+const char *memPolicyName (Mem_Policy_t policy);
+Bool_t parseMemPolicy (const char *name, Mem_Policy_t * policy);
+Bool_t parseMemSize (const char *text, size_t * bytes);
+
+/*******************************************************************************
+ * Global Variables
+ *******************************************************************************
+ */
+#if _MAIN_
+#define GLOBAL_VAR_DECLARE
+#else
+#define GLOBAL_VAR_DECLARE extern
+#endif /* _MAIN_ */
+
+#endif /* __MEM_STATS_H__ */
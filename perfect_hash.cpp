@@ -0,0 +1,482 @@
+/**
+ * @file           perfect_hash.cpp
+ * @brief:         Minimal perfect hash over a fixed set of 64-bit keys.
+ * @verbatim
+ *******************************************************************************
+ * Author:         Douglas L. Potts
+ *
+ * Date:           10/17/2026, <SCR #>
+ *
+ *==============================================================================
+ *==============================================================================
+ * Copyright (c) 2015 Douglas Lee Potts
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ *==============================================================================
+ *==============================================================================
+ *
+ * History:
+ * Date        SCR #  Name  Description
+ * -----------------------------------------------------------------------------
+ *
+ *******************************************************************************
+ * @endverbatim
+ */
+
+/*******************************************************************************
+ * System Includes
+ *******************************************************************************
+ */
+#include <stdio.h>              /* for snprintf() */
+#include <string.h>             /* for memset() */
+#include <algorithm>            /* for std::sort */
+
+/*******************************************************************************
+ * Project Includes
+ *******************************************************************************
+ */
+#include "common_types.h"
+#include "word_hash.h"
+#include "perfect_hash.hpp"
+#if defined(TEST)
+#include "unity.h"
+#endif /* defined(TEST) */
+
+/*******************************************************************************
+ * Local Function Prototypes 
+ *******************************************************************************
+ */
+static uint64_t levelBit (uint64_t key, uint64_t level, uint64_t num_bits);
+static unsigned int popCount (uint64_t word);
+
+/*******************************************************************************
+ * Local Constants 
+ *******************************************************************************
+ */
+#define DBG(X)
+
+/** Words before the level bit counts: num_keys, num_levels, num_fallback */
+#define PERFECT_HASH_HEADER_WORDS (3)
+/** 64-bit words covered by each rank */
+#define PERFECT_HASH_RANK_WORDS   (PERFECT_HASH_RANK_BITS / 64)
+
+/*******************************************************************************
+ * File Scoped Variables 
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ ********************* E X T E R N A L  F U N C T I O N S **********************
+ *******************************************************************************
+ */
+
+#if defined(TEST)
+extern "C"
+{
+
+    void perfectHashBuild (void)
+    {
+        static const int NUM_KEYS = 20000;
+        Perfect_Hash *mph = new Perfect_Hash ();
+        Perfect_Hash *attached = new Perfect_Hash ();
+        vector < uint64_t > keys;
+        vector < Bool_t > used (NUM_KEYS, FALSE);
+        char word[32];
+        uint64_t slot = 0;
+        int idx = 0;
+        int len = 0;
+
+        for (idx = 0; idx < NUM_KEYS; idx++)
+        {
+            len = snprintf (word, sizeof (word), "w%d", idx);
+            keys.push_back (wordHash64 (word, len));
+        }
+        TEST_ASSERT_TRUE (mph->build (keys));
+        TEST_ASSERT_EQUAL (mph->size (), NUM_KEYS);
+
+        /* Every key gets its own slot */
+        for (idx = 0; idx < NUM_KEYS; idx++)
+        {
+            slot = mph->lookup (keys[idx]);
+            TEST_ASSERT_TRUE (slot < NUM_KEYS);
+            TEST_ASSERT_FALSE (used[slot]);
+            used[slot] = TRUE;
+        }
+        TEST_ASSERT_TRUE (mph->bitsPerKey () < 5.0);
+
+        /*
+         * The same words, used in place, give the same slots
+         */
+        TEST_ASSERT_TRUE (attached->attach (mph->words (), mph->numWords ()));
+        for (idx = 0; idx < NUM_KEYS; idx++)
+        {
+            TEST_ASSERT_EQUAL (attached->lookup (keys[idx]),
+                               mph->lookup (keys[idx]));
+        }
+        TEST_ASSERT_FALSE (attached->attach (mph->words (),
+                                             mph->numWords () - 1));
+
+        /* Duplicate keys can't be separated */
+        keys.push_back (keys[0]);
+        TEST_ASSERT_FALSE (mph->build (keys));
+
+        /* Empty set, every lookup misses */
+        keys.clear ();
+        TEST_ASSERT_TRUE (mph->build (keys));
+        TEST_ASSERT_EQUAL (mph->size (), 0);
+        TEST_ASSERT_EQUAL (mph->lookup (12345), 0);
+
+        delete attached;
+        delete mph;
+    }
+}
+#endif /* defined(TEST) */
+
+/**
+ *******************************************************************************
+ * @brief Perfect_Hash - Constructor, an empty hash until build() or attach().
+ *******************************************************************************
+ */
+Perfect_Hash::Perfect_Hash (void)
+{
+    _clear ();
+}
+
+/**
+ *******************************************************************************
+ * @brief ~Perfect_Hash - Destructor
+ *******************************************************************************
+ */
+Perfect_Hash::~Perfect_Hash (void)
+{
+}
+
+/**
+ *******************************************************************************
+ * @brief build - Construct the hash over a set of keys.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      keys           Distinct keys, in any order.
+ *
+ * <!-- Returns -->
+ *      @return TRUE if built, FALSE if 'keys' has duplicates (the hash is
+ *      left empty then).
+ *
+ * @par Algorithm:
+ *      Per level, two bit arrays mark the bits hit once and more than once.
+ *      The bits hit exactly once become the level, and their keys are placed;
+ *      the rest go around again on a level sized for just them.  About
+ *      1 / e^(1 / GAMMA) of the keys carry over each time, so the levels
+ *      shrink geometrically.
+ *******************************************************************************
+ */
+Bool_t Perfect_Hash::build (const vector < uint64_t > &keys)
+{
+    vector < uint64_t > remaining (keys);
+    vector < uint64_t > next;
+    vector < uint64_t > seen;
+    vector < uint64_t > collided;
+    vector < uint64_t > level_bits;
+    vector < uint64_t > all_bits;
+    uint64_t num_bits = 0;
+    uint64_t bit = 0;
+    uint64_t placed = 0;
+    uint64_t rank = 0;
+    size_t idx = 0;
+
+    _clear ();
+    while ((remaining.empty () == false) &&
+           (level_bits.size () < PERFECT_HASH_MAX_LEVELS))
+    {
+        num_bits = (uint64_t) (PERFECT_HASH_GAMMA * remaining.size ());
+        num_bits = (num_bits + 63) & ~(uint64_t) 63;
+        if (num_bits < 64)
+        {
+            num_bits = 64;
+        }
+        seen.assign (num_bits / 64, 0);
+        collided.assign (num_bits / 64, 0);
+        for (idx = 0; idx < remaining.size (); idx++)
+        {
+            bit = levelBit (remaining[idx], level_bits.size (), num_bits);
+            if ((seen[bit >> 6] & ((uint64_t) 1 << (bit & 63))) != 0)
+            {
+                collided[bit >> 6] |= (uint64_t) 1 << (bit & 63);
+            }
+            seen[bit >> 6] |= (uint64_t) 1 << (bit & 63);
+        }
+        next.clear ();
+        for (idx = 0; idx < seen.size (); idx++)
+        {
+            seen[idx] &= ~collided[idx];
+        }
+        for (idx = 0; idx < remaining.size (); idx++)
+        {
+            bit = levelBit (remaining[idx], level_bits.size (), num_bits);
+            if ((seen[bit >> 6] & ((uint64_t) 1 << (bit & 63))) == 0)
+            {
+                next.push_back (remaining[idx]);
+            }
+        }
+        all_bits.insert (all_bits.end (), seen.begin (), seen.end ());
+        level_bits.push_back (num_bits);
+        remaining.swap (next);
+    }
+    sort (remaining.begin (), remaining.end ());
+    for (idx = 1; idx < remaining.size (); idx++)
+    {
+        if (remaining[idx] == remaining[idx - 1])
+        {
+            return (FALSE);
+        }
+    }
+
+    /*
+     * Lay out the words, with a rank before every RANK_WORDS bit words
+     */
+    _owned.push_back (keys.size ());
+    _owned.push_back (level_bits.size ());
+    _owned.push_back (remaining.size ());
+    _owned.insert (_owned.end (), level_bits.begin (), level_bits.end ());
+    _owned.insert (_owned.end (), all_bits.begin (), all_bits.end ());
+    for (idx = 0; idx < all_bits.size (); idx++)
+    {
+        if ((idx % PERFECT_HASH_RANK_WORDS) == 0)
+        {
+            _owned.push_back (rank);
+        }
+        rank += popCount (all_bits[idx]);
+    }
+    placed = rank;
+    for (idx = 0; idx < remaining.size (); idx++)
+    {
+        _owned.push_back (remaining[idx]);
+        _owned.push_back (placed + idx);
+    }
+
+    _words = &_owned[0];
+    _numWords = _owned.size ();
+    if ((_parse () == FALSE) || (placed + remaining.size () != keys.size ()))
+    {
+        _clear ();
+        return (FALSE);
+    }
+    return (TRUE);
+}
+
+/**
+ *******************************************************************************
+ * @brief attach - Use a hash laid out by build() where it is, without
+ * copying it.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      words          First word, as from words() after a
+ *                                     build(), kept valid by the caller.
+ *      @param[in]      num_words      Number of words, as from numWords().
+ *
+ * <!-- Returns -->
+ *      @return TRUE if the words describe a complete hash.
+ *******************************************************************************
+ */
+Bool_t Perfect_Hash::attach (const uint64_t * words, size_t num_words)
+{
+    _clear ();
+    _words = words;
+    _numWords = num_words;
+    if (_parse () == FALSE)
+    {
+        _clear ();
+        return (FALSE);
+    }
+    return (TRUE);
+}
+
+/**
+ *******************************************************************************
+ * @brief lookup - Slot of a key.
+ *
+ * <!-- Returns -->
+ *      @return the key's slot, 0..size()-1, for a key in the set.  Any other
+ *      key gets an arbitrary slot, or size().
+ *
+ * @par Algorithm:
+ *      Try the key's bit on each level in turn, the first one set is the
+ *      key's.  Its slot is the rank stored for its block plus the set bits
+ *      before it in the block.
+ *******************************************************************************
+ */
+uint64_t Perfect_Hash::lookup (uint64_t key)
+{
+    uint64_t level = 0;
+    uint64_t bit = 0;
+    uint64_t word_idx = 0;
+    uint64_t mask = 0;
+    uint64_t slot = 0;
+    uint64_t low = 0;
+    uint64_t high = _numFallback;
+    uint64_t mid = 0;
+
+    for (level = 0; level < _numLevels; level++)
+    {
+        bit = _levelStart[level] + levelBit (key, level, _levelBits[level]);
+        word_idx = bit >> 6;
+        mask = (uint64_t) 1 << (bit & 63);
+        if ((_bits[word_idx] & mask) != 0)
+        {
+            slot = _ranks[word_idx / PERFECT_HASH_RANK_WORDS];
+            for (mid = word_idx - (word_idx % PERFECT_HASH_RANK_WORDS);
+                 mid < word_idx; mid++)
+            {
+                slot += popCount (_bits[mid]);
+            }
+            return (slot + popCount (_bits[word_idx] & (mask - 1)));
+        }
+    }
+    while (low < high)
+    {
+        mid = low + (high - low) / 2;
+        if (_fallback[2 * mid] == key)
+        {
+            return (_fallback[2 * mid + 1]);
+        }
+        if (_fallback[2 * mid] < key)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+    return (_numKeys);
+}
+
+/**
+ *******************************************************************************
+ * @brief bitsPerKey - Size of the hash per key, everything included.
+ *******************************************************************************
+ */
+double Perfect_Hash::bitsPerKey (void)
+{
+    if (_numKeys == 0)
+    {
+        return (0.0);
+    }
+    return (64.0 * (double) _numWords / (double) _numKeys);
+}
+
+/*******************************************************************************
+ ************************ L O C A L  F U N C T I O N S *************************
+ *******************************************************************************
+ */
+
+/**
+ *******************************************************************************
+ * @brief _parse - Find the parts of the hash in its words, checking they add
+ * up to exactly num_words.
+ *******************************************************************************
+ */
+Bool_t Perfect_Hash::_parse (void)
+{
+    uint64_t total_bits = 0;
+    uint64_t level = 0;
+    uint64_t bit_words = 0;
+    uint64_t rank_words = 0;
+
+    if ((_words == NULL) || (_numWords < PERFECT_HASH_HEADER_WORDS))
+    {
+        return (FALSE);
+    }
+    _numKeys = _words[0];
+    _numLevels = _words[1];
+    _numFallback = _words[2];
+    if ((_numLevels > PERFECT_HASH_MAX_LEVELS) ||
+        (_numWords < PERFECT_HASH_HEADER_WORDS + _numLevels))
+    {
+        return (FALSE);
+    }
+    for (level = 0; level < _numLevels; level++)
+    {
+        _levelBits[level] = _words[PERFECT_HASH_HEADER_WORDS + level];
+        _levelStart[level] = total_bits;
+        if ((_levelBits[level] == 0) || ((_levelBits[level] % 64) != 0) ||
+            (_levelBits[level] / 64 > _numWords))
+        {
+            return (FALSE);
+        }
+        total_bits += _levelBits[level];
+    }
+    bit_words = total_bits / 64;
+    rank_words = (bit_words + PERFECT_HASH_RANK_WORDS - 1) /
+        PERFECT_HASH_RANK_WORDS;
+    if ((_numFallback > _numKeys) ||
+        (_numWords != PERFECT_HASH_HEADER_WORDS + _numLevels + bit_words +
+         rank_words + 2 * _numFallback))
+    {
+        return (FALSE);
+    }
+    _bits = _words + PERFECT_HASH_HEADER_WORDS + _numLevels;
+    _ranks = _bits + bit_words;
+    _fallback = _ranks + rank_words;
+    return (TRUE);
+}
+
+/**
+ *******************************************************************************
+ * @brief _clear - Back to an empty hash, every lookup misses.
+ *******************************************************************************
+ */
+void Perfect_Hash::_clear (void)
+{
+    _owned.clear ();
+    _words = NULL;
+    _numWords = 0;
+    _numKeys = 0;
+    _numLevels = 0;
+    _numFallback = 0;
+    memset (_levelBits, 0, sizeof (_levelBits));
+    memset (_levelStart, 0, sizeof (_levelStart));
+    _bits = NULL;
+    _ranks = NULL;
+    _fallback = NULL;
+}
+
+/**
+ *******************************************************************************
+ * @brief levelBit - Bit a key hashes to on one level.
+ *
+ * @par Description:
+ *      A splitmix64 finalizer over the key offset by a per level constant,
+ *      so each level sees an independent hash of the key.
+ *******************************************************************************
+ */
+static uint64_t levelBit (uint64_t key, uint64_t level, uint64_t num_bits)
+{
+    uint64_t hash = key + (level + 1) * UINT64_C (0x9E3779B97F4A7C15);
+
+    hash = (hash ^ (hash >> 30)) * UINT64_C (0xBF58476D1CE4E5B9);
+    hash = (hash ^ (hash >> 27)) * UINT64_C (0x94D049BB133111EB);
+    hash ^= hash >> 31;
+    return (hash % num_bits);
+}
+
+/**
+ *******************************************************************************
+ * @brief popCount - Number of set bits in a word.
+ *******************************************************************************
+ */
+static unsigned int popCount (uint64_t word)
+{
+    return ((unsigned int) (__builtin_popcount ((uint32_t) word) +
+                            __builtin_popcount ((uint32_t) (word >> 32))));
+}
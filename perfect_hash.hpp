@@ -0,0 +1,164 @@
+#ifndef __PERFECT_HASH_H__
+#define __PERFECT_HASH_H__
+/**
+ * @file           perfect_hash.hpp
+ * @brief:         Minimal perfect hash over a fixed set of 64-bit keys.
+ * @verbatim
+ *******************************************************************************
+ * Author:         Douglas L. Potts
+ *
+ * Date:           10/17/2026, <SCR #>
+ *
+ *==============================================================================
+ *==============================================================================
+ * Copyright (c) 2015 Douglas Lee Potts
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ *==============================================================================
+ *==============================================================================
+ *
+ * History:
+ * Date        SCR #  Name  Description
+ * -----------------------------------------------------------------------------
+ *
+ *******************************************************************************
+ * @endverbatim
+ */
+
+/*******************************************************************************
+ * System Includes
+ *******************************************************************************
+ */
+#include <stddef.h>             /* for size_t */
+#include <stdint.h>             /* for uint64_t */
+#include <vector>
+
+/*******************************************************************************
+ * Project Includes
+ *******************************************************************************
+ */
+#include "common_types.h"
+
+#if defined(TEST)
+extern "C"
+{
+    void perfectHashBuild (void);
+}
+#endif                          /* defined(TEST) */
+
+/*******************************************************************************
+ * Typedefs
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * Constants
+ *******************************************************************************
+ */
+/** Bits per level per key still to place, more is faster to build and
+ * look up, less is smaller */
+#define PERFECT_HASH_GAMMA      (2.0)
+/** Levels tried before the last few keys go to the sorted fallback list */
+#define PERFECT_HASH_MAX_LEVELS (24)
+/** Level bits covered by each stored rank */
+#define PERFECT_HASH_RANK_BITS  (512)
+
+/*******************************************************************************
+ * Structures
+ *******************************************************************************
+ */
+using namespace std;
+
+/**
+ * BBHash style minimal perfect hash: maps each of n distinct 64-bit keys to
+ * its own slot in 0..n-1, in a few bits per key, and with no keys stored.
+ *
+ * Level l is a bit array of about GAMMA times the keys not yet placed.  Each
+ * key hashes to one bit per level; keys alone on their bit at a level are
+ * placed there, the colliding ones move on to the next level.  A key's slot
+ * is the number of set bits before its bit, found from a rank stored every
+ * PERFECT_HASH_RANK_BITS bits plus a few popcounts.  Keys still unplaced
+ * after PERFECT_HASH_MAX_LEVELS (very rarely any) are kept in a short sorted
+ * list instead.
+ *
+ * Everything lives in one array of 64-bit words, built in memory by build(),
+ * or used where it is, for instance in a mapped file, with attach():
+ *      num_keys, num_levels, num_fallback, level bit counts[num_levels],
+ *      level bits, ranks, fallback (key, slot) pairs sorted by key
+ *
+ * A key that was not in the set gets an arbitrary slot (or size()), so
+ * callers must compare the key stored in that slot.
+ */
+class Perfect_Hash
+{
+  public:
+    Perfect_Hash (void);
+    virtual ~ Perfect_Hash (void);
+
+    Bool_t build (const vector < uint64_t > &keys);
+    Bool_t attach (const uint64_t * words, size_t num_words);
+    uint64_t lookup (uint64_t key);
+
+    /** Number of keys, slots are 0..size()-1 */
+    uint64_t size (void)
+    {
+        return (this->_numKeys);
+    };
+    const uint64_t *words (void)
+    {
+        return (this->_words);
+    };
+    size_t numWords (void)
+    {
+        return (this->_numWords);
+    };
+    double bitsPerKey (void);
+
+  private:
+    vector < uint64_t > _owned;
+    const uint64_t *_words;
+    size_t _numWords;
+    uint64_t _numKeys;
+    uint64_t _numLevels;
+    uint64_t _numFallback;
+    uint64_t _levelBits[PERFECT_HASH_MAX_LEVELS];
+    uint64_t _levelStart[PERFECT_HASH_MAX_LEVELS];
+    const uint64_t *_bits;
+    const uint64_t *_ranks;
+    const uint64_t *_fallback;
+
+    Bool_t _parse (void);
+    void _clear (void);
+};
+
+/*******************************************************************************
+ * Unions
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * External Function Prototypes
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * Global Variables
+ *******************************************************************************
+ */
+#if _MAIN_
+#define GLOBAL_VAR_DECLARE
+#else
+#define GLOBAL_VAR_DECLARE extern
+#endif /* _MAIN_ */
+
+#endif /* __PERFECT_HASH_H__ */
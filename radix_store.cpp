@@ -0,0 +1,1127 @@
+/**
+ * @file           radix_store.cpp
+ * @brief:         Adaptive radix tree dictionary store, with prefix queries.
+ * @verbatim
+ *******************************************************************************
+ * Author:         Douglas L. Potts
+ *
+ * Date:           10/17/2026, <SCR #>
+ *
+ *==============================================================================
+ *==============================================================================
+ * Copyright (c) 2015 Douglas Lee Potts
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ *==============================================================================
+ *==============================================================================
+ *
+ * History:
+ * Date        SCR #  Name  Description
+ * -----------------------------------------------------------------------------
+ *
+ *******************************************************************************
+ * @endverbatim
+ */
+
+/*******************************************************************************
+ * System Includes
+ *******************************************************************************
+ */
+#include <stdio.h>              /* for fprintf() */
+#include <stdlib.h>             /* for calloc() */
+#include <string.h>             /* for memcmp() */
+#include <algorithm>            /* for std::sort_heap */
+
+/*******************************************************************************
+ * Project Includes
+ *******************************************************************************
+ */
+#include "common_types.h"
+#include "radix_store.hpp"
+#if defined(TEST)
+#include "unity.h"
+#endif /* defined(TEST) */
+
+/*******************************************************************************
+ * Local Function Prototypes 
+ *******************************************************************************
+ */
+static size_t nodeBytes (Radix_Node_Type_t type);
+static void insertSorted (uint8_t * keys, Radix_Node_t ** children,
+                          size_t num_children, uint8_t byte,
+                          Radix_Node_t * child);
+
+/*******************************************************************************
+ * Local Constants 
+ *******************************************************************************
+ */
+#define DBG(X)
+
+/*******************************************************************************
+ * File Scoped Variables 
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ ********************* E X T E R N A L  F U N C T I O N S **********************
+ *******************************************************************************
+ */
+
+#if defined(TEST)
+extern "C"
+{
+
+    void radixStoreInsertFind (void)
+    {
+        static const char *WORDS[] = { "romane", "romanus", "romulus",
+            "rubens", "ruber", "rubicon", "rubicundus", "r", "rom", "rubens"
+        };
+        static const int NUM_WORDS = sizeof (WORDS) / sizeof (WORDS[0]);
+        Radix_Store *store = new Radix_Store ();
+        Dict_Entry_t entry;
+        Dict_Entry_t prev;
+        char word[32];
+        int idx = 0;
+        int len = 0;
+        int entries = 0;
+
+        /*
+         * Words which are prefixes of others, and paths split at every
+         * depth; "rubens" twice is one word
+         */
+        for (idx = 0; idx < NUM_WORDS; idx++)
+        {
+            len = (int) strlen (WORDS[idx]);
+            *store->findOrInsert (WORDS[idx], len,
+                                  wordHash (WORDS[idx], len)) += idx + 1;
+        }
+        TEST_ASSERT_EQUAL (store->size (), NUM_WORDS - 1);
+        TEST_ASSERT_EQUAL (*store->find ("rubens", 6, wordHash ("rubens", 6)),
+                           4 + 10);
+        TEST_ASSERT_EQUAL (*store->find ("r", 1, wordHash ("r", 1)), 8);
+        TEST_ASSERT_EQUAL (*store->find ("rom", 3, wordHash ("rom", 3)), 9);
+        TEST_ASSERT_NULL (store->find ("ro", 2, wordHash ("ro", 2)));
+        TEST_ASSERT_NULL (store->find ("ruben", 5, wordHash ("ruben", 5)));
+        TEST_ASSERT_NULL (store->find ("rubensx", 7, wordHash ("rubensx", 7)));
+        TEST_ASSERT_NULL (store->find ("", 0, wordHash ("", 0)));
+
+        /*
+         * Enough children under one node to grow it through every size
+         */
+        for (idx = 0; idx < 256; idx++)
+        {
+            word[0] = 'x';
+            word[1] = (char) idx;
+            *store->findOrInsert (word, 2, wordHash (word, 2)) = idx;
+        }
+        for (idx = 0; idx < 5000; idx++)
+        {
+            len = snprintf (word, sizeof (word), "w%d", idx);
+            *store->findOrInsert (word, len, wordHash (word, len)) = idx;
+        }
+        TEST_ASSERT_EQUAL (store->size (), NUM_WORDS - 1 + 256 + 5000);
+        for (idx = 0; idx < 256; idx++)
+        {
+            word[0] = 'x';
+            word[1] = (char) idx;
+            TEST_ASSERT_EQUAL (*store->find (word, 2, wordHash (word, 2)),
+                               idx);
+        }
+        for (idx = 0; idx < 5000; idx++)
+        {
+            len = snprintf (word, sizeof (word), "w%d", idx);
+            TEST_ASSERT_EQUAL (*store->find (word, len, wordHash (word, len)),
+                               idx);
+        }
+
+        /* Iteration is in word order */
+        store->rewind ();
+        TEST_ASSERT_TRUE (store->next (&prev));
+        entries = 1;
+        while (store->next (&entry) == TRUE)
+        {
+            TEST_ASSERT_TRUE (compareWords (prev.word, prev.len,
+                                            entry.word, entry.len) < 0);
+            TEST_ASSERT_EQUAL (entry.hash, wordHash (entry.word, entry.len));
+            prev = entry;
+            entries++;
+        }
+        TEST_ASSERT_EQUAL (entries, NUM_WORDS - 1 + 256 + 5000);
+
+        store->clear ();
+        TEST_ASSERT_EQUAL (store->size (), 0);
+        TEST_ASSERT_NULL (store->find ("r", 1, wordHash ("r", 1)));
+        store->rewind ();
+        TEST_ASSERT_FALSE (store->next (&entry));
+
+        delete store;
+    }
+    void radixStorePrefix (void)
+    {
+        static const int NUM_WORDS = 3000;
+        Radix_Store *store = new Radix_Store ();
+        Map_Store *reference = new Map_Store ();
+        vector < Dict_Entry_t > top_list;
+        vector < Dict_Entry_t > expected;
+        Dict_Entry_t entry;
+        char word[32];
+        const char *prefixes[] = { "", "w", "w1", "w12", "w123", "w2999",
+            "w29990", "x", "ww"
+        };
+        int idx = 0;
+        int len = 0;
+        int pass = 0;
+        int entries = 0;
+
+        for (idx = 0; idx < NUM_WORDS; idx++)
+        {
+            len = snprintf (word, sizeof (word), "w%d", idx);
+            *store->findOrInsert (word, len, wordHash (word, len)) =
+                (idx * 7) % 101;
+            *reference->findOrInsert (word, len, wordHash (word, len)) =
+                (idx * 7) % 101;
+        }
+
+        /*
+         * Counts raised through find() must still be seen by the pruning,
+         * the second pass has every "w12..." word near the top
+         */
+        for (pass = 0; pass < 2; pass++)
+        {
+            for (idx = 0; idx < (int) (sizeof (prefixes) /
+                                       sizeof (prefixes[0])); idx++)
+            {
+                len = (int) strlen (prefixes[idx]);
+                store->selectPrefix (prefixes[idx], len, 15, top_list);
+                reference->selectPrefix (prefixes[idx], len, 15, expected);
+                TEST_ASSERT_EQUAL (top_list.size (), expected.size ());
+                for (entries = 0; entries < (int) expected.size (); entries++)
+                {
+                    TEST_ASSERT_EQUAL (top_list[entries].count,
+                                       expected[entries].count);
+                    TEST_ASSERT_EQUAL (top_list[entries].len,
+                                       expected[entries].len);
+                    TEST_ASSERT_EQUAL (memcmp (top_list[entries].word,
+                                               expected[entries].word,
+                                               expected[entries].len), 0);
+                }
+            }
+            for (idx = 120; idx < 130; idx++)
+            {
+                len = snprintf (word, sizeof (word), "w%d", idx);
+                *store->find (word, len, wordHash (word, len)) += 95 + idx;
+                *reference->find (word, len, wordHash (word, len)) +=
+                    95 + idx;
+            }
+        }
+        store->selectPrefix ("w12", 3, 1, top_list);
+        TEST_ASSERT_EQUAL (top_list.size (), 1);
+        TEST_ASSERT_EQUAL (top_list[0].len, 4);
+        TEST_ASSERT_EQUAL (memcmp (top_list[0].word, "w129", 4), 0);
+
+        /* Prefix iteration visits exactly the words under the prefix */
+        store->rewindPrefix ("w29", 3);
+        entries = 0;
+        while (store->next (&entry) == TRUE)
+        {
+            TEST_ASSERT_TRUE (entry.len >= 3);
+            TEST_ASSERT_EQUAL (memcmp (entry.word, "w29", 3), 0);
+            entries++;
+        }
+        TEST_ASSERT_EQUAL (entries, 1 + 10 + 100);
+        store->rewindPrefix ("w3000", 5);
+        TEST_ASSERT_FALSE (store->next (&entry));
+
+        delete reference;
+        delete store;
+    }
+}
+#endif /* defined(TEST) */
+
+/**
+ *******************************************************************************
+ * @brief Radix_Store - Constructor
+ *******************************************************************************
+ */
+Radix_Store::Radix_Store (void)
+{
+    _root = NULL;
+    _size = 0;
+    _leafUsed = RADIX_LEAF_BLOCK;
+    _nodeBytes = 0;
+    _pending = NULL;
+}
+
+/**
+ *******************************************************************************
+ * @brief ~Radix_Store - Destructor
+ *******************************************************************************
+ */
+Radix_Store::~Radix_Store (void)
+{
+    clear ();
+}
+
+/**
+ *******************************************************************************
+ * @brief find - Look up a word by pointer and length.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      word           First byte of the word (need not be nul
+ *                                     terminated).
+ *      @param[in]      len            Length of the word in bytes
+ *      @param[in]      hash           wordHash() of the word, unused
+ *
+ * <!-- Returns -->
+ *      @return pointer to the word's count, NULL if not present.
+ *
+ * @par Description:
+ *      One descent, comparing each node's compressed path and then one
+ *      child byte.  A leaf may be reached before the word is used up, so
+ *      the leaf's whole word is compared.
+ *******************************************************************************
+ */
+int *Radix_Store::find (const char *word, size_t len, Word_Hash_t hash)
+{
+    Radix_Node_t *node = NULL;
+    Radix_Node_t **child = NULL;
+    Radix_Inner_t *inner = NULL;
+    Radix_Leaf_t *leaf = NULL;
+    size_t depth = 0;
+
+    _settle ();
+    _path.clear ();
+    node = _root;
+    while (node != NULL)
+    {
+        if (node->type == RADIX_LEAF)
+        {
+            leaf = (Radix_Leaf_t *) node;
+            if ((_keys.keyLen (leaf->id) != len) ||
+                (memcmp (_keys.key (leaf->id), word, len) != 0))
+            {
+                return (NULL);
+            }
+            _pending = leaf;
+            return (&leaf->count);
+        }
+        inner = (Radix_Inner_t *) node;
+        if ((len - depth < inner->prefixLen) ||
+            (memcmp (word + depth, _prefix (inner, depth),
+                     inner->prefixLen) != 0))
+        {
+            return (NULL);
+        }
+        depth += inner->prefixLen;
+        _path.push_back (inner);
+        if (depth == len)
+        {
+            if (inner->value == NULL)
+            {
+                return (NULL);
+            }
+            _pending = inner->value;
+            return (&inner->value->count);
+        }
+        child = _findChild (inner, (uint8_t) word[depth]);
+        if (child == NULL)
+        {
+            return (NULL);
+        }
+        node = *child;
+        depth++;
+    }
+    return (NULL);
+}
+
+/**
+ *******************************************************************************
+ * @brief findOrInsert - Look up a word, inserting it with a count of 0 if it
+ * is not already present.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      word           First byte of the word
+ *      @param[in]      len            Length of the word in bytes
+ *      @param[in]      hash           wordHash() of the word
+ *
+ * <!-- Returns -->
+ *      @return pointer to the word's count, leaves never move, so it stays
+ *      valid until clear().
+ *
+ * @par Description:
+ *      Descends as find() does.  Where the word leaves the tree, either a
+ *      leaf is reached (replaced by a node holding the old and the new
+ *      leaves, under their common bytes), a compressed path differs (split
+ *      at the first differing byte), or there is no child for the next byte
+ *      (added, growing the node if it is full).
+ *******************************************************************************
+ */
+int *Radix_Store::findOrInsert (const char *word, size_t len, Word_Hash_t hash)
+{
+    Radix_Node_t **ref = &_root;
+    Radix_Node_t **child = NULL;
+    Radix_Node_t *node = NULL;
+    Radix_Inner_t *inner = NULL;
+    Radix_Inner_t *split = NULL;
+    Radix_Leaf_t *old_leaf = NULL;
+    Radix_Leaf_t *leaf = NULL;
+    const char *old_word = NULL;
+    const char *prefix = NULL;
+    size_t old_len = 0;
+    size_t depth = 0;
+    size_t matched = 0;
+
+    _settle ();
+    _path.clear ();
+    while (leaf == NULL)
+    {
+        node = *ref;
+        if (node == NULL)
+        {
+            leaf = _newLeaf (word, len, hash);
+            *ref = (Radix_Node_t *) leaf;
+        }
+        else if (node->type == RADIX_LEAF)
+        {
+            old_leaf = (Radix_Leaf_t *) node;
+            old_word = _keys.key (old_leaf->id);
+            old_len = _keys.keyLen (old_leaf->id);
+            if ((old_len == len) && (memcmp (old_word, word, len) == 0))
+            {
+                leaf = old_leaf;
+                break;
+            }
+            for (matched = 0; (depth + matched < len) &&
+                 (depth + matched < old_len) &&
+                 (old_word[depth + matched] == word[depth + matched]);
+                 matched++)
+            {
+            }
+            leaf = _newLeaf (word, len, hash);
+            split = _newNode (RADIX_NODE4, (uint32_t) matched, old_leaf->id);
+            if (old_leaf->count > split->maxCount)
+            {
+                split->maxCount = old_leaf->count;
+            }
+            *ref = (Radix_Node_t *) split;
+            depth += matched;
+            if (old_len == depth)
+            {
+                split->value = old_leaf;
+            }
+            else
+            {
+                _addChild (ref, (uint8_t) old_word[depth], node);
+            }
+            if (len == depth)
+            {
+                split->value = leaf;
+            }
+            else
+            {
+                _addChild (ref, (uint8_t) word[depth], (Radix_Node_t *) leaf);
+            }
+            _path.push_back (split);
+        }
+        else
+        {
+            inner = (Radix_Inner_t *) node;
+            prefix = _prefix (inner, depth);
+            for (matched = 0; (matched < inner->prefixLen) &&
+                 (depth + matched < len) &&
+                 (prefix[matched] == word[depth + matched]); matched++)
+            {
+            }
+            if (matched < inner->prefixLen)
+            {
+                /* New node for the shared bytes, 'inner' keeps the rest */
+                leaf = _newLeaf (word, len, hash);
+                split = _newNode (RADIX_NODE4, (uint32_t) matched,
+                                  inner->prefixKey);
+                split->maxCount = inner->maxCount;
+                *ref = (Radix_Node_t *) split;
+                _addChild (ref, (uint8_t) prefix[matched], node);
+                inner->prefixLen -= (uint32_t) (matched + 1);
+                depth += matched;
+                if (len == depth)
+                {
+                    split->value = leaf;
+                }
+                else
+                {
+                    _addChild (ref, (uint8_t) word[depth],
+                               (Radix_Node_t *) leaf);
+                }
+                _path.push_back (split);
+                break;
+            }
+            depth += inner->prefixLen;
+            _path.push_back (inner);
+            if (depth == len)
+            {
+                if (inner->value == NULL)
+                {
+                    inner->value = _newLeaf (word, len, hash);
+                }
+                leaf = inner->value;
+                break;
+            }
+            child = _findChild (inner, (uint8_t) word[depth]);
+            if (child == NULL)
+            {
+                leaf = _newLeaf (word, len, hash);
+                _addChild (ref, (uint8_t) word[depth], (Radix_Node_t *) leaf);
+                _path.back () = (Radix_Inner_t *) * ref;
+                break;
+            }
+            ref = child;
+            depth++;
+        }
+    }
+    _pending = leaf;
+    return (&leaf->count);
+}
+
+/**
+ *******************************************************************************
+ * @brief size - Number of words in the tree.
+ *******************************************************************************
+ */
+size_t Radix_Store::size (void)
+{
+    return (_size);
+}
+
+/**
+ *******************************************************************************
+ * @brief clear - Remove every word, and free every node.
+ *******************************************************************************
+ */
+void Radix_Store::clear (void)
+{
+    size_t idx = 0;
+
+    _freeNode (_root);
+    for (idx = 0; idx < _leafBlocks.size (); idx++)
+    {
+        free (_leafBlocks[idx]);
+    }
+    _leafBlocks.clear ();
+    _leafUsed = RADIX_LEAF_BLOCK;
+    _nodeBytes = 0;
+    _keys.clear ();
+    _root = NULL;
+    _size = 0;
+    _stack.clear ();
+    _path.clear ();
+    _pending = NULL;
+}
+
+/**
+ *******************************************************************************
+ * @brief memoryUsage - Inner nodes and leaf blocks as index, and the key
+ * arena.
+ *******************************************************************************
+ */
+void Radix_Store::memoryUsage (Mem_Stats_t * stats)
+{
+    stats->bytes[MEM_INDEX] += _nodeBytes +
+        _leafBlocks.size () * RADIX_LEAF_BLOCK * sizeof (Radix_Leaf_t);
+    stats->bytes[MEM_ARENA] += _keys.bytesUsed ();
+}
+
+/**
+ *******************************************************************************
+ * @brief rewind - Restart iteration at the first word, in word order.
+ *******************************************************************************
+ */
+void Radix_Store::rewind (void)
+{
+    rewindPrefix ("", 0);
+}
+
+/**
+ *******************************************************************************
+ * @brief rewindPrefix - Restart iteration at the first word starting with
+ * 'prefix', next() then stops after the last such word.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      prefix         First byte of the prefix
+ *      @param[in]      len            Length of the prefix, 0 for every word
+ *******************************************************************************
+ */
+void Radix_Store::rewindPrefix (const char *prefix, size_t len)
+{
+    Radix_Frame_t frame;
+
+    _settle ();
+    _stack.clear ();
+    frame.node = _prefixRoot (prefix, len);
+    frame.pos = -1;
+    if (frame.node != NULL)
+    {
+        _stack.push_back (frame);
+    }
+}
+
+/**
+ *******************************************************************************
+ * @brief next - Return the next word in word order and advance.
+ *
+ * @par Description:
+ *      Depth first, a node's own word before its children's, and children in
+ *      byte order, which is bytewise word order.
+ *******************************************************************************
+ */
+Bool_t Radix_Store::next (Dict_Entry_t * entry)
+{
+    Radix_Inner_t *inner = NULL;
+    Radix_Frame_t frame;
+
+    while (_stack.empty () == false)
+    {
+        if (_stack.back ().node->type == RADIX_LEAF)
+        {
+            _fillEntry ((Radix_Leaf_t *) _stack.back ().node, entry);
+            _stack.pop_back ();
+            return (TRUE);
+        }
+        inner = (Radix_Inner_t *) _stack.back ().node;
+        if (_stack.back ().pos < 0)
+        {
+            _stack.back ().pos = 0;
+            if (inner->value != NULL)
+            {
+                _fillEntry (inner->value, entry);
+                return (TRUE);
+            }
+        }
+        frame.node = _childAt (inner, &_stack.back ().pos);
+        frame.pos = -1;
+        if (frame.node == NULL)
+        {
+            _stack.pop_back ();
+        }
+        else
+        {
+            _stack.push_back (frame);
+        }
+    }
+    return (FALSE);
+}
+
+/**
+ *******************************************************************************
+ * @brief selectPrefix - The 'top_k' words starting with 'prefix', highest
+ * count first, ties in word order.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      prefix         First byte of the prefix
+ *      @param[in]      len            Length of the prefix, 0 for every word
+ *      @param[in]      top_k          Number of words wanted
+ *      @param[out]     top_list       Replaced with the selected entries
+ *
+ * @par Description:
+ *      Descends to the prefix's subtree, then walks it in word order,
+ *      skipping any subtree whose highest count cannot displace the worst
+ *      of the 'top_k' kept so far.  Everything already kept sorts before
+ *      the skipped words, so even an equal count would not displace it.
+ *******************************************************************************
+ */
+void Radix_Store::selectPrefix (const char *prefix, size_t len, size_t top_k,
+                                vector < Dict_Entry_t > &top_list)
+{
+    Radix_Node_t *node = NULL;
+
+    _settle ();
+    top_list.clear ();
+    node = _prefixRoot (prefix, len);
+    if ((node != NULL) && (top_k > 0))
+    {
+        _selectBelow (node, top_k, top_list);
+    }
+    sort_heap (top_list.begin (), top_list.end (), dictEntryRanksBefore);
+}
+
+/*******************************************************************************
+ ************************ L O C A L  F U N C T I O N S *************************
+ *******************************************************************************
+ */
+
+/**
+ *******************************************************************************
+ * @brief _settle - Raise the highest count recorded along the path to the
+ * last word handed out, now its count may have been written.
+ *******************************************************************************
+ */
+void Radix_Store::_settle (void)
+{
+    size_t idx = 0;
+
+    if (_pending == NULL)
+    {
+        return;
+    }
+    for (idx = 0; idx < _path.size (); idx++)
+    {
+        if (_path[idx]->maxCount < _pending->count)
+        {
+            _path[idx]->maxCount = _pending->count;
+        }
+    }
+    _pending = NULL;
+}
+
+/**
+ *******************************************************************************
+ * @brief _newLeaf - Copy a word into the arena, and give it a leaf with a
+ * count of 0.
+ *******************************************************************************
+ */
+Radix_Leaf_t *Radix_Store::_newLeaf (const char *word, size_t len,
+                                     Word_Hash_t hash)
+{
+    Radix_Leaf_t *leaf = NULL;
+
+    if (_leafUsed == RADIX_LEAF_BLOCK)
+    {
+        leaf = (Radix_Leaf_t *) calloc (RADIX_LEAF_BLOCK,
+                                        sizeof (Radix_Leaf_t));
+        if (leaf == NULL)
+        {
+            fprintf (stderr, "[%s, %d:%s] failed to allocate %d leaves\n",
+                     __FILE__, __LINE__, __FUNCTION__, RADIX_LEAF_BLOCK);
+            exit (EXIT_FAILURE);
+        }
+        _leafBlocks.push_back (leaf);
+        _leafUsed = 0;
+    }
+    leaf = &_leafBlocks.back ()[_leafUsed++];
+    leaf->type = RADIX_LEAF;
+    leaf->id = _keys.add (word, len);
+    leaf->hash = hash;
+    leaf->count = 0;
+    _size++;
+    return (leaf);
+}
+
+/**
+ *******************************************************************************
+ * @brief _newNode - Allocate an empty inner node.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      type           RADIX_NODE4 .. RADIX_NODE256
+ *      @param[in]      prefix_len     Compressed path bytes
+ *      @param[in]      prefix_key     A word which will be below the node
+ *******************************************************************************
+ */
+Radix_Inner_t *Radix_Store::_newNode (Radix_Node_Type_t type,
+                                      uint32_t prefix_len,
+                                      Key_Id_t prefix_key)
+{
+    Radix_Inner_t *inner = (Radix_Inner_t *) calloc (1, nodeBytes (type));
+
+    if (inner == NULL)
+    {
+        fprintf (stderr, "[%s, %d:%s] failed to allocate a node\n",
+                 __FILE__, __LINE__, __FUNCTION__);
+        exit (EXIT_FAILURE);
+    }
+    _nodeBytes += nodeBytes (type);
+    inner->type = (uint8_t) type;
+    inner->prefixLen = prefix_len;
+    inner->prefixKey = prefix_key;
+    return (inner);
+}
+
+/**
+ *******************************************************************************
+ * @brief _freeNode - Free an inner node and every inner node below it.
+ * Leaves belong to the leaf blocks.
+ *******************************************************************************
+ */
+void Radix_Store::_freeNode (Radix_Node_t * node)
+{
+    Radix_Node_t *child = NULL;
+    int pos = 0;
+
+    if ((node == NULL) || (node->type == RADIX_LEAF))
+    {
+        return;
+    }
+    while ((child = _childAt ((Radix_Inner_t *) node, &pos)) != NULL)
+    {
+        _freeNode (child);
+    }
+    free (node);
+}
+
+/**
+ *******************************************************************************
+ * @brief _findChild - Child of a node for one byte.
+ *
+ * <!-- Returns -->
+ *      @return pointer to the node's child pointer, so it can be replaced,
+ *      NULL if there is no such child.
+ *******************************************************************************
+ */
+Radix_Node_t **Radix_Store::_findChild (Radix_Inner_t * inner, uint8_t byte)
+{
+    Radix_Node4_t *node4 = (Radix_Node4_t *) inner;
+    Radix_Node16_t *node16 = (Radix_Node16_t *) inner;
+    Radix_Node48_t *node48 = (Radix_Node48_t *) inner;
+    Radix_Node256_t *node256 = (Radix_Node256_t *) inner;
+    size_t idx = 0;
+
+    switch (inner->type)
+    {
+    case RADIX_NODE4:
+        for (idx = 0; idx < inner->numChildren; idx++)
+        {
+            if (node4->keys[idx] == byte)
+            {
+                return (&node4->children[idx]);
+            }
+        }
+        break;
+    case RADIX_NODE16:
+        for (idx = 0; (idx < inner->numChildren) &&
+             (node16->keys[idx] <= byte); idx++)
+        {
+            if (node16->keys[idx] == byte)
+            {
+                return (&node16->children[idx]);
+            }
+        }
+        break;
+    case RADIX_NODE48:
+        if (node48->index[byte] != 0)
+        {
+            return (&node48->children[node48->index[byte] - 1]);
+        }
+        break;
+    case RADIX_NODE256:
+        if (node256->children[byte] != NULL)
+        {
+            return (&node256->children[byte]);
+        }
+        break;
+    default:
+        break;
+    }
+    return (NULL);
+}
+
+/**
+ *******************************************************************************
+ * @brief _addChild - Add a child for a byte the node has no child for,
+ * moving the node to the next larger size first if it is full.
+ *
+ * <!-- Parameters -->
+ *      @param[in,out]  ref            Pointer to the node, replaced if the
+ *                                     node grows
+ *      @param[in]      byte           Byte the child is for
+ *      @param[in]      child          Leaf or inner node to add
+ *******************************************************************************
+ */
+void Radix_Store::_addChild (Radix_Node_t ** ref, uint8_t byte,
+                             Radix_Node_t * child)
+{
+    Radix_Inner_t *inner = (Radix_Inner_t *) * ref;
+    Radix_Node4_t *node4 = (Radix_Node4_t *) inner;
+    Radix_Node16_t *node16 = (Radix_Node16_t *) inner;
+    Radix_Node48_t *node48 = (Radix_Node48_t *) inner;
+    Radix_Node256_t *node256 = (Radix_Node256_t *) inner;
+    Radix_Inner_t *grown = NULL;
+    size_t idx = 0;
+
+    switch (inner->type)
+    {
+    case RADIX_NODE4:
+        if (inner->numChildren < 4)
+        {
+            insertSorted (node4->keys, node4->children, inner->numChildren,
+                          byte, child);
+            break;
+        }
+        grown = _newNode (RADIX_NODE16, 0, 0);
+        *grown = *inner;
+        grown->type = RADIX_NODE16;
+        memcpy (((Radix_Node16_t *) grown)->keys, node4->keys, 4);
+        memcpy (((Radix_Node16_t *) grown)->children, node4->children,
+                sizeof (node4->children));
+        break;
+    case RADIX_NODE16:
+        if (inner->numChildren < 16)
+        {
+            insertSorted (node16->keys, node16->children, inner->numChildren,
+                          byte, child);
+            break;
+        }
+        grown = _newNode (RADIX_NODE48, 0, 0);
+        *grown = *inner;
+        grown->type = RADIX_NODE48;
+        for (idx = 0; idx < 16; idx++)
+        {
+            ((Radix_Node48_t *) grown)->index[node16->keys[idx]] =
+                (uint8_t) (idx + 1);
+            ((Radix_Node48_t *) grown)->children[idx] = node16->children[idx];
+        }
+        break;
+    case RADIX_NODE48:
+        if (inner->numChildren < 48)
+        {
+            /* Nothing is ever removed, so the next free slot is the last */
+            node48->children[inner->numChildren] = child;
+            node48->index[byte] = (uint8_t) (inner->numChildren + 1);
+            break;
+        }
+        grown = _newNode (RADIX_NODE256, 0, 0);
+        *grown = *inner;
+        grown->type = RADIX_NODE256;
+        for (idx = 0; idx < 256; idx++)
+        {
+            if (node48->index[idx] != 0)
+            {
+                ((Radix_Node256_t *) grown)->children[idx] =
+                    node48->children[node48->index[idx] - 1];
+            }
+        }
+        break;
+    case RADIX_NODE256:
+        node256->children[byte] = child;
+        break;
+    default:
+        break;
+    }
+
+    if (grown != NULL)
+    {
+        _nodeBytes -= nodeBytes ((Radix_Node_Type_t) inner->type);
+        free (inner);
+        *ref = (Radix_Node_t *) grown;
+        _addChild (ref, byte, child);
+        return;
+    }
+    inner->numChildren++;
+}
+
+/**
+ *******************************************************************************
+ * @brief _childAt - Iterate a node's children in byte order.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      inner          Node whose children to visit
+ *      @param[in,out]  pos            Position to look from, 0 to start,
+ *                                     advanced past the child returned
+ *
+ * <!-- Returns -->
+ *      @return the next child, NULL once there are no more.
+ *******************************************************************************
+ */
+Radix_Node_t *Radix_Store::_childAt (Radix_Inner_t * inner, int *pos)
+{
+    Radix_Node48_t *node48 = (Radix_Node48_t *) inner;
+    Radix_Node256_t *node256 = (Radix_Node256_t *) inner;
+
+    switch (inner->type)
+    {
+    case RADIX_NODE4:
+        if (*pos < inner->numChildren)
+        {
+            return (((Radix_Node4_t *) inner)->children[(*pos)++]);
+        }
+        break;
+    case RADIX_NODE16:
+        if (*pos < inner->numChildren)
+        {
+            return (((Radix_Node16_t *) inner)->children[(*pos)++]);
+        }
+        break;
+    case RADIX_NODE48:
+        for (; *pos < 256; (*pos)++)
+        {
+            if (node48->index[*pos] != 0)
+            {
+                return (node48->children[node48->index[(*pos)++] - 1]);
+            }
+        }
+        break;
+    case RADIX_NODE256:
+        for (; *pos < 256; (*pos)++)
+        {
+            if (node256->children[*pos] != NULL)
+            {
+                return (node256->children[(*pos)++]);
+            }
+        }
+        break;
+    default:
+        break;
+    }
+    return (NULL);
+}
+
+/**
+ *******************************************************************************
+ * @brief _prefixRoot - Top of the subtree holding exactly the words which
+ * start with 'prefix'.
+ *
+ * <!-- Returns -->
+ *      @return the node or leaf, NULL if no word starts with 'prefix'.
+ *******************************************************************************
+ */
+Radix_Node_t *Radix_Store::_prefixRoot (const char *prefix, size_t len)
+{
+    Radix_Node_t *node = _root;
+    Radix_Node_t **child = NULL;
+    Radix_Inner_t *inner = NULL;
+    Radix_Leaf_t *leaf = NULL;
+    const char *path = NULL;
+    size_t depth = 0;
+    size_t idx = 0;
+
+    while (node != NULL)
+    {
+        if (node->type == RADIX_LEAF)
+        {
+            leaf = (Radix_Leaf_t *) node;
+            if ((_keys.keyLen (leaf->id) >= len) &&
+                (memcmp (_keys.key (leaf->id), prefix, len) == 0))
+            {
+                return (node);
+            }
+            return (NULL);
+        }
+        inner = (Radix_Inner_t *) node;
+        path = _prefix (inner, depth);
+        for (idx = 0; idx < inner->prefixLen; idx++)
+        {
+            if (depth + idx == len)
+            {
+                return (node);
+            }
+            if (path[idx] != prefix[depth + idx])
+            {
+                return (NULL);
+            }
+        }
+        depth += inner->prefixLen;
+        if (depth == len)
+        {
+            return (node);
+        }
+        child = _findChild (inner, (uint8_t) prefix[depth]);
+        if (child == NULL)
+        {
+            return (NULL);
+        }
+        node = *child;
+        depth++;
+    }
+    return (NULL);
+}
+
+/**
+ *******************************************************************************
+ * @brief _selectBelow - Offer every word of a subtree to a top_k heap, in
+ * word order, skipping subtrees which cannot get in.
+ *******************************************************************************
+ */
+void Radix_Store::_selectBelow (Radix_Node_t * node, size_t top_k,
+                                vector < Dict_Entry_t > &top_list)
+{
+    Radix_Inner_t *inner = NULL;
+    Radix_Node_t *child = NULL;
+    Dict_Entry_t entry;
+    int pos = 0;
+
+    if (node->type == RADIX_LEAF)
+    {
+        _fillEntry ((Radix_Leaf_t *) node, &entry);
+        dictEntryOffer (entry, top_k, top_list);
+        return;
+    }
+    inner = (Radix_Inner_t *) node;
+    if ((top_list.size () == top_k) &&
+        (inner->maxCount <= top_list.front ().count))
+    {
+        return;
+    }
+    if (inner->value != NULL)
+    {
+        _fillEntry (inner->value, &entry);
+        dictEntryOffer (entry, top_k, top_list);
+    }
+    while ((child = _childAt (inner, &pos)) != NULL)
+    {
+        _selectBelow (child, top_k, top_list);
+    }
+}
+
+/**
+ *******************************************************************************
+ * @brief _fillEntry - Describe a leaf as a Dict_Entry_t.
+ *******************************************************************************
+ */
+void Radix_Store::_fillEntry (Radix_Leaf_t * leaf, Dict_Entry_t * entry)
+{
+    entry->word = _keys.key (leaf->id);
+    entry->len = _keys.keyLen (leaf->id);
+    entry->hash = leaf->hash;
+    entry->count = leaf->count;
+}
+
+/**
+ *******************************************************************************
+ * @brief nodeBytes - Allocation size of an inner node type.
+ *******************************************************************************
+ */
+static size_t nodeBytes (Radix_Node_Type_t type)
+{
+    switch (type)
+    {
+    case RADIX_NODE4:
+        return (sizeof (Radix_Node4_t));
+    case RADIX_NODE16:
+        return (sizeof (Radix_Node16_t));
+    case RADIX_NODE48:
+        return (sizeof (Radix_Node48_t));
+    case RADIX_NODE256:
+    default:
+        return (sizeof (Radix_Node256_t));
+    }
+}
+
+/**
+ *******************************************************************************
+ * @brief insertSorted - Insert a child into a sorted key/child array pair
+ * with room for it.
+ *******************************************************************************
+ */
+static void insertSorted (uint8_t * keys, Radix_Node_t ** children,
+                          size_t num_children, uint8_t byte,
+                          Radix_Node_t * child)
+{
+    size_t pos = 0;
+
+    while ((pos < num_children) && (keys[pos] < byte))
+    {
+        pos++;
+    }
+    memmove (keys + pos + 1, keys + pos, num_children - pos);
+    memmove (children + pos + 1, children + pos,
+             (num_children - pos) * sizeof (children[0]));
+    keys[pos] = byte;
+    children[pos] = child;
+}
@@ -0,0 +1,241 @@
+#ifndef __RADIX_STORE_H__
+#define __RADIX_STORE_H__
+/**
+ * @file           radix_store.hpp
+ * @brief:         Adaptive radix tree dictionary store, with prefix queries.
+ * @verbatim
+ *******************************************************************************
+ * Author:         Douglas L. Potts
+ *
+ * Date:           10/17/2026, <SCR #>
+ *
+ *==============================================================================
+ *==============================================================================
+ * Copyright (c) 2015 Douglas Lee Potts
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ *==============================================================================
+ *==============================================================================
+ *
+ * History:
+ * Date        SCR #  Name  Description
+ * -----------------------------------------------------------------------------
+ *
+ *******************************************************************************
+ * @endverbatim
+ */
+
+/*******************************************************************************
+ * System Includes
+ *******************************************************************************
+ */
+#include <stdint.h>             /* for uint8_t, uint32_t */
+#include <vector>
+
+/*******************************************************************************
+ * Project Includes
+ *******************************************************************************
+ */
+#include "common_types.h"
+#include "dict_store.hpp"
+#include "key_arena.hpp"
+
+#if defined(TEST)
+extern "C"
+{
+    void radixStoreInsertFind (void);
+    void radixStorePrefix (void);
+}
+#endif                          /* defined(TEST) */
+
+/*******************************************************************************
+ * Typedefs
+ *******************************************************************************
+ */
+
+/** Kind of a tree node, the first byte of every node */
+typedef enum
+{
+    RADIX_LEAF = 0,             /**< One word, a Radix_Leaf_t */
+    RADIX_NODE4 = 1,            /**< Up to 4 children, sorted keys */
+    RADIX_NODE16 = 2,           /**< Up to 16 children, sorted keys */
+    RADIX_NODE48 = 3,           /**< Up to 48 children, 256-entry index */
+    RADIX_NODE256 = 4           /**< A child pointer per byte value */
+} Radix_Node_Type_t;
+
+/*******************************************************************************
+ * Constants
+ *******************************************************************************
+ */
+/** Leaves allocated at a time, leaves never move once allocated */
+#define RADIX_LEAF_BLOCK (1024)
+
+/*******************************************************************************
+ * Structures
+ *******************************************************************************
+ */
+using namespace std;
+
+/** What every node starts with, so a child pointer can be told apart */
+typedef struct
+{
+    uint8_t type;               /**< Radix_Node_Type_t */
+} Radix_Node_t;
+
+/** One word and its count */
+typedef struct
+{
+    uint8_t type;               /**< RADIX_LEAF */
+    Key_Id_t id;                /**< Arena id of the whole word */
+    Word_Hash_t hash;           /**< wordHash() of the word */
+    int count;                  /**< Count for this word */
+} Radix_Leaf_t;
+
+/**
+ * Start of every inner node.  The node stands for prefixLen bytes of path
+ * (path compression), which are not stored, but read from any word below it,
+ * prefixKey.  A word ending right after those bytes is the node's 'value',
+ * as no child byte can stand for the end of a word.
+ */
+typedef struct
+{
+    uint8_t type;               /**< RADIX_NODE4 .. RADIX_NODE256 */
+    uint16_t numChildren;       /**< Children in use */
+    uint32_t prefixLen;         /**< Compressed path bytes */
+    Key_Id_t prefixKey;         /**< A word below, holding the path bytes */
+    int maxCount;               /**< No count below is higher */
+    Radix_Leaf_t *value;        /**< Word ending after the path, or NULL */
+} Radix_Inner_t;
+
+typedef struct
+{
+    Radix_Inner_t inner;
+    uint8_t keys[4];            /**< Child bytes, ascending */
+    Radix_Node_t *children[4];
+} Radix_Node4_t;
+
+typedef struct
+{
+    Radix_Inner_t inner;
+    uint8_t keys[16];           /**< Child bytes, ascending */
+    Radix_Node_t *children[16];
+} Radix_Node16_t;
+
+typedef struct
+{
+    Radix_Inner_t inner;
+    uint8_t index[256];         /**< 1 + slot in children, 0 if no child */
+    Radix_Node_t *children[48];
+} Radix_Node48_t;
+
+typedef struct
+{
+    Radix_Inner_t inner;
+    Radix_Node_t *children[256];
+} Radix_Node256_t;
+
+/** Iteration position within one node */
+typedef struct
+{
+    Radix_Node_t *node;         /**< Node being visited */
+    int pos;                    /**< -1 before its value, else next child
+                                  position to look at */
+} Radix_Frame_t;
+
+/**
+ * Adaptive radix tree (ART): a trie on the bytes of each word, whose inner
+ * nodes grow through four sizes as children are added, so sparse nodes stay
+ * small and dense ones index directly.  Shared prefixes are stored once,
+ * chains of single-child nodes are collapsed into one node's path, and a
+ * subtree holding one word is just that word's leaf.
+ *
+ * Iteration is in word order, and can be limited to the words under a
+ * prefix.  Every inner node records the highest count below it, so top-K by
+ * prefix skips any subtree which cannot beat the K-th best found so far.
+ * That annotation is raised when a count is written through a pointer from
+ * find()/findOrInsert(), at the store's next call, so it is exact while
+ * counts only go up, and a safe upper bound otherwise.
+ */
+class Radix_Store:public Dict_Store
+{
+  public:
+    Radix_Store (void);
+    virtual ~ Radix_Store (void);
+
+    virtual int *find (const char *word, size_t len, Word_Hash_t hash);
+    virtual int *findOrInsert (const char *word, size_t len,
+                               Word_Hash_t hash);
+    virtual size_t size (void);
+    virtual void clear (void);
+    virtual void rewind (void);
+    virtual Bool_t next (Dict_Entry_t * entry);
+    virtual void selectPrefix (const char *prefix, size_t len, size_t top_k,
+                               vector < Dict_Entry_t > &top_list);
+    virtual void memoryUsage (Mem_Stats_t * stats);
+
+    void rewindPrefix (const char *prefix, size_t len);
+    Key_Arena & keys (void)
+    {
+        return (this->_keys);
+    };
+
+  private:
+    Radix_Node_t *_root;
+    Key_Arena _keys;
+    size_t _size;
+    vector < Radix_Leaf_t * >_leafBlocks;
+    size_t _leafUsed;
+    size_t _nodeBytes;
+    vector < Radix_Frame_t > _stack;
+    vector < Radix_Inner_t * >_path;
+    Radix_Leaf_t *_pending;
+
+    void _settle (void);
+    Radix_Leaf_t *_newLeaf (const char *word, size_t len, Word_Hash_t hash);
+    Radix_Inner_t *_newNode (Radix_Node_Type_t type, uint32_t prefix_len,
+                             Key_Id_t prefix_key);
+    void _freeNode (Radix_Node_t * node);
+    const char *_prefix (Radix_Inner_t * inner, size_t depth)
+    {
+        return (this->_keys.key (inner->prefixKey) + depth);
+    };
+    Radix_Node_t **_findChild (Radix_Inner_t * inner, uint8_t byte);
+    void _addChild (Radix_Node_t ** ref, uint8_t byte, Radix_Node_t * child);
+    Radix_Node_t *_childAt (Radix_Inner_t * inner, int *pos);
+    Radix_Node_t *_prefixRoot (const char *prefix, size_t len);
+    void _selectBelow (Radix_Node_t * node, size_t top_k,
+                       vector < Dict_Entry_t > &top_list);
+    void _fillEntry (Radix_Leaf_t * leaf, Dict_Entry_t * entry);
+};
+
+/*******************************************************************************
+ * Unions
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * External Function Prototypes
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * Global Variables
+ *******************************************************************************
+ */
+#if _MAIN_
+#define GLOBAL_VAR_DECLARE
+#else
+#define GLOBAL_VAR_DECLARE extern
+#endif /* _MAIN_ */
+
+#endif /* __RADIX_STORE_H__ */
@@ -0,0 +1,554 @@
+/**
+ * @file           uring_reader.cpp
+ * @brief:         io_uring rings, set up with raw syscalls.
+ * @verbatim
+ *******************************************************************************
+ * Author:         Douglas L. Potts
+ *
+ * Date:           10/17/2026, <SCR #>
+ *
+ *==============================================================================
+ *==============================================================================
+ * Copyright (c) 2015 Douglas Lee Potts
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ *==============================================================================
+ *==============================================================================
+ *
+ * History:
+ * Date        SCR #  Name  Description
+ * -----------------------------------------------------------------------------
+ *
+ *******************************************************************************
+ * @endverbatim
+ */
+
+/*******************************************************************************
+ * System Includes
+ *******************************************************************************
+ */
+#include <stdio.h>              /* for fprintf() */
+#include <stdlib.h>             /* for calloc(), mkstemp() */
+#include <string.h>             /* for memset() */
+#include <errno.h>              /* for errno */
+#include <fcntl.h>              /* for O_RDONLY, AT_FDCWD */
+#include <unistd.h>             /* for syscall(), close() */
+#include <sys/mman.h>           /* for mmap() */
+#include <sys/syscall.h>        /* for __NR_io_uring_setup */
+#include <linux/io_uring.h>
+
+/*******************************************************************************
+ * Project Includes
+ *******************************************************************************
+ */
+#include "common_types.h"
+#include "uring_reader.hpp"
+#if defined(TEST)
+#include "unity.h"
+#endif /* defined(TEST) */
+
+/*******************************************************************************
+ * Local Function Prototypes 
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * Local Constants 
+ *******************************************************************************
+ */
+#define DBG(X)
+
+/** Operations the probe has room for, more than the kernel has today */
+#define URING_PROBE_OPS (256)
+
+/*******************************************************************************
+ * File Scoped Variables 
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ ********************* E X T E R N A L  F U N C T I O N S **********************
+ *******************************************************************************
+ */
+
+#if defined(TEST)
+extern "C"
+{
+    void uringReaderReads (void)
+    {
+        static const char DATA[] = "hello uring world";
+        char path[] = "/tmp/ssfi_uring_XXXXXX";
+        Uring_Reader *ring = NULL;
+        char first[5] = { 0 };
+        char second[5] = { 0 };
+        char past_end[4] = { 0 };
+        uint64_t user_data = 0;
+        int res = 0;
+        int fd = -1;
+        int seen = 0;
+
+        /* A ring with no entries is refused by the kernel */
+        ring = new Uring_Reader (0);
+        TEST_ASSERT_TRUE (ring->isReady () == FALSE);
+        TEST_ASSERT_TRUE (ring->prepOpen (path, O_RDONLY, 1) == FALSE);
+        delete ring;
+
+        fd = mkstemp (path);
+        TEST_ASSERT_TRUE (fd != -1);
+        TEST_ASSERT_EQUAL (write (fd, DATA, strlen (DATA)), strlen (DATA));
+        close (fd);
+
+        ring = new Uring_Reader (4);
+        if (ring->isReady () == FALSE)
+        {
+            delete ring;
+            unlink (path);
+            TEST_IGNORE_MESSAGE ("io_uring is not available");
+        }
+
+        /*
+         * An open, then reads at three offsets in flight at once, completing
+         * in any order
+         */
+        TEST_ASSERT_TRUE (ring->prepOpen (path, O_RDONLY, 1) == TRUE);
+        TEST_ASSERT_TRUE (ring->prepOpen ("/nonexistent/ssfi", O_RDONLY, 2) ==
+                          TRUE);
+        TEST_ASSERT_EQUAL (ring->inFlight (), 2);
+        fd = -1;
+        while (ring->inFlight () > 0)
+        {
+            TEST_ASSERT_TRUE (ring->submit (1) >= 0);
+            while (ring->nextCompletion (&user_data, &res) == TRUE)
+            {
+                if (user_data == 1)
+                {
+                    fd = res;
+                }
+                else
+                {
+                    TEST_ASSERT_EQUAL (user_data, 2);
+                    TEST_ASSERT_EQUAL (res, -ENOENT);
+                }
+            }
+        }
+        TEST_ASSERT_TRUE (fd >= 0);
+
+        TEST_ASSERT_TRUE (ring->prepRead (fd, first, 5, 0, 10) == TRUE);
+        TEST_ASSERT_TRUE (ring->prepRead (fd, second, 5, 6, 11) == TRUE);
+        TEST_ASSERT_TRUE (ring->prepRead (fd, past_end, 4, 100, 12) == TRUE);
+        while (ring->inFlight () > 0)
+        {
+            TEST_ASSERT_TRUE (ring->submit (1) >= 0);
+            while (ring->nextCompletion (&user_data, &res) == TRUE)
+            {
+                TEST_ASSERT_EQUAL (res, (user_data == 12) ? 0 : 5);
+                seen++;
+            }
+        }
+        TEST_ASSERT_EQUAL (seen, 3);
+        TEST_ASSERT_EQUAL_MEMORY ("hello", first, 5);
+        TEST_ASSERT_EQUAL_MEMORY ("uring", second, 5);
+
+        close (fd);
+        unlink (path);
+        delete ring;
+    }
+}
+#endif /* defined(TEST) */
+
+/**
+ *******************************************************************************
+ * @brief Uring_Reader - Constructor, setting up the rings.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      entries        Operations that may be in flight at
+ *                                     once, rounded up by the kernel to a
+ *                                     power of two
+ *
+ * @par Description:
+ *      Nothing here fails loudly, a ring which couldn't be set up is left
+ *      with isReady() FALSE.
+ *******************************************************************************
+ */
+Uring_Reader::Uring_Reader (unsigned int entries)
+{
+    _ringFd = -1;
+    _entries = 0;
+    _inFlight = 0;
+    _toSubmit = 0;
+    _sqRing = MAP_FAILED;
+    _sqRingBytes = 0;
+    _cqRing = MAP_FAILED;
+    _cqRingBytes = 0;
+    _sqes = (struct io_uring_sqe *) MAP_FAILED;
+    _sqesBytes = 0;
+    _sqHead = NULL;
+    _sqTail = NULL;
+    _sqMask = NULL;
+    _sqArray = NULL;
+    _cqHead = NULL;
+    _cqTail = NULL;
+    _cqMask = NULL;
+    _cqes = NULL;
+
+    if ((_setup (entries) == FALSE) || (_probe () == FALSE))
+    {
+        _teardown ();
+    }
+}
+
+/**
+ *******************************************************************************
+ * @brief ~Uring_Reader - Destructor, unmapping and closing the rings.
+ *
+ * @par Description:
+ *      Operations still in flight are abandoned, the buffers they read into
+ *      must stay valid until the process exits.
+ *******************************************************************************
+ */
+Uring_Reader::~Uring_Reader (void)
+{
+    _teardown ();
+}
+
+/**
+ *******************************************************************************
+ * @brief prepOpen - Queue an open of a file.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      path           File to open, which must stay valid
+ *                                     until the open completes
+ *      @param[in]      flags          open() flags, O_RDONLY and any of
+ *                                     O_DIRECT etc.
+ *      @param[in]      user_data      Handed back with the completion
+ *
+ * <!-- Returns -->
+ *      @return TRUE    If queued, the completion's result is the file
+ *                      descriptor, or -errno
+ *      @return FALSE   If the ring isn't ready or is full
+ *******************************************************************************
+ */
+Bool_t Uring_Reader::prepOpen (const char *path, int flags,
+                               uint64_t user_data)
+{
+    struct io_uring_sqe *sqe = _nextSqe ();
+
+    if (sqe == NULL)
+    {
+        return (FALSE);
+    }
+    sqe->opcode = IORING_OP_OPENAT;
+    sqe->fd = AT_FDCWD;
+    sqe->addr = (uint64_t) (uintptr_t) path;
+    sqe->open_flags = (uint32_t) flags;
+    sqe->user_data = user_data;
+    return (TRUE);
+}
+
+/**
+ *******************************************************************************
+ * @brief prepRead - Queue a read from a file at an offset.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      fd             Open file to read
+ *      @param[out]     buf            Where to read to, which must stay valid
+ *                                     until the read completes
+ *      @param[in]      len            Most bytes to read
+ *      @param[in]      offset         File offset to read from
+ *      @param[in]      user_data      Handed back with the completion
+ *
+ * <!-- Returns -->
+ *      @return TRUE    If queued, the completion's result is the bytes read,
+ *                      0 at end of file, or -errno
+ *      @return FALSE   If the ring isn't ready or is full
+ *******************************************************************************
+ */
+Bool_t Uring_Reader::prepRead (int fd, void *buf, unsigned int len,
+                               uint64_t offset, uint64_t user_data)
+{
+    struct io_uring_sqe *sqe = _nextSqe ();
+
+    if (sqe == NULL)
+    {
+        return (FALSE);
+    }
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = fd;
+    sqe->addr = (uint64_t) (uintptr_t) buf;
+    sqe->len = len;
+    sqe->off = offset;
+    sqe->user_data = user_data;
+    return (TRUE);
+}
+
+/**
+ *******************************************************************************
+ * @brief submit - Hand every queued operation to the kernel, and optionally
+ * wait for completions.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      wait_nr        Completions to wait for, 0 not to wait
+ *
+ * <!-- Returns -->
+ *      @return Operations submitted, or -errno
+ *******************************************************************************
+ */
+int Uring_Reader::submit (unsigned int wait_nr)
+{
+    long ret = 0;
+
+    if (_ringFd == -1)
+    {
+        return (-EBADF);
+    }
+    if (wait_nr > _inFlight)
+    {
+        wait_nr = _inFlight;
+    }
+    do
+    {
+        ret = syscall (__NR_io_uring_enter, _ringFd, _toSubmit, wait_nr,
+                       (wait_nr > 0) ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+    }
+    while ((ret < 0) && (errno == EINTR));
+    if (ret < 0)
+    {
+        return (-errno);
+    }
+    _toSubmit -= (unsigned int) ret;
+    return ((int) ret);
+}
+
+/**
+ *******************************************************************************
+ * @brief nextCompletion - Take the next finished operation, without waiting.
+ *
+ * <!-- Parameters -->
+ *      @param[out]     user_data      The operation's user_data
+ *      @param[out]     res            Its result, see prepOpen()/prepRead()
+ *
+ * <!-- Returns -->
+ *      @return TRUE    If an operation had finished
+ *      @return FALSE   If none has, submit() with a wait_nr to wait
+ *******************************************************************************
+ */
+Bool_t Uring_Reader::nextCompletion (uint64_t * user_data, int *res)
+{
+    unsigned int head = 0;
+    struct io_uring_cqe *cqe = NULL;
+
+    if (_ringFd == -1)
+    {
+        return (FALSE);
+    }
+    head = *_cqHead;
+    if (head == __atomic_load_n (_cqTail, __ATOMIC_ACQUIRE))
+    {
+        return (FALSE);
+    }
+    cqe = &_cqes[head & *_cqMask];
+    *user_data = cqe->user_data;
+    *res = cqe->res;
+    __atomic_store_n (_cqHead, head + 1, __ATOMIC_RELEASE);
+    _inFlight--;
+    return (TRUE);
+}
+
+/*******************************************************************************
+ ************************ L O C A L  F U N C T I O N S *************************
+ *******************************************************************************
+ */
+
+/**
+ *******************************************************************************
+ * @brief _setup - io_uring_setup(), and map the rings it makes.
+ *
+ * @par Description:
+ *      With IORING_FEAT_SINGLE_MMAP (5.4 kernels on) both rings are in one
+ *      mapping, else each is mapped on its own.  The submission queue's
+ *      index array is filled in once with every entry in order, so a queued
+ *      entry only has to be published by moving the tail.
+ *******************************************************************************
+ */
+Bool_t Uring_Reader::_setup (unsigned int entries)
+{
+    struct io_uring_params params;
+    char *sq = NULL;
+    char *cq = NULL;
+    long fd = -1;
+    unsigned int idx = 0;
+
+    memset (&params, 0, sizeof (params));
+    fd = syscall (__NR_io_uring_setup, entries, &params);
+    if (fd < 0)
+    {
+        DBG (fprintf (stderr, "io_uring_setup failed, errno=%d\n", errno));
+        return (FALSE);
+    }
+    _ringFd = (int) fd;
+    _entries = params.sq_entries;
+
+    _sqRingBytes = params.sq_off.array + params.sq_entries *
+        sizeof (unsigned int);
+    _cqRingBytes = params.cq_off.cqes + params.cq_entries *
+        sizeof (struct io_uring_cqe);
+    if ((params.features & IORING_FEAT_SINGLE_MMAP) != 0)
+    {
+        if (_cqRingBytes > _sqRingBytes)
+        {
+            _sqRingBytes = _cqRingBytes;
+        }
+        _cqRingBytes = 0;
+    }
+    _sqRing = mmap (NULL, _sqRingBytes, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, _ringFd, IORING_OFF_SQ_RING);
+    if (_sqRing == MAP_FAILED)
+    {
+        return (FALSE);
+    }
+    if (_cqRingBytes == 0)
+    {
+        cq = (char *) _sqRing;
+    }
+    else
+    {
+        _cqRing = mmap (NULL, _cqRingBytes, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, _ringFd,
+                        IORING_OFF_CQ_RING);
+        if (_cqRing == MAP_FAILED)
+        {
+            return (FALSE);
+        }
+        cq = (char *) _cqRing;
+    }
+    _sqesBytes = params.sq_entries * sizeof (struct io_uring_sqe);
+    _sqes = (struct io_uring_sqe *) mmap (NULL, _sqesBytes,
+                                          PROT_READ | PROT_WRITE,
+                                          MAP_SHARED | MAP_POPULATE,
+                                          _ringFd, IORING_OFF_SQES);
+    if ((void *) _sqes == MAP_FAILED)
+    {
+        return (FALSE);
+    }
+
+    sq = (char *) _sqRing;
+    _sqHead = (unsigned int *) (sq + params.sq_off.head);
+    _sqTail = (unsigned int *) (sq + params.sq_off.tail);
+    _sqMask = (unsigned int *) (sq + params.sq_off.ring_mask);
+    _sqArray = (unsigned int *) (sq + params.sq_off.array);
+    _cqHead = (unsigned int *) (cq + params.cq_off.head);
+    _cqTail = (unsigned int *) (cq + params.cq_off.tail);
+    _cqMask = (unsigned int *) (cq + params.cq_off.ring_mask);
+    _cqes = (struct io_uring_cqe *) (cq + params.cq_off.cqes);
+    for (idx = 0; idx < params.sq_entries; idx++)
+    {
+        _sqArray[idx] = idx;
+    }
+    return (TRUE);
+}
+
+/**
+ *******************************************************************************
+ * @brief _probe - Check the kernel has the open and read operations, which
+ * came in 5.6, after io_uring itself.
+ *******************************************************************************
+ */
+Bool_t Uring_Reader::_probe (void)
+{
+    struct io_uring_probe *probe = NULL;
+    Bool_t ok = FALSE;
+    long ret = 0;
+
+    probe = (struct io_uring_probe *) calloc (1, sizeof (*probe) +
+                                              URING_PROBE_OPS *
+                                              sizeof (struct
+                                                      io_uring_probe_op));
+    if (probe == NULL)
+    {
+        return (FALSE);
+    }
+    ret = syscall (__NR_io_uring_register, _ringFd, IORING_REGISTER_PROBE,
+                   probe, URING_PROBE_OPS);
+    if ((ret == 0) && (probe->last_op >= IORING_OP_READ) &&
+        ((probe->ops[IORING_OP_OPENAT].flags & IO_URING_OP_SUPPORTED) != 0) &&
+        ((probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED) != 0))
+    {
+        ok = TRUE;
+    }
+    free (probe);
+    return (ok);
+}
+
+/**
+ *******************************************************************************
+ * @brief _teardown - Unmap the rings and close the ring, leaving isReady()
+ * FALSE.
+ *******************************************************************************
+ */
+void Uring_Reader::_teardown (void)
+{
+    if ((void *) _sqes != MAP_FAILED)
+    {
+        munmap ((void *) _sqes, _sqesBytes);
+        _sqes = (struct io_uring_sqe *) MAP_FAILED;
+    }
+    if (_cqRing != MAP_FAILED)
+    {
+        munmap (_cqRing, _cqRingBytes);
+        _cqRing = MAP_FAILED;
+    }
+    if (_sqRing != MAP_FAILED)
+    {
+        munmap (_sqRing, _sqRingBytes);
+        _sqRing = MAP_FAILED;
+    }
+    if (_ringFd != -1)
+    {
+        close (_ringFd);
+        _ringFd = -1;
+    }
+    _inFlight = 0;
+    _toSubmit = 0;
+}
+
+/**
+ *******************************************************************************
+ * @brief _nextSqe - Claim the next submission queue entry, cleared, and
+ * publish it to the kernel for the next submit().
+ *
+ * <!-- Returns -->
+ *      @return The entry, or NULL if the ring isn't ready or every entry is
+ *      in flight
+ *******************************************************************************
+ */
+struct io_uring_sqe *Uring_Reader::_nextSqe (void)
+{
+    struct io_uring_sqe *sqe = NULL;
+    unsigned int tail = 0;
+
+    if ((_ringFd == -1) || (_inFlight >= _entries))
+    {
+        return (NULL);
+    }
+    tail = *_sqTail;
+    sqe = &_sqes[tail & *_sqMask];
+    memset (sqe, 0, sizeof (*sqe));
+    /*
+     * The caller fills the entry in before the next submit(), which is a
+     * system call, so the kernel won't look at it before then.
+     */
+    __atomic_store_n (_sqTail, tail + 1, __ATOMIC_RELEASE);
+    _toSubmit++;
+    _inFlight++;
+    return (sqe);
+}
@@ -0,0 +1,164 @@
+#ifndef __URING_READER_H__
+#define __URING_READER_H__
+/**
+ * @file           uring_reader.hpp
+ * @brief:         io_uring rings, set up with raw syscalls.
+ * @verbatim
+ *******************************************************************************
+ * Author:         Douglas L. Potts
+ *
+ * Date:           10/17/2026, <SCR #>
+ *
+ *==============================================================================
+ *==============================================================================
+ * Copyright (c) 2015 Douglas Lee Potts
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ *==============================================================================
+ *==============================================================================
+ *
+ * History:
+ * Date        SCR #  Name  Description
+ * -----------------------------------------------------------------------------
+ *
+ *******************************************************************************
+ * @endverbatim
+ */
+
+/*******************************************************************************
+ * System Includes
+ *******************************************************************************
+ */
+#include <stddef.h>             /* for size_t */
+#include <stdint.h>             /* for uint64_t */
+
+/*******************************************************************************
+ * Project Includes
+ *******************************************************************************
+ */
+#include "common_types.h"
+
+#if defined(TEST)
+extern "C"
+{
+    void uringReaderReads (void);
+}
+#endif                          /* defined(TEST) */
+
+/*******************************************************************************
+ * Typedefs
+ *******************************************************************************
+ */
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+/*******************************************************************************
+ * Constants
+ *******************************************************************************
+ */
+/** Submission queue entries when none are asked for */
+#define URING_DEFAULT_ENTRIES (8)
+
+/*******************************************************************************
+ * Structures
+ *******************************************************************************
+ */
+
+/**
+ * An io_uring instance, set up straight through the io_uring_setup() and
+ * io_uring_enter() system calls, so there is no liburing to depend on.
+ *
+ * Operations are queued with prepOpen()/prepRead(), each tagged with a
+ * caller's 'user_data', handed to the kernel in one system call by
+ * submit(), and their results taken with nextCompletion() in whatever
+ * order they finish.  At most the ring's entries may be in flight.
+ *
+ * isReady() is FALSE if the kernel has no io_uring, won't let this process
+ * use it (seccomp, sysctl), or lacks the open and read operations, and the
+ * caller should use plain system calls instead.  Not thread-safe, a ring
+ * belongs to one thread.
+ */
+class Uring_Reader
+{
+  public:
+    Uring_Reader (unsigned int entries = URING_DEFAULT_ENTRIES);
+    virtual ~ Uring_Reader (void);
+
+    Bool_t isReady (void)
+    {
+        return ((this->_ringFd != -1) ? TRUE : FALSE);
+    };
+    unsigned int inFlight (void)
+    {
+        return (this->_inFlight);
+    };
+    unsigned int entries (void)
+    {
+        return (this->_entries);
+    };
+
+    Bool_t prepOpen (const char *path, int flags, uint64_t user_data);
+    Bool_t prepRead (int fd, void *buf, unsigned int len, uint64_t offset,
+                     uint64_t user_data);
+    int submit (unsigned int wait_nr);
+    Bool_t nextCompletion (uint64_t * user_data, int *res);
+
+  private:
+    int _ringFd;
+    unsigned int _entries;
+    unsigned int _inFlight;
+    unsigned int _toSubmit;
+
+    void *_sqRing;
+    size_t _sqRingBytes;
+    void *_cqRing;
+    size_t _cqRingBytes;
+    struct io_uring_sqe *_sqes;
+    size_t _sqesBytes;
+
+    unsigned int *_sqHead;
+    unsigned int *_sqTail;
+    unsigned int *_sqMask;
+    unsigned int *_sqArray;
+    unsigned int *_cqHead;
+    unsigned int *_cqTail;
+    unsigned int *_cqMask;
+    struct io_uring_cqe *_cqes;
+
+    Bool_t _setup (unsigned int entries);
+    Bool_t _probe (void);
+    void _teardown (void);
+    struct io_uring_sqe *_nextSqe (void);
+};
+
+/*******************************************************************************
+ * Unions
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * External Function Prototypes
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * Global Variables
+ *******************************************************************************
+ */
+#if _MAIN_
+#define GLOBAL_VAR_DECLARE
+#else
+#define GLOBAL_VAR_DECLARE extern
+#endif /* _MAIN_ */
+
+#endif /* __URING_READER_H__ */
@@ -0,0 +1,114 @@
+#ifndef __UTF8_WORDS_H__
+#define __UTF8_WORDS_H__
+/**
+ * @file           utf8_words.hpp
+ * @brief:         UTF-8 word characters and simple case folding.
+ * @verbatim
+ *******************************************************************************
+ * Author:         Douglas L. Potts
+ *
+ * Date:           10/17/2026, <SCR #>
+ *
+ *==============================================================================
+ *==============================================================================
+ * Copyright (c) 2015 Douglas Lee Potts
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ *==============================================================================
+ *==============================================================================
+ *
+ * History:
+ * Date        SCR #  Name  Description
+ * -----------------------------------------------------------------------------
+ *
+ *******************************************************************************
+ * @endverbatim
+ */
+
+/*******************************************************************************
+ * System Includes
+ *******************************************************************************
+ */
+#include <stddef.h>             /* for size_t */
+#include <stdint.h>             /* for uint32_t, uint64_t */
+
+/*******************************************************************************
+ * Project Includes
+ *******************************************************************************
+ */
+#include "common_types.h"
+#include "word_scan.hpp"
+
+#if defined(TEST)
+extern "C"
+{
+    void utf8Words (void);
+}
+#endif                          /* defined(TEST) */
+
+/*******************************************************************************
+ * Typedefs
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * Constants
+ *******************************************************************************
+ */
+/** Bytes utf8ScanBlock() checks for being all ASCII at once */
+#define UTF8_ASCII_RUN (32)
+/** What utf8Decode() gives for a byte that doesn't start a valid sequence */
+#define UTF8_INVALID (0xfffd)
+
+/*******************************************************************************
+ * Structures
+ *******************************************************************************
+ */
+
+/** A code point cut off by the end of the last block utf8ScanBlock() did */
+typedef struct
+{
+    size_t pending;             /**< Its bytes at the start of the next block */
+    Bool_t pending_word;        /**< Whether it is a word character */
+    Bool_t non_ascii;           /**< Whether the last block had any bytes
+                                  above ASCII */
+} Utf8_Scan_t;
+
+/*******************************************************************************
+ * Unions
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * External Function Prototypes
+ *******************************************************************************
+ */
+size_t utf8Decode (const char *bytes, size_t len, uint32_t * code_point);
+Bool_t utf8IsWordCodePoint (uint32_t code_point);
+uint32_t utf8FoldCodePoint (uint32_t code_point);
+void utf8FoldWord (const char *word, char *fold, size_t len);
+Bool_t utf8IsAscii (const char *run);
+uint64_t utf8ScanBlock (const char *block, size_t len, size_t avail,
+                        Word_Scan_Fn_t scan, Utf8_Scan_t * state);
+
+/*******************************************************************************
+ * Global Variables
+ *******************************************************************************
+ */
+#if _MAIN_
+#define GLOBAL_VAR_DECLARE
+#else
+#define GLOBAL_VAR_DECLARE extern
+#endif /* _MAIN_ */
+
+#endif /* __UTF8_WORDS_H__ */
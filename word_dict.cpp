@@ -39,9 +39,10 @@
  */
 #include <stdlib.h>             /* for malloc() */
 #include <string.h>             /* for memset() */
+#include <sched.h>              /* for sched_yield() */
 #include <iostream>             /* for cout() */
 #include <vector>
-#include <algorithm>            /* for std::sort */
+#include <algorithm>            /* for std::partial_sort, std::push_heap */
 
 /*******************************************************************************
  * Project Includes
@@ -54,10 +55,43 @@
 #include "unity.h"
 #endif /* defined(TEST) */
 
+/*******************************************************************************
+ * Local Structs
+ *******************************************************************************
+ */
+/** Arguments for one pairwise merge in mergeDictionaries */
+typedef struct
+{
+    Word_Dict *dst;             /**< Dictionary receiving the counts */
+    Word_Dict *src;             /**< Dictionary being folded into dst */
+} Dict_Merge_Pair_t;
+
+/** Arguments and result for one thread of selectTopX */
+typedef struct
+{
+    Word_Dict *dict;            /**< Dictionary being searched */
+    unsigned int first_shard;   /**< First shard this thread looks at */
+    unsigned int shard_step;    /**< Distance between its shards */
+    size_t top_k;               /**< Candidates to keep */
+    vector < Dict_Entry_t > candidates; /**< Selected entries */
+} Dict_TopX_Job_t;
+
 /*******************************************************************************
  * Local Function Prototypes 
  *******************************************************************************
  */
+static void *mergeThread (void *arg);
+static void *topXThread (void *arg);
+static bool leaderRanksBefore (const Dict_Leader_t & left,
+                               const Dict_Leader_t & right);
+static bool entryHashBefore (const Dict_Entry_t & left,
+                             const Dict_Entry_t & right);
+#if defined(TEST)
+static void *shardedIncrementThread (void *arg);
+static void *upsertThread (void *arg);
+static void *snapshotReaderThread (void *arg);
+static void *leaderboardReaderThread (void *arg);
+#endif /* defined(TEST) */
 
 /*******************************************************************************
  * Local Constants 
@@ -65,6 +99,15 @@
  */
 #define DBG(X)
 
+/** Shard whose lock serializes the Approx_Counter in approximate mode, for
+ * every shard, see enableApproximate() */
+#define APPROX_SHARD (0)
+/** Narrowest sketch checkMemoryLimit() will switch to, however tight the
+ * limit */
+#define WORD_DICT_MIN_SKETCH_WIDTH (1024)
+/** Words merged in from a spilled dictionary between memory limit checks */
+#define WORD_DICT_SPILL_CHECK_WORDS (64 * 1024)
+
 #if defined(TEST)
 static char word1[] = "1";
 static char word2[] = "3";
@@ -74,6 +117,9 @@ static char APPLES[] = "apples";
 static char ORANGES[] = "oranges";
 static char CHERRIES[] = "cherries";
 static char PEARS[] = "pears";
+
+/** Increments each test thread performs per word in wordDictShardedThreads */
+static const int SHARD_TEST_LOOPS = 10000;
 #endif /* defined(TEST) */
 
 /*******************************************************************************
@@ -118,13 +164,14 @@ extern "C"
         myDictionary->insertWord (word3, 7);
         printf ("myDictionary Inserted WORDS:\n");
 
+        TEST_ASSERT_NOT_NULL (myDictionary->getMap ());
         std::map < string, int >::iterator it =
-            myDictionary->getMap ().begin ();
+            myDictionary->getMap ()->begin ();
 
         // showing contents:
         std::cout << "myDictionary contains:\n";
-        for (idx = 0, it = myDictionary->getMap ().begin ();
-             it != myDictionary->getMap ().end (); ++it, idx++)
+        for (idx = 0, it = myDictionary->getMap ()->begin ();
+             it != myDictionary->getMap ()->end (); ++it, idx++)
         {
 
             std::cout << it->first << " => " << it->second << '\n';
@@ -303,484 +350,3385 @@ extern "C"
 
         delete myDictionary;
     }
-}
-#endif /* defined(TEST) */
+    void wordDictShardedIterItems (void)
+    {
+        Word_Dict *myDictionary = new Word_Dict (8);
+        string _word;
+        int _wordCount = 0;
+        int entries = 0;
+        int total = 0;
 
-/**
- *******************************************************************************
- * @brief Word_Dict - Constructor
- *******************************************************************************
- */
-Word_Dict::Word_Dict (void)
-{
-    int stat = 0;
+        TEST_ASSERT_NOT_NULL (myDictionary);
+        TEST_ASSERT_EQUAL (myDictionary->getNumShards (), 8);
 
-    _mut_init = FALSE;
-    _is_locked = FALSE;
+        myDictionary->insertWord (APPLES, 2);
+        myDictionary->insertWord (ORANGES, 5);
+        myDictionary->insertWord (CHERRIES, 7);
+        myDictionary->insertWord (PEARS, 11);
+        myDictionary->incrementWordCount (PEARS);
 
-    stat = pthread_mutex_init (&_mut, NULL);
-    EXIT_EARLY_ON_ERROR (stat);
-    _mut_init = TRUE;
-    _it = _dictionaryMap.begin ();
-    _showDebugOutput = FALSE;
+        TEST_ASSERT_TRUE (myDictionary->hasWord (CHERRIES));
+        TEST_ASSERT_EQUAL (myDictionary->getWordCount (PEARS), 12);
 
-  cleanup:
-    return;
+        /*
+         * Iteration has to walk every shard and see each word exactly once
+         */
+        myDictionary->begin ();
+        do
+        {
+            myDictionary->getNextWord (_word, &_wordCount);
+            if (_word.empty () == false)
+            {
+                entries++;
+                total += _wordCount;
+            }
+        }
+        while (_word.empty () == false);
+        TEST_ASSERT_EQUAL (entries, 4);
+        TEST_ASSERT_EQUAL (total, 2 + 5 + 7 + 12);
 
-  error:
-    goto cleanup;
-}
+        delete myDictionary;
+    }
+    void wordDictShardedThreads (void)
+    {
+        static const int NUM_THREADS = 4;
+        Word_Dict *myDictionary = new Word_Dict (16);
+        pthread_t threads[NUM_THREADS];
+        int idx = 0;
 
-/**
- *******************************************************************************
- * @brief ~Word_Dict - Destructor
- *******************************************************************************
- */
-Word_Dict::~Word_Dict (void)
-{
-    int stat = 0;
+        myDictionary->insertWord (APPLES, 0);
+        myDictionary->insertWord (ORANGES, 0);
+        myDictionary->insertWord (CHERRIES, 0);
+        for (idx = 0; idx < NUM_THREADS; idx++)
+        {
+            TEST_ASSERT_EQUAL (pthread_create (&threads[idx], NULL,
+                                               shardedIncrementThread,
+                                               (void *) myDictionary), 0);
+        }
+        for (idx = 0; idx < NUM_THREADS; idx++)
+        {
+            pthread_join (threads[idx], NULL);
+        }
+        TEST_ASSERT_EQUAL (myDictionary->getWordCount (APPLES),
+                           NUM_THREADS * SHARD_TEST_LOOPS);
+        TEST_ASSERT_EQUAL (myDictionary->getWordCount (ORANGES),
+                           NUM_THREADS * SHARD_TEST_LOOPS);
+        TEST_ASSERT_EQUAL (myDictionary->getWordCount (CHERRIES),
+                           NUM_THREADS * SHARD_TEST_LOOPS);
 
-    DBG (printf ("[%s:%d] deleting myDictionary\n", __FILE__, __LINE__));
+        delete myDictionary;
+    }
+    void wordDictAddOrIncrement (void)
+    {
+        Word_Dict *myDictionary = new Word_Dict ();
 
+        TEST_ASSERT_NOT_NULL (myDictionary);
 
-    _lock ();
-    if (!_dictionaryMap.empty ())
+        TEST_ASSERT_EQUAL (myDictionary->addOrIncrement (APPLES), 1);
+        TEST_ASSERT_EQUAL (myDictionary->addOrIncrement (APPLES), 2);
+        TEST_ASSERT_EQUAL (myDictionary->addOrIncrement (ORANGES, 5), 5);
+        TEST_ASSERT_EQUAL (myDictionary->addOrIncrement (APPLES, 3), 5);
+
+        TEST_ASSERT_EQUAL (myDictionary->getWordCount (APPLES), 5);
+        TEST_ASSERT_EQUAL (myDictionary->getWordCount (ORANGES), 5);
+        TEST_ASSERT_FALSE (myDictionary->hasWord (PEARS));
+
+        delete myDictionary;
+    }
+    void wordDictAddOrIncrementBatch (void)
+    {
+        Word_Dict *myDictionary = new Word_Dict (4);
+        string batch[] = { APPLES, PEARS, APPLES, CHERRIES, APPLES, PEARS };
+
+        TEST_ASSERT_NOT_NULL (myDictionary);
+
+        myDictionary->addOrIncrement (batch, 6);
+        myDictionary->addOrIncrement (batch, 2, 10);
+        myDictionary->addOrIncrement (batch, 0);
+
+        TEST_ASSERT_EQUAL (myDictionary->getWordCount (APPLES), 13);
+        TEST_ASSERT_EQUAL (myDictionary->getWordCount (PEARS), 12);
+        TEST_ASSERT_EQUAL (myDictionary->getWordCount (CHERRIES), 1);
+        TEST_ASSERT_EQUAL (myDictionary->getWordCount (ORANGES), -1);
+
+        delete myDictionary;
+    }
+    void wordDictAddOrIncrementThreads (void)
     {
-        DBG (printf
-             ("[%s:%d] Erasing any existing map entries\n", __FILE__,
-              __LINE__));
-        _dictionaryMap.erase (_dictionaryMap.begin (), _dictionaryMap.end ());
+        static const int NUM_THREADS = 4;
+        Word_Dict *myDictionary = new Word_Dict ();
+        pthread_t threads[NUM_THREADS];
+        int idx = 0;
+
+        /*
+         * Words are deliberately NOT pre-inserted, every thread races to be
+         * the one that creates them.
+         */
+        for (idx = 0; idx < NUM_THREADS; idx++)
+        {
+            TEST_ASSERT_EQUAL (pthread_create (&threads[idx], NULL,
+                                               upsertThread,
+                                               (void *) myDictionary), 0);
+        }
+        for (idx = 0; idx < NUM_THREADS; idx++)
+        {
+            pthread_join (threads[idx], NULL);
+        }
+        TEST_ASSERT_EQUAL (myDictionary->getWordCount (APPLES),
+                           NUM_THREADS * SHARD_TEST_LOOPS);
+        TEST_ASSERT_EQUAL (myDictionary->getWordCount (PEARS),
+                           NUM_THREADS * SHARD_TEST_LOOPS);
+
+        delete myDictionary;
     }
-    else
+    void wordDictMerge (void)
     {
-        printf ("[%s:%d] No map entries to erase\n", __FILE__, __LINE__);
+        Word_Dict *dst = new Word_Dict (4);
+        Word_Dict *same = new Word_Dict (4, FALSE);
+        Word_Dict *other = new Word_Dict (3, FALSE);
+
+        TEST_ASSERT_FALSE (same->isThreadSafe ());
+
+        dst->addOrIncrement (APPLES, 2);
+        same->addOrIncrement (APPLES, 3);
+        same->addOrIncrement (PEARS, 1);
+        other->addOrIncrement (PEARS, 4);
+        other->addOrIncrement (CHERRIES, 5);
+
+        /*
+         * Same shard count takes the shard-to-shard path, different shard
+         * count puts the words in hash order to re-shard them.
+         */
+        dst->merge (*same);
+        dst->merge (*other);
+
+        TEST_ASSERT_EQUAL (dst->getWordCount (APPLES), 5);
+        TEST_ASSERT_EQUAL (dst->getWordCount (PEARS), 5);
+        TEST_ASSERT_EQUAL (dst->getWordCount (CHERRIES), 5);
+        TEST_ASSERT_EQUAL (dst->size (), 3);
+
+        delete dst;
+        delete same;
+        delete other;
     }
-    _unlock ();
+    void wordDictMergeTree (void)
+    {
+        static const int NUM_DICTS = 7;
+        Word_Dict *dicts[NUM_DICTS];
+        Word_Dict *merged = NULL;
+        int idx = 0;
 
+        for (idx = 0; idx < NUM_DICTS; idx++)
+        {
+            dicts[idx] = new Word_Dict (2, FALSE);
+            dicts[idx]->addOrIncrement (APPLES, 1);
+            dicts[idx]->addOrIncrement (word1, idx);
+        }
+        dicts[NUM_DICTS - 1]->addOrIncrement (PEARS, 9);
+
+        merged = mergeDictionaries (dicts, NUM_DICTS);
+        TEST_ASSERT_TRUE (merged == dicts[0]);
+        TEST_ASSERT_EQUAL (merged->getWordCount (APPLES), NUM_DICTS);
+        TEST_ASSERT_EQUAL (merged->getWordCount (word1), 0 + 1 + 2 + 3 + 4 + 5 + 6);
+        TEST_ASSERT_EQUAL (merged->getWordCount (PEARS), 9);
+        for (idx = 1; idx < NUM_DICTS; idx++)
+        {
+            TEST_ASSERT_EQUAL (dicts[idx]->size (), 0);
+        }
+        TEST_ASSERT_NULL (mergeDictionaries (dicts, 0));
 
-    DBG (printf ("[%s:%d] Destroying mutex\n", __FILE__, __LINE__));
-    stat = pthread_mutex_destroy (&_mut);
-    if (stat != 0)
+        for (idx = 0; idx < NUM_DICTS; idx++)
+        {
+            delete dicts[idx];
+        }
+    }
+    void wordDictHashBackend (void)
     {
-        fprintf (stderr, "[%s, %d:%s] failed, stat=%d, errno=%d, %s\n",
-                 __FILE__, __LINE__, __FUNCTION__, stat, errno,
-                 strerror (errno));
+        Word_Dict *hashDict = new Word_Dict (4, TRUE, DICT_BACKEND_HASH);
+        Word_Dict *mapDict = new Word_Dict (1);
+        string word;
+        int count = -1;
+        int seen = 0;
+
+        TEST_ASSERT_EQUAL (hashDict->getBackend (), DICT_BACKEND_HASH);
+        hashDict->insertWord (APPLES, 2);
+        hashDict->incrementWordCount (APPLES);
+        hashDict->addOrIncrement (PEARS, 4);
+        /* Pointer and length lookups need not be nul terminated */
+        hashDict->addOrIncrement (CHERRIES, 6, wordHash (CHERRIES, 6), 7);
+
+        TEST_ASSERT_EQUAL (hashDict->getWordCount (APPLES), 3);
+        TEST_ASSERT_EQUAL (hashDict->getWordCount (PEARS), 4);
+        TEST_ASSERT_EQUAL (hashDict->getWordCount ("cherries", 6), 7);
+        TEST_ASSERT_EQUAL (hashDict->getWordCount (CHERRIES), -1);
+        TEST_ASSERT_TRUE (hashDict->hasWord ("cherri"));
+        TEST_ASSERT_EQUAL (hashDict->size (), 3);
+        /* Only the map backend has a std::map */
+        TEST_ASSERT_NULL (hashDict->getMap ());
+
+        hashDict->begin ();
+        do
+        {
+            hashDict->getNextWord (word, &count);
+            if (word != "")
+            {
+                seen++;
+            }
+        }
+        while (word != "");
+        TEST_ASSERT_EQUAL (seen, 3);
+
+        /* Backends can be mixed when merging */
+        mapDict->merge (*hashDict);
+        TEST_ASSERT_EQUAL (mapDict->getWordCount (PEARS), 4);
+        TEST_ASSERT_EQUAL (mapDict->getMap ()->size (), 3);
+
+        delete hashDict;
+        delete mapDict;
     }
-    _mut_init = FALSE;
+    void wordDictTopX (void)
+    {
+        static const int NUM_WORDS = 1000;
+        static const int TOP_X = 5;
+        Word_Dict *myDictionary = new Word_Dict (8, TRUE, DICT_BACKEND_HASH);
+        vector < Dict_Entry_t > top_list;
+        char word[32];
+        int idx = 0;
+        int len = 0;
 
-}
+        for (idx = 0; idx < NUM_WORDS; idx++)
+        {
+            len = snprintf (word, sizeof (word), "w%d", idx);
+            myDictionary->addOrIncrement (word, len, wordHash (word, len),
+                                          idx % 500);
+        }
 
-/**
- *******************************************************************************
- * @brief _lock - Class private lock method, for class access
- *******************************************************************************
- */
-void Word_Dict::_lock (void)
-{
-    int stat = STATUS_SUCCESS;
+        /*
+         * Each count 499..497 is shared by two words, ties go in word order
+         */
+        myDictionary->selectTopX (TOP_X, top_list, 3);
+        TEST_ASSERT_EQUAL (top_list.size (), TOP_X);
+        TEST_ASSERT_EQUAL (top_list[0].count, 499);
+        TEST_ASSERT_EQUAL (strncmp (top_list[0].word, "w499", 4), 0);
+        TEST_ASSERT_EQUAL (top_list[1].count, 499);
+        TEST_ASSERT_EQUAL (strncmp (top_list[1].word, "w999", 4), 0);
+        TEST_ASSERT_EQUAL (top_list[2].count, 498);
+        TEST_ASSERT_EQUAL (top_list[4].count, 497);
+
+        /* Thread count doesn't change the answer */
+        for (idx = 1; idx <= 16; idx *= 2)
+        {
+            vector < Dict_Entry_t > other;
 
-    stat = pthread_mutex_lock (&_mut);
-    if (stat == STATUS_SUCCESS)
+            myDictionary->selectTopX (TOP_X, other, idx);
+            TEST_ASSERT_EQUAL (other.size (), TOP_X);
+            TEST_ASSERT_EQUAL (other[1].word, top_list[1].word);
+            TEST_ASSERT_EQUAL (other[4].word, top_list[4].word);
+        }
+
+        delete myDictionary;
+    }
+    void wordDictTopXAll (void)
     {
-        _is_locked = TRUE;
+        Word_Dict *myDictionary = new Word_Dict (3);
+        vector < Dict_Entry_t > top_list;
+        size_t idx = 0;
+
+        myDictionary->addOrIncrement (APPLES, 2);
+        myDictionary->addOrIncrement (ORANGES, 9);
+        myDictionary->addOrIncrement (PEARS, 2);
+        myDictionary->addOrIncrement (CHERRIES, 4);
+
+        /* -1 and anything past the end both mean every word */
+        myDictionary->selectTopX (-1, top_list, 2);
+        TEST_ASSERT_EQUAL (top_list.size (), 4);
+        myDictionary->selectTopX (100, top_list, 2);
+        TEST_ASSERT_EQUAL (top_list.size (), 4);
+        for (idx = 1; idx < top_list.size (); idx++)
+        {
+            TEST_ASSERT_TRUE (top_list[idx - 1].count >= top_list[idx].count);
+        }
+        TEST_ASSERT_EQUAL_STRING ("oranges", top_list[0].word);
+        TEST_ASSERT_EQUAL_STRING ("apples", top_list[2].word);
+        TEST_ASSERT_EQUAL_STRING ("pears", top_list[3].word);
+
+        myDictionary->selectTopX (0, top_list);
+        TEST_ASSERT_EQUAL (top_list.size (), 0);
+
+        delete myDictionary;
     }
-}
+    void wordDictLeaderboard (void)
+    {
+        Word_Dict *myDictionary = new Word_Dict (4);
+        vector < pair < string, int > >leaders;
+        string batch[] = { CHERRIES, PEARS, CHERRIES, PEARS };
+        int idx = 0;
 
-/**
- *******************************************************************************
- * @brief lock - Public lock method.
- *******************************************************************************
- */
-void Word_Dict::lock (void)
-{
-    _lock ();
-}
+        myDictionary->enableLeaderboard (2);
+        TEST_ASSERT_EQUAL (myDictionary->getLeaderboard (leaders), 0);
 
-/**
- *******************************************************************************
- * @brief _unlock - Class private unlock method, for class access
- *******************************************************************************
- */
-void Word_Dict::_unlock (void)
-{
-    int stat = STATUS_SUCCESS;
+        myDictionary->addOrIncrement (APPLES, 3);
+        myDictionary->insertWord (ORANGES, 5);
+        myDictionary->addOrIncrement (PEARS, 1);
+        TEST_ASSERT_EQUAL (myDictionary->getLeaderboard (leaders), 2);
+        TEST_ASSERT_EQUAL_STRING ("oranges", leaders[0].first.c_str ());
+        TEST_ASSERT_EQUAL (leaders[0].second, 5);
+        TEST_ASSERT_EQUAL_STRING ("apples", leaders[1].first.c_str ());
+
+        /*
+         * pears climbs past apples one increment at a time, then a batch
+         * pushes cherries past oranges, and pears past both
+         */
+        for (idx = 0; idx < 3; idx++)
+        {
+            myDictionary->incrementWordCount (PEARS);
+        }
+        myDictionary->getLeaderboard (leaders);
+        TEST_ASSERT_EQUAL_STRING ("oranges", leaders[0].first.c_str ());
+        TEST_ASSERT_EQUAL_STRING ("pears", leaders[1].first.c_str ());
+        TEST_ASSERT_EQUAL (leaders[1].second, 4);
+
+        myDictionary->addOrIncrement (CHERRIES, 3);
+        myDictionary->addOrIncrement (batch, 4);
+        myDictionary->getLeaderboard (leaders);
+        TEST_ASSERT_EQUAL (leaders.size (), 2);
+        TEST_ASSERT_EQUAL_STRING ("pears", leaders[0].first.c_str ());
+        TEST_ASSERT_EQUAL (leaders[0].second, 6);
+        TEST_ASSERT_EQUAL_STRING ("cherries", leaders[1].first.c_str ());
+        TEST_ASSERT_EQUAL (leaders[1].second, 5);
+
+        myDictionary->clear ();
+        TEST_ASSERT_EQUAL (myDictionary->getLeaderboard (leaders), 0);
 
-    stat = pthread_mutex_unlock (&_mut);
-    if (stat == STATUS_SUCCESS)
-    {
-        _is_locked = FALSE;
+        delete myDictionary;
     }
-}
+    void wordDictLeaderboardSeed (void)
+    {
+        Word_Dict *myDictionary = new Word_Dict (3, TRUE, DICT_BACKEND_HASH);
+        Word_Dict *other = new Word_Dict (2, FALSE);
+        vector < pair < string, int > >leaders;
+        vector < Dict_Entry_t > top_list;
+        char word[32];
+        int idx = 0;
+        int len = 0;
 
-/**
- *******************************************************************************
- * @brief unlock - Public unlock method.
- *******************************************************************************
- */
-void Word_Dict::unlock (void)
-{
-    _unlock ();
-}
+        /*
+         * Enabling on a populated dictionary seeds the board, and later
+         * merges keep it in step with a full top X scan
+         */
+        for (idx = 0; idx < 200; idx++)
+        {
+            len = snprintf (word, sizeof (word), "w%d", idx);
+            myDictionary->addOrIncrement (word, len, wordHash (word, len),
+                                          idx % 37);
+            other->addOrIncrement (word, len, wordHash (word, len), idx % 11);
+        }
+        myDictionary->enableLeaderboard (4);
+        myDictionary->getLeaderboard (leaders);
+        myDictionary->selectTopX (4, top_list);
+        TEST_ASSERT_EQUAL (leaders.size (), 4);
+        for (idx = 0; idx < 4; idx++)
+        {
+            TEST_ASSERT_EQUAL (leaders[idx].second, top_list[idx].count);
+        }
 
-/**
- *******************************************************************************
- * @brief insertWord - Insert a word and word count pair into the dictionary.
- *
- * <!-- Parameters -->
- *      @param[in]      word           String representation of word for
- *                                     dictionary.
- *      @param[in]      count          Initial word count for 'word'
- *
- * <!-- Returns -->
- *      None (if return type is void)
- *
- * @par Pre/Post Conditions:
- *      None (if entry/exit conditions do not apply)
- *
- * @par Global Data:
- *      None (if no global data)
- *
- * @par Description:
- *      Using the class access lock, insert the word and word count pair into
- *      the dictionary.
- *******************************************************************************
- */
-void Word_Dict::insertWord (string word, int count)
-{
-    _lock ();
-    _dictionaryMap.insert (pair < string, int >(word, count));
+        myDictionary->merge (*other);
+        myDictionary->getLeaderboard (leaders);
+        myDictionary->selectTopX (4, top_list);
+        for (idx = 0; idx < 4; idx++)
+        {
+            TEST_ASSERT_EQUAL (leaders[idx].second, top_list[idx].count);
+            TEST_ASSERT_EQUAL (strncmp (leaders[idx].first.c_str (),
+                                        top_list[idx].word,
+                                        top_list[idx].len), 0);
+        }
 
-    _unlock ();
-}
+        delete myDictionary;
+        delete other;
+    }
+    void wordDictApproximate (void)
+    {
+        static const int NUM_DICTS = 3;
+        Word_Dict *dicts[NUM_DICTS];
+        Word_Dict *exact = new Word_Dict (2, FALSE);
+        Word_Dict *merged = NULL;
+        vector < Dict_Entry_t > top_list;
+        int idx = 0;
 
-/**
- *******************************************************************************
- * @brief begin - Set the Word_Dict instance iterator to the beginning of the
- * dictionary.
- *******************************************************************************
- */
-void Word_Dict::begin (void)
-{
-    _lock ();
-    _it = _dictionaryMap.begin ();
-    _unlock ();
-}
+        for (idx = 0; idx < NUM_DICTS; idx++)
+        {
+            dicts[idx] = new Word_Dict (2, FALSE);
+            dicts[idx]->enableApproximate (2048, 4, 3);
+            TEST_ASSERT_TRUE (dicts[idx]->isApproximate ());
+            dicts[idx]->addOrIncrement (APPLES, 10);
+            dicts[idx]->insertWord (word1, 1);
+        }
+        dicts[1]->incrementWordCount (APPLES);
+        dicts[2]->incrementWordCount (PEARS);   /* not there, no effect */
+        TEST_ASSERT_EQUAL (dicts[2]->getWordCount (PEARS), -1);
+
+        /*
+         * Exact counts fold into an approximate dictionary, and approximate
+         * ones combine sketch to sketch
+         */
+        exact->addOrIncrement (ORANGES, 7);
+        exact->addOrIncrement (APPLES, 4);
+        dicts[0]->merge (*exact);
+        merged = mergeDictionaries (dicts, NUM_DICTS);
+
+        TEST_ASSERT_TRUE (merged->getWordCount (APPLES) >= 35);
+        TEST_ASSERT_TRUE (merged->getWordCount (ORANGES) >= 7);
+        TEST_ASSERT_TRUE (merged->getWordCount (word1) >= 3);
+        TEST_ASSERT_EQUAL (merged->getApproxCounter ()->total (), 45);
+        TEST_ASSERT_EQUAL (merged->size (), 3);
+
+        merged->selectTopX (2, top_list);
+        TEST_ASSERT_EQUAL (top_list.size (), 2);
+        TEST_ASSERT_EQUAL_STRING ("apples", top_list[0].word);
+        TEST_ASSERT_EQUAL_STRING ("oranges", top_list[1].word);
+
+        /* Shards are never used in approximate mode */
+        TEST_ASSERT_EQUAL (merged->getMap (0)->size (), 0);
+
+        for (idx = 0; idx < NUM_DICTS; idx++)
+        {
+            delete dicts[idx];
+        }
+        delete exact;
+    }
+    void wordDictSnapshot (void)
+    {
+        Word_Dict *myDictionary = new Word_Dict (4);
+        Dict_Snapshot *before = NULL;
+        Dict_Snapshot *again = NULL;
+        Dict_Snapshot *after = NULL;
+        string batch[] = { APPLES, ORANGES, CHERRIES, PEARS, APPLES };
+        Dict_Entry_t entry;
+        unsigned int apples_shard = 0;
+        unsigned int idx = 0;
+        int total = 0;
+
+        myDictionary->addOrIncrement (batch, 5);
+        before = myDictionary->snapshot ();
+        again = myDictionary->snapshot ();
+        TEST_ASSERT_EQUAL (before->getNumShards (), 4);
+        TEST_ASSERT_EQUAL (before->size (), 4);
+
+        /* Nothing changed in between, so every shard copy is shared */
+        for (idx = 0; idx < 4; idx++)
+        {
+            TEST_ASSERT_TRUE (before->getShardView (idx) ==
+                              again->getShardView (idx));
+        }
 
-/**
- *******************************************************************************
- * @brief end - Set the Word_Dict instance iterator to the end of the
- * dictionary.
- *******************************************************************************
- */
-void Word_Dict::end (void)
-{
-    _lock ();
-    _it = _dictionaryMap.begin ();
-    _unlock ();
-}
+        /*
+         * Only the written shard is copied again
+         */
+        myDictionary->addOrIncrement (APPLES, 10);
+        after = myDictionary->snapshot ();
+        apples_shard = wordHashRange (wordHash (APPLES, strlen (APPLES)), 4);
+        for (idx = 0; idx < 4; idx++)
+        {
+            TEST_ASSERT_EQUAL (idx == apples_shard,
+                               before->getShardView (idx) !=
+                               after->getShardView (idx));
+        }
+        TEST_ASSERT_EQUAL (before->getWordCount (APPLES, strlen (APPLES)), 2);
+        TEST_ASSERT_EQUAL (after->getWordCount (APPLES, strlen (APPLES)), 12);
+        TEST_ASSERT_EQUAL (after->getWordCount (word1, strlen (word1)), 0);
 
-/**
- *******************************************************************************
- * @brief getNextWord - Using the in-class instance iterator, get the next word
- * and its count.
- *
- * <!-- Parameters -->
- *      @param[in,out]  word           reference to string in which to put the
+        /*
+         * Independent cursors, interleaved, and both outlive the dictionary
+         */
+        delete myDictionary;
+        before->begin ();
+        after->begin ();
+        while (before->getNextEntry (&entry) == TRUE)
+        {
+            total += entry.count;
+            TEST_ASSERT_TRUE (after->getNextEntry (&entry));
+            total += entry.count;
+        }
+        TEST_ASSERT_FALSE (after->getNextEntry (&entry));
+        TEST_ASSERT_EQUAL (total, 5 + 15);
+
+        delete before;
+        delete again;
+        delete after;
+    }
+    void wordDictSnapshotThreads (void)
+    {
+        static const int NUM_THREADS = 2;
+        Word_Dict *myDictionary = new Word_Dict (4);
+        pthread_t writers[NUM_THREADS];
+        pthread_t readers[NUM_THREADS];
+        void *failures = NULL;
+        int idx = 0;
+
+        for (idx = 0; idx < NUM_THREADS; idx++)
+        {
+            TEST_ASSERT_EQUAL (pthread_create (&writers[idx], NULL,
+                                               upsertThread,
+                                               (void *) myDictionary), 0);
+            TEST_ASSERT_EQUAL (pthread_create (&readers[idx], NULL,
+                                               snapshotReaderThread,
+                                               (void *) myDictionary), 0);
+        }
+        for (idx = 0; idx < NUM_THREADS; idx++)
+        {
+            pthread_join (writers[idx], NULL);
+            pthread_join (readers[idx], &failures);
+            TEST_ASSERT_NULL (failures);
+        }
+        TEST_ASSERT_EQUAL (myDictionary->getWordCount (APPLES),
+                           NUM_THREADS * SHARD_TEST_LOOPS);
+
+        delete myDictionary;
+    }
+    void wordDictPrefixTopX (void)
+    {
+        static const Dict_Backend_t BACKENDS[] = { DICT_BACKEND_MAP,
+            DICT_BACKEND_HASH, DICT_BACKEND_RADIX
+        };
+        Word_Dict *dicts[3];
+        vector < Dict_Entry_t > top_lists[3];
+        char word[32];
+        int backend = 0;
+        int idx = 0;
+        int len = 0;
+
+        for (backend = 0; backend < 3; backend++)
+        {
+            dicts[backend] = new Word_Dict (4, TRUE, BACKENDS[backend]);
+            for (idx = 0; idx < 2000; idx++)
+            {
+                len = snprintf (word, sizeof (word), "pre%d", idx);
+                dicts[backend]->addOrIncrement (word, len,
+                                                wordHash (word, len),
+                                                (idx % 13) + 1);
+            }
+            dicts[backend]->insertWord ("pre", 40);
+            dicts[backend]->incrementWordCount ("pre77");
+            dicts[backend]->addOrIncrement ("prefix", 6,
+                                            wordHash ("prefix", 6), 30);
+        }
+        TEST_ASSERT_EQUAL (dicts[2]->getBackend (), DICT_BACKEND_RADIX);
+
+        /* Every backend gives the same answer, ties in word order */
+        for (backend = 0; backend < 3; backend++)
+        {
+            dicts[backend]->selectPrefixTopX ("pre1", 4, 5,
+                                              top_lists[backend]);
+            TEST_ASSERT_EQUAL (top_lists[backend].size (), 5);
+            TEST_ASSERT_EQUAL (top_lists[backend][0].count, 13);
+            TEST_ASSERT_EQUAL (top_lists[backend][0].len, 7);
+            TEST_ASSERT_EQUAL (memcmp (top_lists[backend][0].word,
+                                       "pre1000", 7), 0);
+            TEST_ASSERT_EQUAL (top_lists[backend][3].len, 6);
+            TEST_ASSERT_EQUAL (memcmp (top_lists[backend][3].word,
+                                       "pre103", 6), 0);
+
+            dicts[backend]->selectPrefixTopX ("pre", 3, 3,
+                                              top_lists[backend]);
+            TEST_ASSERT_EQUAL (top_lists[backend][0].count, 40);
+            TEST_ASSERT_EQUAL (top_lists[backend][1].count, 30);
+            TEST_ASSERT_EQUAL (top_lists[backend][2].count, 14);
+
+            dicts[backend]->selectPrefixTopX ("pre77", 5, -1,
+                                              top_lists[backend]);
+            TEST_ASSERT_EQUAL (top_lists[backend].size (), 11);
+            TEST_ASSERT_EQUAL (top_lists[backend][0].count, 14);
+            TEST_ASSERT_EQUAL (memcmp (top_lists[backend][0].word,
+                                       "pre77", 5), 0);
+
+            dicts[backend]->selectPrefixTopX ("post", 4, 5,
+                                              top_lists[backend]);
+            TEST_ASSERT_EQUAL (top_lists[backend].size (), 0);
+        }
+
+        for (backend = 0; backend < 3; backend++)
+        {
+            delete dicts[backend];
+        }
+    }
+    void wordDictMemoryUsage (void)
+    {
+        static const int NUM_WORDS = 2000;
+        Dict_Backend_t backends[3] =
+            { DICT_BACKEND_MAP, DICT_BACKEND_HASH, DICT_BACKEND_RADIX };
+        Word_Dict *dict = NULL;
+        Dict_Snapshot *snap = NULL;
+        Mem_Stats_t empty_stats;
+        Mem_Stats_t stats;
+        char word[64];
+        int backend = 0;
+        int idx = 0;
+        int len = 0;
+
+        for (backend = 0; backend < 3; backend++)
+        {
+            dict = new Word_Dict (4, TRUE, backends[backend]);
+            memStatsClear (&empty_stats);
+            dict->memoryUsage (&empty_stats);
+            TEST_ASSERT_TRUE (memStatsTotal (&empty_stats) > 0);
+
+            /*
+             * Half of the words too long for a short string
+             */
+            for (idx = 0; idx < NUM_WORDS; idx++)
+            {
+                len = snprintf (word, sizeof (word), (idx % 2) ?
+                                "mem%d" : "memory_accounting_%d", idx);
+                dict->addOrIncrement (word, len, wordHash (word, len));
+            }
+            memStatsClear (&stats);
+            dict->memoryUsage (&stats);
+            TEST_ASSERT_TRUE (stats.bytes[MEM_INDEX] >
+                              empty_stats.bytes[MEM_INDEX] + NUM_WORDS * 8);
+            if (backends[backend] == DICT_BACKEND_MAP)
+            {
+                TEST_ASSERT_TRUE (stats.bytes[MEM_KEYS] >=
+                                  (NUM_WORDS / 2) * 19);
+            }
+            else
+            {
+                TEST_ASSERT_TRUE (stats.bytes[MEM_ARENA] >=
+                                  (NUM_WORDS / 2) * 19);
+            }
+            TEST_ASSERT_EQUAL (stats.bytes[MEM_SNAPSHOTS], 0);
+            TEST_ASSERT_EQUAL (stats.bytes[MEM_SKETCHES], 0);
+
+            /*
+             * Shard views cached for snapshots are counted until the shards
+             * change again
+             */
+            snap = dict->snapshot ();
+            memStatsClear (&stats);
+            dict->memoryUsage (&stats);
+            TEST_ASSERT_TRUE (stats.bytes[MEM_SNAPSHOTS] > NUM_WORDS * 8);
+            delete snap;
+
+            dict->clear ();
+            memStatsClear (&stats);
+            dict->memoryUsage (&stats);
+            TEST_ASSERT_TRUE (memStatsTotal (&stats) <=
+                              memStatsTotal (&empty_stats));
+
+            delete dict;
+        }
+    }
+    void wordDictMemoryLimit (void)
+    {
+        static const int NUM_HOT = 20;
+        static const int HOT_COUNT = 50;
+        static const int NUM_COLD = 20000;
+        Dict_Backend_t backends[2] = { DICT_BACKEND_HASH, DICT_BACKEND_MAP };
+        Mem_Policy_t policies[2] = { MEM_POLICY_PRUNE, MEM_POLICY_APPROX };
+        Word_Dict *dict = NULL;
+        Mem_Stats_t stats;
+        size_t used = 0;
+        char word[32];
+        int pass = 0;
+        int idx = 0;
+        int len = 0;
+
+        for (pass = 0; pass < 2; pass++)
+        {
+            dict = new Word_Dict (4, TRUE, backends[pass]);
+            for (idx = 0; idx < NUM_HOT; idx++)
+            {
+                len = snprintf (word, sizeof (word), "hot%d", idx);
+                dict->addOrIncrement (word, len, wordHash (word, len),
+                                      HOT_COUNT);
+            }
+            for (idx = 0; idx < NUM_COLD; idx++)
+            {
+                len = snprintf (word, sizeof (word), "cold%d", idx);
+                dict->addOrIncrement (word, len, wordHash (word, len));
+            }
+            memStatsClear (&stats);
+            dict->memoryUsage (&stats);
+            used = memStatsTotal (&stats);
+
+            /*
+             * No limit, or comfortably under it, changes nothing
+             */
+            TEST_ASSERT_TRUE (dict->checkMemoryLimit () == FALSE);
+            dict->setMemoryLimit (used * 2, policies[pass]);
+            TEST_ASSERT_TRUE (dict->checkMemoryLimit () == FALSE);
+            TEST_ASSERT_EQUAL (dict->size (), NUM_HOT + NUM_COLD);
+
+            /*
+             * The policy is applied short of the limit itself
+             */
+            dict->setMemoryLimit (used + used / 20, policies[pass]);
+            TEST_ASSERT_TRUE (dict->checkMemoryLimit () == TRUE);
+            memStatsClear (&stats);
+            dict->memoryUsage (&stats);
+            TEST_ASSERT_TRUE (memStatsTotal (&stats) < used);
+            TEST_ASSERT_TRUE (dict->checkMemoryLimit () == FALSE);
+
+            if (policies[pass] == MEM_POLICY_PRUNE)
+            {
+                /* Every word seen once goes, the rest keep exact counts */
+                TEST_ASSERT_TRUE (dict->isApproximate () == FALSE);
+                TEST_ASSERT_EQUAL (dict->size (), NUM_HOT);
+                TEST_ASSERT_EQUAL (dict->getPrunedWords (), NUM_COLD);
+                TEST_ASSERT_EQUAL (dict->getPruneFloor (), 2);
+                TEST_ASSERT_EQUAL (dict->getWordCount ((char *) "hot7"),
+                                   HOT_COUNT);
+                TEST_ASSERT_EQUAL (dict->getWordCount ((char *) "cold7"), -1);
+            }
+            else
+            {
+                /* Counts carry over into the sketch, and counting goes on */
+                TEST_ASSERT_TRUE (dict->isApproximate () == TRUE);
+                TEST_ASSERT_EQUAL (dict->getPrunedWords (), 0);
+                TEST_ASSERT_TRUE (dict->getWordCount ((char *) "hot7") >=
+                                  HOT_COUNT);
+                TEST_ASSERT_TRUE (dict->addOrIncrement (string ("hot7")) >
+                                  HOT_COUNT);
+                TEST_ASSERT_TRUE (stats.bytes[MEM_SKETCHES] > 0);
+            }
+
+            delete dict;
+        }
+    }
+    void wordDictSwitchThreads (void)
+    {
+        static const int NUM_THREADS = 2;
+        static const int NUM_COLD = 50000;
+        Word_Dict *myDictionary = new Word_Dict (4);
+        pthread_t writers[NUM_THREADS];
+        pthread_t readers[NUM_THREADS];
+        void *failures = NULL;
+        char word[32];
+        int idx = 0;
+        int len = 0;
+
+        /* Enough words that the switch takes a while */
+        myDictionary->enableLeaderboard (3);
+        for (idx = 0; idx < NUM_COLD; idx++)
+        {
+            len = snprintf (word, sizeof (word), "cold%d", idx);
+            myDictionary->addOrIncrement (word, len, wordHash (word, len));
+        }
+        for (idx = 0; idx < NUM_THREADS; idx++)
+        {
+            TEST_ASSERT_EQUAL (pthread_create (&writers[idx], NULL,
+                                               upsertThread,
+                                               (void *) myDictionary), 0);
+            TEST_ASSERT_EQUAL (pthread_create (&readers[idx], NULL,
+                                               leaderboardReaderThread,
+                                               (void *) myDictionary), 0);
+        }
+
+        /*
+         * Switch while the writers and readers are going, no count is lost
+         */
+        while (myDictionary->getWordCount (APPLES) < SHARD_TEST_LOOPS / 4)
+        {
+            sched_yield ();
+        }
+        myDictionary->switchToApproximate (1024);
+        TEST_ASSERT_TRUE (myDictionary->isApproximate () == TRUE);
+        for (idx = 0; idx < NUM_THREADS; idx++)
+        {
+            pthread_join (writers[idx], NULL);
+            pthread_join (readers[idx], &failures);
+            TEST_ASSERT_NULL (failures);
+        }
+        TEST_ASSERT_TRUE (myDictionary->getWordCount (APPLES) >=
+                          NUM_THREADS * SHARD_TEST_LOOPS);
+        TEST_ASSERT_TRUE (myDictionary->getWordCount (PEARS) >=
+                          NUM_THREADS * SHARD_TEST_LOOPS);
+        TEST_ASSERT_EQUAL (myDictionary->getApproxCounter ()->total (),
+                           NUM_COLD + 2 * NUM_THREADS * SHARD_TEST_LOOPS);
+
+        delete myDictionary;
+    }
+    void wordDictSpill (void)
+    {
+        static const int NUM_ROUNDS = 3;
+        static const int NUM_WORDS = 3000;
+        Word_Dict *dict = new Word_Dict (4, TRUE, DICT_BACKEND_HASH);
+        Word_Dict *reference = new Word_Dict (4, TRUE, DICT_BACKEND_MAP);
+        Word_Dict *merged = new Word_Dict (2);
+        vector < Dict_Entry_t > got;
+        vector < Dict_Entry_t > want;
+        Mem_Stats_t stats;
+        size_t used = 0;
+        char word[32];
+        int round = 0;
+        int idx = 0;
+        int len = 0;
+
+        /*
+         * Each round counts an overlapping set of words, then spills them,
+         * the last round stays in memory
+         */
+        for (round = 0; round < NUM_ROUNDS; round++)
+        {
+            for (idx = 0; idx < NUM_WORDS; idx++)
+            {
+                len = snprintf (word, sizeof (word), "word%d",
+                                (idx * 7 + round * 1000) % (2 * NUM_WORDS));
+                dict->addOrIncrement (word, len, wordHash (word, len),
+                                      idx % 13 + 1);
+                reference->addOrIncrement (word, len, wordHash (word, len),
+                                           idx % 13 + 1);
+            }
+            if (round == 0)
+            {
+                memStatsClear (&stats);
+                dict->memoryUsage (&stats);
+                used = memStatsTotal (&stats);
+                dict->setMemoryLimit (used, MEM_POLICY_SPILL);
+                TEST_ASSERT_TRUE (dict->checkMemoryLimit () == TRUE);
+                memStatsClear (&stats);
+                dict->memoryUsage (&stats);
+                TEST_ASSERT_TRUE (memStatsTotal (&stats) < used / 2);
+                dict->setMemoryLimit (0, MEM_POLICY_NONE);
+            }
+            else if (round < NUM_ROUNDS - 1)
+            {
+                TEST_ASSERT_TRUE (dict->spill () == TRUE);
+            }
+        }
+        TEST_ASSERT_EQUAL (dict->getSpilledRuns (), NUM_ROUNDS - 1);
+        TEST_ASSERT_TRUE (dict->getSpilledBytes () > 0);
+        TEST_ASSERT_TRUE (dict->isApproximate () == FALSE);
+
+        /*
+         * Every answer is exact, as if nothing had been spilled
+         */
+        TEST_ASSERT_EQUAL (dict->size (), reference->size ());
+        dict->selectTopX (-1, got);
+        reference->selectTopX (-1, want);
+        TEST_ASSERT_EQUAL (got.size (), want.size ());
+        for (idx = 0; idx < (int) want.size (); idx++)
+        {
+            TEST_ASSERT_EQUAL (got[idx].count, want[idx].count);
+            TEST_ASSERT_EQUAL (got[idx].len, want[idx].len);
+            TEST_ASSERT_EQUAL (memcmp (got[idx].word, want[idx].word,
+                                       want[idx].len), 0);
+            TEST_ASSERT_EQUAL (got[idx].hash, want[idx].hash);
+        }
+        dict->selectPrefixTopX ("word12", 6, 5, got);
+        reference->selectPrefixTopX ("word12", 6, 5, want);
+        TEST_ASSERT_EQUAL (got.size (), 5);
+        for (idx = 0; idx < (int) want.size (); idx++)
+        {
+            TEST_ASSERT_EQUAL (got[idx].count, want[idx].count);
+            TEST_ASSERT_EQUAL (memcmp (got[idx].word, want[idx].word,
+                                       want[idx].len), 0);
+        }
+        TEST_ASSERT_EQUAL (dict->getWordCount ((char *) "word1000"),
+                           reference->getWordCount ((char *) "word1000"));
+        TEST_ASSERT_EQUAL (dict->getWordCount ((char *) "word7"),
+                           reference->getWordCount ((char *) "word7"));
+        TEST_ASSERT_EQUAL (dict->getWordCount ((char *) "nosuchword"), -1);
+
+        /*
+         * Merging streams the runs into a dictionary which never spilled
+         */
+        merged->merge (*dict);
+        merged->selectTopX (10, got);
+        reference->selectTopX (10, want);
+        for (idx = 0; idx < (int) want.size (); idx++)
+        {
+            TEST_ASSERT_EQUAL (got[idx].count, want[idx].count);
+            TEST_ASSERT_EQUAL (memcmp (got[idx].word, want[idx].word,
+                                       want[idx].len), 0);
+        }
+        TEST_ASSERT_EQUAL (merged->size (), reference->size ());
+
+        dict->clear ();
+        TEST_ASSERT_EQUAL (dict->getSpilledRuns (), 0);
+        TEST_ASSERT_EQUAL (dict->size (), 0);
+
+        delete merged;
+        delete reference;
+        delete dict;
+    }
+}
+#endif /* defined(TEST) */
+
+/**
+ *******************************************************************************
+ * @brief Word_Dict - Constructor
+ *
+ * <!-- Parameters -->
+ *      @param[in]      num_shards     Number of independently locked shards to
+ *                                     split the dictionary into.  One shard
+ *                                     gives the original single-lock behavior.
+ *      @param[in]      thread_safe    If FALSE, the shard locks are skipped
+ *                                     entirely.  Only for dictionaries owned
+ *                                     by a single thread.
+ *      @param[in]      backend        Storage used by every shard.  The
+ *                                     default, DICT_BACKEND_MAP, is the
+ *                                     original std::map, whose keys are not
+ *                                     interned; only the hash and radix
+ *                                     backends keep their keys in a
+ *                                     Key_Arena.  ssfi uses the hash backend
+ *                                     unless -d says otherwise.
+ *
+ * @par Description:
+ *      Out of range shard counts are clamped to [1, WORD_DICT_MAX_SHARDS].
+ *******************************************************************************
+ */
+Word_Dict::Word_Dict (unsigned int num_shards, Bool_t thread_safe,
+                      Dict_Backend_t backend)
+{
+    int stat = 0;
+    unsigned int idx = 0;
+
+    _mut_init = FALSE;
+    _is_locked = FALSE;
+    _threadSafe = thread_safe;
+    _backend = backend;
+    _showDebugOutput = FALSE;
+    _leaderboardSize = 0;
+    _approx = NULL;
+    _memLimit = 0;
+    _memPolicy = MEM_POLICY_NONE;
+    _prunedWords = 0;
+    _pruneFloor = 0;
+    _spill = NULL;
+
+    if (num_shards < 1)
+    {
+        num_shards = 1;
+    }
+    else if (num_shards > WORD_DICT_MAX_SHARDS)
+    {
+        num_shards = WORD_DICT_MAX_SHARDS;
+    }
+    _numShards = num_shards;
+    _shards = new Dict_Shard_t[_numShards];
+    for (idx = 0; idx < _numShards; idx++)
+    {
+        _shards[idx].store = newDictStore (_backend);
+        _shards[idx].leaderMin = 0;
+        _shards[idx].view = NULL;
+    }
+
+    stat = pthread_mutex_init (&_mut, NULL);
+    EXIT_EARLY_ON_ERROR (stat);
+    stat = pthread_mutex_init (&_memMut, NULL);
+    EXIT_EARLY_ON_ERROR (stat);
+    for (idx = 0; idx < _numShards; idx++)
+    {
+        stat = pthread_mutex_init (&_shards[idx].mut, NULL);
+        EXIT_EARLY_ON_ERROR (stat);
+    }
+    _mut_init = TRUE;
+    _itShard = 0;
+    _itDone = FALSE;
+    _shards[0].store->rewind ();
+
+  cleanup:
+    return;
+
+  error:
+    goto cleanup;
+}
+
+/**
+ *******************************************************************************
+ * @brief ~Word_Dict - Destructor
+ *******************************************************************************
+ */
+Word_Dict::~Word_Dict (void)
+{
+    int stat = 0;
+    unsigned int idx = 0;
+    Bool_t had_entries = FALSE;
+
+    DBG (printf ("[%s:%d] deleting myDictionary\n", __FILE__, __LINE__));
+
+
+    _lock ();
+    for (idx = 0; idx < _numShards; idx++)
+    {
+        if (_shards[idx].store->size () > 0)
+        {
+            DBG (printf
+                 ("[%s:%d] Erasing any existing map entries\n", __FILE__,
+                  __LINE__));
+            had_entries = TRUE;
+        }
+        delete _shards[idx].store;
+        _shards[idx].store = NULL;
+        _touchShard (idx);
+    }
+    if (had_entries == FALSE)
+    {
+        DBG (printf ("[%s:%d] No map entries to erase\n", __FILE__,
+                     __LINE__));
+    }
+    _unlock ();
+
+
+    DBG (printf ("[%s:%d] Destroying mutex\n", __FILE__, __LINE__));
+    for (idx = 0; idx < _numShards; idx++)
+    {
+        stat = pthread_mutex_destroy (&_shards[idx].mut);
+        if (stat != 0)
+        {
+            fprintf (stderr, "[%s, %d:%s] failed, stat=%d, errno=%d, %s\n",
+                     __FILE__, __LINE__, __FUNCTION__, stat, errno,
+                     strerror (errno));
+        }
+    }
+    stat = pthread_mutex_destroy (&_mut);
+    if (stat != 0)
+    {
+        fprintf (stderr, "[%s, %d:%s] failed, stat=%d, errno=%d, %s\n",
+                 __FILE__, __LINE__, __FUNCTION__, stat, errno,
+                 strerror (errno));
+    }
+    stat = pthread_mutex_destroy (&_memMut);
+    if (stat != 0)
+    {
+        fprintf (stderr, "[%s, %d:%s] failed, stat=%d, errno=%d, %s\n",
+                 __FILE__, __LINE__, __FUNCTION__, stat, errno,
+                 strerror (errno));
+    }
+    _mut_init = FALSE;
+
+    delete[]_shards;
+    _shards = NULL;
+    delete _approx;
+    _approx = NULL;
+    delete _spill;
+    _spill = NULL;
+    _shards = NULL;
+}
+
+/**
+ *******************************************************************************
+ * @brief _lock - Class private lock method, locks the whole dictionary.
+ *
+ * @par Description:
+ *      Takes the instance mutex and then every shard mutex in index order.  All
+ *      multi-shard locking goes through here so the order is always the same.
+ *******************************************************************************
+ */
+void Word_Dict::_lock (void)
+{
+    int stat = STATUS_SUCCESS;
+    unsigned int idx = 0;
+
+    stat = pthread_mutex_lock (&_mut);
+    for (idx = 0; idx < _numShards; idx++)
+    {
+        _lockShard (idx);
+    }
+    if (stat == STATUS_SUCCESS)
+    {
+        _is_locked = TRUE;
+    }
+}
+
+/**
+ *******************************************************************************
+ * @brief lock - Public lock method.
+ *******************************************************************************
+ */
+void Word_Dict::lock (void)
+{
+    _lock ();
+}
+
+/**
+ *******************************************************************************
+ * @brief _unlock - Class private unlock method, unlocks the whole dictionary.
+ *******************************************************************************
+ */
+void Word_Dict::_unlock (void)
+{
+    int stat = STATUS_SUCCESS;
+    unsigned int idx = 0;
+
+    for (idx = _numShards; idx > 0; idx--)
+    {
+        _unlockShard (idx - 1);
+    }
+
+    /* Cleared while still held, the next locker sets it */
+    _is_locked = FALSE;
+    stat = pthread_mutex_unlock (&_mut);
+    if (stat != STATUS_SUCCESS)
+    {
+        _is_locked = TRUE;
+    }
+}
+
+/**
+ *******************************************************************************
+ * @brief unlock - Public unlock method.
+ *******************************************************************************
+ */
+void Word_Dict::unlock (void)
+{
+    _unlock ();
+}
+
+/**
+ *******************************************************************************
+ * @brief _lockShard - Class private lock method for a single shard.
+ *******************************************************************************
+ */
+void Word_Dict::_lockShard (unsigned int shard_idx)
+{
+    if (_threadSafe == TRUE)
+    {
+        (void) pthread_mutex_lock (&_shards[shard_idx].mut);
+    }
+}
+
+/**
+ *******************************************************************************
+ * @brief _unlockShard - Class private unlock method for a single shard.
+ *******************************************************************************
+ */
+void Word_Dict::_unlockShard (unsigned int shard_idx)
+{
+    if (_threadSafe == TRUE)
+    {
+        (void) pthread_mutex_unlock (&_shards[shard_idx].mut);
+    }
+}
+
+/**
+ *******************************************************************************
+ * @brief _lockApproxFrom - Trade the lock of a shard which found the
+ * dictionary counting approximately for the lock of the sketch.
+ *
+ * @par Description:
+ *      Called holding shard 'shard_idx', returns holding APPROX_SHARD.  The
+ *      first lock is let go before the second is taken, so shard locks are
+ *      still only ever taken one at a time or all in order by _lock().
+ *      _approx is never unset while threads are counting, so it is still
+ *      set once the sketch lock is held.
+ *******************************************************************************
+ */
+void Word_Dict::_lockApproxFrom (unsigned int shard_idx)
+{
+    if (shard_idx != APPROX_SHARD)
+    {
+        _unlockShard (shard_idx);
+        _lockShard (APPROX_SHARD);
+    }
+}
+
+/**
+ *******************************************************************************
+ * @brief _shardFor - Map a word hash to the index of the shard which owns it.
+ *
+ * @par Description:
+ *      Uses the high bits of the word hash (see wordHashRange()), while the
+ *      hash store indexes its slots with the low bits, so the two stay
+ *      independent.
+ *******************************************************************************
+ */
+unsigned int Word_Dict::_shardFor (Word_Hash_t hash)
+{
+    return (wordHashRange (hash, _numShards));
+}
+
+/**
+ *******************************************************************************
+ * @brief getMap - Direct access to the std::map behind a shard.
+ *
+ * <!-- Returns -->
+ *      @return the shard's map, or NULL unless the backend is
+ *      DICT_BACKEND_MAP: the other backends have no std::map, their keys are
+ *      interned in a Key_Arena.
+ *******************************************************************************
+ */
+map < string, int >*Word_Dict::getMap (unsigned int shard_idx)
+{
+    Map_Store *map_store =
+        dynamic_cast < Map_Store * >(_shards[shard_idx].store);
+
+    if (map_store == NULL)
+    {
+        return (NULL);
+    }
+    return (&map_store->getMap ());
+}
+
+/**
+ *******************************************************************************
+ * @brief insertWord - Insert a word and word count pair into the dictionary.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      word           String representation of word for
+ *                                     dictionary.
+ *      @param[in]      count          Initial word count for 'word'
+ *
+ * <!-- Returns -->
+ *      None (if return type is void)
+ *
+ * @par Pre/Post Conditions:
+ *      None (if entry/exit conditions do not apply)
+ *
+ * @par Global Data:
+ *      None (if no global data)
+ *
+ * @par Description:
+ *      Using the lock of the shard owning 'word', insert the word and word
+ *      count pair into the dictionary.  As with std::map::insert, an existing
+ *      word keeps its current count.
+ *******************************************************************************
+ */
+void Word_Dict::insertWord (string word, int count)
+{
+    Word_Hash_t hash = wordHash (word.data (), word.size ());
+    unsigned int shard_idx = _shardFor (hash);
+    Dict_Store *store = _shards[shard_idx].store;
+
+    _lockShard (shard_idx);
+    if (_approx != NULL)
+    {
+        _lockApproxFrom (shard_idx);
+        if (_approx->estimate (hash) == 0)
+        {
+            (void) _approx->add (word.data (), word.size (), hash,
+                                 (uint32_t) count);
+        }
+        _unlockShard (APPROX_SHARD);
+        return;
+    }
+    if (store->find (word.data (), word.size (), hash) == NULL)
+    {
+        _touchShard (shard_idx);
+        *store->findOrInsert (word.data (), word.size (), hash) = count;
+        _updateLeaders (shard_idx, word.data (), word.size (), hash, count);
+    }
+    _unlockShard (shard_idx);
+}
+
+/**
+ *******************************************************************************
+ * @brief begin - Set the Word_Dict instance iterator to the beginning of the
+ * dictionary.
+ *******************************************************************************
+ */
+void Word_Dict::begin (void)
+{
+    (void) pthread_mutex_lock (&_mut);
+    _itShard = 0;
+    _itDone = FALSE;
+    _lockShard (0);
+    _shards[0].store->rewind ();
+    _unlockShard (0);
+    (void) pthread_mutex_unlock (&_mut);
+}
+
+/**
+ *******************************************************************************
+ * @brief end - Set the Word_Dict instance iterator to the end of the
+ * dictionary.
+ *******************************************************************************
+ */
+void Word_Dict::end (void)
+{
+    (void) pthread_mutex_lock (&_mut);
+    _itShard = _numShards - 1;
+    _itDone = TRUE;
+    (void) pthread_mutex_unlock (&_mut);
+}
+
+/**
+ *******************************************************************************
+ * @brief getNextWord - Using the in-class instance iterator, get the next word
+ * and its count.
+ *
+ * <!-- Parameters -->
+ *      @param[in,out]  word           reference to string in which to put the
  *                                     word from the dictionary.
  *      @param[in,out]  count          current word count for this 'word'
  *
  * <!-- Returns -->
- *      None (if return type is void)
- *
- * @par Pre/Post Conditions:
- *      None (if entry/exit conditions do not apply)
- *
- * @par Global Data:
- *      None (if no global data)
+ *      None (if return type is void)
+ *
+ * @par Pre/Post Conditions:
+ *      None (if entry/exit conditions do not apply)
+ *
+ * @par Global Data:
+ *      None (if no global data)
+ *
+ * @par Description:
+ *      Using the class access lock, and iterator, return the next word and word
+ *      count pair.  Requires that begin() be called prior to calling, and will 
+ *      return a -1 word count, and empty string if at the end of the dictionary
+ *      list.
+ *******************************************************************************
+ */
+void Word_Dict::getNextWord (string & word, int *count)
+{
+    int _count = -1;
+    int stat = STATUS_SUCCESS;
+    Dict_Entry_t entry;
+
+    EXIT_ON_NULL_PTR (count, stat);
+    word = "";
+    if (getNextEntry (&entry) == TRUE)
+    {
+        word.assign (entry.word, entry.len);
+        _count = entry.count;
+    }
+  cleanup:
+    if (count != NULL)
+    {
+        *count = _count;
+    }
+    return;
+  error:
+    goto cleanup;
+
+}
+
+/**
+ *******************************************************************************
+ * @brief getNextEntry - Using the in-class instance iterator, get the next
+ * word and its count without copying the word.
+ *
+ * <!-- Parameters -->
+ *      @param[out]     entry          Filled in with the next word's bytes,
+ *                                     length, hash and count.
+ *
+ * <!-- Returns -->
+ *      @return TRUE if an entry was returned, FALSE at the end of the
+ *      dictionary.
+ *
+ * @par Pre/Post Conditions:
+ *      @pre     begin() has been called.
+ *      @post    entry->word points into the dictionary's own storage (it is
+ *               not nul terminated for every backend), and is only valid
+ *               until the dictionary is next modified.
+ *
+ * @par Global Data:
+ *      None (if no global data)
+ *
+ * @par Description:
+ *      When one shard is exhausted the iterator moves on to the next, so
+ *      callers see every shard in turn.
+ *******************************************************************************
+ */
+Bool_t Word_Dict::getNextEntry (Dict_Entry_t * entry)
+{
+    Bool_t found = FALSE;
+
+    if (entry == NULL)
+    {
+        return (FALSE);
+    }
+    (void) pthread_mutex_lock (&_mut);
+    while ((_itDone == FALSE) && (found == FALSE))
+    {
+        _lockShard (_itShard);
+        found = _shards[_itShard].store->next (entry);
+        _unlockShard (_itShard);
+        if (found == TRUE)
+        {
+            break;
+        }
+        if (_itShard + 1 < _numShards)
+        {
+            _itShard++;
+            _lockShard (_itShard);
+            _shards[_itShard].store->rewind ();
+            _unlockShard (_itShard);
+        }
+        else
+        {
+            _itDone = TRUE;
+        }
+    }
+    (void) pthread_mutex_unlock (&_mut);
+
+    return (found);
+}
+
+/**
+ *******************************************************************************
+ * @brief hasWord - Search through dictionary to determine if word is contained.
+ * and its count.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      word           String representation of word
+ *
+ * <!-- Returns -->
+ *      @return TRUE if word is already in the dictionary.
+ *      @return FALSE if word is not in the dictionary.
+ *
+ * @par Pre/Post Conditions:
+ *      None (if entry/exit conditions do not apply)
+ *
+ * @par Global Data:
+ *      None (if no global data)
+ *
+ * @par Description:
+ *      Using the owning shard's lock, search for the word, and if already
+ *      present, return TRUE.
+ *******************************************************************************
+ */
+Bool_t Word_Dict::hasWord (string word)
+{
+    int count = getWordCount (word.data (), word.size ());
+
+    if ((count >= 0) && (_showDebugOutput == TRUE))
+    {
+        printf ("%s => %d\n", word.c_str (), count);
+    }
+
+    return ((count >= 0) ? TRUE : FALSE);
+}
+
+/**
+ *******************************************************************************
+ * @brief incrementWordCount - Search through dictionary to determine if word is
+ * contained, and if is present increment its word count.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      word           String representation of word
+ *
+ * <!-- Returns -->
+ *      None (if return type is void)
+ *
+ * @par Pre/Post Conditions:
+ *      None (if entry/exit conditions do not apply)
+ *
+ * @par Global Data:
+ *      None (if no global data)
+ *
+ * @par Description:
+ *      Using the owning shard's lock, search for the word, and if already
+ *      present, increment its word count.
+ *******************************************************************************
+ */
+void Word_Dict::incrementWordCount (string word)
+{
+    Word_Hash_t hash = wordHash (word.data (), word.size ());
+    unsigned int shard_idx = _shardFor (hash);
+    int *count = NULL;
+
+    _lockShard (shard_idx);
+    if (_approx != NULL)
+    {
+        _lockApproxFrom (shard_idx);
+        if (_approx->estimate (hash) > 0)
+        {
+            (void) _approx->add (word.data (), word.size (), hash);
+        }
+        _unlockShard (APPROX_SHARD);
+        return;
+    }
+
+    count = _shards[shard_idx].store->find (word.data (), word.size (), hash);
+    if (count != NULL)
+    {
+        _touchShard (shard_idx);
+        (*count)++;
+        _updateLeaders (shard_idx, word.data (), word.size (), hash, *count);
+    }
+
+    _unlockShard (shard_idx);
+
+    return;
+}
+
+/**
+ *******************************************************************************
+ * @brief addOrIncrement - Add 'delta' to the count for a word, inserting the
+ * word first if it is not yet in the dictionary.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      word           String representation of word
+ *      @param[in]      delta          Amount to add to the word count
+ *
+ * <!-- Returns -->
+ *      @return the word count after the update.
+ *
+ * @par Pre/Post Conditions:
+ *      None (if entry/exit conditions do not apply)
+ *
+ * @par Global Data:
+ *      None (if no global data)
+ *
+ * @par Description:
+ *      Single lookup under a single acquisition of the owning shard's lock.
+ *      Unlike hasWord() followed by insertWord(), two threads racing on a new
+ *      word can not lose either thread's count.
+ *******************************************************************************
+ */
+int Word_Dict::addOrIncrement (const string & word, int delta)
+{
+    return (addOrIncrement (word.data (), word.size (),
+                            wordHash (word.data (), word.size ()), delta));
+}
+
+/**
+ *******************************************************************************
+ * @brief addOrIncrement - Pointer and length form, for callers which already
+ * have the word's bytes and hash and don't want to build a std::string.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      word           First byte of the word (need not be nul
+ *                                     terminated)
+ *      @param[in]      len            Length of the word in bytes
+ *      @param[in]      hash           wordHash (word, len)
+ *      @param[in]      delta          Amount to add to the word count
+ *
+ * <!-- Returns -->
+ *      @return the word count after the update.
+ *******************************************************************************
+ */
+int Word_Dict::addOrIncrement (const char *word, size_t len, Word_Hash_t hash,
+                               int delta)
+{
+    unsigned int shard_idx = _shardFor (hash);
+    int new_count = 0;
+
+    _lockShard (shard_idx);
+    if (_approx != NULL)
+    {
+        _lockApproxFrom (shard_idx);
+        new_count = _approxCount (_approx->add (word, len, hash,
+                                                (uint32_t) delta));
+        _unlockShard (APPROX_SHARD);
+        return (new_count);
+    }
+    _touchShard (shard_idx);
+    new_count = (*_shards[shard_idx].store->findOrInsert (word, len, hash) +=
+                 delta);
+    _updateLeaders (shard_idx, word, len, hash, new_count);
+    _unlockShard (shard_idx);
+
+    return (new_count);
+}
+
+/**
+ *******************************************************************************
+ * @brief addOrIncrement - Batch form, add 'delta' to the count of every word
+ * in an array of words.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      words          Pointer to the first word of the batch
+ *      @param[in]      num_words      Number of words pointed to by 'words'
+ *      @param[in]      delta          Amount to add for each occurrence
+ *
+ * <!-- Returns -->
+ *      None (if return type is void)
+ *
+ * @par Pre/Post Conditions:
+ *      None (if entry/exit conditions do not apply)
+ *
+ * @par Global Data:
+ *      None (if no global data)
+ *
+ * @par Description:
+ *      Each word costs one lookup.  A shard lock is held across consecutive
+ *      words owned by the same shard, and only one shard lock is ever held at
+ *      a time, so a single shard dictionary takes its lock once per batch.
+ *******************************************************************************
+ */
+void Word_Dict::addOrIncrement (const string * words, size_t num_words,
+                                int delta)
+{
+    size_t idx = 0;
+    Word_Hash_t hash = 0;
+    unsigned int shard_idx = 0;
+    unsigned int locked_shard = _numShards;
+    int new_count = 0;
+
+    if ((words == NULL) || (num_words == 0))
+    {
+        return;
+    }
+    for (idx = 0; idx < num_words; idx++)
+    {
+        hash = wordHash (words[idx].data (), words[idx].size ());
+        shard_idx = _shardFor (hash);
+        if (shard_idx != locked_shard)
+        {
+            if (locked_shard != _numShards)
+            {
+                _unlockShard (locked_shard);
+            }
+            _lockShard (shard_idx);
+            if (_approx != NULL)
+            {
+                /* Counting approximately, maybe since part way through,
+                 * the rest of the words go to the sketch */
+                _lockApproxFrom (shard_idx);
+                for (; idx < num_words; idx++)
+                {
+                    (void) _approx->add (words[idx].data (),
+                                         words[idx].size (),
+                                         wordHash (words[idx].data (),
+                                                   words[idx].size ()),
+                                         (uint32_t) delta);
+                }
+                _unlockShard (APPROX_SHARD);
+                return;
+            }
+            _touchShard (shard_idx);
+            locked_shard = shard_idx;
+        }
+        new_count =
+            (*_shards[shard_idx].store->findOrInsert (words[idx].data (),
+                                                      words[idx].size (),
+                                                      hash) += delta);
+        _updateLeaders (shard_idx, words[idx].data (), words[idx].size (),
+                        hash, new_count);
+    }
+    _unlockShard (locked_shard);
+}
+
+/**
+ *******************************************************************************
+ * @brief merge - Add every word count from another dictionary into this one.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      other          Dictionary whose counts to add in.
+ *
+ * <!-- Returns -->
+ *      None (if return type is void)
+ *
+ * @par Pre/Post Conditions:
+ *      @pre     No other thread is modifying 'other'.
+ *
+ * @par Global Data:
+ *      None (if no global data)
+ *
+ * @par Description:
+ *      Entries carry their hash, so nothing is rehashed.  As in the batch
+ *      addOrIncrement, a shard lock is held across runs of words owned by the
+ *      same shard; when both dictionaries have the same number of shards, that
+ *      is one lock acquisition per shard.  Otherwise each of the other's
+ *      shards is put in hash order first, which groups its words by the shard
+ *      they go to here (wordHashRange() keeps the order), so an unsharded
+ *      private table still takes each shard lock at most once.
+ *
+ *      Approximate dictionaries of the same sketch shape combine sketch to
+ *      sketch.  Otherwise an approximate 'other' contributes only its heavy
+ *      hitter candidates, at their estimated counts.
+ *******************************************************************************
+ */
+void Word_Dict::merge (Word_Dict & other)
+{
+    unsigned int idx = 0;
+    unsigned int shard_idx = 0;
+    unsigned int locked_shard = _numShards;
+    int new_count = 0;
+    size_t entry_idx = 0;
+    vector < Dict_Entry_t > entries;
+    Dict_Entry_t entry;
+    Bool_t approx = FALSE;
+
+    if (&other == this)
+    {
+        return;
+    }
+    if ((other._approx == NULL) && (other._spill != NULL))
+    {
+        vector < Dict_Entry_t > extra;
+        size_t merged = 0;
+
+        /*
+         * Stream the other's runs through, and let this dictionary spill
+         * in turn if it has to
+         */
+        other._lock ();
+        other._gatherEntries (extra);
+        sort (extra.begin (), extra.end (), dictEntryWordBefore);
+        other._spill->rewind (&extra);
+        while (other._spill->next (&entry) == TRUE)
+        {
+            (void) addOrIncrement (entry.word, entry.len, entry.hash,
+                                   entry.count);
+            if (++merged % WORD_DICT_SPILL_CHECK_WORDS == 0)
+            {
+                (void) checkMemoryLimit ();
+            }
+        }
+        other._unlock ();
+        return;
+    }
+
+    /*
+     * Once set, _approx stays set while other threads count, so a sketch
+     * seen here is still there below.  One set after this is caught by the
+     * check under each shard lock.
+     */
+    _lockShard (APPROX_SHARD);
+    approx = (_approx != NULL) ? TRUE : FALSE;
+    _unlockShard (APPROX_SHARD);
+    if ((approx == TRUE) && (other._approx != NULL))
+    {
+        Bool_t merged = FALSE;
+
+        _lockShard (APPROX_SHARD);
+        other._lockShard (APPROX_SHARD);
+        merged = _approx->merge (*other._approx);
+        other._unlockShard (APPROX_SHARD);
+        _unlockShard (APPROX_SHARD);
+        if (merged == TRUE)
+        {
+            return;
+        }
+    }
+    if (other._approx != NULL)
+    {
+        vector < Dict_Entry_t > candidates;
+        size_t cand_idx = 0;
+
+        other._lockShard (APPROX_SHARD);
+        other._approx->getCandidates (candidates);
+        for (cand_idx = 0; cand_idx < candidates.size (); cand_idx++)
+        {
+            (void) addOrIncrement (candidates[cand_idx].word,
+                                   candidates[cand_idx].len,
+                                   candidates[cand_idx].hash,
+                                   candidates[cand_idx].count);
+        }
+        other._unlockShard (APPROX_SHARD);
+        return;
+    }
+    if (approx == TRUE)
+    {
+        _lockShard (APPROX_SHARD);
+        for (idx = 0; idx < other._numShards; idx++)
+        {
+            Dict_Store *src = other._shards[idx].store;
+
+            other._lockShard (idx);
+            src->rewind ();
+            while (src->next (&entry) == TRUE)
+            {
+                (void) _approx->add (entry.word, entry.len, entry.hash,
+                                     (uint32_t) entry.count);
+            }
+            other._unlockShard (idx);
+        }
+        _unlockShard (APPROX_SHARD);
+        return;
+    }
+    for (idx = 0; idx < other._numShards; idx++)
+    {
+        Dict_Store *src = other._shards[idx].store;
+
+        other._lockShard (idx);
+        entries.clear ();
+        src->rewind ();
+        while (src->next (&entry) == TRUE)
+        {
+            entries.push_back (entry);
+        }
+        if (other._numShards != _numShards)
+        {
+            sort (entries.begin (), entries.end (), entryHashBefore);
+        }
+        for (entry_idx = 0; entry_idx < entries.size (); entry_idx++)
+        {
+            entry = entries[entry_idx];
+            shard_idx = _shardFor (entry.hash);
+            if (shard_idx != locked_shard)
+            {
+                if (locked_shard != _numShards)
+                {
+                    _unlockShard (locked_shard);
+                }
+                _lockShard (shard_idx);
+                if (_approx != NULL)
+                {
+                    /* Switched to approximate counting part way through,
+                     * the rest of the entries go to the sketch */
+                    _unlockShard (shard_idx);
+                    locked_shard = _numShards;
+                    (void) addOrIncrement (entry.word, entry.len, entry.hash,
+                                           entry.count);
+                    continue;
+                }
+                _touchShard (shard_idx);
+                locked_shard = shard_idx;
+            }
+            new_count =
+                (*_shards[shard_idx].store->findOrInsert (entry.word,
+                                                          entry.len,
+                                                          entry.hash) +=
+                 entry.count);
+            _updateLeaders (shard_idx, entry.word, entry.len, entry.hash,
+                            new_count);
+        }
+        other._unlockShard (idx);
+    }
+    if (locked_shard != _numShards)
+    {
+        _unlockShard (locked_shard);
+    }
+}
+
+/**
+ *******************************************************************************
+ * @brief clear - Remove every word from the dictionary.
+ *******************************************************************************
+ */
+void Word_Dict::clear (void)
+{
+    unsigned int idx = 0;
+
+    _lock ();
+    for (idx = 0; idx < _numShards; idx++)
+    {
+        _touchShard (idx);
+        _shards[idx].store->clear ();
+        _shards[idx].leaders.clear ();
+        _shards[idx].leaderMin = 0;
+    }
+    if (_approx != NULL)
+    {
+        _approx->clear ();
+    }
+    delete _spill;
+    _spill = NULL;
+    _spillWords.clear ();
+    _itShard = 0;
+    _itDone = FALSE;
+    _shards[0].store->rewind ();
+    _unlock ();
+}
+
+/**
+ *******************************************************************************
+ * @brief size - Number of distinct words in the dictionary.
+ *
+ * @par Description:
+ *      Once the dictionary has spilled (see spill()), words may be in memory
+ *      and in several runs, so this is a full merge of the runs.
+ *******************************************************************************
+ */
+size_t Word_Dict::size (void)
+{
+    vector < Dict_Entry_t > extra;
+    Dict_Entry_t entry;
+    unsigned int idx = 0;
+    size_t total = 0;
+
+    _lockShard (APPROX_SHARD);
+    if (_approx != NULL)
+    {
+        total = _approx->numCandidates ();
+        _unlockShard (APPROX_SHARD);
+        return (total);
+    }
+    _unlockShard (APPROX_SHARD);
+    if (_spill != NULL)
+    {
+        _lock ();
+        _gatherEntries (extra);
+        sort (extra.begin (), extra.end (), dictEntryWordBefore);
+        _spill->rewind (&extra);
+        while (_spill->next (&entry) == TRUE)
+        {
+            total++;
+        }
+        _unlock ();
+        return (total);
+    }
+    for (idx = 0; idx < _numShards; idx++)
+    {
+        _lockShard (idx);
+        total += _shards[idx].store->size ();
+        _unlockShard (idx);
+    }
+    return (total);
+}
+
+/**
+ *******************************************************************************
+ * @brief print - Iterate through dictionary item list, and print the entries
+ * out.
+ *******************************************************************************
+ */
+void Word_Dict::print (void)
+{
+    Dict_Entry_t entry;
+
+    if (_approx != NULL)
+    {
+        printTopX (-1);
+        return;
+    }
+    printf ("Dumping word dictionary: =================================\n");
+    begin ();
+    while (getNextEntry (&entry) == TRUE)
+    {
+        printf ("%.*s => %d\n", (int) entry.len, entry.word, entry.count);
+    }
+    printf ("==========================================================\n");
+
+    return;
+}
+
+/**
+ *******************************************************************************
+ * @brief setDebug - Set current value of instance debug flag.
+ *******************************************************************************
+ */
+void Word_Dict::setDebug (Bool_t enabled)
+{
+    (void) pthread_mutex_lock (&_mut);
+    _showDebugOutput = enabled;
+    (void) pthread_mutex_unlock (&_mut);
+}
+
+/**
+ *******************************************************************************
+ * @brief getDebug - Get current value of instance debug flag.
+ *******************************************************************************
+ */
+Bool_t Word_Dict::getDebug (void)
+{
+    Bool_t isEnabled = FALSE;
+
+    (void) pthread_mutex_lock (&_mut);
+    isEnabled = _showDebugOutput;
+    (void) pthread_mutex_unlock (&_mut);
+    return (isEnabled);
+}
+
+/**
+ *******************************************************************************
+ * @brief enableApproximate - Switch to fixed memory approximate counting.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      width          Count-Min Sketch counters per row
+ *      @param[in]      depth          Count-Min Sketch rows
+ *      @param[in]      num_candidates Heavy hitter words tracked for the top
+ *                                     X report
+ *
+ * <!-- Returns -->
+ *      None (if return type is void)
+ *
+ * @par Pre/Post Conditions:
+ *      @pre     The dictionary is empty, any exact counts are not carried
+ *               over.
+ *      @post    Counts go to an Approx_Counter of width * depth * 4 bytes,
+ *               and the shards stay empty.  getWordCount() returns an upper
+ *               bound, size() the number of candidates, and selectTopX() /
+ *               printTopX() / getLeaderboard() draw from the candidates.
+ *               Iterating with begin()/getNextWord() sees no words.
+ *
+ * @par Global Data:
+ *      None (if no global data)
+ *
+ * @par Description:
+ *      See Approx_Counter for the error bounds.  There is one sketch for the
+ *      whole dictionary, so every update is serialized by the first shard's
+ *      lock, however many shards there are.  That keeps the memory fixed at
+ *      one sketch, a sketch per shard would multiply it by the shard count;
+ *      the cost is that approximate counting does not scale with shards.
+ *      Threads wanting both should count into thread local dictionaries and
+ *      merge them.
+ *******************************************************************************
+ */
+void Word_Dict::enableApproximate (uint32_t width, uint32_t depth,
+                                   size_t num_candidates)
+{
+    _lock ();
+    delete _approx;
+    _approx = new Approx_Counter (width, depth, num_candidates);
+    _unlock ();
+}
+
+/**
+ *******************************************************************************
+ * @brief _approxCount - Clamp a sketch estimate into an int word count.
+ *******************************************************************************
+ */
+int Word_Dict::_approxCount (uint32_t estimate)
+{
+    return ((estimate > (uint32_t) APPROX_INT_COUNT_MAX) ?
+            APPROX_INT_COUNT_MAX : (int) estimate);
+}
+
+/**
+ *******************************************************************************
+ * @brief enableLeaderboard - Start keeping a live list of the top 'top_n'
+ * words, updated as counts change.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      top_n          Words to keep, 0 turns the leaderboard
+ *                                     back off.
+ *
+ * <!-- Returns -->
+ *      None (if return type is void)
+ *
+ * @par Pre/Post Conditions:
+ *      None (if entry/exit conditions do not apply)
+ *
+ * @par Global Data:
+ *      None (if no global data)
+ *
+ * @par Description:
+ *      Any words already in the dictionary are scanned once to seed the
+ *      leaderboard.  From then on every insert or increment keeps it exact,
+ *      see _updateLeaders().
+ *******************************************************************************
+ */
+void Word_Dict::enableLeaderboard (size_t top_n)
+{
+    unsigned int idx = 0;
+    Dict_Entry_t entry;
+
+    _lock ();
+    _leaderboardSize = top_n;
+    for (idx = 0; idx < _numShards; idx++)
+    {
+        Dict_Store *store = _shards[idx].store;
+
+        _shards[idx].leaders.clear ();
+        _shards[idx].leaderMin = 0;
+        if (top_n == 0)
+        {
+            continue;
+        }
+        store->rewind ();
+        while (store->next (&entry) == TRUE)
+        {
+            _updateLeaders (idx, entry.word, entry.len, entry.hash,
+                            entry.count);
+        }
+        store->rewind ();
+    }
+    _unlock ();
+}
+
+/**
+ *******************************************************************************
+ * @brief getLeaderboard - Copy out the current top words, highest count first.
+ *
+ * <!-- Parameters -->
+ *      @param[out]     leaders        Replaced with the leaderboard, at most
+ *                                     the size given to enableLeaderboard().
+ *
+ * <!-- Returns -->
+ *      @return number of words returned.
+ *
+ * @par Pre/Post Conditions:
+ *      None (if entry/exit conditions do not apply)
+ *
+ * @par Global Data:
+ *      None (if no global data)
+ *
+ * @par Description:
+ *      Safe to call while other threads keep counting.  Only the per-shard
+ *      leaderboards are read, one shard lock at a time, so the cost depends on
+ *      the leaderboard size and shard count, never on the dictionary size.
+ *      Because shards are read at slightly different moments, the result is
+ *      exact for each shard, but not a single point in time snapshot.
+ *******************************************************************************
+ */
+size_t Word_Dict::getLeaderboard (vector < pair < string, int > >&leaders)
+{
+    vector < Dict_Leader_t > all;
+    unsigned int idx = 0;
+    size_t top_n = _leaderboardSize;
+
+    leaders.clear ();
+    _lockShard (APPROX_SHARD);
+    if (_approx != NULL)
+    {
+        vector < Dict_Entry_t > candidates;
+
+        _approx->getCandidates (candidates);
+        for (idx = 0; (idx < top_n) && (idx < candidates.size ()); idx++)
+        {
+            leaders.push_back (pair < string, int >(candidates[idx].word,
+                                                    candidates[idx].count));
+        }
+        _unlockShard (APPROX_SHARD);
+        return (leaders.size ());
+    }
+    _unlockShard (APPROX_SHARD);
+    for (idx = 0; idx < _numShards; idx++)
+    {
+        _lockShard (idx);
+        all.insert (all.end (), _shards[idx].leaders.begin (),
+                    _shards[idx].leaders.end ());
+        _unlockShard (idx);
+    }
+    if (top_n > all.size ())
+    {
+        top_n = all.size ();
+    }
+    partial_sort (all.begin (), all.begin () + top_n, all.end (),
+                  leaderRanksBefore);
+    for (idx = 0; idx < top_n; idx++)
+    {
+        leaders.push_back (pair < string, int >(all[idx].word,
+                                                all[idx].count));
+    }
+    return (leaders.size ());
+}
+
+/**
+ *******************************************************************************
+ * @brief snapshot - Take a read-only view of the dictionary, which can be
+ * iterated and queried without blocking the threads still counting.
+ *
+ * <!-- Returns -->
+ *      @return New Dict_Snapshot, deleted by the caller.
+ *
+ * @par Pre/Post Conditions:
+ *      @post    The legacy begin()/getNextWord() cursor is disturbed for any
+ *               shard that had to be copied.
+ *
+ * @par Global Data:
+ *      None (if no global data)
+ *
+ * @par Description:
+ *      Copy-on-snapshot per shard: a shard is copied into a Dict_Shard_View
+ *      under its lock the first time it is snapshotted after a change, and
+ *      that view is shared by every later snapshot until a writer touches the
+ *      shard again.  Writers only drop the cached view, they never copy, and
+ *      readers hold no locks at all once the snapshot is taken.  Frequent
+ *      snapshots of a busy dictionary therefore cost in proportion to the
+ *      shards which changed in between.
+ *
+ *      An approximate dictionary snapshots its heavy hitter candidates, at
+ *      their estimated counts, as a single shard.
+ *******************************************************************************
+ */
+Dict_Snapshot *Word_Dict::snapshot (void)
+{
+    vector < Dict_Shard_View * >views;
+    unsigned int idx = 0;
+
+    _lockShard (APPROX_SHARD);
+    if (_approx != NULL)
+    {
+        vector < Dict_Entry_t > candidates;
+
+        _approx->getCandidates (candidates);
+        views.push_back (new Dict_Shard_View (candidates));
+        _unlockShard (APPROX_SHARD);
+        return (new Dict_Snapshot (views));
+    }
+    _unlockShard (APPROX_SHARD);
+    views.reserve (_numShards);
+    for (idx = 0; idx < _numShards; idx++)
+    {
+        _lockShard (idx);
+        if (_shards[idx].view == NULL)
+        {
+            _shards[idx].view = new Dict_Shard_View (*_shards[idx].store);
+        }
+        _shards[idx].view->acquire ();
+        views.push_back (_shards[idx].view);
+        _unlockShard (idx);
+    }
+    return (new Dict_Snapshot (views));
+}
+
+/**
+ *******************************************************************************
+ * @brief freeze - Copy the dictionary into a read-only Frozen_Dict, for
+ * serving lookups once counting is finished.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      perfect_hash   If TRUE, index the words with a minimal
+ *                                     perfect hash, so a lookup is one probe.
+ *
+ * <!-- Returns -->
+ *      @return New Frozen_Dict, deleted by the caller, or NULL if it could
+ *      not be built.
+ *
+ * @par Description:
+ *      Built from a snapshot(), so counting may go on meanwhile, and the
+ *      result is consistent per shard.  Nothing links the two afterwards.
+ *******************************************************************************
+ */
+Frozen_Dict *Word_Dict::freeze (Bool_t perfect_hash)
+{
+    Dict_Snapshot *snap = snapshot ();
+    Frozen_Dict *frozen = new Frozen_Dict ();
+    vector < Dict_Entry_t > entries;
+    Dict_Entry_t entry;
+
+    entries.reserve (snap->size ());
+    snap->begin ();
+    while (snap->getNextEntry (&entry) == TRUE)
+    {
+        entries.push_back (entry);
+    }
+    if (frozen->build (entries, perfect_hash) == FALSE)
+    {
+        delete frozen;
+        frozen = NULL;
+    }
+    delete snap;
+    return (frozen);
+}
+
+/**
+ *******************************************************************************
+ * @brief _updateLeaders - Account for a word's new count in its shard's
+ * leaderboard.  Called with the shard lock held.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      shard_idx      Shard owning the word
+ *      @param[in]      word           First byte of the word
+ *      @param[in]      len            Length of the word in bytes
+ *      @param[in]      hash           wordHash (word, len)
+ *      @param[in]      count          The word's count after the change
+ *
+ * <!-- Returns -->
+ *      None (if return type is void)
+ *
+ * @par Pre/Post Conditions:
+ *      @pre     Counts only ever increase.  A decrease of a word on the
+ *               leaderboard is applied, but a word off the board which now
+ *               outranks it will not be noticed.
+ *
+ * @par Global Data:
+ *      None (if no global data)
+ *
+ * @par Algorithm:
+ *      Every word not on a full leaderboard has a count no higher than the
+ *      lowest count on it (leaderMin).  So a count at or below leaderMin
+ *      needs nothing more than that one compare, which is the common case.
+ *      Otherwise the word is updated in place if already present, or takes
+ *      the lowest entry's place, and leaderMin is recomputed.  The board is
+ *      a few entries long, so linear scans beat any indexed structure.
+ *******************************************************************************
+ */
+void Word_Dict::_updateLeaders (unsigned int shard_idx, const char *word,
+                                size_t len, Word_Hash_t hash, int count)
+{
+    vector < Dict_Leader_t > &leaders = _shards[shard_idx].leaders;
+    size_t idx = 0;
+    size_t min_idx = 0;
+
+    if ((_leaderboardSize == 0) ||
+        ((leaders.size () >= _leaderboardSize) &&
+         (count <= _shards[shard_idx].leaderMin)))
+    {
+        return;
+    }
+    for (idx = 0; idx < leaders.size (); idx++)
+    {
+        if ((leaders[idx].hash == hash) && (leaders[idx].word.size () == len)
+            && (memcmp (leaders[idx].word.data (), word, len) == 0))
+        {
+            break;
+        }
+    }
+    if (idx == leaders.size ())
+    {
+        Dict_Leader_t leader;
+
+        leader.word.assign (word, len);
+        leader.hash = hash;
+        if (leaders.size () < _leaderboardSize)
+        {
+            leaders.push_back (leader);
+        }
+        else
+        {
+            for (idx = 1; idx < leaders.size (); idx++)
+            {
+                if (leaders[idx].count < leaders[min_idx].count)
+                {
+                    min_idx = idx;
+                }
+            }
+            idx = min_idx;
+            leaders[idx] = leader;
+        }
+    }
+    leaders[idx].count = count;
+
+    _shards[shard_idx].leaderMin = leaders[0].count;
+    for (idx = 1; idx < leaders.size (); idx++)
+    {
+        if (leaders[idx].count < _shards[shard_idx].leaderMin)
+        {
+            _shards[shard_idx].leaderMin = leaders[idx].count;
+        }
+    }
+}
+
+/**
+ *******************************************************************************
+ * @brief getWordCount - Current count for a nul terminated word, -1 if the
+ * word is not in the dictionary.
+ *******************************************************************************
+ */
+int Word_Dict::getWordCount (char *word)
+{
+    return (getWordCount (word, strlen (word)));
+}
+
+/**
+ *******************************************************************************
+ * @brief getWordCount - Current count for 'len' bytes at 'word', -1 if the
+ * word is not in the dictionary.
+ *******************************************************************************
+ */
+int Word_Dict::getWordCount (const char *word, size_t len)
+{
+    int _word_count = -1;
+    Word_Hash_t hash = wordHash (word, len);
+    unsigned int shard_idx = _shardFor (hash);
+    int *count = NULL;
+
+    _lockShard (shard_idx);
+    if (_approx != NULL)
+    {
+        _lockApproxFrom (shard_idx);
+        _word_count = _approxCount (_approx->estimate (hash));
+        _unlockShard (APPROX_SHARD);
+        return ((_word_count == 0) ? -1 : _word_count);
+    }
+    if (_spill != NULL)
+    {
+        /* Spilled runs are shared by every shard */
+        _unlockShard (shard_idx);
+        _lock ();
+        _word_count = _spill->getWordCount (word, len);
+        count = _shards[shard_idx].store->find (word, len, hash);
+        if (count != NULL)
+        {
+            _word_count = ((_word_count < 0) ? 0 : _word_count) + *count;
+        }
+        _unlock ();
+        return (_word_count);
+    }
+    count = _shards[shard_idx].store->find (word, len, hash);
+    if (count != NULL)
+    {
+        _word_count = *count;
+    }
+    _unlockShard (shard_idx);
+
+    return (_word_count);
+}
+
+#if 0
+/**
+ *******************************************************************************
+ * @brief wordCmp - Comparitor for sort
+ *******************************************************************************
+ */
+/*
+ * If we were sorting in least count to most count, we'd use this 
+ */
+bool wordCmp (const pair < string, int >&left_count, const pair < string,
+              int >&right_count)
+{
+    return (left_count.second < right_count.second);
+}
+#endif
+
+/**
+ *******************************************************************************
+ * @brief selectShardTopX - Pick the top 'top_k' entries from a subset of the
+ * shards, without copying any words.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      first_shard    First shard to look at.
+ *      @param[in]      shard_step     Look at every shard_step'th shard from
+ *                                     first_shard on.
+ *      @param[in]      top_k          How many entries to keep, (size_t) -1
+ *                                     for all of them.
+ *      @param[out]     candidates     Replaced with the selected entries, in
+ *                                     no particular order.
+ *
+ * <!-- Returns -->
+ *      None (if return type is void)
+ *
+ * @par Pre/Post Conditions:
+ *      @pre     No thread is modifying the dictionary.
+ *      @post    The instance iterator (begin()/getNextWord()) is reset.
+ *
+ * @par Global Data:
+ *      None (if no global data)
+ *
+ * @par Algorithm:
+ *      Bounded heap of at most top_k entries whose front is the lowest
+ *      ranked entry kept so far.  Each entry that outranks the front replaces
+ *      it, so selection is O(N log K) time and O(K) space.
+ *******************************************************************************
+ */
+void Word_Dict::selectShardTopX (unsigned int first_shard,
+                                 unsigned int shard_step, size_t top_k,
+                                 vector < Dict_Entry_t > &candidates)
+{
+    unsigned int shard_idx = 0;
+    Dict_Entry_t entry;
+
+    candidates.clear ();
+    if ((top_k == 0) || (shard_step == 0))
+    {
+        return;
+    }
+    for (shard_idx = first_shard; shard_idx < _numShards;
+         shard_idx += shard_step)
+    {
+        Dict_Store *store = _shards[shard_idx].store;
+
+        _lockShard (shard_idx);
+        store->rewind ();
+        while (store->next (&entry) == TRUE)
+        {
+            dictEntryOffer (entry, top_k, candidates);
+        }
+        store->rewind ();
+        _unlockShard (shard_idx);
+    }
+}
+
+/**
+ *******************************************************************************
+ * @brief selectTopX - Find the 'top_X_counts' highest counted words, in
+ * ranked order, without copying any words.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      top_X_counts   How many words, -1 for all of them.
+ *      @param[out]     top_list       Replaced with the selected entries,
+ *                                     highest count first.  Entry words point
+ *                                     into the dictionary, see getNextEntry().
+ *      @param[in]      num_threads    Threads to spread the shards over.
+ *
+ * <!-- Returns -->
+ *      None (if return type is void)
+ *
+ * @par Pre/Post Conditions:
+ *      @pre     No thread is modifying the dictionary.
+ *
+ * @par Global Data:
+ *      None (if no global data)
+ *
+ * @par Algorithm:
+ *      Each thread runs selectShardTopX() over an interleaved subset of the
+ *      shards, leaving at most top_X_counts candidates apiece.  The union of
+ *      the candidates must contain the overall top X, so a partial sort of
+ *      that (small) union finishes the job.
+ *******************************************************************************
+ */
+void Word_Dict::selectTopX (int top_X_counts,
+                            vector < Dict_Entry_t > &top_list,
+                            int num_threads)
+{
+    size_t top_k = (top_X_counts < 0) ? (size_t) -1 : (size_t) top_X_counts;
+    vector < Dict_TopX_Job_t > jobs;
+    vector < pthread_t > threads;
+    vector < Bool_t > spawned;
+    size_t idx = 0;
+
+    top_list.clear ();
+    _lockShard (APPROX_SHARD);
+    if (_approx != NULL)
+    {
+        _approx->getCandidates (top_list);
+        _unlockShard (APPROX_SHARD);
+        if (top_k < top_list.size ())
+        {
+            top_list.resize (top_k);
+        }
+        return;
+    }
+    _unlockShard (APPROX_SHARD);
+    if (_spill != NULL)
+    {
+        _selectSpilled (NULL, 0, top_k, top_list);
+        return;
+    }
+    if (num_threads < 1)
+    {
+        num_threads = 1;
+    }
+    if ((unsigned int) num_threads > _numShards)
+    {
+        num_threads = (int) _numShards;
+    }
+
+    jobs.resize (num_threads);
+    threads.resize (num_threads);
+    spawned.resize (num_threads, FALSE);
+    for (idx = 0; idx < jobs.size (); idx++)
+    {
+        jobs[idx].dict = this;
+        jobs[idx].first_shard = (unsigned int) idx;
+        jobs[idx].shard_step = (unsigned int) num_threads;
+        jobs[idx].top_k = top_k;
+    }
+    /*
+     * The calling thread takes the first job itself
+     */
+    for (idx = 1; idx < jobs.size (); idx++)
+    {
+        if (pthread_create (&threads[idx], NULL, topXThread,
+                            (void *) &jobs[idx]) == 0)
+        {
+            spawned[idx] = TRUE;
+        }
+        else
+        {
+            (void) topXThread ((void *) &jobs[idx]);
+        }
+    }
+    (void) topXThread ((void *) &jobs[0]);
+    for (idx = 0; idx < jobs.size (); idx++)
+    {
+        if (spawned[idx] == TRUE)
+        {
+            pthread_join (threads[idx], NULL);
+        }
+        top_list.insert (top_list.end (), jobs[idx].candidates.begin (),
+                         jobs[idx].candidates.end ());
+    }
+
+    if (top_k > top_list.size ())
+    {
+        top_k = top_list.size ();
+    }
+    partial_sort (top_list.begin (), top_list.begin () + top_k,
+                  top_list.end (), dictEntryRanksBefore);
+    top_list.resize (top_k);
+}
+
+/**
+ *******************************************************************************
+ * @brief selectPrefixTopX - Find the 'top_X_counts' highest counted words
+ * which start with a prefix.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      prefix         First byte of the prefix
+ *      @param[in]      len            Length of the prefix, 0 for every word
+ *      @param[in]      top_X_counts   How many words to select, -1 for all
+ *                                     of them.
+ *      @param[out]     top_list       Replaced with the selected entries,
+ *                                     ordered as by selectTopX().
+ *
+ * @par Pre/Post Conditions:
+ *      @post    As for selectTopX(), the entries point into the shards and
+ *               are only valid until the dictionary is next modified.
+ *
+ * @par Description:
+ *      Each shard's store selects its own best words under the prefix
+ *      (Dict_Store::selectPrefix()), which the radix backend does without
+ *      visiting subtrees that cannot make the list, then the per-shard lists
+ *      are merged.  An approximate dictionary picks from its heavy hitter
+ *      candidates, and a spilled one merges its runs (see spill()).
+ *******************************************************************************
+ */
+void Word_Dict::selectPrefixTopX (const char *prefix, size_t len,
+                                  int top_X_counts,
+                                  vector < Dict_Entry_t > &top_list)
+{
+    size_t top_k = (top_X_counts < 0) ? (size_t) -1 : (size_t) top_X_counts;
+    vector < Dict_Entry_t > candidates;
+    unsigned int shard_idx = 0;
+    size_t idx = 0;
+    Bool_t approx = FALSE;
+
+    top_list.clear ();
+    _lockShard (APPROX_SHARD);
+    if (_approx != NULL)
+    {
+        approx = TRUE;
+        _approx->getCandidates (candidates);
+    }
+    _unlockShard (APPROX_SHARD);
+    if ((approx == FALSE) && (_spill != NULL))
+    {
+        _selectSpilled (prefix, len, top_k, top_list);
+        return;
+    }
+    if (approx == TRUE)
+    {
+        for (idx = 0; idx < candidates.size (); idx++)
+        {
+            if ((candidates[idx].len >= len) &&
+                (memcmp (candidates[idx].word, prefix, len) == 0))
+            {
+                top_list.push_back (candidates[idx]);
+            }
+        }
+    }
+    else
+    {
+        for (shard_idx = 0; shard_idx < _numShards; shard_idx++)
+        {
+            _lockShard (shard_idx);
+            _shards[shard_idx].store->selectPrefix (prefix, len, top_k,
+                                                    candidates);
+            _unlockShard (shard_idx);
+            top_list.insert (top_list.end (), candidates.begin (),
+                             candidates.end ());
+        }
+    }
+
+    if (top_k > top_list.size ())
+    {
+        top_k = top_list.size ();
+    }
+    partial_sort (top_list.begin (), top_list.begin () + top_k,
+                  top_list.end (), dictEntryRanksBefore);
+    top_list.resize (top_k);
+}
+
+/**
+ *******************************************************************************
+ * @brief printTopX - Go through all of the dictionary entries, and print out
+ * the top 'top_X_counts' counts.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      top_X_counts   How many words to print, -1 for all of
+ *                                     them.
+ *      @param[in]      num_threads    Threads to select with, see
+ *                                     selectTopX().
+ *
+ * @par Description:
+ *      Equal counts are printed in word order.  The dictionary must not be
+ *      modified while this runs.  An approximate dictionary first prints a
+ *      line giving the error bound of the counts that follow, and can only
+ *      report as many words as it has heavy hitter candidates.
+ *******************************************************************************
+ */
+void Word_Dict::printTopX (int top_X_counts, int num_threads)
+{
+    vector < Dict_Entry_t > top_list;
+    size_t idx = 0;
+
+    if (_approx != NULL)
+    {
+        printf ("Approximate counts, %u x %u Count-Min Sketch over %lu words: "
+                "each is at most %lu too high, with probability %.6f\n",
+                _approx->width (), _approx->depth (),
+                (unsigned long) _approx->total (),
+                (unsigned long) _approx->errorBound (),
+                _approx->confidence ());
+    }
+    selectTopX (top_X_counts, top_list, num_threads);
+
+    for (idx = 0; idx < top_list.size (); idx++)
+    {
+        printf ("%.*s\t%d\n", (int) top_list[idx].len, top_list[idx].word,
+                top_list[idx].count);
+    }                           /* end for */
+}
+
+/**
+ *******************************************************************************
+ * @brief memoryUsage - Add the dictionary's memory, by component, into
+ * 'stats'.
+ *
+ * @par Description:
+ *      Each shard is measured under its own lock, every store keeps its
+ *      figures as it goes, so this costs a few reads per shard and can be
+ *      called while other threads are counting.
+ *******************************************************************************
+ */
+void Word_Dict::memoryUsage (Mem_Stats_t * stats)
+{
+    unsigned int idx = 0;
+
+    stats->bytes[MEM_INDEX] += _numShards * sizeof (Dict_Shard_t);
+    for (idx = 0; idx < _numShards; idx++)
+    {
+        _lockShard (idx);
+        _shards[idx].store->memoryUsage (stats);
+        stats->bytes[MEM_INDEX] +=
+            _shards[idx].leaders.capacity () * sizeof (Dict_Leader_t);
+        if (_shards[idx].view != NULL)
+        {
+            stats->bytes[MEM_SNAPSHOTS] += _shards[idx].view->bytesUsed ();
+        }
+        if ((idx == 0) && (_spill != NULL))
+        {
+            /* spill() holds every shard, so any one keeps _spill still */
+            stats->bytes[MEM_BUFFERS] += _spill->bytesUsed ();
+        }
+        if ((idx == APPROX_SHARD) && (_approx != NULL))
+        {
+            stats->bytes[MEM_SKETCHES] += _approx->bytesUsed ();
+        }
+        _unlockShard (idx);
+    }
+}
+
+/**
+ *******************************************************************************
+ * @brief setMemoryLimit - Set the memory budget checkMemoryLimit() holds the
+ * dictionary to.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      limit_bytes    Budget in bytes, 0 for no limit
+ *      @param[in]      policy         What to do on nearing the limit
+ *******************************************************************************
+ */
+void Word_Dict::setMemoryLimit (size_t limit_bytes, Mem_Policy_t policy)
+{
+    _memLimit = limit_bytes;
+    _memPolicy = policy;
+}
+
+/**
+ *******************************************************************************
+ * @brief checkMemoryLimit - Apply the memory limit policy if the dictionary,
+ * plus whatever else the caller is accountable for, is near the limit.
+ *
+ * <!-- Parameters -->
+ *      @param[in]      other_bytes    Memory outside the dictionary counted
+ *                                     against the same limit, such as read
+ *                                     buffers and queued work
+ *
+ * <!-- Returns -->
+ *      @return TRUE if the policy was applied.
+ *
+ * @par Pre/Post Conditions:
+ *      None (if entry/exit conditions do not apply)
+ *
+ * @par Global Data:
+ *      None (if no global data)
+ *
+ * @par Description:
+ *      Meant to be called often, between batches of updates: with no limit
+ *      set it returns at once, otherwise it measures the dictionary (see
+ *      memoryUsage()).  The policy is applied at MEM_LIMIT_HIGH_WATER_PCT of
+ *      the limit, so it takes effect before the limit is reached.
+ *
+ *      MEM_POLICY_PRUNE removes every word with a count below 2, then 4, 8 and
+ *      so on, until usage is back under MEM_LIMIT_LOW_WATER_PCT of the limit.
+ *      The dictionary may always keep half of that, so a limit mostly taken
+ *      up by 'other_bytes' does not prune it down to nothing.  Counts of the
+ *      words kept stay exact, but a pruned word seen again starts over, so it
+ *      may be under counted or missing from the results.
+ *
+ *      MEM_POLICY_APPROX moves every count into a sketch of fixed size (see
+ *      switchToApproximate()), sized to a share of the limit, after which the
+ *      limit needs no more checks.
+ *
+ *      MEM_POLICY_SPILL writes every count out to a sorted run on disk and
+ *      empties the dictionary (see spill()), so counts stay exact.  If the
+ *      run can't be written, the dictionary is pruned instead.
+ *
+ *      Only one thread applies the policy at a time, the others return
+ *      FALSE rather than wait.
+ *******************************************************************************
+ */
+Bool_t Word_Dict::checkMemoryLimit (size_t other_bytes)
+{
+    Bool_t applied = FALSE;
+    size_t used = 0;
+    size_t low_water = 0;
+    size_t target = 0;
+    int min_count = 0;
+    uint32_t width = 0;
+    Bool_t approx = FALSE;
+
+    if ((_memLimit == 0) || (_memPolicy == MEM_POLICY_NONE))
+    {
+        return (FALSE);
+    }
+    if ((_threadSafe == TRUE) && (pthread_mutex_trylock (&_memMut) != 0))
+    {
+        return (FALSE);
+    }
+
+    /* A sketch needs no more checks */
+    _lockShard (APPROX_SHARD);
+    approx = (_approx != NULL) ? TRUE : FALSE;
+    _unlockShard (APPROX_SHARD);
+    if (approx == FALSE)
+    {
+        used = _memoryTotal () + other_bytes;
+    }
+    if ((approx == FALSE) &&
+        (used >= (_memLimit / 100) * MEM_LIMIT_HIGH_WATER_PCT))
+    {
+        applied = TRUE;
+        if (_memPolicy == MEM_POLICY_APPROX)
+        {
+            /* Half of what pruning would aim for goes to the sketch */
+            width = (uint32_t) ((_memLimit / 100) * MEM_LIMIT_LOW_WATER_PCT /
+                                2 / (APPROX_DEFAULT_DEPTH *
+                                     sizeof (uint32_t)));
+            if (width < WORD_DICT_MIN_SKETCH_WIDTH)
+            {
+                width = WORD_DICT_MIN_SKETCH_WIDTH;
+            }
+            else if (width > APPROX_DEFAULT_WIDTH)
+            {
+                width = APPROX_DEFAULT_WIDTH;
+            }
+            switchToApproximate (width);
+        }
+        else if ((_memPolicy != MEM_POLICY_SPILL) || (spill () == FALSE))
+        {
+            low_water = (_memLimit / 100) * MEM_LIMIT_LOW_WATER_PCT;
+            target = (other_bytes < low_water / 2) ?
+                (low_water - other_bytes) : (low_water / 2);
+            used = _memoryTotal ();
+            for (min_count = 2; (used > target) && (size () > 0);
+                 min_count *= 2)
+            {
+                _prunedWords += prune (min_count);
+                if (min_count > _pruneFloor)
+                {
+                    _pruneFloor = min_count;
+                }
+                used = _memoryTotal ();
+            }
+        }
+    }
+
+    if (_threadSafe == TRUE)
+    {
+        (void) pthread_mutex_unlock (&_memMut);
+    }
+    return (applied);
+}
+
+/**
+ *******************************************************************************
+ * @brief prune - Remove every word with a count below 'min_count'.
+ *
+ * <!-- Returns -->
+ *      @return number of words removed, always 0 for an approximate
+ *      dictionary.
  *
  * @par Description:
- *      Using the class access lock, and iterator, return the next word and word
- *      count pair.  Requires that begin() be called prior to calling, and will 
- *      return a -1 word count, and empty string if at the end of the dictionary
- *      list.
+ *      Leaderboard entries for removed words go too.  A leaderboard holds a
+ *      shard's highest counts, so if any of it is pruned, so is every word not
+ *      on it, and what remains is still the shard's top words.
  *******************************************************************************
  */
-void Word_Dict::getNextWord (string & word, int *count)
+size_t Word_Dict::prune (int min_count)
 {
-    int _count = -1;
-    int stat = STATUS_SUCCESS;
+    unsigned int idx = 0;
+    size_t leader_idx = 0;
+    size_t removed = 0;
 
-    EXIT_ON_NULL_PTR (count, stat);
-    word = "";
     _lock ();
-    if (_it == _dictionaryMap.end ())
+    if (_approx != NULL)
     {
-        // fprintf(stderr, "[%s, %d:%s] failed to get next, iterator at end\n",
-        // __FILE__, __LINE__, __FUNCTION__);
+        _unlock ();
+        return (0);
     }
-    else
-    {
-        word = _it->first;
-        _count = _it->second;
-        ++_it;
-    }
-  cleanup:
-    if (count != NULL)
+    for (idx = 0; idx < _numShards; idx++)
     {
-        *count = _count;
+        vector < Dict_Leader_t > &leaders = _shards[idx].leaders;
+
+        _touchShard (idx);
+        removed += _shards[idx].store->prune (min_count);
+        for (leader_idx = leaders.size (); leader_idx > 0; leader_idx--)
+        {
+            if (leaders[leader_idx - 1].count < min_count)
+            {
+                leaders.erase (leaders.begin () + (leader_idx - 1));
+            }
+        }
+        _shards[idx].leaderMin = 0;
+        for (leader_idx = 0; leader_idx < leaders.size (); leader_idx++)
+        {
+            if ((leader_idx == 0) ||
+                (leaders[leader_idx].count < _shards[idx].leaderMin))
+            {
+                _shards[idx].leaderMin = leaders[leader_idx].count;
+            }
+        }
     }
+    _itShard = 0;
+    _itDone = FALSE;
+    _shards[0].store->rewind ();
     _unlock ();
-    return;
-  error:
-    goto cleanup;
 
+    return (removed);
 }
 
 /**
  *******************************************************************************
- * @brief hasWord - Search through dictionary to determine if word is contained.
- * and its count.
- *
- * <!-- Parameters -->
- *      @param[in]      word           String representation of word
- *
- * <!-- Returns -->
- *      @return TRUE if word is already in the dictionary.
- *      @return FALSE if word is not in the dictionary.
- *
- * @par Pre/Post Conditions:
- *      None (if entry/exit conditions do not apply)
- *
- * @par Global Data:
- *      None (if no global data)
+ * @brief switchToApproximate - Carry on counting approximately, starting from
+ * the exact counts so far.
  *
  * @par Description:
- *      Using the class access lock, search for the word, and if already present,
- *      return TRUE.
+ *      Every word's count is added to a new Approx_Counter of the given
+ *      shape, then the exact stores are emptied.  Unlike enableApproximate(),
+ *      no counts are lost, and it is safe while other threads are counting:
+ *      _approx is only set with every shard locked, and every reader which
+ *      may run alongside it checks _approx under a shard lock, so an update
+ *      waiting on its shard lock during the switch goes to the sketch once it
+ *      has the lock.
  *******************************************************************************
  */
-Bool_t Word_Dict::hasWord (string word)
+void Word_Dict::switchToApproximate (uint32_t width, uint32_t depth,
+                                     size_t num_candidates)
 {
-    std::map < string, int >::iterator it;
-    Bool_t found = FALSE;
-    string wordFound;
-
+    Approx_Counter *approx = NULL;
+    Dict_Store *store = NULL;
+    Dict_Entry_t entry;
+    unsigned int idx = 0;
 
     _lock ();
-    it = _dictionaryMap.find (word);
-    _unlock ();
-    if ((it != _dictionaryMap.end ()))
+    if (_approx == NULL)
     {
-        int count = -1;
-
-        found = TRUE;
-        wordFound = it->first;
-        count = it->second;
-        if (_showDebugOutput == TRUE)
+        approx = new Approx_Counter (width, depth, num_candidates);
+        for (idx = 0; idx < _numShards; idx++)
         {
-            printf ("%s => %d\n", wordFound.c_str (), count);
+            store = _shards[idx].store;
+            store->rewind ();
+            while (store->next (&entry) == TRUE)
+            {
+                (void) approx->add (entry.word, entry.len, entry.hash,
+                                    (uint32_t) entry.count);
+            }
+            _touchShard (idx);
+            store->clear ();
+            _shards[idx].leaders.clear ();
+            _shards[idx].leaderMin = 0;
         }
+        _approx = approx;
+        _itShard = 0;
+        _itDone = FALSE;
+        _shards[0].store->rewind ();
     }
-
-    return (found);
+    _unlock ();
 }
 
 /**
  *******************************************************************************
- * @brief incrementWordCount - Search through dictionary to determine if word is
- * contained, and if is present increment its word count.
- *
- * <!-- Parameters -->
- *      @param[in]      word           String representation of word
+ * @brief spill - Write every count out to a sorted run on disk, and empty the
+ * dictionary.
  *
  * <!-- Returns -->
- *      None (if return type is void)
- *
- * @par Pre/Post Conditions:
- *      None (if entry/exit conditions do not apply)
- *
- * @par Global Data:
- *      None (if no global data)
+ *      @return TRUE if the counts were spilled, FALSE if there were none, the
+ *      dictionary is approximate, or the run could not be written (the
+ *      counts are then kept).
  *
  * @par Description:
- *      Using the class access lock, search for the word, and if already present,
- *      increment its word count.
+ *      Counting carries on in memory, and the runs (see Dict_Spill) are
+ *      merged back in by selectTopX(), selectPrefixTopX(), getWordCount(),
+ *      size() and merge(), so every count stays exact.  Iteration, snapshots,
+ *      freeze() and the leaderboard only see the words counted since the
+ *      last spill.  Safe while other threads are counting.
  *******************************************************************************
  */
-void Word_Dict::incrementWordCount (string word)
+Bool_t Word_Dict::spill (void)
 {
-    std::map < string, int >::iterator it;
-
-    // char *wordFound = NULL;
-    // int count = -1;
+    vector < Dict_Entry_t > entries;
+    Bool_t spilled = FALSE;
+    unsigned int idx = 0;
 
     _lock ();
-
-    it = _dictionaryMap.find (word);
-    if (it != _dictionaryMap.end ())
+    if (_approx == NULL)
     {
-        it->second++;
-        // wordFound = it->first;
-        // count = it->second;
-        // count++;
-        // _dictionaryMap.erase(it);
-        // _dictionaryMap.insert(pair<string,int>(wordFound, count));
+        _gatherEntries (entries);
+    }
+    if (entries.empty () == false)
+    {
+        if (_spill == NULL)
+        {
+            _spill = new Dict_Spill ();
+        }
+        spilled = _spill->addRun (entries);
+    }
+    if (spilled == TRUE)
+    {
+        for (idx = 0; idx < _numShards; idx++)
+        {
+            _touchShard (idx);
+            _shards[idx].store->clear ();
+            _shards[idx].leaders.clear ();
+            _shards[idx].leaderMin = 0;
+        }
+        _itShard = 0;
+        _itDone = FALSE;
+        _shards[0].store->rewind ();
     }
-
     _unlock ();
 
-    return;
+    return (spilled);
 }
 
 /**
  *******************************************************************************
- * @brief print - Iterate through dictionary item list, and print the entries
- * out.
+ * @brief _gatherEntries - Every in-memory entry of every shard, in no
+ * particular order.  Called with the dictionary locked (_lock()).
  *******************************************************************************
  */
-void Word_Dict::print (void)
+void Word_Dict::_gatherEntries (vector < Dict_Entry_t > &entries)
 {
-    string word;
-    int wordCount = -1;
+    Dict_Store *store = NULL;
+    Dict_Entry_t entry;
+    unsigned int idx = 0;
 
-    printf ("Dumping word dictionary: =================================\n");
-    begin ();
-    do
+    entries.clear ();
+    for (idx = 0; idx < _numShards; idx++)
     {
-        getNextWord (word, &wordCount);
-        if (word != "")
+        store = _shards[idx].store;
+        store->rewind ();
+        while (store->next (&entry) == TRUE)
         {
-            std::cout << word << " => " << wordCount << '\n';
+            entries.push_back (entry);
         }
+        store->rewind ();
     }
-    while (word != "");
-    printf ("==========================================================\n");
-
-    return;
 }
 
 /**
  *******************************************************************************
- * @brief setDebug - Set current value of instance debug flag.
+ * @brief _selectSpilled - selectPrefixTopX() of a spilled dictionary, a
+ * k-way merge of the runs and the words in memory.
+ *
+ * @par Description:
+ *      Merged words are only valid until the merge moves on, so each one
+ *      kept is copied to a slot of _spillWords, the slot index standing in
+ *      for the entry's hash while in the heap.  A word pushed out of the heap
+ *      gives its slot to the word replacing it, so at most 'top_k' words are
+ *      ever copied, and they stay valid until the next selection.
  *******************************************************************************
  */
-void Word_Dict::setDebug (Bool_t enabled)
+void Word_Dict::_selectSpilled (const char *prefix, size_t len, size_t top_k,
+                                vector < Dict_Entry_t > &top_list)
 {
+    vector < Dict_Entry_t > extra;
+    Dict_Entry_t entry;
+    size_t slot = 0;
+    size_t idx = 0;
+
+    top_list.clear ();
+    _spillWords.clear ();
+    if (top_k == 0)
+    {
+        return;
+    }
     _lock ();
-    _showDebugOutput = enabled;
+    _gatherEntries (extra);
+    sort (extra.begin (), extra.end (), dictEntryWordBefore);
+    _spill->rewind (&extra);
+    while (_spill->next (&entry) == TRUE)
+    {
+        if ((len > 0) &&
+            ((entry.len < len) || (memcmp (entry.word, prefix, len) != 0)))
+        {
+            continue;
+        }
+        if (top_list.size () < top_k)
+        {
+            slot = _spillWords.size ();
+            _spillWords.push_back (string (entry.word, entry.len));
+        }
+        else if (dictEntryRanksBefore (entry, top_list.front ()))
+        {
+            pop_heap (top_list.begin (), top_list.end (),
+                      dictEntryRanksBefore);
+            slot = top_list.back ().hash;
+            top_list.pop_back ();
+            _spillWords[slot].assign (entry.word, entry.len);
+        }
+        else
+        {
+            continue;
+        }
+        entry.word = _spillWords[slot].data ();
+        entry.hash = (Word_Hash_t) slot;
+        top_list.push_back (entry);
+        push_heap (top_list.begin (), top_list.end (), dictEntryRanksBefore);
+    }
     _unlock ();
+
+    sort_heap (top_list.begin (), top_list.end (), dictEntryRanksBefore);
+    for (idx = 0; idx < top_list.size (); idx++)
+    {
+        top_list[idx].hash = wordHash (top_list[idx].word, top_list[idx].len);
+    }
 }
 
 /**
  *******************************************************************************
- * @brief getDebug - Get current value of instance debug flag.
+ * @brief _memoryTotal - Bytes used by the dictionary, all components.
  *******************************************************************************
  */
-Bool_t Word_Dict::getDebug (void)
+size_t Word_Dict::_memoryTotal (void)
 {
-    Bool_t isEnabled = FALSE;
+    Mem_Stats_t stats;
 
-    _lock ();
-    isEnabled = _showDebugOutput;
-    _unlock ();
-    return (isEnabled);
+    memStatsClear (&stats);
+    memoryUsage (&stats);
+    return (memStatsTotal (&stats));
 }
 
-int Word_Dict::getWordCount (char *word)
+/**
+ *******************************************************************************
+ * @brief mergeDictionaries - Combine an array of dictionaries into the first
+ * one, using a parallel tree reduction.
+ *
+ * <!-- Parameters -->
+ *      @param[in,out]  dicts          Array of dictionaries to combine.
+ *      @param[in]      num_dicts      Number of entries in 'dicts'
+ *
+ * <!-- Returns -->
+ *      @return dicts[0], now holding the combined counts (NULL if no dicts).
+ *
+ * @par Pre/Post Conditions:
+ *      @pre     No thread is still modifying any of the dictionaries.
+ *      @post    dicts[1..num_dicts-1] are left empty, but not deleted.
+ *
+ * @par Global Data:
+ *      None (if no global data)
+ *
+ * @par Algorithm:
+ *      In round R (stride S = 2^R), dicts[i + S] is merged into dicts[i] for
+ *      every i that is a multiple of 2S, each pair on its own thread.  Pairs in
+ *      a round are disjoint, so no two threads touch the same dictionary, and
+ *      the whole reduction takes ceil(log2(num_dicts)) rounds.
+ *******************************************************************************
+ */
+Word_Dict *mergeDictionaries (Word_Dict ** dicts, int num_dicts)
 {
-    int _word_count = -1;
-
-    _lock ();
-    std::map < string, int >::iterator it = _dictionaryMap.find (word);
+    int stride = 1;
+    int idx = 0;
+    int num_pairs = 0;
+    int stat = 0;
+    vector < pthread_t > threads;
+    vector < Dict_Merge_Pair_t > pairs;
 
-    if (it != _dictionaryMap.end ())
+    if ((dicts == NULL) || (num_dicts < 1))
     {
-        _word_count = it->second;
+        return (NULL);
     }
-    _unlock ();
+    for (stride = 1; stride < num_dicts; stride *= 2)
+    {
+        pairs.clear ();
+        for (idx = 0; idx + stride < num_dicts; idx += 2 * stride)
+        {
+            Dict_Merge_Pair_t pair_args;
 
-    return (_word_count);
+            pair_args.dst = dicts[idx];
+            pair_args.src = dicts[idx + stride];
+            pairs.push_back (pair_args);
+        }
+        num_pairs = (int) pairs.size ();
+        threads.resize (num_pairs);
+        for (idx = 0; idx < num_pairs; idx++)
+        {
+            stat = pthread_create (&threads[idx], NULL, mergeThread,
+                                   (void *) &pairs[idx]);
+            if (stat != 0)
+            {
+                /*
+                 * Couldn't get a thread, do this pair on the calling thread 
+                 */
+                (void) mergeThread ((void *) &pairs[idx]);
+                pairs[idx].src = NULL;
+            }
+        }
+        for (idx = 0; idx < num_pairs; idx++)
+        {
+            if (pairs[idx].src != NULL)
+            {
+                pthread_join (threads[idx], NULL);
+            }
+        }
+    }
+
+    return (dicts[0]);
 }
 
-#if 0
+/*******************************************************************************
+ ************************ L O C A L  F U N C T I O N S *************************
+ *******************************************************************************
+ */
+
 /**
  *******************************************************************************
- * @brief wordCmp - Comparitor for sort
+ * @brief leaderRanksBefore - Leaderboard ordering, highest count first, ties
+ * in word order.
  *******************************************************************************
  */
-/*
- * If we were sorting in least count to most count, we'd use this 
+static bool leaderRanksBefore (const Dict_Leader_t & left,
+                               const Dict_Leader_t & right)
+{
+    if (left.count != right.count)
+    {
+        return (left.count > right.count);
+    }
+    return (left.word < right.word);
+}
+
+/**
+ *******************************************************************************
+ * @brief entryHashBefore - Hash order of entries, which is also the order of
+ * the shards they belong to, see merge().
+ *******************************************************************************
  */
-bool wordCmp (const pair < string, int >&left_count, const pair < string,
-              int >&right_count)
+static bool entryHashBefore (const Dict_Entry_t & left,
+                             const Dict_Entry_t & right)
 {
-    return (left_count.second < right_count.second);
+    return (left.hash < right.hash);
 }
-#endif
 
 /**
  *******************************************************************************
- * @brief wordRevCmp - Comparitor for sort, reversed ordering
+ * @brief topXThread - Run one selectTopX job, selecting candidates from its
+ * share of the shards.
  *******************************************************************************
  */
-bool wordRevCmp (const pair < string, int >&left_count, const pair < string,
-                 int >&right_count)
+static void *topXThread (void *arg)
 {
-    return (left_count.second > right_count.second);
+    Dict_TopX_Job_t *job = (Dict_TopX_Job_t *) arg;
+
+    job->dict->selectShardTopX (job->first_shard, job->shard_step,
+                                job->top_k, job->candidates);
+
+    return (NULL);
 }
 
+/**
+ *******************************************************************************
+ * @brief mergeThread - Merge one pair of dictionaries for mergeDictionaries,
+ * emptying the source once its counts have been folded in.
+ *******************************************************************************
+ */
+static void *mergeThread (void *arg)
+{
+    Dict_Merge_Pair_t *pair_args = (Dict_Merge_Pair_t *) arg;
+
+    pair_args->dst->merge (*pair_args->src);
+    pair_args->src->clear ();
+
+    return (NULL);
+}
 
+#if defined(TEST)
 /**
  *******************************************************************************
- * @brief printTopX - Go through all of the dictionary entries, and print out
- * the top 'top_X_counts' counts.
+ * @brief shardedIncrementThread - Worker for wordDictShardedThreads, hammers
+ * the same few words from several threads at once.
  *******************************************************************************
  */
-void Word_Dict::printTopX (int top_X_counts)
+static void *shardedIncrementThread (void *arg)
 {
-    vector< pair<string,int>   > top_list;
-    string word;
-    int wordCount = -1;
-    int top_count = top_X_counts;
+    Word_Dict *dict = (Word_Dict *) arg;
+    int loop = 0;
 
-    /*
-     * Put dictionary entries into vector for sorting 
-     */
-    begin ();
-    do
+    for (loop = 0; loop < SHARD_TEST_LOOPS; loop++)
     {
-        getNextWord (word, &wordCount);
-        if (word.empty () == false)
-        {
-            top_list.push_back (pair < string, int >(word, wordCount));
-        }
+        dict->incrementWordCount (APPLES);
+        dict->incrementWordCount (ORANGES);
+        dict->incrementWordCount (CHERRIES);
     }
-    while (word != "");
+    return (NULL);
+}
 
-    /*
-     * Special cue to print them all, as sorted 
-     */
-    if (top_count == -1)
+/**
+ *******************************************************************************
+ * @brief upsertThread - Worker for wordDictAddOrIncrementThreads, upserts
+ * words which may or may not exist yet, one at a time and in batches.
+ *******************************************************************************
+ */
+static void *upsertThread (void *arg)
+{
+    Word_Dict *dict = (Word_Dict *) arg;
+    string batch[] = { PEARS };
+    int loop = 0;
+
+    for (loop = 0; loop < SHARD_TEST_LOOPS; loop++)
     {
-        top_count = top_list.size ();
+        dict->addOrIncrement (APPLES);
+        dict->addOrIncrement (batch, 1);
     }
+    return (NULL);
+}
 
-
-    // sort (top_list.begin(), top_list.end(), wordCmp);
-    sort (top_list.begin (), top_list.end (), wordRevCmp);
-
-    int idx = 0;
-
-    for (vector < pair < string, int > >::iterator it = top_list.begin ();
-         ((it != top_list.end ()) && (idx < top_count)); ++it, idx++)
-
+/**
+ *******************************************************************************
+ * @brief snapshotReaderThread - Worker for wordDictSnapshotThreads, reads
+ * snapshots while upsertThread writers run.
+ *
+ * <!-- Returns -->
+ *      @return NULL if every snapshot was consistent, non-NULL otherwise.
+ *******************************************************************************
+ */
+static void *snapshotReaderThread (void *arg)
+{
+    static const int NUM_SNAPSHOTS = 200;
+    Word_Dict *dict = (Word_Dict *) arg;
+    Dict_Snapshot *snap = NULL;
+    Dict_Entry_t entry;
+    int last_apples = 0;
+    int apples = 0;
+    int loop = 0;
+    void *result = NULL;
+
+    for (loop = 0; (loop < NUM_SNAPSHOTS) && (result == NULL); loop++)
     {
-        // printf ("[%d]  %s => %d\n", idx + 1, it->first.c_str(), it->second);
-        printf ("%s\t%d\n", it->first.c_str (), it->second);
-    }                           /* end for */
+        snap = dict->snapshot ();
+
+        /* Counts only go up, and iteration agrees with lookup */
+        apples = snap->getWordCount (APPLES, strlen (APPLES));
+        if (apples < last_apples)
+        {
+            result = (void *) snap;
+        }
+        last_apples = apples;
+        snap->begin ();
+        while (snap->getNextEntry (&entry) == TRUE)
+        {
+            if (snap->getWordCount (entry.word, entry.len) != entry.count)
+            {
+                result = (void *) snap;
+            }
+        }
+        delete snap;
+    }
+    return (result);
 }
 
-/*******************************************************************************
- ************************ L O C A L  F U N C T I O N S *************************
+/**
+ *******************************************************************************
+ * @brief leaderboardReaderThread - Worker for wordDictSwitchThreads, reads
+ * the leaderboard, size and counts while upsertThread writers run.
+ *
+ * <!-- Returns -->
+ *      @return NULL if every read was consistent, non-NULL otherwise.
  *******************************************************************************
  */
+static void *leaderboardReaderThread (void *arg)
+{
+    static const int NUM_READS = 2000;
+    Word_Dict *dict = (Word_Dict *) arg;
+    vector < pair < string, int > >leaders;
+    size_t idx = 0;
+    int loop = 0;
+    void *result = NULL;
+
+    for (loop = 0; (loop < NUM_READS) && (result == NULL); loop++)
+    {
+        (void) dict->getLeaderboard (leaders);
+        for (idx = 0; idx < leaders.size (); idx++)
+        {
+            if (leaders[idx].second < 1)
+            {
+                result = arg;
+            }
+        }
+        if ((dict->size () == 0) ||
+            (dict->getWordCount ((char *) "cold7") < 1))
+        {
+            result = arg;
+        }
+    }
+    return (result);
+}
+#endif /* defined(TEST) */
@@ -40,14 +40,22 @@
  *******************************************************************************
  */
 #include <pthread.h>            /* for pthread_* calls */
+#include <deque>
 #include <map>
 #include <string>
+#include <vector>
 
 /*******************************************************************************
  * Project Includes
  *******************************************************************************
  */
 #include "common_types.h"
+#include "word_hash.h"
+#include "dict_store.hpp"
+#include "approx_counter.hpp"
+#include "dict_snapshot.hpp"
+#include "frozen_dict.hpp"
+#include "dict_spill.hpp"
 
 #if defined(TEST)
 extern "C"
@@ -60,6 +68,26 @@ extern "C"
     void wordDictGoodFind (void);
     void wordDictGoodMiss (void);
     void wordDictGoodIncrement (void);
+    void wordDictShardedIterItems (void);
+    void wordDictShardedThreads (void);
+    void wordDictAddOrIncrement (void);
+    void wordDictAddOrIncrementBatch (void);
+    void wordDictAddOrIncrementThreads (void);
+    void wordDictMerge (void);
+    void wordDictMergeTree (void);
+    void wordDictHashBackend (void);
+    void wordDictTopX (void);
+    void wordDictTopXAll (void);
+    void wordDictLeaderboard (void);
+    void wordDictLeaderboardSeed (void);
+    void wordDictApproximate (void);
+    void wordDictSnapshot (void);
+    void wordDictSnapshotThreads (void);
+    void wordDictPrefixTopX (void);
+    void wordDictMemoryUsage (void);
+    void wordDictMemoryLimit (void);
+    void wordDictSpill (void);
+    void wordDictSwitchThreads (void);
 }
 #endif                          /* defined(TEST) */
 
@@ -72,6 +100,10 @@ extern "C"
  * Constants
  *******************************************************************************
  */
+/** Shard count giving the original single-lock dictionary behavior */
+#define WORD_DICT_DEFAULT_SHARDS (1)
+/** Upper bound on the number of independently locked dictionary shards */
+#define WORD_DICT_MAX_SHARDS     (4096)
 
 /*******************************************************************************
  * Structures
@@ -79,10 +111,38 @@ extern "C"
  */
 using namespace std;
 
+/** One word on a shard's live leaderboard */
+typedef struct
+{
+    string word;                /**< Copy of the word */
+    Word_Hash_t hash;           /**< wordHash() of word */
+    int count;                  /**< Count as of the word's last update */
+} Dict_Leader_t;
+
+/**
+ * One independently locked slice of the dictionary.  Words are assigned to a
+ * shard by their hash, so threads working on different words rarely contend.
+ */
+typedef struct
+{
+    pthread_mutex_t mut;                /**< Lock protecting store and
+                                          leaders */
+    Dict_Store *store;                  /**< Words owned by this shard */
+    vector < Dict_Leader_t > leaders;   /**< This shard's top words, unordered,
+                                          empty if the leaderboard is off */
+    int leaderMin;                      /**< Lowest count in leaders */
+    Dict_Shard_View *view;              /**< Copy of store handed to
+                                          snapshots, NULL once store changes */
+    char pad[64];                       /**< Keep neighboring shard locks off
+                                          the same cache line */
+} Dict_Shard_t;
+
 class Word_Dict
 {
   public:
-    Word_Dict (void);
+    Word_Dict (unsigned int num_shards = WORD_DICT_DEFAULT_SHARDS,
+               Bool_t thread_safe = TRUE,
+               Dict_Backend_t backend = DICT_BACKEND_MAP);
       virtual ~ Word_Dict (void);
     void lock (void);
     void unlock (void);
@@ -93,36 +153,143 @@ class Word_Dict
 
     // void insertWord(char *word, int count);
     void insertWord (string word, int count);
-    map < string, int >&getMap (void)
+    map < string, int >*getMap (unsigned int shard_idx = 0);
+    unsigned int getNumShards (void)
+    {
+        return (this->_numShards);
+    };
+    Bool_t isThreadSafe (void)
+    {
+        return (this->_threadSafe);
+    };
+    Dict_Backend_t getBackend (void)
     {
-        return (this->_dictionaryMap);
+        return (this->_backend);
     };
     void begin (void);
     void end (void);
     void getNextWord (string & word, int *count);
+    Bool_t getNextEntry (Dict_Entry_t * entry);
 
     // Bool_t hasWord(char *word);
     Bool_t hasWord (string word);
 
     // void incrementWordCount(char *word);
     void incrementWordCount (string word);
+    int addOrIncrement (const string & word, int delta = 1);
+    int addOrIncrement (const char *word, size_t len, Word_Hash_t hash,
+                        int delta = 1);
+    void addOrIncrement (const string * words, size_t num_words,
+                         int delta = 1);
     void print (void);
     void setDebug (Bool_t enabled);
     Bool_t getDebug (void);
     int getWordCount (char *word);
-    void printTopX (int top_X_counts);
+    int getWordCount (const char *word, size_t len);
+    void printTopX (int top_X_counts, int num_threads = 1);
+    void selectTopX (int top_X_counts, vector < Dict_Entry_t > &top_list,
+                     int num_threads = 1);
+    void selectShardTopX (unsigned int first_shard, unsigned int shard_step,
+                          size_t top_k, vector < Dict_Entry_t > &candidates);
+    void selectPrefixTopX (const char *prefix, size_t len, int top_X_counts,
+                           vector < Dict_Entry_t > &top_list);
+    void merge (Word_Dict & other);
+    void enableApproximate (uint32_t width = APPROX_DEFAULT_WIDTH,
+                            uint32_t depth = APPROX_DEFAULT_DEPTH,
+                            size_t num_candidates =
+                            APPROX_DEFAULT_CANDIDATES);
+    Bool_t isApproximate (void)
+    {
+        return ((this->_approx != NULL) ? TRUE : FALSE);
+    };
+    Approx_Counter *getApproxCounter (void)
+    {
+        return (this->_approx);
+    };
+    void enableLeaderboard (size_t top_n);
+    size_t getLeaderboard (vector < pair < string, int > >&leaders);
+    Dict_Snapshot *snapshot (void);
+    Frozen_Dict *freeze (Bool_t perfect_hash = TRUE);
+    void clear (void);
+    size_t size (void);
+    void memoryUsage (Mem_Stats_t * stats);
+    void setMemoryLimit (size_t limit_bytes, Mem_Policy_t policy);
+    size_t getMemoryLimit (void)
+    {
+        return (this->_memLimit);
+    };
+    Mem_Policy_t getMemoryPolicy (void)
+    {
+        return (this->_memPolicy);
+    };
+    Bool_t checkMemoryLimit (size_t other_bytes = 0);
+    size_t prune (int min_count);
+    void switchToApproximate (uint32_t width = APPROX_DEFAULT_WIDTH,
+                              uint32_t depth = APPROX_DEFAULT_DEPTH,
+                              size_t num_candidates =
+                              APPROX_DEFAULT_CANDIDATES);
+    size_t getPrunedWords (void)
+    {
+        return (this->_prunedWords);
+    };
+    int getPruneFloor (void)
+    {
+        return (this->_pruneFloor);
+    };
+    Bool_t spill (void);
+    size_t getSpilledRuns (void)
+    {
+        return ((this->_spill != NULL) ? this->_spill->numRuns () : 0);
+    };
+    uint64_t getSpilledBytes (void)
+    {
+        return ((this->_spill != NULL) ? this->_spill->bytesWritten () : 0);
+    };
 
 
   private:
     Bool_t _mut_init;
     Bool_t _is_locked;
+    Bool_t _threadSafe;
+    Dict_Backend_t _backend;
     pthread_mutex_t _mut;
-    map < string, int >_dictionaryMap;
-    map < string, int >::iterator _it;
+    Dict_Shard_t *_shards;
+    unsigned int _numShards;
+    unsigned int _itShard;
+    Bool_t _itDone;
     Bool_t _showDebugOutput;
+    size_t _leaderboardSize;
+    Approx_Counter *_approx;
+    pthread_mutex_t _memMut;
+    size_t _memLimit;
+    Mem_Policy_t _memPolicy;
+    size_t _prunedWords;
+    int _pruneFloor;
+    Dict_Spill *_spill;
+    deque < string > _spillWords;
 
     void _lock (void);
     void _unlock (void);
+    void _lockShard (unsigned int shard_idx);
+    void _unlockShard (unsigned int shard_idx);
+    void _lockApproxFrom (unsigned int shard_idx);
+    unsigned int _shardFor (Word_Hash_t hash);
+    /* Called with the shard locked, before its store is modified */
+    void _touchShard (unsigned int shard_idx)
+    {
+        if (this->_shards[shard_idx].view != NULL)
+        {
+            this->_shards[shard_idx].view->release ();
+            this->_shards[shard_idx].view = NULL;
+        }
+    };
+    int _approxCount (uint32_t estimate);
+    size_t _memoryTotal (void);
+    void _gatherEntries (vector < Dict_Entry_t > &entries);
+    void _selectSpilled (const char *prefix, size_t len, size_t top_k,
+                         vector < Dict_Entry_t > &top_list);
+    void _updateLeaders (unsigned int shard_idx, const char *word, size_t len,
+                         Word_Hash_t hash, int count);
 };
 
 /*******************************************************************************
@@ -134,6 +301,7 @@ class Word_Dict
  * External Function Prototypes
  *******************************************************************************
  */
+Word_Dict *mergeDictionaries (Word_Dict ** dicts, int num_dicts);
 
 /*******************************************************************************
  * Global Variables
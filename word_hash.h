@@ -0,0 +1,222 @@
+#ifndef __WORD_HASH_H__
+#define __WORD_HASH_H__
+/**
+ * @file           word_hash.h
+ * @brief:         Hash function shared by the dictionary and tokenizer.
+ * @verbatim
+ *******************************************************************************
+ * Author:         Douglas L. Potts
+ *
+ * Date:           10/17/2026, <SCR #>
+ *
+ *==============================================================================
+ *==============================================================================
+ * Copyright (c) 2015 Douglas Lee Potts
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ *==============================================================================
+ *==============================================================================
+ *
+ * History:
+ * Date        SCR #  Name  Description
+ * -----------------------------------------------------------------------------
+ *
+ *******************************************************************************
+ * @endverbatim
+ */
+
+/*******************************************************************************
+ * System Includes
+ *******************************************************************************
+ */
+#include <stddef.h>             /* for size_t */
+#include <stdint.h>             /* for uint32_t, UINT64_C */
+#include <string.h>             /* for memcpy() */
+
+/*******************************************************************************
+ * Project Includes
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * Typedefs
+ *******************************************************************************
+ */
+typedef uint32_t Word_Hash_t;
+#if defined(__SIZEOF_INT128__)
+__extension__ typedef unsigned __int128 Word_Hash_Wide_t;
+#endif
+
+/*******************************************************************************
+ * Constants
+ *******************************************************************************
+ */
+#define WORD_HASH_FNV64_OFFSET (UINT64_C (14695981039346656037))
+#define WORD_HASH_FNV64_PRIME  (UINT64_C (1099511628211))
+/** Odd constants with well spread bits for wordHash(), as used by wyhash */
+#define WORD_HASH_SEED         (UINT64_C (0xa0761d6478bd642f))
+#define WORD_HASH_P1           (UINT64_C (0xe7037ed1a0b428db))
+#define WORD_HASH_P2           (UINT64_C (0x8ebc6af09c88c6e3))
+#define WORD_HASH_P3           (UINT64_C (0x589965cc75374cc3))
+
+/*******************************************************************************
+ * External Function Prototypes
+ *******************************************************************************
+ */
+
+/**
+ *******************************************************************************
+ * @brief wordHashMum - Multiply two 64-bit values to 128 bits, and fold the
+ * halves together with XOR.
+ *******************************************************************************
+ */
+static inline uint64_t wordHashMum (uint64_t left, uint64_t right)
+{
+#if defined(__SIZEOF_INT128__)
+    Word_Hash_Wide_t product = (Word_Hash_Wide_t) left * right;
+
+    return ((uint64_t) product ^ (uint64_t) (product >> 64));
+#else
+    uint64_t lo_lo = (left & 0xFFFFFFFFU) * (right & 0xFFFFFFFFU);
+    uint64_t hi_lo = (left >> 32) * (right & 0xFFFFFFFFU);
+    uint64_t lo_hi = (left & 0xFFFFFFFFU) * (right >> 32);
+    uint64_t hi_hi = (left >> 32) * (right >> 32);
+    uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFFU) + lo_hi;
+
+    return (((cross << 32) | (lo_lo & 0xFFFFFFFFU)) ^
+            (hi_hi + (hi_lo >> 32) + (cross >> 32)));
+#endif
+}
+
+/**
+ *******************************************************************************
+ * @brief wordHashBlock - Mix the next (up to) 8 bytes of a word, loaded as
+ * one integer, into a wordHash() in progress.
+ *******************************************************************************
+ */
+static inline uint64_t wordHashBlock (uint64_t hash, uint64_t block)
+{
+    return (wordHashMum (block ^ WORD_HASH_P1, hash ^ WORD_HASH_P2));
+}
+
+/**
+ *******************************************************************************
+ * @brief wordHashFinish - Mix the length into a wordHash() in progress and
+ * fold it to 32 bits.
+ *******************************************************************************
+ */
+static inline Word_Hash_t wordHashFinish (uint64_t hash, size_t len)
+{
+    hash = wordHashMum (hash ^ WORD_HASH_P3, (uint64_t) len ^ WORD_HASH_P1);
+    return ((Word_Hash_t) (hash ^ (hash >> 32)));
+}
+
+/**
+ *******************************************************************************
+ * @brief wordHash - 32-bit hash of 'len' bytes starting at 'word'.
+ *
+ * @par Description:
+ *      Every component which picks a dictionary shard or table slot for a word
+ *      must go through this function, so that a hash computed in one place can
+ *      be handed to another without being recomputed.
+ *
+ *      wyhash style: each 8 bytes, the last block zero padded, are loaded as
+ *      one integer and mixed in with a 64 x 64 -> 128-bit multiply, then the
+ *      length is mixed in (so padding can't collide with a real zero byte).
+ *      A few multiplies per word, where FNV-1a had a dependent multiply per
+ *      byte.  Only used within one run, so the byte order of the loads does
+ *      not matter.  The tokenizer computes the same hash while it case-folds
+ *      (see wordHashBlock()), and must stay in step with this.
+ *******************************************************************************
+ */
+static inline Word_Hash_t wordHash (const char *word, size_t len)
+{
+    uint64_t hash = WORD_HASH_SEED;
+    uint64_t block = 0;
+    size_t idx = 0;
+
+    for (idx = 0; idx + 8 <= len; idx += 8)
+    {
+        memcpy (&block, word + idx, 8);
+        hash = wordHashBlock (hash, block);
+    }
+    if (idx < len)
+    {
+        block = 0;
+        memcpy (&block, word + idx, len - idx);
+        hash = wordHashBlock (hash, block);
+    }
+
+    return (wordHashFinish (hash, len));
+}
+
+/**
+ *******************************************************************************
+ * @brief wordHash64 - 64-bit FNV-1a hash of 'len' bytes starting at 'word'.
+ *
+ * @par Description:
+ *      For structures which need distinct words to have distinct hashes, such
+ *      as a perfect hash, where the 32-bit wordHash() would collide somewhere
+ *      in any vocabulary of more than a few tens of thousands of words.
+ *******************************************************************************
+ */
+static inline uint64_t wordHash64 (const char *word, size_t len)
+{
+    uint64_t hash = WORD_HASH_FNV64_OFFSET;
+    size_t idx = 0;
+
+    for (idx = 0; idx < len; idx++)
+    {
+        hash ^= (unsigned char) word[idx];
+        hash *= WORD_HASH_FNV64_PRIME;
+    }
+
+    return (hash);
+}
+
+/**
+ *******************************************************************************
+ * @brief wordHashMix - Murmur3 finalizer, derives a second, well mixed hash
+ * from a word hash.
+ *
+ * @par Description:
+ *      For sketches which need an extra hash, or need every bit of the hash to
+ *      be equally random, without going back over the word's bytes.
+ *******************************************************************************
+ */
+static inline uint32_t wordHashMix (Word_Hash_t hash)
+{
+    hash ^= hash >> 16;
+    hash *= 0x85EBCA6BU;
+    hash ^= hash >> 13;
+    hash *= 0xC2B2AE35U;
+    hash ^= hash >> 16;
+    return (hash);
+}
+
+/**
+ *******************************************************************************
+ * @brief wordHashRange - Map a word hash onto 0..range-1 using its high bits
+ * (multiply-shift range reduction).
+ *
+ * @par Description:
+ *      Picks a word's dictionary shard.  Tables index with the low bits, so
+ *      the two choices stay independent.
+ *******************************************************************************
+ */
+static inline unsigned int wordHashRange (Word_Hash_t hash, unsigned int range)
+{
+    return ((unsigned int) (((uint64_t) hash * range) >> 32));
+}
+
+#endif /* __WORD_HASH_H__ */
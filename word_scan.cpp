@@ -0,0 +1,435 @@
+/**
+ * @file           word_scan.cpp
+ * @brief:         Word character classification, 64 bytes at a time.
+ * @verbatim
+ *******************************************************************************
+ * Author:         Douglas L. Potts
+ *
+ * Date:           10/17/2026, <SCR #>
+ *
+ *==============================================================================
+ *==============================================================================
+ * Copyright (c) 2015 Douglas Lee Potts
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ *==============================================================================
+ *==============================================================================
+ *
+ * History:
+ * Date        SCR #  Name  Description
+ * -----------------------------------------------------------------------------
+ *
+ *******************************************************************************
+ * @endverbatim
+ */
+
+/*******************************************************************************
+ * System Includes
+ *******************************************************************************
+ */
+#include <pthread.h>            /* for pthread_once() */
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>          /* for SSE2, AVX2 and AVX-512 intrinsics */
+#define WORD_SCAN_X86 (1)
+#endif
+
+/*******************************************************************************
+ * Project Includes
+ *******************************************************************************
+ */
+#include "common_types.h"
+#include "word_scan.hpp"
+#if defined(TEST)
+#include "unity.h"
+#endif /* defined(TEST) */
+
+/*******************************************************************************
+ * Local Function Prototypes 
+ *******************************************************************************
+ */
+static void _select_kernel (void);
+static uint64_t _scan_scalar (const char *block);
+#if defined(WORD_SCAN_X86)
+static uint64_t _scan_sse2 (const char *block);
+static uint64_t _scan_avx2 (const char *block);
+static uint64_t _scan_avx512 (const char *block);
+#endif
+
+/*******************************************************************************
+ * Local Constants 
+ *******************************************************************************
+ */
+#define DBG(X)
+
+/*******************************************************************************
+ * File Scoped Variables 
+ *******************************************************************************
+ */
+
+/** Kernel in use, picked once by _select_kernel() */
+static pthread_once_t g_scanOnce = PTHREAD_ONCE_INIT;
+static Word_Scan_Kernel_t g_scanKernel = WORD_SCAN_SCALAR;
+static Word_Scan_Fn_t g_scanFn = _scan_scalar;
+
+/** Every kernel, indexed by Word_Scan_Kernel_t, NULL if not built */
+static const Word_Scan_Fn_t g_scanFns[WORD_SCAN_NUM_KERNELS] = {
+    _scan_scalar,
+#if defined(WORD_SCAN_X86)
+    _scan_sse2,
+    _scan_avx2,
+    _scan_avx512
+#else
+    NULL,
+    NULL,
+    NULL
+#endif
+};
+
+/*******************************************************************************
+ ********************* E X T E R N A L  F U N C T I O N S **********************
+ *******************************************************************************
+ */
+
+#if defined(TEST)
+extern "C"
+{
+    void wordScanKernels (void)
+    {
+        static const size_t BUF_LEN = 4 * WORD_SCAN_BLOCK;
+        Word_Scan_Kernel_t original = wordScanKernel ();
+        char buffer[BUF_LEN];
+        uint64_t expected = 0;
+        uint32_t seed = 12345;
+        size_t offset = 0;
+        size_t idx = 0;
+        int kernel = 0;
+        unsigned char byte = 0;
+
+        /*
+         * Every byte value turns up, including either side of each range
+         */
+        for (idx = 0; idx < BUF_LEN; idx++)
+        {
+            seed = seed * 1103515245U + 12345U;
+            buffer[idx] = (char) ((idx < 256) ? idx : (seed >> 16));
+        }
+        for (idx = 0; idx < BUF_LEN / 2; idx++)
+        {
+            seed = seed * 1103515245U + 12345U;
+            byte = (unsigned char) buffer[idx];
+            buffer[idx] = buffer[(seed >> 8) % BUF_LEN];
+            buffer[(seed >> 8) % BUF_LEN] = (char) byte;
+        }
+
+        TEST_ASSERT_TRUE (wordScanSupported (WORD_SCAN_SCALAR) == TRUE);
+        TEST_ASSERT_TRUE (wordScanSetKernel (WORD_SCAN_NUM_KERNELS) == FALSE);
+        for (kernel = WORD_SCAN_SCALAR; kernel < WORD_SCAN_NUM_KERNELS;
+             kernel++)
+        {
+            if (wordScanSetKernel ((Word_Scan_Kernel_t) kernel) == FALSE)
+            {
+                printf ("  %s: not supported here\n",
+                        wordScanKernelName ((Word_Scan_Kernel_t) kernel));
+                continue;
+            }
+            TEST_ASSERT_EQUAL (wordScanKernel (), kernel);
+            for (offset = 0; offset + WORD_SCAN_BLOCK <= BUF_LEN; offset++)
+            {
+                expected = 0;
+                for (idx = 0; idx < WORD_SCAN_BLOCK; idx++)
+                {
+                    byte = (unsigned char) buffer[offset + idx];
+                    if (((byte >= 'a') && (byte <= 'z')) ||
+                        ((byte >= 'A') && (byte <= 'Z')) ||
+                        ((byte >= '0') && (byte <= '9')))
+                    {
+                        expected |= (uint64_t) 1 << idx;
+                    }
+                }
+                TEST_ASSERT_TRUE (wordScanFunction ()(&buffer[offset]) ==
+                                  expected);
+                TEST_ASSERT_TRUE (wordScanTail (&buffer[offset], offset %
+                                                WORD_SCAN_BLOCK) ==
+                                  (expected & (((uint64_t) 1 <<
+                                                (offset % WORD_SCAN_BLOCK)) -
+                                               1)));
+            }
+        }
+        TEST_ASSERT_TRUE (wordScanTail (buffer, 0) == 0);
+        TEST_ASSERT_TRUE (wordScanSetKernel (original) == TRUE);
+    }
+}
+#endif /* defined(TEST) */
+
+/**
+ *******************************************************************************
+ * @brief wordScanFunction - The fastest kernel this CPU supports, or the one
+ * set by wordScanSetKernel().
+ *
+ * @par Description:
+ *      The first call checks the CPU (CPUID, through the compiler's
+ *      __builtin_cpu_supports()), every call after is a load.  Callers
+ *      fetch it once per buffer, not once per block.
+ *******************************************************************************
+ */
+Word_Scan_Fn_t wordScanFunction (void)
+{
+    (void) pthread_once (&g_scanOnce, _select_kernel);
+    return (g_scanFn);
+}
+
+/**
+ *******************************************************************************
+ * @brief wordScanTail - Classify fewer than WORD_SCAN_BLOCK bytes, as for a
+ * Word_Scan_Fn_t, the bits past 'len' clear.
+ *******************************************************************************
+ */
+uint64_t wordScanTail (const char *data, size_t len)
+{
+    uint64_t mask = 0;
+    size_t idx = 0;
+    unsigned char byte = 0;
+
+    for (idx = 0; idx < len; idx++)
+    {
+        byte = (unsigned char) data[idx];
+        if (((unsigned char) ((byte | 0x20) - 'a') < 26) ||
+            ((unsigned char) (byte - '0') < 10))
+        {
+            mask |= (uint64_t) 1 << idx;
+        }
+    }
+    return (mask);
+}
+
+/**
+ *******************************************************************************
+ * @brief wordScanKernel - Which kernel wordScanFunction() returns.
+ *******************************************************************************
+ */
+Word_Scan_Kernel_t wordScanKernel (void)
+{
+    (void) pthread_once (&g_scanOnce, _select_kernel);
+    return (g_scanKernel);
+}
+
+/**
+ *******************************************************************************
+ * @brief wordScanSupported - TRUE if 'kernel' is built in and this CPU can
+ * run it.
+ *******************************************************************************
+ */
+Bool_t wordScanSupported (Word_Scan_Kernel_t kernel)
+{
+    if ((kernel < WORD_SCAN_SCALAR) || (kernel >= WORD_SCAN_NUM_KERNELS) ||
+        (g_scanFns[kernel] == NULL))
+    {
+        return (FALSE);
+    }
+#if defined(WORD_SCAN_X86)
+    __builtin_cpu_init ();
+    switch (kernel)
+    {
+    case WORD_SCAN_SSE2:
+        return (__builtin_cpu_supports ("sse2") ? TRUE : FALSE);
+    case WORD_SCAN_AVX2:
+        return (__builtin_cpu_supports ("avx2") ? TRUE : FALSE);
+    case WORD_SCAN_AVX512:
+        return (__builtin_cpu_supports ("avx512bw") ? TRUE : FALSE);
+    default:
+        break;
+    }
+#endif
+    return (TRUE);
+}
+
+/**
+ *******************************************************************************
+ * @brief wordScanSetKernel - Use 'kernel' from now on, instead of the fastest
+ * one, for tests and benchmarks.
+ *
+ * <!-- Returns -->
+ *      @return FALSE, changing nothing, if the kernel is not supported.
+ *
+ * @par Pre/Post Conditions:
+ *      @pre     No thread is tokenizing.
+ *******************************************************************************
+ */
+Bool_t wordScanSetKernel (Word_Scan_Kernel_t kernel)
+{
+    (void) pthread_once (&g_scanOnce, _select_kernel);
+    if (wordScanSupported (kernel) == FALSE)
+    {
+        return (FALSE);
+    }
+    g_scanKernel = kernel;
+    g_scanFn = g_scanFns[kernel];
+    return (TRUE);
+}
+
+/**
+ *******************************************************************************
+ * @brief wordScanKernelName - Printable name of a kernel.
+ *******************************************************************************
+ */
+const char *wordScanKernelName (Word_Scan_Kernel_t kernel)
+{
+    switch (kernel)
+    {
+    case WORD_SCAN_SCALAR:
+        return ("scalar");
+    case WORD_SCAN_SSE2:
+        return ("sse2");
+    case WORD_SCAN_AVX2:
+        return ("avx2");
+    case WORD_SCAN_AVX512:
+        return ("avx512");
+    default:
+        return ("unknown");
+    }
+}
+
+/*******************************************************************************
+ ************************ L O C A L  F U N C T I O N S *************************
+ *******************************************************************************
+ */
+
+/**
+ *******************************************************************************
+ * @brief _select_kernel - Pick the fastest supported kernel, run once.
+ *******************************************************************************
+ */
+static void _select_kernel (void)
+{
+    int kernel = 0;
+
+    for (kernel = WORD_SCAN_NUM_KERNELS - 1; kernel > WORD_SCAN_SCALAR;
+         kernel--)
+    {
+        if (wordScanSupported ((Word_Scan_Kernel_t) kernel) == TRUE)
+        {
+            break;
+        }
+    }
+    g_scanKernel = (Word_Scan_Kernel_t) kernel;
+    g_scanFn = g_scanFns[kernel];
+}
+
+/**
+ *******************************************************************************
+ * @brief _scan_scalar - Word_Scan_Fn_t for any CPU.
+ *******************************************************************************
+ */
+static uint64_t _scan_scalar (const char *block)
+{
+    return (wordScanTail (block, WORD_SCAN_BLOCK));
+}
+
+#if defined(WORD_SCAN_X86)
+/*
+ * The SIMD kernels test both ranges, a-z (after setting the 0x20 bit, which
+ * folds A-Z onto it) and 0-9, with one compare each.  Adding 0x80 - lo moves
+ * lo..hi to the bottom of the signed byte range, so the byte is in range if
+ * it is then below -128 + (hi - lo + 1).  AVX-512BW has unsigned compares,
+ * and needs no such shift.
+ */
+
+/**
+ *******************************************************************************
+ * @brief _scan_sse2 - Word_Scan_Fn_t, 16 bytes per compare.
+ *******************************************************************************
+ */
+__attribute__ ((target ("sse2")))
+static uint64_t _scan_sse2 (const char *block)
+{
+    const __m128i fold = _mm_set1_epi8 (0x20);
+    const __m128i alpha_shift = _mm_set1_epi8 ((char) (0x80 - 'a'));
+    const __m128i alpha_limit = _mm_set1_epi8 ((char) (0x80 + 26));
+    const __m128i digit_shift = _mm_set1_epi8 ((char) (0x80 - '0'));
+    const __m128i digit_limit = _mm_set1_epi8 ((char) (0x80 + 10));
+    __m128i bytes;
+    __m128i word;
+    uint64_t mask = 0;
+    int idx = 0;
+
+    for (idx = 0; idx < WORD_SCAN_BLOCK; idx += 16)
+    {
+        bytes = _mm_loadu_si128 ((const __m128i *) (block + idx));
+        word = _mm_or_si128 (_mm_cmplt_epi8 (_mm_add_epi8 (_mm_or_si128
+                                                           (bytes, fold),
+                                                           alpha_shift),
+                                             alpha_limit),
+                             _mm_cmplt_epi8 (_mm_add_epi8 (bytes,
+                                                           digit_shift),
+                                             digit_limit));
+        mask |= (uint64_t) (uint32_t) _mm_movemask_epi8 (word) << idx;
+    }
+    return (mask);
+}
+
+/**
+ *******************************************************************************
+ * @brief _scan_avx2 - Word_Scan_Fn_t, 32 bytes per compare.
+ *******************************************************************************
+ */
+__attribute__ ((target ("avx2")))
+static uint64_t _scan_avx2 (const char *block)
+{
+    const __m256i fold = _mm256_set1_epi8 (0x20);
+    const __m256i alpha_shift = _mm256_set1_epi8 ((char) (0x80 - 'a'));
+    const __m256i alpha_limit = _mm256_set1_epi8 ((char) (0x80 + 26));
+    const __m256i digit_shift = _mm256_set1_epi8 ((char) (0x80 - '0'));
+    const __m256i digit_limit = _mm256_set1_epi8 ((char) (0x80 + 10));
+    __m256i bytes;
+    __m256i word;
+    uint64_t mask = 0;
+    int idx = 0;
+
+    for (idx = 0; idx < WORD_SCAN_BLOCK; idx += 32)
+    {
+        bytes = _mm256_loadu_si256 ((const __m256i *) (block + idx));
+        /* _mm256_cmpgt_epi8 (limit, x) is x < limit */
+        word = _mm256_or_si256 (_mm256_cmpgt_epi8 (alpha_limit,
+                                                   _mm256_add_epi8
+                                                   (_mm256_or_si256
+                                                    (bytes, fold),
+                                                    alpha_shift)),
+                                _mm256_cmpgt_epi8 (digit_limit,
+                                                   _mm256_add_epi8
+                                                   (bytes, digit_shift)));
+        mask |= (uint64_t) (uint32_t) _mm256_movemask_epi8 (word) << idx;
+    }
+    return (mask);
+}
+
+/**
+ *******************************************************************************
+ * @brief _scan_avx512 - Word_Scan_Fn_t, the whole block in one compare.
+ *******************************************************************************
+ */
+__attribute__ ((target ("avx512bw")))
+static uint64_t _scan_avx512 (const char *block)
+{
+    __m512i bytes = _mm512_loadu_si512 ((const void *) block);
+    __m512i alpha = _mm512_sub_epi8 (_mm512_or_si512 (bytes,
+                                                      _mm512_set1_epi8
+                                                      (0x20)),
+                                     _mm512_set1_epi8 ('a'));
+    __m512i digit = _mm512_sub_epi8 (bytes, _mm512_set1_epi8 ('0'));
+
+    return ((uint64_t) (_mm512_cmplt_epu8_mask (alpha,
+                                                _mm512_set1_epi8 (26)) |
+                        _mm512_cmplt_epu8_mask (digit,
+                                                _mm512_set1_epi8 (10))));
+}
+#endif /* defined(WORD_SCAN_X86) */
@@ -0,0 +1,117 @@
+#ifndef __WORD_SCAN_H__
+#define __WORD_SCAN_H__
+/**
+ * @file           word_scan.hpp
+ * @brief:         Word character classification, 64 bytes at a time.
+ * @verbatim
+ *******************************************************************************
+ * Author:         Douglas L. Potts
+ *
+ * Date:           10/17/2026, <SCR #>
+ *
+ *==============================================================================
+ *==============================================================================
+ * Copyright (c) 2015 Douglas Lee Potts
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ *==============================================================================
+ *==============================================================================
+ *
+ * History:
+ * Date        SCR #  Name  Description
+ * -----------------------------------------------------------------------------
+ *
+ *******************************************************************************
+ * @endverbatim
+ */
+
+/*******************************************************************************
+ * System Includes
+ *******************************************************************************
+ */
+#include <stddef.h>             /* for size_t */
+#include <stdint.h>             /* for uint64_t */
+
+/*******************************************************************************
+ * Project Includes
+ *******************************************************************************
+ */
+#include "common_types.h"
+
+#if defined(TEST)
+extern "C"
+{
+    void wordScanKernels (void);
+}
+#endif                          /* defined(TEST) */
+
+/*******************************************************************************
+ * Typedefs
+ *******************************************************************************
+ */
+
+/** Implementations of wordScanBlock(), slowest first */
+typedef enum
+{
+    WORD_SCAN_SCALAR = 0,       /**< A byte at a time, any CPU */
+    WORD_SCAN_SSE2 = 1,         /**< 16 bytes at a time */
+    WORD_SCAN_AVX2 = 2,         /**< 32 bytes at a time */
+    WORD_SCAN_AVX512 = 3,       /**< 64 bytes at a time, needs AVX-512BW */
+    WORD_SCAN_NUM_KERNELS = 4
+} Word_Scan_Kernel_t;
+
+/**
+ * Classifies the WORD_SCAN_BLOCK bytes at 'block', no alignment needed, bit N
+ * of the result set if byte N is a word character (see isWordChar()).
+ */
+typedef uint64_t (*Word_Scan_Fn_t) (const char *block);
+
+/*******************************************************************************
+ * Constants
+ *******************************************************************************
+ */
+/** Bytes classified by one call of a Word_Scan_Fn_t */
+#define WORD_SCAN_BLOCK (64)
+
+/*******************************************************************************
+ * Structures
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * Unions
+ *******************************************************************************
+ */
+
+/*******************************************************************************
+ * External Function Prototypes
+ *******************************************************************************
+ */
+Word_Scan_Fn_t wordScanFunction (void);
+uint64_t wordScanTail (const char *data, size_t len);
+Word_Scan_Kernel_t wordScanKernel (void);
+Bool_t wordScanSupported (Word_Scan_Kernel_t kernel);
+Bool_t wordScanSetKernel (Word_Scan_Kernel_t kernel);
+const char *wordScanKernelName (Word_Scan_Kernel_t kernel);
+
+/*******************************************************************************
+ * Global Variables
+ *******************************************************************************
+ */
+#if _MAIN_
+#define GLOBAL_VAR_DECLARE
+#else
+#define GLOBAL_VAR_DECLARE extern
+#endif /* _MAIN_ */
+
+#endif /* __WORD_SCAN_H__ */
@@ -80,6 +80,7 @@ Work_Queue::Work_Queue (void)
     _mut_init = FALSE;
     _con_init = FALSE;
     _is_locked = FALSE;
+    _pathBytes = 0;
 
     stat = pthread_cond_init (&_con, NULL);
     EXIT_EARLY_ON_ERROR (stat);
@@ -107,7 +108,7 @@ Work_Queue::~Work_Queue (void)
     _lock ();
     while (!_filePathQueue.empty ())
     {
-        _filePathQueue.pop ();
+        _filePathQueue.pop_front ();
     }
     _unlock ();
 
@@ -166,10 +167,12 @@ void Work_Queue::_unlock (void)
 {
     int stat = STATUS_SUCCESS;
 
+    /* Cleared while still held, the next locker sets it */
+    _is_locked = FALSE;
     stat = pthread_mutex_unlock (&_mut);
-    if (stat == STATUS_SUCCESS)
+    if (stat != STATUS_SUCCESS)
     {
-        _is_locked = FALSE;
+        _is_locked = TRUE;
     }
 }
 
@@ -213,9 +216,34 @@ void Work_Queue::_wait (void)
  *******************************************************************************
  */
 void Work_Queue::push (string filePath)
+{
+    Work_Item_t item;
+
+    item.path = filePath;
+    item.offset = 0;
+    item.length = 0;
+    _lock ();
+    _filePathQueue.push_back (item);
+    _pathBytes += _itemBytes (item);
+    _unlock ();
+    _signal ();
+}
+
+/**
+ *******************************************************************************
+ * @brief pushFront - Put an item at the front of the queue, ahead of anything
+ * already waiting, "EXIT"s included.
+ *
+ * @par Description:
+ *      For the chunks of a file a worker has split, so they are taken next,
+ *      while the file is being read, and can't end up behind the "EXIT"s.
+ *******************************************************************************
+ */
+void Work_Queue::pushFront (const Work_Item_t & item)
 {
     _lock ();
-    _filePathQueue.push (filePath);
+    _filePathQueue.push_front (item);
+    _pathBytes += _itemBytes (item);
     _unlock ();
     _signal ();
 }
@@ -228,7 +256,8 @@ void Work_Queue::push (string filePath)
 void Work_Queue::pop (void)
 {
     _lock ();
-    _filePathQueue.pop ();
+    _pathBytes -= _itemBytes (_filePathQueue.front ());
+    _filePathQueue.pop_front ();
     _unlock ();
 }
 
@@ -249,19 +278,94 @@ void Work_Queue::waitForNotEmpty (void)
 /**
  *******************************************************************************
  * @brief pop_front - Public method to pop_front for underlying data structure.
+ *
+ * @par Description:
+ *      The path of popItem(), for a queue of whole files.
  *******************************************************************************
  */
 string Work_Queue::pop_front (void)
 {
-    string front_item;
+    return (popItem ().path);
+}
+
+/**
+ *******************************************************************************
+ * @brief tryPopFront - pop_front(), without waiting for an item.
+ *
+ * <!-- Parameters -->
+ *      @param[out]     item           The front item, if there was one
+ *
+ * <!-- Returns -->
+ *      @return TRUE    If an item was popped into 'item'
+ *      @return FALSE   If the queue was empty
+ *******************************************************************************
+ */
+Bool_t Work_Queue::tryPopFront (string & item)
+{
+    Work_Item_t front_item;
+
+    if (tryPopItem (front_item) == FALSE)
+    {
+        return (FALSE);
+    }
+    item = front_item.path;
+    return (TRUE);
+}
+
+/**
+ *******************************************************************************
+ * @brief popItem - Pop the front item, a file or a chunk of one.
+ *
+ * @par Description:
+ *      Waits, under the queue lock, for an item to be present.  Several
+ *      readers can see the same item after waitForNotEmpty(), only one of
+ *      them gets it, the others keep waiting.
+ *******************************************************************************
+ */
+Work_Item_t Work_Queue::popItem (void)
+{
+    Work_Item_t front_item;
 
     _lock ();
+    while (_filePathQueue.empty ())
+    {
+        pthread_cond_wait (&_con, &_mut);
+    }
     front_item = _filePathQueue.front ();
-    _filePathQueue.pop ();
+    _pathBytes -= _itemBytes (front_item);
+    _filePathQueue.pop_front ();
     _unlock ();
     return (front_item);
 }
 
+/**
+ *******************************************************************************
+ * @brief tryPopItem - popItem(), without waiting for an item.
+ *
+ * <!-- Parameters -->
+ *      @param[out]     item           The front item, if there was one
+ *
+ * <!-- Returns -->
+ *      @return TRUE    If an item was popped into 'item'
+ *      @return FALSE   If the queue was empty
+ *******************************************************************************
+ */
+Bool_t Work_Queue::tryPopItem (Work_Item_t & item)
+{
+    Bool_t popped = FALSE;
+
+    _lock ();
+    if (_filePathQueue.empty () == false)
+    {
+        item = _filePathQueue.front ();
+        _pathBytes -= _itemBytes (item);
+        _filePathQueue.pop_front ();
+        popped = TRUE;
+    }
+    _unlock ();
+    return (popped);
+}
+
 /**
  *******************************************************************************
  * @brief front - Public method to get front for underlying data structure.
@@ -272,7 +376,7 @@ string Work_Queue::front (void)
     string front_item;
 
     _lock ();
-    front_item = _filePathQueue.front ();
+    front_item = _filePathQueue.front ().path;
     _unlock ();
     return (front_item);
 }
@@ -307,7 +411,32 @@ Bool_t Work_Queue::empty ()
     return (isEmpty);
 }
 
+/**
+ *******************************************************************************
+ * @brief bytesUsed - Memory held by the queued file paths.
+ *******************************************************************************
+ */
+size_t Work_Queue::bytesUsed (void)
+{
+    size_t bytes = 0;
+
+    _lock ();
+    bytes = _pathBytes;
+    _unlock ();
+    return (bytes);
+}
+
 /*******************************************************************************
  ************************ L O C A L  F U N C T I O N S *************************
  *******************************************************************************
  */
+
+/**
+ *******************************************************************************
+ * @brief _itemBytes - Memory an item holds in the queue, for bytesUsed().
+ *******************************************************************************
+ */
+size_t Work_Queue::_itemBytes (const Work_Item_t & item)
+{
+    return (sizeof (Work_Item_t) + item.path.size () + 1);
+}
@@ -22,7 +22,8 @@
  *******************************************************************************
  */
 #include <pthread.h>            /* for pthread_* calls */
-#include <queue>
+#include <stdint.h>             /* for uint64_t */
+#include <deque>
 #include <string>
 
 /*******************************************************************************
@@ -47,6 +48,15 @@
  */
 using namespace std;
 
+/** One piece of work: a whole file, a chunk of one, or "EXIT" */
+typedef struct
+{
+    string path;                /**< File path, or "EXIT" */
+    uint64_t offset;            /**< File offset of the chunk's first byte */
+    uint64_t length;            /**< Bytes in the chunk, 0 for the whole
+                                  file */
+} Work_Item_t;
+
 class Work_Queue
 {
   public:
@@ -59,12 +69,17 @@ class Work_Queue
         return (_is_locked);
     };
     void push (string filePath);
+    void pushFront (const Work_Item_t & item);
     void pop (void);
     void waitForNotEmpty (void);
     string pop_front (void);
+    Bool_t tryPopFront (string & item);
+    Work_Item_t popItem (void);
+    Bool_t tryPopItem (Work_Item_t & item);
     string front (void);
     unsigned int size (void);
     Bool_t empty ();
+    size_t bytesUsed (void);
 
 
   private:
@@ -74,7 +89,9 @@ class Work_Queue
     pthread_mutex_t _mut;
     pthread_cond_t _con;
 
-    queue < string > _filePathQueue;
+    deque < Work_Item_t > _filePathQueue;
+    size_t _pathBytes;
+    size_t _itemBytes (const Work_Item_t & item);
     void _lock (void);
     void _unlock (void);
     void _signal (void);